@@ -732,3 +732,43 @@ IF(HAVE_LIBNUMA AND NOT WITH_NUMA)
    SET(HAVE_LIBNUMA 0)
    MESSAGE(STATUS "Disabling NUMA on user's request")
 ENDIF()
+
+CHECK_INCLUDE_FILES(zstd.h HAVE_ZSTD_H)
+CHECK_INCLUDE_FILES(zdict.h HAVE_ZDICT_H)
+
+IF(HAVE_ZSTD_H AND HAVE_ZDICT_H)
+    SET(SAVE_CMAKE_REQUIRED_LIBRARIES ${CMAKE_REQUIRED_LIBRARIES})
+    SET(CMAKE_REQUIRED_LIBRARIES ${CMAKE_REQUIRED_LIBRARIES} zstd)
+    CHECK_C_SOURCE_COMPILES(
+    "
+    #include <zstd.h>
+    #include <zdict.h>
+    int main()
+    {
+       ZSTD_DDict *ddict= ZSTD_createDDict(0, 0);
+       unsigned id= ZSTD_getDictID_fromFrame(0, 0) + ZDICT_getDictID(0, 0);
+       ZSTD_freeDDict(ddict);
+       return (int) id;
+    }"
+    HAVE_LIBZSTD)
+    SET(CMAKE_REQUIRED_LIBRARIES ${SAVE_CMAKE_REQUIRED_LIBRARIES})
+ELSE()
+    SET(HAVE_LIBZSTD 0)
+ENDIF()
+
+IF(HAVE_LIBZSTD)
+   OPTION(WITH_ZSTD "Support Zstandard page compression in InnoDB" ON)
+ELSE()
+   OPTION(WITH_ZSTD "Support Zstandard page compression in InnoDB" OFF)
+ENDIF()
+
+IF(WITH_ZSTD AND NOT HAVE_LIBZSTD)
+  # Forget it in cache, abort the build.
+  UNSET(WITH_ZSTD CACHE)
+  MESSAGE(FATAL_ERROR "Could not find zstd headers/libraries")
+ENDIF()
+
+IF(HAVE_LIBZSTD AND NOT WITH_ZSTD)
+   SET(HAVE_LIBZSTD 0)
+   MESSAGE(STATUS "Disabling Zstandard on user's request")
+ENDIF()
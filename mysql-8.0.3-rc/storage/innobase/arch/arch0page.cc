@@ -922,9 +922,9 @@ Arch_Page_Sys::start(
 
 		if (!attach_to_current) {
 
-			log_mutex_enter();
+			log_buffer_x_lock_enter();
 
-			log_sys_lsn = log_sys->lsn;
+			log_sys_lsn = log_get_lsn();
 
 			/* Enable/Reset buffer pool page tracking. */
 			set_tracking_buf_pool(log_sys_lsn);
@@ -934,7 +934,7 @@ Arch_Page_Sys::start(
 			tracked. */
 			arch_oper_mutex_enter();
 
-			log_mutex_exit();
+			log_buffer_x_lock_exit();
 		}
 		break;
 
@@ -1056,9 +1056,9 @@ Arch_Page_Sys::stop(
 	uint		count = 0;
 
 	arch_mutex_enter();
-	log_mutex_enter();
+	log_buffer_x_lock_enter();
 
-	*stop_lsn = log_sys->lsn;
+	*stop_lsn = log_get_lsn();
 
 	count = group->detach(*stop_lsn);
 
@@ -1071,7 +1071,7 @@ Arch_Page_Sys::stop(
 		set_tracking_buf_pool(LSN_MAX);
 
 		arch_oper_mutex_enter();
-		log_mutex_exit();
+		log_buffer_x_lock_exit();
 
 		m_state = ARCH_STATE_PREPARE_IDLE;
 
@@ -1089,7 +1089,7 @@ Arch_Page_Sys::stop(
 		os_event_set(archiver_thread_event);
 	} else {
 
-		log_mutex_exit();
+		log_buffer_x_lock_exit();
 		arch_oper_mutex_enter();
 
 		*stop_pos = m_write_pos;
@@ -750,6 +750,8 @@ btr_cur_search_to_nth_level(
 	cursor->low_match = ULINT_UNDEFINED;
 #endif /* UNIV_DEBUG */
 
+	cursor->parent_page_no = FIL_NULL;
+
 	ibool	s_latch_by_caller;
 
 	s_latch_by_caller = latch_mode & BTR_ALREADY_S_LATCHED;
@@ -1704,6 +1706,10 @@ need_opposite_intention:
 			}
 		}
 
+		if (height == 0) {
+			cursor->parent_page_no = block->page.id.page_no();
+		}
+
 		/* Go to the child node */
 		page_id.reset(
 			space,
@@ -1953,6 +1959,8 @@ btr_cur_search_to_nth_level_with_no_latch(
 	cursor->low_match = ULINT_UNDEFINED;
 #endif /* UNIV_DEBUG */
 
+	cursor->parent_page_no = FIL_NULL;
+
 	cursor->flag = BTR_CUR_BINARY;
 	cursor->index = index;
 
@@ -2161,6 +2169,8 @@ btr_cur_open_at_index_side_func(
 		node_ptr_max_size = dict_index_node_ptr_max_size(index);
 	}
 
+	cursor->parent_page_no = FIL_NULL;
+
 	height = ULINT_UNDEFINED;
 
 	for (;;) {
@@ -2394,6 +2404,10 @@ btr_cur_open_at_index_side_func(
 			}
 		}
 
+		if (height == 0) {
+			cursor->parent_page_no = block->page.id.page_no();
+		}
+
 		/* Go to the child node */
 		page_id.set_page_no(
 			btr_node_ptr_get_child_page_no(node_ptr, offsets));
@@ -2445,6 +2459,8 @@ btr_cur_open_at_index_side_with_no_latch_func(
 					dict_index_get_page(index));
 	const page_size_t&	page_size = dict_table_page_size(index->table);
 
+	cursor->parent_page_no = FIL_NULL;
+
 	height = ULINT_UNDEFINED;
 
 	for (;;) {
@@ -2496,6 +2512,10 @@ btr_cur_open_at_index_side_with_no_latch_func(
 		offsets = rec_get_offsets(node_ptr, cursor->index, offsets,
 					  ULINT_UNDEFINED, &heap);
 
+		if (height == 0) {
+			cursor->parent_page_no = block->page.id.page_no();
+		}
+
 		/* Go to the child node */
 		page_id.set_page_no(
 			btr_node_ptr_get_child_page_no(node_ptr, offsets));
@@ -2604,6 +2624,8 @@ btr_cur_open_at_rnd_pos_func(
 		node_ptr_max_size = dict_index_node_ptr_max_size(index);
 	}
 
+	cursor->parent_page_no = FIL_NULL;
+
 	height = ULINT_UNDEFINED;
 
 	for (;;) {
@@ -2772,6 +2794,10 @@ btr_cur_open_at_rnd_pos_func(
 			}
 		}
 
+		if (height == 0) {
+			cursor->parent_page_no = block->page.id.page_no();
+		}
+
 		/* Go to the child node */
 		page_id.set_page_no(
 			btr_node_ptr_get_child_page_no(node_ptr, offsets));
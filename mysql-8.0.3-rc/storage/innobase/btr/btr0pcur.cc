@@ -27,9 +27,11 @@ Created 2/23/1996 Heikki Tuuri
 
 #include <stddef.h>
 
+#include "buf0rea.h"
 #include "my_dbug.h"
 #include "my_inttypes.h"
 #include "rem0cmp.h"
+#include "srv0srv.h"
 #include "trx0trx.h"
 #include "ut0byte.h"
 
@@ -395,6 +397,196 @@ btr_pcur_restore_position_func(
 	return(FALSE);
 }
 
+/** Maximum number of leaf pages that one call of btr_pcur_read_ahead()
+requests. This is the upper bound of innodb_read_ahead_leaf_pages. */
+static const ulint	BTR_PCUR_READ_AHEAD_MAX = 256;
+
+/** Collects the page numbers of the leaf pages that follow a leaf page in
+the scan order, from the node pointers of the level 1 page remembered in
+btr_cur_t::parent_page_no. If the leaf page is not found there, the scan has
+crossed to the neighbouring parent page, which is tried next. The parent
+pages are only latched if that can be done without waiting, because the
+caller holds a latch on the leaf page.
+@param[in,out]	btr_cur		tree cursor; parent_page_no is updated to
+				the parent of leaf_page_no, or reset to
+				FIL_NULL if it turns out to be stale
+@param[in]	leaf_page_no	leaf page the scan is positioned on
+@param[in]	forward		true if the scan moves to the next pages
+@param[in]	depth		maximum number of pages to collect
+@param[out]	page_nos	collected page numbers, in scan order
+@return number of page numbers collected */
+static
+ulint
+btr_pcur_read_ahead_collect(
+	btr_cur_t*	btr_cur,
+	page_no_t	leaf_page_no,
+	bool		forward,
+	ulint		depth,
+	page_no_t*	page_nos)
+{
+	const dict_index_t*	index = btr_cur->index;
+	const space_id_t	space_id = dict_index_get_space(index);
+	page_no_t		father_no = btr_cur->parent_page_no;
+	bool			found = false;
+	bool			stale = false;
+	ulint			n = 0;
+	mem_heap_t*		heap = NULL;
+	ulint			offsets_[REC_OFFS_NORMAL_SIZE];
+	ulint*			offsets = offsets_;
+	rec_offs_init(offsets_);
+
+	for (ulint i = 0; i < 2 && father_no != FIL_NULL && n < depth; i++) {
+		mtr_t	mtr;
+
+		mtr_start(&mtr);
+
+		const buf_block_t*	father
+			= buf_page_try_get_possibly_freed(
+				page_id_t(space_id, father_no), &mtr);
+
+		if (father == NULL) {
+			mtr_commit(&mtr);
+			break;
+		}
+
+		const page_t*	page = buf_block_get_frame(father);
+
+		if (!fil_page_index_page_check(page)
+		    || btr_page_get_index_id(page) != index->id
+		    || btr_page_get_level_low(page) != 1) {
+
+			/* The page was freed or reused since the
+			descent: the hint is useless. */
+			mtr_commit(&mtr);
+			stale = !found;
+			break;
+		}
+
+		const rec_t*	rec = forward
+			? page_rec_get_next_const(page_get_infimum_rec(page))
+			: page_rec_get_prev_const(page_get_supremum_rec(page));
+
+		while (!page_rec_is_infimum(rec) && !page_rec_is_supremum(rec)
+		       && n < depth) {
+
+			offsets = rec_get_offsets(
+				rec, index, offsets, ULINT_UNDEFINED, &heap);
+
+			page_no_t	child = btr_node_ptr_get_child_page_no(
+				rec, offsets);
+
+			if (found) {
+				page_nos[n++] = child;
+			} else if (child == leaf_page_no) {
+				found = true;
+				btr_cur->parent_page_no = father_no;
+			}
+
+			rec = forward
+				? page_rec_get_next_const(rec)
+				: page_rec_get_prev_const(rec);
+		}
+
+		father_no = forward
+			? btr_page_get_next(page, &mtr)
+			: btr_page_get_prev(page, &mtr);
+
+		mtr_commit(&mtr);
+
+		if (!found && (i == 1 || father_no == FIL_NULL)) {
+			stale = true;
+		}
+	}
+
+	if (stale) {
+		btr_cur->parent_page_no = FIL_NULL;
+	}
+
+	if (heap != NULL) {
+		mem_heap_free(heap);
+	}
+
+	return(n);
+}
+
+/** Requests asynchronous reads of the leaf pages that a scan is about to
+visit, after the cursor moved to a neighbouring leaf page. The number of
+pages read ahead grows with the number of consecutive page moves in the same
+direction, up to srv_read_ahead_leaf_pages, so that point lookups and short
+ranges do not read more than they use. The pages are found through the node
+pointers of the parent page and so are read ahead no matter where they lie
+in the tablespace; if the parent page cannot be used, only the sibling of the
+current leaf page is requested.
+@param[in,out]	cursor	persistent cursor, just moved to another page
+@param[in]	forward	true if the cursor moved to the next page
+@param[in]	mtr	mini-transaction holding the leaf page latch */
+static
+void
+btr_pcur_read_ahead(
+	btr_pcur_t*	cursor,
+	bool		forward,
+	mtr_t*		mtr)
+{
+	btr_cur_t*		btr_cur = btr_pcur_get_btr_cur(cursor);
+	const dict_index_t*	index = btr_cur->index;
+	const ulint		max_depth = srv_read_ahead_leaf_pages;
+
+	if (max_depth == 0
+	    || index->table->is_intrinsic()
+	    || dict_index_is_spatial(index)
+	    || dict_index_is_ibuf(index)) {
+
+		return;
+	}
+
+	if (cursor->read_ahead_forward != forward) {
+		cursor->read_ahead_forward = forward;
+		cursor->read_ahead_moves = 0;
+		cursor->read_ahead_issued = 0;
+	}
+
+	++cursor->read_ahead_moves;
+
+	if (cursor->read_ahead_issued > 0) {
+		--cursor->read_ahead_issued;
+	}
+
+	const ulint	depth = ut_min(
+		ut_min(cursor->read_ahead_moves, max_depth),
+		BTR_PCUR_READ_AHEAD_MAX);
+
+	/* Top up the window only when half of it has been consumed, so
+	that the parent page is not scanned on every page move. */
+	if (cursor->read_ahead_issued > depth / 2) {
+		return;
+	}
+
+	const buf_block_t*	block = btr_pcur_get_block(cursor);
+	page_no_t		page_nos[BTR_PCUR_READ_AHEAD_MAX];
+
+	ulint	n = btr_pcur_read_ahead_collect(
+		btr_cur, block->page.id.page_no(), forward, depth, page_nos);
+
+	if (n == 0) {
+		const page_t*	page = buf_block_get_frame(block);
+
+		page_nos[0] = forward
+			? btr_page_get_next(page, mtr)
+			: btr_page_get_prev(page, mtr);
+
+		if (page_nos[0] == FIL_NULL) {
+			return;
+		}
+
+		n = 1;
+	}
+
+	buf_read_ahead_leaves(
+		block->page.id.space(), block->page.size, page_nos, n);
+
+	cursor->read_ahead_issued = n;
+}
+
 /*********************************************************//**
 Moves the persistent cursor to the first record on the next page. Releases the
 latch on the current page, and bufferunfixes it. Note that there must not be
@@ -459,6 +651,8 @@ btr_pcur_move_to_next_page(
 	page_cur_set_before_first(next_block, btr_pcur_get_page_cur(cursor));
 
 	ut_d(page_check_dir(next_page));
+
+	btr_pcur_read_ahead(cursor, true, mtr);
 }
 
 /*********************************************************//**
@@ -529,6 +723,8 @@ btr_pcur_move_backward_from_page(
 
 			page_cur_set_after_last(prev_block,
 					btr_pcur_get_page_cur(cursor));
+
+			btr_pcur_read_ahead(cursor, false, mtr);
 		} else {
 
 			/* The repositioned cursor did not end on an infimum
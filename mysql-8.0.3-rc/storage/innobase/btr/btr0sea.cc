@@ -44,6 +44,7 @@ Created 2/17/1996 Heikki Tuuri
 #include "page0cur.h"
 #include "page0page.h"
 #include "srv0mon.h"
+#include "srv0start.h"
 #include "sync0sync.h"
 
 /** Is search system enabled.
@@ -89,6 +90,70 @@ is then built on the page, assuming the global limit has been reached */
 before hash index building is started */
 #define BTR_SEARCH_BUILD_LIMIT		100
 
+/** Maximum number of page hash index build requests in the queue */
+#define BTR_SEARCH_BUILD_QUEUE_SIZE	1024
+
+/** Maximum number of requests that btr_search_build_thread() takes from the
+queue at a time */
+#define BTR_SEARCH_BUILD_BATCH		64
+
+/** A request to build the hash index of a page */
+struct btr_search_build_req_t {
+	/** index of the page; pinned by btr_search_t::n_pending */
+	dict_index_t*	index;
+
+	/** block that contained the page when the request was made */
+	buf_block_t*	block;
+
+	/** tablespace of the page that the request is for */
+	space_id_t	space_id;
+
+	/** number of the page that the request is for */
+	page_no_t	page_no;
+
+	/** block->modify_clock when the request was made */
+	uint64_t	modify_clock;
+
+	/** buf_withdraw_clock when the request was made */
+	ulint		withdraw_clock;
+
+	/** hash this many full fields */
+	ulint		n_fields;
+
+	/** hash this many bytes of the next field */
+	ulint		n_bytes;
+
+	/** hash for searches from the left side */
+	ibool		left_side;
+};
+
+/** Page hash index build requests waiting for btr_search_build_thread() */
+struct btr_search_build_queue_t {
+	/** protects the other fields and btr_search_t::n_pending */
+	ib_mutex_t		mutex;
+
+	/** circular buffer of requests */
+	btr_search_build_req_t	reqs[BTR_SEARCH_BUILD_QUEUE_SIZE];
+
+	/** position of the oldest request in reqs */
+	ulint			first;
+
+	/** number of requests in reqs */
+	ulint			n_reqs;
+
+	/** true while btr_search_build_thread() accepts requests */
+	bool			accepting;
+};
+
+/** The page hash index build queue */
+static btr_search_build_queue_t*	btr_search_build_queue;
+
+/** Event to wake up btr_search_build_thread() */
+os_event_t	btr_search_build_event;
+
+/** true if btr_search_build_thread() is running */
+bool		btr_search_build_thread_active	= false;
+
 /** Compute the hash value of an index identifier.
 @param[in]	space_id	tablespace identifier
 @param[in]	index_id	index identifier
@@ -241,6 +306,20 @@ btr_search_sys_create(ulint hash_size)
 		btr_search_sys->hash_tables[i]->adaptive = TRUE;
 #endif /* UNIV_AHI_DEBUG || UNIV_DEBUG */
 	}
+
+	/* Step-3: Create the queue of background page hash index
+	builds. */
+	btr_search_build_queue = UT_NEW(
+		btr_search_build_queue_t(), mem_key_ahi);
+
+	mutex_create(LATCH_ID_AHI_BUILD_QUEUE,
+		     &btr_search_build_queue->mutex);
+
+	btr_search_build_queue->first = 0;
+	btr_search_build_queue->n_reqs = 0;
+	btr_search_build_queue->accepting = false;
+
+	btr_search_build_event = os_event_create(0);
 }
 
 /** Resize hash index hash table.
@@ -313,6 +392,46 @@ btr_search_sys_free()
 
 	ut_free(btr_search_latches);
 	btr_search_latches = NULL;
+
+	/* Step-3: Release the queue of background page hash index
+	builds. btr_search_build_thread() has exited by now. */
+	ut_ad(!btr_search_build_queue->accepting);
+	ut_ad(btr_search_build_queue->n_reqs == 0);
+
+	os_event_destroy(btr_search_build_event);
+
+	mutex_free(&btr_search_build_queue->mutex);
+	UT_DELETE(btr_search_build_queue);
+	btr_search_build_queue = NULL;
+}
+
+/** Remove queued page hash index build requests. The caller must hold the
+build queue mutex.
+@param[in]	index	remove the requests for this index, or all requests
+			if NULL */
+static
+void
+btr_search_build_queue_remove(const dict_index_t* index)
+{
+	btr_search_build_queue_t*	queue = btr_search_build_queue;
+	ulint				n_kept = 0;
+
+	ut_ad(mutex_own(&queue->mutex));
+
+	for (ulint i = 0; i < queue->n_reqs; ++i) {
+		const btr_search_build_req_t&	req = queue->reqs[
+			(queue->first + i) % BTR_SEARCH_BUILD_QUEUE_SIZE];
+
+		if (index == NULL || req.index == index) {
+			ut_ad(req.index->search_info->n_pending > 0);
+			--req.index->search_info->n_pending;
+		} else {
+			queue->reqs[(queue->first + n_kept++)
+				    % BTR_SEARCH_BUILD_QUEUE_SIZE] = req;
+		}
+	}
+
+	queue->n_reqs = n_kept;
 }
 
 /** Set index->ref_count = 0 on all indexes of a table.
@@ -362,6 +481,13 @@ btr_search_disable(
 
 	btr_search_enabled = false;
 
+	/* Forget the queued page hash index builds. A request that
+	btr_search_build_thread() is processing right now will notice
+	that the search system is disabled. */
+	mutex_enter(&btr_search_build_queue->mutex);
+	btr_search_build_queue_remove(NULL);
+	mutex_exit(&btr_search_build_queue->mutex);
+
 	/* Clear the index->search_info->ref_count of every index in
 	the data dictionary cache. */
 	for (table = UT_LIST_GET_FIRST(dict_sys->table_LRU); table;
@@ -426,6 +552,13 @@ btr_search_info_create(mem_heap_t* heap)
 
 	info->last_hash_succ = FALSE;
 
+	info->n_pending = 0;
+	info->n_sampled_hits = 0;
+	info->n_sampled_misses = 0;
+	info->ahi_disabled = FALSE;
+	info->n_disabled = 0;
+	info->n_skipped = 0;
+
 #ifdef UNIV_SEARCH_PERF_STAT
 	info->n_hash_succ = 0;
 	info->n_hash_fail = 0;
@@ -453,17 +586,25 @@ btr_search_info_get_ref_count(
 {
 	ulint ret = 0;
 
+	ut_ad(info);
+
+	/* A queued page hash index build must not outlive the index,
+	even if the search system has been disabled meanwhile. */
+	if (btr_search_build_queue != NULL) {
+		mutex_enter(&btr_search_build_queue->mutex);
+		ret = info->n_pending;
+		mutex_exit(&btr_search_build_queue->mutex);
+	}
+
 	if (!btr_search_enabled) {
 		return(ret);
 	}
 
-	ut_ad(info);
-
 	ut_ad(!rw_lock_own(btr_get_search_latch(index), RW_LOCK_S));
 	ut_ad(!rw_lock_own(btr_get_search_latch(index), RW_LOCK_X));
 
 	btr_search_s_lock(index);
-	ret = info->ref_count;
+	ret += info->ref_count;
 	btr_search_s_unlock(index);
 
 	return(ret);
@@ -733,6 +874,63 @@ btr_search_update_hash_ref(
 	}
 }
 
+/** Queue a page hash index build for btr_search_build_thread(), using the
+hash parameters recommended in the block.
+@param[in]	index	index of the page
+@param[in]	block	index page, s- or x-latched
+@return false if the page has to be hashed by the caller */
+static
+bool
+btr_search_build_enqueue(
+	dict_index_t*	index,
+	buf_block_t*	block)
+{
+	btr_search_build_queue_t*	queue = btr_search_build_queue;
+
+	/* Pages of temporary tables are not always latched, so that
+	the modify clock cannot tell if they have changed. */
+	if (index->table->is_temporary()) {
+		return(false);
+	}
+
+	mutex_enter(&queue->mutex);
+
+	if (!queue->accepting
+	    || queue->n_reqs == BTR_SEARCH_BUILD_QUEUE_SIZE) {
+
+		mutex_exit(&queue->mutex);
+
+		return(false);
+	}
+
+	btr_search_build_req_t&	req = queue->reqs[
+		(queue->first + queue->n_reqs) % BTR_SEARCH_BUILD_QUEUE_SIZE];
+
+	req.index = index;
+	req.block = block;
+	req.space_id = block->page.id.space();
+	req.page_no = block->page.id.page_no();
+	req.modify_clock = buf_block_get_modify_clock(block);
+	req.withdraw_clock = buf_withdraw_clock;
+	req.n_fields = block->n_fields;
+	req.n_bytes = block->n_bytes;
+	req.left_side = block->left_side;
+
+	++index->search_info->n_pending;
+
+	const bool	wake = queue->n_reqs++ == 0;
+
+	mutex_exit(&queue->mutex);
+
+	if (wake) {
+		os_event_set(btr_search_build_event);
+	}
+
+	MONITOR_INC(MONITOR_ADAPTIVE_HASH_PAGE_QUEUED);
+
+	return(true);
+}
+
 /** Updates the search info.
 @param[in,out]	info	search info
 @param[in]	cursor	cursor which was just positioned */
@@ -781,11 +979,59 @@ btr_search_info_update_slow(
 		/* Note that since we did not protect block->n_fields etc.
 		with any semaphore, the values can be inconsistent. We have
 		to check inside the function call that they make sense. */
-		btr_search_build_page_hash_index(cursor->index, block,
-						 block->n_fields,
-						 block->n_bytes,
-						 block->left_side);
+		if (btr_search_build_enqueue(cursor->index, block)) {
+			/* Do not queue the page again before it has
+			been hashed. */
+			block->n_hash_helps = 0;
+		} else {
+			btr_search_build_page_hash_index(cursor->index, block,
+							 block->n_fields,
+							 block->n_bytes,
+							 block->left_side);
+		}
+	}
+}
+
+/** Updates the search info of an index on which hash searches have been
+turned off.
+@param[in,out]	info	search info
+@param[in]	cursor	cursor which was just positioned */
+void
+btr_search_info_update_disabled(
+	btr_search_t*	info,
+	btr_cur_t*	cursor)
+{
+	buf_block_t*	block = btr_cur_get_block(cursor);
+
+	ut_ad(rw_lock_own(&block->lock, RW_LOCK_S)
+	      || rw_lock_own(&block->lock, RW_LOCK_X));
+
+	/* Drop the hash index of the pages that are still hashed when
+	they are visited, instead of scanning the buffer pool. */
+	if (block->index != NULL) {
+		btr_search_drop_page_hash_index(block);
+	}
+
+	/* The searches stay off twice as long each time they have
+	been turned off for the index. */
+	const ulint	n_disabled = ut_min(info->n_disabled, ulint(7));
+	const ulint	limit = BTR_SEARCH_REENABLE_LIMIT
+		<< (n_disabled > 0 ? n_disabled - 1 : 0);
+
+	if (++info->n_skipped < limit) {
+		return;
 	}
+
+	info->hash_analysis = 0;
+	info->n_hash_potential = 0;
+	info->last_hash_succ = FALSE;
+	info->ahi_disabled = FALSE;
+
+	MONITOR_INC(MONITOR_ADAPTIVE_HASH_INDEX_ENABLED);
+
+	ib::info() << "Trying adaptive hash index searches again on index "
+		<< cursor->index->name << " of table "
+		<< cursor->index->table->name;
 }
 
 /** Checks if a guessed position for a tree cursor is right. Note that if
@@ -932,9 +1178,70 @@ exit_func:
 	return(success);
 }
 
+/** Samples the outcome of a hash search, and turns hash searches off for the
+index if too few of the sampled searches succeeded. Only one in
+BTR_SEARCH_SAMPLE_RATE searches of a thread is sampled, so that the
+searches do not keep writing to the shared search info.
+@param[in]	index	index
+@param[in,out]	info	search info of the index
+@param[in]	hit	whether the hash search succeeded */
+static
+void
+btr_search_sample(
+	const dict_index_t*	index,
+	btr_search_t*		info,
+	bool			hit)
+{
+	static thread_local ulint	n_searches;
+
+	if ((++n_searches & (BTR_SEARCH_SAMPLE_RATE - 1)) != 0) {
+		return;
+	}
+
+	ulint	n_hits = info->n_sampled_hits;
+	ulint	n_misses = info->n_sampled_misses;
+
+	if (hit) {
+		info->n_sampled_hits = ++n_hits;
+	} else {
+		info->n_sampled_misses = ++n_misses;
+	}
+
+	const ulint	n_samples = n_hits + n_misses;
+
+	if (n_samples < BTR_SEARCH_SAMPLE_WINDOW) {
+		return;
+	}
+
+	info->n_sampled_hits = 0;
+	info->n_sampled_misses = 0;
+
+	if (info->ahi_disabled
+	    || n_hits * 100 >= n_samples * BTR_SEARCH_MIN_HIT_PCT) {
+		return;
+	}
+
+	/* The hash searches cost more than they save. Leave the index
+	alone for a while; btr_search_info_update_disabled() drops the
+	page hash indexes and turns the searches back on later. */
+	info->n_skipped = 0;
+	info->n_disabled++;
+	info->ahi_disabled = TRUE;
+
+	MONITOR_INC(MONITOR_ADAPTIVE_HASH_INDEX_DISABLED);
+
+	ib::info() << "Turning off adaptive hash index searches on index "
+		<< index->name << " of table " << index->table->name
+		<< ": only " << n_hits << " of " << n_samples
+		<< " sampled searches succeeded";
+}
+
 static
 void
-btr_search_failure(btr_search_t* info, btr_cur_t* cursor)
+btr_search_failure(
+	const dict_index_t*	index,
+	btr_search_t*		info,
+	btr_cur_t*		cursor)
 {
 	cursor->flag = BTR_CUR_HASH_FAIL;
 
@@ -946,7 +1253,11 @@ btr_search_failure(btr_search_t* info, btr_cur_t* cursor)
 	}
 #endif /* UNIV_SEARCH_PERF_STAT */
 
-	info->last_hash_succ = FALSE;
+	if (info->last_hash_succ) {
+		info->last_hash_succ = FALSE;
+	}
+
+	btr_search_sample(index, info, false);
 }
 
 /** Tries to guess the right search position based on the hash search info
@@ -986,7 +1297,7 @@ btr_search_guess_on_hash(
 	btr_pcur_t	pcur;
 #endif
 
-	if (!btr_search_enabled) {
+	if (!btr_search_enabled || info->ahi_disabled) {
 		return(FALSE);
 	}
 
@@ -1029,7 +1340,7 @@ btr_search_guess_on_hash(
 		if (!btr_search_enabled) {
 			btr_search_s_unlock(index);
 
-			btr_search_failure(info, cursor);
+			btr_search_failure(index, info, cursor);
 
 			return(FALSE);
 		}
@@ -1047,7 +1358,7 @@ btr_search_guess_on_hash(
 			btr_search_s_unlock(index);
 		}
 
-		btr_search_failure(info, cursor);
+		btr_search_failure(index, info, cursor);
 
 		return(FALSE);
 	}
@@ -1064,7 +1375,7 @@ btr_search_guess_on_hash(
 				btr_search_s_unlock(index);
 			}
 
-			btr_search_failure(info, cursor);
+			btr_search_failure(index, info, cursor);
 
 			return(FALSE);
 		}
@@ -1083,7 +1394,7 @@ btr_search_guess_on_hash(
 			btr_leaf_page_release(block, latch_mode, mtr);
 		}
 
-		btr_search_failure(info, cursor);
+		btr_search_failure(index, info, cursor);
 
 		return(FALSE);
 	}
@@ -1109,7 +1420,7 @@ btr_search_guess_on_hash(
 			btr_leaf_page_release(block, latch_mode, mtr);
 		}
 
-		btr_search_failure(info, cursor);
+		btr_search_failure(index, info, cursor);
 
 		return(FALSE);
 	}
@@ -1154,7 +1465,13 @@ btr_search_guess_on_hash(
 	fail if the page of the cursor gets removed from the buffer pool
 	meanwhile! Thus it might not be a bug. */
 #endif
-	info->last_hash_succ = TRUE;
+	/* Avoid dirtying the cache line of the search info, which
+	all the threads searching the index read. */
+	if (!info->last_hash_succ) {
+		info->last_hash_succ = TRUE;
+	}
+
+	btr_search_sample(index, info, true);
 
 #ifdef UNIV_SEARCH_PERF_STAT
 	btr_search_n_succ++;
@@ -1436,6 +1753,11 @@ btr_drop_ahi_for_table(dict_table_t* table)
 		return;
 	}
 
+	for (const dict_index_t* index = table->first_index();
+	     index != nullptr; index = index->next()) {
+		btr_search_build_discard(index);
+	}
+
 	const dict_index_t*	indexes[MAX_INDEXES];
 	static constexpr unsigned DROP_BATCH = 1024;
 
@@ -1520,6 +1842,8 @@ btr_drop_ahi_for_index(dict_index_t* index)
 {
 	ut_ad(index->is_committed());
 
+	btr_search_build_discard(index);
+
 	if (index->disable_ahi || index->search_info->ref_count == 0) {
 		return;
 	}
@@ -1616,7 +1940,8 @@ btr_search_build_page_hash_index(
 	ulint		offsets_[REC_OFFS_NORMAL_SIZE];
 	ulint*		offsets		= offsets_;
 
-	if (index->disable_ahi || !btr_search_enabled) {
+	if (index->disable_ahi || !btr_search_enabled
+	    || index->search_info->ahi_disabled) {
 		return;
 	}
 
@@ -1784,6 +2109,145 @@ exit_func:
 	}
 }
 
+/** Builds the page hash index that a request asks for, if the page is still
+in the buffer pool and has not been modified since the request was made.
+@param[in]	req	page hash index build request */
+static
+void
+btr_search_build_from_request(const btr_search_build_req_t* req)
+{
+	dict_index_t*	index = req->index;
+	buf_block_t*	block = req->block;
+
+	if (!btr_search_enabled
+	    || index->search_info->ahi_disabled
+	    || buf_pool_is_obsolete(req->withdraw_clock)) {
+		return;
+	}
+
+	mtr_t	mtr;
+
+	mtr_start(&mtr);
+
+	/* The block may have been evicted or reused for another page
+	meanwhile. Both increment the modify clock, and so does any
+	change that moves records on the page. */
+	if (buf_page_optimistic_get(RW_S_LATCH, block, req->modify_clock,
+				    __FILE__, __LINE__, &mtr)) {
+
+		buf_block_dbg_add_level(block, SYNC_TREE_NODE_FROM_HASH);
+
+		if (block->page.id.space() == req->space_id
+		    && block->page.id.page_no() == req->page_no
+		    && btr_page_get_index_id(block->frame) == index->id) {
+
+			btr_search_build_page_hash_index(
+				index, block, req->n_fields, req->n_bytes,
+				req->left_side);
+		}
+	}
+
+	mtr_commit(&mtr);
+}
+
+/** Builds page hash indexes that searches have queued with
+btr_search_info_update(), so that the searching threads do not have to
+hash all the records of a page themselves. */
+void
+btr_search_build_thread()
+{
+	btr_search_build_queue_t*	queue = btr_search_build_queue;
+	btr_search_build_req_t		batch[BTR_SEARCH_BUILD_BATCH];
+
+	my_thread_init();
+
+	btr_search_build_thread_active = true;
+
+	mutex_enter(&queue->mutex);
+	queue->accepting = true;
+	mutex_exit(&queue->mutex);
+
+	while (srv_shutdown_state == SRV_SHUTDOWN_NONE) {
+		ulint	n_reqs = 0;
+
+		mutex_enter(&queue->mutex);
+
+		while (n_reqs < BTR_SEARCH_BUILD_BATCH && queue->n_reqs > 0) {
+			batch[n_reqs++] = queue->reqs[queue->first];
+
+			queue->first = (queue->first + 1)
+				% BTR_SEARCH_BUILD_QUEUE_SIZE;
+			--queue->n_reqs;
+		}
+
+		if (n_reqs == 0) {
+			int64_t	sig_count = os_event_reset(
+				btr_search_build_event);
+
+			mutex_exit(&queue->mutex);
+
+			os_event_wait_low(btr_search_build_event, sig_count);
+
+			continue;
+		}
+
+		mutex_exit(&queue->mutex);
+
+		for (ulint i = 0; i < n_reqs; ++i) {
+			btr_search_build_from_request(&batch[i]);
+		}
+
+		/* Unpin the indexes only now, so that
+		btr_search_build_discard() can wait for the batch. */
+		mutex_enter(&queue->mutex);
+
+		for (ulint i = 0; i < n_reqs; ++i) {
+			ut_ad(batch[i].index->search_info->n_pending > 0);
+			--batch[i].index->search_info->n_pending;
+		}
+
+		mutex_exit(&queue->mutex);
+	}
+
+	/* From now on the searches build the page hash indexes
+	themselves. */
+	mutex_enter(&queue->mutex);
+	queue->accepting = false;
+	btr_search_build_queue_remove(NULL);
+	mutex_exit(&queue->mutex);
+
+	btr_search_build_thread_active = false;
+
+	my_thread_end();
+}
+
+/** Discard the queued page hash index build requests for an index and wait
+until the build thread no longer uses the index.
+@param[in]	index	index that is being dropped */
+void
+btr_search_build_discard(const dict_index_t* index)
+{
+	btr_search_build_queue_t*	queue = btr_search_build_queue;
+
+	for (;;) {
+		mutex_enter(&queue->mutex);
+
+		btr_search_build_queue_remove(index);
+
+		const ulint	n_pending = index->search_info->n_pending;
+
+		mutex_exit(&queue->mutex);
+
+		if (n_pending == 0) {
+			return;
+		}
+
+		/* btr_search_build_thread() is processing a batch
+		that contains the index. */
+		os_thread_sleep(1000);
+	}
+}
+
 /** Moves or deletes hash entries for moved records. If new_page is already
 hashed, then the hash index for page, if any, is dropped. If new_page is not
 hashed, and page is hashed, then a new hash index is built to new_page with the
@@ -817,6 +817,9 @@ buf_block_init(
 
 	block->modify_clock = 0;
 
+	block->n_cur_searches = 0;
+	block->search_cache = NULL;
+
 	ut_d(block->page.file_page_was_freed = FALSE);
 
 	block->index = NULL;
@@ -1229,6 +1232,10 @@ buf_pool_init_instance(
 
 	buf_pool->try_LRU_scan = TRUE;
 
+	buf_pool->LRU_scan_depth = srv_LRU_scan_depth;
+
+	buf_pool->free_event = os_event_create(0);
+
 	/* Dirty Page Tracking is disabled by default. */
 	buf_pool->track_page_lsn = LSN_MAX;
 
@@ -1301,6 +1308,7 @@ buf_pool_free_instance(
 		buf_block_t*	block = chunk->blocks;
 
 		for (ulint i = chunk->size; i--; block++) {
+			page_cur_search_cache_free(block);
 			mutex_free(&block->mutex);
 			rw_lock_free(&block->lock);
 
@@ -1315,6 +1323,8 @@ buf_pool_free_instance(
 		os_event_destroy(buf_pool->no_flush[i]);
 	}
 
+	os_event_destroy(buf_pool->free_event);
+
 	ut_free(buf_pool->chunks);
 	ha_clear(buf_pool->page_hash);
 	hash_table_free(buf_pool->page_hash);
@@ -1323,6 +1333,33 @@ buf_pool_free_instance(
 	buf_pool->allocator.~ut_allocator();
 }
 
+/** Register the memory of all the buffer pool chunks with the native AIO
+backend, so that page I/O can use registered buffers. */
+static
+void
+buf_pool_register_chunks_for_io()
+{
+	std::vector<os_aio_region_t, ut_allocator<os_aio_region_t> >
+		regions;
+
+	for (ulint i = 0; i < srv_buf_pool_instances; ++i) {
+		const buf_pool_t*	buf_pool = buf_pool_from_array(i);
+		const buf_chunk_t*	chunk = buf_pool->chunks;
+
+		for (ulint j = 0; j < buf_pool->n_chunks; ++j, ++chunk) {
+			os_aio_region_t	region;
+
+			region.ptr = chunk->mem;
+			region.len = chunk->mem_size();
+
+			regions.push_back(region);
+		}
+	}
+
+	os_aio_register_buffers(
+		regions.empty() ? NULL : &regions[0], regions.size());
+}
+
 /********************************************************************//**
 Creates the buffer pool.
 @return DB_SUCCESS if success, DB_ERROR if not enough memory or error */
@@ -1370,6 +1407,8 @@ buf_pool_init(
 	buf_stat_per_index = UT_NEW(buf_stat_per_index_t(),
 				    mem_key_buf_stat_per_index_t);
 
+	buf_pool_register_chunks_for_io();
+
 	return(DB_SUCCESS);
 }
 
@@ -2130,6 +2169,10 @@ withdraw_retry:
 		return;
 	}
 
+	/* The chunks are about to be freed or added, the registration
+	is redone after the resize. */
+	os_aio_register_buffers(NULL, 0);
+
 	/* Indicate critical path */
 	buf_pool_resizing = true;
 
@@ -2375,6 +2418,8 @@ calc_buf_pool_size:
 
 	buf_pool_resizing = false;
 
+	buf_pool_register_chunks_for_io();
+
 	/* Normalize other components, if the new size is too different */
 	if (!warning && new_size_too_diff) {
 		srv_buf_pool_base_size = srv_buf_pool_size;
@@ -4277,14 +4322,17 @@ buf_page_get_known_nowait(
 /** Given a tablespace id and page number tries to get that page. If the
 page is not in the buffer pool it is not loaded and NULL is returned.
 Suitable for using when holding the lock_sys_t::mutex.
-@param[in]	page_id	page id
-@param[in]	file	file name
-@param[in]	line	line where called
-@param[in]	mtr	mini-transaction
+@param[in]	page_id		page id
+@param[in]	possibly_freed	whether the page may have been freed,
+				as when the page number is only a hint
+@param[in]	file		file name
+@param[in]	line		line where called
+@param[in]	mtr		mini-transaction
 @return pointer to a page or NULL */
 const buf_block_t*
 buf_page_try_get_func(
 	const page_id_t&	page_id,
+	bool			possibly_freed,
 	const char*		file,
 	ulint			line,
 	mtr_t*			mtr)
@@ -4351,7 +4399,7 @@ buf_page_try_get_func(
 #endif /* UNIV_DEBUG || UNIV_BUF_DEBUG */
 
 	ut_d(buf_page_mutex_enter(block));
-	ut_d(ut_a(!block->page.file_page_was_freed));
+	ut_d(ut_a(possibly_freed || !block->page.file_page_was_freed));
 	ut_d(buf_page_mutex_exit(block));
 
 	buf_block_dbg_add_level(block, SYNC_NO_ORDER_CHECK);
@@ -5980,6 +6028,9 @@ buf_stats_aggregate_pool_info(
 	total_info->io_cur += pool_info->io_cur;
 	total_info->unzip_sum += pool_info->unzip_sum;
 	total_info->unzip_cur += pool_info->unzip_cur;
+	total_info->LRU_scan_depth += pool_info->LRU_scan_depth;
+	total_info->n_free_waits += pool_info->n_free_waits;
+	total_info->n_single_flushes += pool_info->n_single_flushes;
 }
 /*******************************************************************//**
 Collect buffer pool stats information for a buffer pool. Also
@@ -6028,6 +6079,12 @@ buf_stats_get_pool_info(
 		 (buf_pool->n_flush[BUF_FLUSH_SINGLE_PAGE]
 		  + buf_pool->init_flush[BUF_FLUSH_SINGLE_PAGE]);
 
+	pool_info->LRU_scan_depth = buf_pool->LRU_scan_depth;
+
+	pool_info->n_free_waits = buf_pool->n_free_waits;
+
+	pool_info->n_single_flushes = buf_pool->n_single_flushes;
+
 	current_time = time(NULL);
 	time_elapsed = 0.001 + difftime(current_time,
 					buf_pool->last_printout_time);
@@ -6194,6 +6251,12 @@ buf_print_io_instance(
 		pool_info->lru_len, pool_info->unzip_lru_len,
 		pool_info->io_sum, pool_info->io_cur,
 		pool_info->unzip_sum, pool_info->unzip_cur);
+
+	fprintf(file,
+		"Free list target " ULINTPF ", free block waits " ULINTPF ","
+		" single page flushes " ULINTPF "\n",
+		pool_info->LRU_scan_depth, pool_info->n_free_waits,
+		pool_info->n_single_flushes);
 }
 
 /*********************************************************************//**
@@ -24,6 +24,9 @@ Created 2011/12/19
 *******************************************************/
 
 #include <sys/types.h>
+#include <algorithm>
+#include <atomic>
+#include <vector>
 
 #include "buf0buf.h"
 #include "buf0checksum.h"
@@ -31,6 +34,7 @@ Created 2011/12/19
 #include "ha_prototypes.h"
 #include "my_compiler.h"
 #include "my_inttypes.h"
+#include "os0thread-create.h"
 #include "page0zip.h"
 #include "srv0srv.h"
 #include "srv0start.h"
@@ -73,6 +77,65 @@ buf_dblwr_page_inside(
 	return(FALSE);
 }
 
+/** Number of pages in the doublewrite file of a buffer pool instance. The
+file holds a batch for the LRU flushes, a batch for the flush list flushes
+and the slots for single page flushes of the instance. */
+#define BUF_DBLWR_FILE_N_PAGES						\
+	(srv_doublewrite_batch_size + 2 * TRX_SYS_DOUBLEWRITE_BLOCK_SIZE)
+
+/** Minimum number of pages to restore per doublewrite recovery thread */
+static const ulint	BUF_DBLWR_RECOVER_MIN_PAGES = 16;
+
+/** Build the path of a doublewrite file.
+@param[in]	i	buffer pool instance number
+@return path allocated with ut_malloc_nokey(), to be freed by the caller */
+static
+char*
+buf_dblwr_file_path(ulint i)
+{
+	char*	path = static_cast<char*>(ut_malloc_nokey(OS_FILE_MAX_PATH));
+
+	snprintf(path, OS_FILE_MAX_PATH, "%s%c#ib_" ULINTPF ".dblwr",
+		 srv_data_home, OS_PATH_SEPARATOR, i);
+
+	return(path);
+}
+
+/** Delete the doublewrite files of buffer pool instances that are not
+in use any more.
+@param[in]	first	first instance number whose file is deleted */
+static
+void
+buf_dblwr_delete_files(ulint first)
+{
+	ut_ad(!srv_read_only_mode);
+
+	for (ulint i = first; i < MAX_BUFFER_POOLS; ++i) {
+		char*	path = buf_dblwr_file_path(i);
+
+		os_file_delete_if_exists(innodb_data_file_key, path, NULL);
+
+		ut_free(path);
+	}
+}
+
+/** Get the doublewrite shard of a page that is being flushed.
+@param[in]	bpage		page being flushed
+@param[in]	flush_type	flush type
+@return shard of the buffer pool instance of bpage */
+static
+buf_dblwr_shard_t*
+buf_dblwr_get_shard(
+	const buf_page_t*	bpage,
+	buf_flush_t		flush_type)
+{
+	const ulint	i = buf_pool_index(buf_pool_from_bpage(bpage));
+
+	ut_ad(i < buf_dblwr->n_files);
+
+	return(&buf_dblwr->shards[i * BUF_FLUSH_N_TYPES + flush_type]);
+}
+
 /****************************************************************//**
 Calls buf_page_get() on the TRX_SYS_PAGE and returns a pointer to the
 doublewrite buffer within it.
@@ -122,45 +185,173 @@ buf_dblwr_init(
 	byte*	doublewrite)	/*!< in: pointer to the doublewrite buf
 				header on trx sys page */
 {
-	ulint	buf_size;
-
 	buf_dblwr = static_cast<buf_dblwr_t*>(
 		ut_zalloc_nokey(sizeof(buf_dblwr_t)));
 
-	/* There are two blocks of same size in the doublewrite
-	buffer. */
-	buf_size = 2 * TRX_SYS_DOUBLEWRITE_BLOCK_SIZE;
+	buf_dblwr->block1 = mach_read_from_4(
+		doublewrite + TRX_SYS_DOUBLEWRITE_BLOCK1);
+	buf_dblwr->block2 = mach_read_from_4(
+		doublewrite + TRX_SYS_DOUBLEWRITE_BLOCK2);
+}
+
+/** Initialize a doublewrite shard.
+@param[out]	shard	shard to initialize
+@param[in]	file	doublewrite file of the shard
+@param[in]	offset	first page of the shard in the file
+@param[in]	n_slots	number of pages in the shard */
+static
+void
+buf_dblwr_shard_init(
+	buf_dblwr_shard_t*	shard,
+	buf_dblwr_file_t*	file,
+	page_no_t		offset,
+	ulint			n_slots)
+{
+	mutex_create(LATCH_ID_BUF_DBLWR, &shard->mutex);
+
+	shard->file = file;
+	shard->offset = offset;
+	shard->n_slots = n_slots;
+
+	shard->b_event = os_event_create("dblwr_batch_event");
+	shard->s_event = os_event_create("dblwr_single_event");
+	shard->first_free = 0;
+	shard->s_reserved = 0;
+	shard->b_reserved = 0;
+	shard->batch_running = false;
+
+	shard->in_use = static_cast<bool*>(
+		ut_zalloc_nokey(n_slots * sizeof(bool)));
+
+	shard->write_buf_unaligned = static_cast<byte*>(
+		ut_malloc_nokey((1 + n_slots) * UNIV_PAGE_SIZE));
+
+	shard->write_buf = static_cast<byte*>(
+		ut_align(shard->write_buf_unaligned, UNIV_PAGE_SIZE));
+
+	shard->buf_block_arr = static_cast<buf_page_t**>(
+		ut_zalloc_nokey(n_slots * sizeof(void*)));
+}
+
+/** Free a doublewrite shard.
+@param[in,out]	shard	shard to free */
+static
+void
+buf_dblwr_shard_free(
+	buf_dblwr_shard_t*	shard)
+{
+	ut_ad(shard->s_reserved == 0);
+	ut_ad(shard->b_reserved == 0);
+
+	os_event_destroy(shard->b_event);
+	os_event_destroy(shard->s_event);
+
+	ut_free(shard->write_buf_unaligned);
+	shard->write_buf_unaligned = NULL;
+
+	ut_free(shard->buf_block_arr);
+	shard->buf_block_arr = NULL;
+
+	ut_free(shard->in_use);
+	shard->in_use = NULL;
+
+	mutex_free(&shard->mutex);
+}
+
+/** Open or create the doublewrite file of each buffer pool instance and
+split it into the shards for LRU, flush list and single page flushes.
+@return DB_SUCCESS or error code */
+static
+dberr_t
+buf_dblwr_files_open()
+{
+	ut_ad(buf_dblwr->n_files == 0);
+
+	if (srv_read_only_mode || !srv_use_doublewrite_buf) {
+		return(DB_SUCCESS);
+	}
+
+	const ulint	batch_size = srv_doublewrite_batch_size;
+	const ulint	n_pages = BUF_DBLWR_FILE_N_PAGES;
 
 	/* There must be atleast one buffer for single page writes
 	and one buffer for batch writes. */
-	ut_a(srv_doublewrite_batch_size > 0
-	     && srv_doublewrite_batch_size < buf_size);
+	ut_a(batch_size > 0
+	     && batch_size < 2 * TRX_SYS_DOUBLEWRITE_BLOCK_SIZE);
+
+	buf_dblwr->files = static_cast<buf_dblwr_file_t*>(
+		ut_zalloc_nokey(srv_buf_pool_instances
+				* sizeof(buf_dblwr_file_t)));
+
+	buf_dblwr->shards = static_cast<buf_dblwr_shard_t*>(
+		ut_zalloc_nokey(srv_buf_pool_instances * BUF_FLUSH_N_TYPES
+				* sizeof(buf_dblwr_shard_t)));
+
+	for (ulint i = 0; i < srv_buf_pool_instances; ++i) {
+		buf_dblwr_file_t*	file = &buf_dblwr->files[i];
+		bool			success;
+
+		file->path = buf_dblwr_file_path(i);
+
+		file->handle = os_file_create(
+			innodb_data_file_key, file->path,
+			OS_FILE_OPEN | OS_FILE_ON_ERROR_NO_EXIT
+			| OS_FILE_ON_ERROR_SILENT,
+			OS_FILE_NORMAL, OS_DATA_FILE, false, &success);
+
+		if (!success) {
+			file->handle = os_file_create(
+				innodb_data_file_key, file->path,
+				OS_FILE_CREATE | OS_FILE_ON_ERROR_NO_EXIT,
+				OS_FILE_NORMAL, OS_DATA_FILE, false, &success);
+		}
 
-	mutex_create(LATCH_ID_BUF_DBLWR, &buf_dblwr->mutex);
+		if (!success) {
+			ib::error() << "Cannot open or create the doublewrite"
+				" file '" << file->path << "'";
 
-	buf_dblwr->b_event = os_event_create("dblwr_batch_event");
-	buf_dblwr->s_event = os_event_create("dblwr_single_event");
-	buf_dblwr->first_free = 0;
-	buf_dblwr->s_reserved = 0;
-	buf_dblwr->b_reserved = 0;
+			ut_free(file->path);
+			file->path = NULL;
 
-	buf_dblwr->block1 = mach_read_from_4(
-		doublewrite + TRX_SYS_DOUBLEWRITE_BLOCK1);
-	buf_dblwr->block2 = mach_read_from_4(
-		doublewrite + TRX_SYS_DOUBLEWRITE_BLOCK2);
+			return(DB_CANNOT_OPEN_FILE);
+		}
+
+		const os_offset_t	size = n_pages * UNIV_PAGE_SIZE;
+
+		if (os_file_get_size(file->handle) < size
+		    && !os_file_set_size(file->path, file->handle, size,
+					 false, true)) {
+
+			ib::error() << "Cannot set the size of the doublewrite"
+				" file '" << file->path << "' to "
+				<< (size >> 20) << " MB";
+
+			os_file_close(file->handle);
+			ut_free(file->path);
+			file->path = NULL;
+
+			return(DB_OUT_OF_FILE_SPACE);
+		}
 
-	buf_dblwr->in_use = static_cast<bool*>(
-		ut_zalloc_nokey(buf_size * sizeof(bool)));
+		buf_dblwr_shard_t*	shards
+			= &buf_dblwr->shards[i * BUF_FLUSH_N_TYPES];
 
-	buf_dblwr->write_buf_unaligned = static_cast<byte*>(
-		ut_malloc_nokey((1 + buf_size) * UNIV_PAGE_SIZE));
+		buf_dblwr_shard_init(
+			&shards[BUF_FLUSH_LRU], file, 0, batch_size);
 
-	buf_dblwr->write_buf = static_cast<byte*>(
-		ut_align(buf_dblwr->write_buf_unaligned,
-			 UNIV_PAGE_SIZE));
+		buf_dblwr_shard_init(
+			&shards[BUF_FLUSH_LIST], file,
+			static_cast<page_no_t>(batch_size), batch_size);
 
-	buf_dblwr->buf_block_arr = static_cast<buf_page_t**>(
-		ut_zalloc_nokey(buf_size * sizeof(void*)));
+		buf_dblwr_shard_init(
+			&shards[BUF_FLUSH_SINGLE_PAGE], file,
+			static_cast<page_no_t>(2 * batch_size),
+			n_pages - 2 * batch_size);
+
+		++buf_dblwr->n_files;
+	}
+
+	return(DB_SUCCESS);
 }
 
 /****************************************************************//**
@@ -206,11 +397,18 @@ start_again:
 
 		mtr_commit(&mtr);
 		buf_dblwr_being_created = FALSE;
-		return(true);
+
+		return(buf_dblwr_files_open() == DB_SUCCESS);
 	}
 
 	ib::info() << "Doublewrite buffer not found: creating new";
 
+	/* Doublewrite files left behind by an earlier installation must
+	not be restored into the new one. */
+	if (!srv_read_only_mode) {
+		buf_dblwr_delete_files(0);
+	}
+
 	ulint min_doublewrite_size =
 		( ( 2 * TRX_SYS_DOUBLEWRITE_BLOCK_SIZE
 		  + FSP_EXTENT_SIZE / 2
@@ -341,12 +539,60 @@ start_again:
 	goto start_again;
 }
 
+/** Open the doublewrite files that exist and get the number of pages in
+them.
+@param[out]	handles		file handles, OS_FILE_CLOSED if the file of
+				the instance does not exist
+@param[out]	n_pages		number of pages in each file
+@return total number of pages in the doublewrite files */
+static
+ulint
+buf_dblwr_files_open_for_recovery(
+	pfs_os_file_t*	handles,
+	ulint*		n_pages)
+{
+	ulint	total = 0;
+
+	for (ulint i = 0; i < MAX_BUFFER_POOLS; ++i) {
+		char*	path = buf_dblwr_file_path(i);
+		bool	success;
+
+		handles[i] = os_file_create(
+			innodb_data_file_key, path,
+			OS_FILE_OPEN | OS_FILE_ON_ERROR_NO_EXIT
+			| OS_FILE_ON_ERROR_SILENT,
+			OS_FILE_NORMAL, OS_DATA_FILE, true, &success);
+
+		ut_free(path);
+
+		n_pages[i] = 0;
+
+		if (!success) {
+			handles[i].m_file = OS_FILE_CLOSED;
+			continue;
+		}
+
+		os_offset_t	size = os_file_get_size(handles[i]);
+
+		if (size != static_cast<os_offset_t>(-1)) {
+			n_pages[i] = static_cast<ulint>(size / UNIV_PAGE_SIZE);
+		}
+
+		total += n_pages[i];
+	}
+
+	return(total);
+}
+
 /**
 At database startup initializes the doublewrite buffer memory structure if
 we already have a doublewrite buffer created in the data files. If we are
 upgrading to an InnoDB version which supports multiple tablespaces, then this
 function performs the necessary update operations. If we are in a crash
 recovery, this function loads the pages from double write buffer into memory.
+The pages are read both from the doublewrite area in the system tablespace,
+which is only written by older versions, and from the doublewrite files of
+the buffer pool instances.
 @param[in]	file		File handle
 @param[in]	path		Path name of file
 @return DB_SUCCESS or error code */
@@ -407,8 +653,6 @@ buf_dblwr_init_or_load_pages(
 
 		block1 = buf_dblwr->block1;
 		block2 = buf_dblwr->block2;
-
-		buf = buf_dblwr->write_buf;
 	} else {
 		ut_free(unaligned_read_buf);
 		return(DB_SUCCESS);
@@ -428,6 +672,18 @@ buf_dblwr_init_or_load_pages(
 		ib::info() << "Resetting space id's in the doublewrite buffer";
 	}
 
+	pfs_os_file_t	handles[MAX_BUFFER_POOLS];
+	ulint		n_file_pages[MAX_BUFFER_POOLS];
+
+	const ulint	n_pages = 2 * TRX_SYS_DOUBLEWRITE_BLOCK_SIZE
+		+ buf_dblwr_files_open_for_recovery(handles, n_file_pages);
+
+	buf_dblwr->recv_buf_unaligned = static_cast<byte*>(
+		ut_malloc_nokey((1 + n_pages) * UNIV_PAGE_SIZE));
+
+	buf = static_cast<byte*>(
+		ut_align(buf_dblwr->recv_buf_unaligned, UNIV_PAGE_SIZE));
+
 	/* Read the pages from the doublewrite buffer to memory */
 	err = os_file_read(
 		read_request,
@@ -439,24 +695,55 @@ buf_dblwr_init_or_load_pages(
 		ib::error()
 			<< "Failed to read the first double write buffer "
 			"extent";
+	} else {
+		err = os_file_read(
+			read_request,
+			file,
+			buf + TRX_SYS_DOUBLEWRITE_BLOCK_SIZE * UNIV_PAGE_SIZE,
+			block2 * UNIV_PAGE_SIZE,
+			TRX_SYS_DOUBLEWRITE_BLOCK_SIZE * UNIV_PAGE_SIZE);
 
-		ut_free(unaligned_read_buf);
+		if (err != DB_SUCCESS) {
 
-		return(err);
+			ib::error()
+				<< "Failed to read the second double write"
+				" buffer extent";
+		}
 	}
 
-	err = os_file_read(
-		read_request,
-		file,
-		buf + TRX_SYS_DOUBLEWRITE_BLOCK_SIZE * UNIV_PAGE_SIZE,
-		block2 * UNIV_PAGE_SIZE,
-		TRX_SYS_DOUBLEWRITE_BLOCK_SIZE * UNIV_PAGE_SIZE);
+	/* Read the doublewrite files of the buffer pool instances after
+	the pages of the system tablespace. */
+	byte*	file_buf = buf
+		+ 2 * TRX_SYS_DOUBLEWRITE_BLOCK_SIZE * UNIV_PAGE_SIZE;
+	ulint	n_read = 2 * TRX_SYS_DOUBLEWRITE_BLOCK_SIZE;
 
-	if (err != DB_SUCCESS) {
+	for (ulint i = 0; i < MAX_BUFFER_POOLS; ++i) {
 
-		ib::error()
-			<< "Failed to read the second double write buffer "
-			"extent";
+		if (handles[i].m_file == OS_FILE_CLOSED) {
+			continue;
+		}
+
+		if (err == DB_SUCCESS && n_file_pages[i] > 0) {
+
+			err = os_file_read(
+				read_request,
+				handles[i], file_buf, 0,
+				n_file_pages[i] * UNIV_PAGE_SIZE);
+
+			if (err != DB_SUCCESS) {
+				ib::error()
+					<< "Failed to read the doublewrite"
+					" file of buffer pool instance " << i;
+			}
+
+			file_buf += n_file_pages[i] * UNIV_PAGE_SIZE;
+			n_read += n_file_pages[i];
+		}
+
+		os_file_close(handles[i]);
+	}
+
+	if (err != DB_SUCCESS) {
 
 		ut_free(unaligned_read_buf);
 
@@ -521,23 +808,36 @@ buf_dblwr_init_or_load_pages(
 		os_file_flush(file);
 	}
 
+	/* The doublewrite files are preallocated with zeroes, skip the
+	slots that have never been written to. */
+	for (ulint i = 2 * TRX_SYS_DOUBLEWRITE_BLOCK_SIZE; i < n_read; ++i) {
+
+		if (!buf_page_is_zeroes(page, univ_page_size)) {
+			recv_dblwr.add(page);
+		}
+
+		page += univ_page_size.physical();
+	}
+
 	ut_free(unaligned_read_buf);
 
-	return(DB_SUCCESS);
+	return(buf_dblwr_files_open());
 }
 
 /** Recover a single page
 @param[in]	page_no_dblwr	Page number in the doublewrite buffer
 @param[in,out]	space		Tablespace instance to write to
 @param[in]	page_no		Page number in the tablespace
-@param[in]	page		Page data to write */
+@param[in]	page		Page data to write
+@param[in]	page_crc32	buf_calc_page_crc32(page) */
 static
 void
 buf_dblwr_recover_page(
 	page_no_t	page_no_dblwr,
 	fil_space_t*	space,
 	page_no_t	page_no,
-	const page_t*	page)
+	const page_t*	page,
+	uint32_t	page_crc32)
 {
 	byte*		ptr;
 	byte*		read_buf;
@@ -602,6 +902,8 @@ buf_dblwr_recover_page(
 				true, page, page_size,
 				fsp_is_checksum_disabled(space->id));
 
+			dblwr_buf_page.set_crc32(page_crc32);
+
 			if (dblwr_buf_page.is_corrupted()) {
 
 				ib::error() << "Dump of the page:";
@@ -637,6 +939,8 @@ buf_dblwr_recover_page(
 				true, page, page_size,
 				fsp_is_checksum_disabled(space->id));
 
+			reporter.set_crc32(page_crc32);
+
 			bool	t3 = reporter.is_corrupted();
 
 			if (t1 && !(t2 || t3)) {
@@ -675,22 +979,138 @@ buf_dblwr_recover_page(
 	ut_free(ptr);
 }
 
-/** Process and remove the double write buffer pages for all tablespaces. */
+/** A page to restore from the doublewrite buffer */
+struct buf_dblwr_recv_page_t {
+	/** Page number in the doublewrite buffer */
+	page_no_t	no;
+
+	/** Tablespace that the page belongs to */
+	fil_space_t*	space;
+
+	/** Page read from the doublewrite buffer */
+	const byte*	page;
+
+	/** buf_calc_page_crc32(page) */
+	uint32_t	crc32;
+};
+
+/** Pages to restore from the doublewrite buffer, shared by the
+doublewrite recovery threads */
+struct buf_dblwr_recover_t {
+	using Pages = std::vector<
+		buf_dblwr_recv_page_t, ut_allocator<buf_dblwr_recv_page_t>>;
+
+	/** Pages to restore */
+	Pages			pages;
+
+	/** Index of the next page to restore */
+	std::atomic<ulint>	next;
+};
+
+/** Restore pages from the doublewrite buffer until there are no pages
+left to claim.
+@param[in,out]	recover	pages to restore */
+static
+void
+buf_dblwr_recover_next_pages(
+	buf_dblwr_recover_t*	recover)
+{
+	for (;;) {
+		const ulint	i = recover->next.fetch_add(1);
+
+		if (i >= recover->pages.size()) {
+			break;
+		}
+
+		const buf_dblwr_recv_page_t&	p = recover->pages[i];
+
+		buf_dblwr_recover_page(
+			p.no, p.space, page_get_page_no(p.page), p.page,
+			p.crc32);
+	}
+}
+
+/** Process and remove the double write buffer pages for all tablespaces.
+Only the copy with the highest LSN of each page is considered, the copies
+in the doublewrite files of different buffer pool instances and flush types
+can be of different age. The pages are restored by up to
+srv_n_read_io_threads threads, the reads and writes of the tablespace
+pages are synchronous. */
 void
 buf_dblwr_process()
 {
 	page_no_t		page_no_dblwr	= 0;
 	recv_dblwr_t&		dblwr	= recv_sys->dblwr;
 
+	using Copy = std::pair<page_no_t, const byte*>;
+	using Copies = std::vector<Copy, ut_allocator<Copy>>;
+
+	Copies	copies;
+
+	copies.reserve(dblwr.pages.size());
+
 	for (auto i = dblwr.pages.begin();
 	     i != dblwr.pages.end();
 	     ++i, ++page_no_dblwr) {
 
-		const byte*	page		= *i;
+		copies.push_back(Copy(page_no_dblwr, *i));
+	}
+
+	/* Sort by page id, and the newest copy of a page first */
+	std::sort(copies.begin(), copies.end(),
+		  [](const Copy& lhs, const Copy& rhs) {
+			  const space_id_t	lhs_space
+				  = page_get_space_id(lhs.second);
+			  const space_id_t	rhs_space
+				  = page_get_space_id(rhs.second);
+
+			  if (lhs_space != rhs_space) {
+				  return(lhs_space < rhs_space);
+			  }
+
+			  const page_no_t	lhs_no
+				  = page_get_page_no(lhs.second);
+			  const page_no_t	rhs_no
+				  = page_get_page_no(rhs.second);
+
+			  if (lhs_no != rhs_no) {
+				  return(lhs_no < rhs_no);
+			  }
+
+			  return(mach_read_from_8(lhs.second + FIL_PAGE_LSN)
+				 > mach_read_from_8(rhs.second
+						    + FIL_PAGE_LSN));
+		  });
+
+	buf_dblwr_recover_t	recover;
+
+	recover.pages.reserve(copies.size());
+
+	fil_space_t*	space = nullptr;
+
+	for (auto i = copies.begin(); i != copies.end(); ++i) {
+
+		const byte*	page		= i->second;
 		page_no_t	page_no		= page_get_page_no(page);
 		space_id_t	space_id	= page_get_space_id(page);
 
-		fil_space_t*	space = fil_space_get(space_id);
+		if (i != copies.begin()
+		    && page_get_space_id((i - 1)->second) == space_id
+		    && page_get_page_no((i - 1)->second) == page_no) {
+
+			/* An older copy of the previous page */
+			continue;
+		}
+
+		if (space == nullptr || space->id != space_id) {
+			space = fil_space_get(space_id);
+
+			if (space != nullptr) {
+				/* Open it here rather than in the recovery
+				threads, which would race for it. */
+				fil_space_open_if_needed(space);
+			}
+		}
 
 		if (space == nullptr) {
 
@@ -700,13 +1120,55 @@ buf_dblwr_process()
 
 			using Page = recv_dblwr_t::Page;
 
-			dblwr.deferred.push_back(Page(page_no_dblwr, page));
+			dblwr.deferred.push_back(Page(i->first, page));
 		} else {
-			buf_dblwr_recover_page(
-				page_no_dblwr, space, page_no, page);
+			buf_dblwr_recv_page_t	p = {i->first, space, page, 0};
+
+			recover.pages.push_back(p);
 		}
 	}
 
+	/* The copies were read from the doublewrite buffer in one go,
+	checksum them together. */
+	{
+		std::vector<const byte*, ut_allocator<const byte*>>	pages;
+		std::vector<uint32_t, ut_allocator<uint32_t>>		crc32s(
+			recover.pages.size());
+
+		pages.reserve(recover.pages.size());
+
+		for (const auto& p : recover.pages) {
+			pages.push_back(p.page);
+		}
+
+		if (!pages.empty()) {
+			buf_calc_page_crc32_batch(
+				&pages[0], pages.size(), &crc32s[0]);
+		}
+
+		for (ulint i = 0; i < recover.pages.size(); ++i) {
+			recover.pages[i].crc32 = crc32s[i];
+		}
+	}
+
+	const ulint	n_threads = ut_min(
+		static_cast<ulint>(srv_n_read_io_threads),
+		recover.pages.size() / BUF_DBLWR_RECOVER_MIN_PAGES + 1);
+
+	recover.next = 0;
+
+	Helper_threads	helpers;
+
+	for (ulint i = 1; i < n_threads; ++i) {
+		helpers.start(
+			buf_dblwr_recover_thread_key,
+			buf_dblwr_recover_next_pages, &recover);
+	}
+
+	buf_dblwr_recover_next_pages(&recover);
+
+	helpers.join();
+
 	dblwr.pages.clear();
 
 	fil_flush_file_spaces(to_int(FIL_TYPE_TABLESPACE));
@@ -735,7 +1197,9 @@ buf_dblwr_recover_pages(fil_space_t* space)
 
 			page_no = page_get_page_no(page.m_page);
 
-			buf_dblwr_recover_page(0, space, page_no, page.m_page);
+			buf_dblwr_recover_page(
+				0, space, page_no, page.m_page,
+				buf_calc_page_crc32(page.m_page));
 
 			page.close();
 
@@ -748,6 +1212,28 @@ buf_dblwr_recover_pages(fil_space_t* space)
 	fil_flush_file_spaces(to_int(FIL_TYPE_TABLESPACE));
 }
 
+/** Free the memory that holds the pages read from the doublewrite buffer
+and the doublewrite files at startup. Must be called after
+recv_sys->dblwr.pages has been cleared. */
+void
+buf_dblwr_free_recv_buf()
+{
+	ut_a(recv_sys->dblwr.pages.empty());
+
+	if (buf_dblwr == NULL) {
+		return;
+	}
+
+	ut_free(buf_dblwr->recv_buf_unaligned);
+	buf_dblwr->recv_buf_unaligned = NULL;
+
+	/* The pages of the buffer pool instances that do not exist
+	any more have been restored, their files can be removed now. */
+	if (!srv_read_only_mode) {
+		buf_dblwr_delete_files(buf_dblwr->n_files);
+	}
+}
+
 /****************************************************************//**
 Frees doublewrite buffer. */
 void
@@ -755,21 +1241,21 @@ buf_dblwr_free(void)
 /*================*/
 {
 	/* Free the double write data structures. */
-	ut_ad(buf_dblwr->s_reserved == 0);
-	ut_ad(buf_dblwr->b_reserved == 0);
+	for (ulint i = 0; i < buf_dblwr->n_files; ++i) {
 
-	os_event_destroy(buf_dblwr->b_event);
-	os_event_destroy(buf_dblwr->s_event);
-	ut_free(buf_dblwr->write_buf_unaligned);
-	buf_dblwr->write_buf_unaligned = NULL;
+		for (ulint j = 0; j < BUF_FLUSH_N_TYPES; ++j) {
+			buf_dblwr_shard_free(
+				&buf_dblwr->shards[i * BUF_FLUSH_N_TYPES + j]);
+		}
 
-	ut_free(buf_dblwr->buf_block_arr);
-	buf_dblwr->buf_block_arr = NULL;
+		os_file_close(buf_dblwr->files[i].handle);
+		ut_free(buf_dblwr->files[i].path);
+	}
 
-	ut_free(buf_dblwr->in_use);
-	buf_dblwr->in_use = NULL;
+	ut_free(buf_dblwr->shards);
+	ut_free(buf_dblwr->files);
+	ut_free(buf_dblwr->recv_buf_unaligned);
 
-	mutex_free(&buf_dblwr->mutex);
 	ut_free(buf_dblwr);
 	buf_dblwr = NULL;
 }
@@ -790,42 +1276,44 @@ buf_dblwr_update(
 
 	ut_ad(!srv_read_only_mode);
 
+	buf_dblwr_shard_t*	shard = buf_dblwr_get_shard(bpage, flush_type);
+
 	switch (flush_type) {
 	case BUF_FLUSH_LIST:
 	case BUF_FLUSH_LRU:
-		mutex_enter(&buf_dblwr->mutex);
+		mutex_enter(&shard->mutex);
 
-		ut_ad(buf_dblwr->batch_running);
-		ut_ad(buf_dblwr->b_reserved > 0);
-		ut_ad(buf_dblwr->b_reserved <= buf_dblwr->first_free);
+		ut_ad(shard->batch_running);
+		ut_ad(shard->b_reserved > 0);
+		ut_ad(shard->b_reserved <= shard->first_free);
 
-		buf_dblwr->b_reserved--;
+		shard->b_reserved--;
 
-		if (buf_dblwr->b_reserved == 0) {
-			mutex_exit(&buf_dblwr->mutex);
+		if (shard->b_reserved == 0) {
+			mutex_exit(&shard->mutex);
 			/* This will finish the batch. Sync data files
 			to the disk. */
 			fil_flush_file_spaces(to_int(FIL_TYPE_TABLESPACE));
-			mutex_enter(&buf_dblwr->mutex);
+			mutex_enter(&shard->mutex);
 
 			/* We can now reuse the doublewrite memory buffer: */
-			buf_dblwr->first_free = 0;
-			buf_dblwr->batch_running = false;
-			os_event_set(buf_dblwr->b_event);
+			shard->first_free = 0;
+			shard->batch_running = false;
+			os_event_set(shard->b_event);
 		}
 
-		mutex_exit(&buf_dblwr->mutex);
+		mutex_exit(&shard->mutex);
 		break;
 	case BUF_FLUSH_SINGLE_PAGE:
 		{
-			const ulint size = 2 * TRX_SYS_DOUBLEWRITE_BLOCK_SIZE;
+			const ulint size = shard->n_slots;
 			ulint i;
-			mutex_enter(&buf_dblwr->mutex);
-			for (i = srv_doublewrite_batch_size; i < size; ++i) {
-				if (buf_dblwr->buf_block_arr[i] == bpage) {
-					buf_dblwr->s_reserved--;
-					buf_dblwr->buf_block_arr[i] = NULL;
-					buf_dblwr->in_use[i] = false;
+			mutex_enter(&shard->mutex);
+			for (i = 0; i < size; ++i) {
+				if (shard->buf_block_arr[i] == bpage) {
+					shard->s_reserved--;
+					shard->buf_block_arr[i] = NULL;
+					shard->in_use[i] = false;
 					break;
 				}
 			}
@@ -834,8 +1322,8 @@ buf_dblwr_update(
 			reserved block. */
 			ut_a(i < size);
 		}
-		os_event_set(buf_dblwr->s_event);
-		mutex_exit(&buf_dblwr->mutex);
+		os_event_set(shard->s_event);
+		mutex_exit(&shard->mutex);
 		break;
 	case BUF_FLUSH_N_TYPES:
 		ut_error;
@@ -953,14 +1441,17 @@ void
 buf_dblwr_write_block_to_datafile(
 /*==============================*/
 	const buf_page_t*	bpage,	/*!< in: page to write */
-	bool			sync)	/*!< in: true if sync IO
+	bool			sync,	/*!< in: true if sync IO
 					is requested */
+	bool			batched)/*!< in: true if the caller
+					calls os_aio_simulated_wake_handler_
+					threads() after posting the batch */
 {
 	ut_a(buf_page_in_file(bpage));
 
 	ulint	type = IORequest::WRITE;
 
-	if (sync) {
+	if (sync || batched) {
 		type |= IORequest::DO_NOT_WAKE;
 	}
 
@@ -991,38 +1482,61 @@ buf_dblwr_write_block_to_datafile(
 	}
 }
 
-/********************************************************************//**
-Flushes possible buffered writes from the doublewrite memory buffer to disk,
-and also wakes up the aio thread if simulated aio is used. It is very
-important to call this function after a batch of writes has been posted,
-and also when we may have to wait for a page latch! Otherwise a deadlock
-of threads can occur. */
+/** Write the pages in the write buffer of a shard to its region of the
+doublewrite file and sync the file.
+@param[in]	shard	doublewrite shard
+@param[in]	slot	first slot to write
+@param[in]	n	number of slots to write
+@param[in]	buf	page frames to write, aligned to UNIV_PAGE_SIZE */
+static
 void
-buf_dblwr_flush_buffered_writes(void)
-/*=================================*/
+buf_dblwr_write_to_file(
+	const buf_dblwr_shard_t*	shard,
+	ulint				slot,
+	ulint				n,
+	const byte*			buf)
 {
-	byte*		write_buf;
-	ulint		first_free;
-	ulint		len;
+	ut_ad(slot + n <= shard->n_slots);
 
-	if (!srv_use_doublewrite_buf || buf_dblwr == NULL) {
-		/* Sync the writes to the disk. */
-		buf_dblwr_sync_datafiles();
-		return;
+	IORequest	request(IORequest::WRITE);
+
+	request.disable_compression();
+
+	dberr_t	err = os_file_write(
+		request, shard->file->path, shard->file->handle, buf,
+		static_cast<os_offset_t>(shard->offset + slot)
+		* UNIV_PAGE_SIZE,
+		n * UNIV_PAGE_SIZE);
+
+	if (err != DB_SUCCESS) {
+		ib::fatal() << "Failed to write to the doublewrite file '"
+			<< shard->file->path << "': " << ut_strerr(err);
 	}
 
-	ut_ad(!srv_read_only_mode);
+	os_file_flush(shard->file->handle);
+}
+
+/** Flushes possible buffered writes of a shard from the doublewrite memory
+buffer to disk, and posts the writes of the pages to the datafiles.
+@param[in,out]	shard	doublewrite shard of a batch flush type */
+static
+void
+buf_dblwr_flush_shard(
+	buf_dblwr_shard_t*	shard)
+{
+	byte*		write_buf;
+	ulint		first_free;
 
 try_again:
-	mutex_enter(&buf_dblwr->mutex);
+	mutex_enter(&shard->mutex);
 
-	/* Write first to doublewrite buffer blocks. We use synchronous
-	aio and thus know that file write has been completed when the
+	/* Write first to the doublewrite file. We use synchronous
+	i/o and thus know that file write has been completed when the
 	control returns. */
 
-	if (buf_dblwr->first_free == 0) {
+	if (shard->first_free == 0) {
 
-		mutex_exit(&buf_dblwr->mutex);
+		mutex_exit(&shard->mutex);
 
 		/* Wake possible simulated aio thread as there could be
 		system temporary tablespace pages active for flushing.
@@ -1033,39 +1547,39 @@ try_again:
 		return;
 	}
 
-	if (buf_dblwr->batch_running) {
+	if (shard->batch_running) {
 		/* Another thread is running the batch right now. Wait
 		for it to finish. */
-		int64_t	sig_count = os_event_reset(buf_dblwr->b_event);
-		mutex_exit(&buf_dblwr->mutex);
+		int64_t	sig_count = os_event_reset(shard->b_event);
+		mutex_exit(&shard->mutex);
 
-		os_event_wait_low(buf_dblwr->b_event, sig_count);
+		os_event_wait_low(shard->b_event, sig_count);
 		goto try_again;
 	}
 
-	ut_a(!buf_dblwr->batch_running);
-	ut_ad(buf_dblwr->first_free == buf_dblwr->b_reserved);
+	ut_a(!shard->batch_running);
+	ut_ad(shard->first_free == shard->b_reserved);
 
 	/* Disallow anyone else to post to doublewrite buffer or to
 	start another batch of flushing. */
-	buf_dblwr->batch_running = true;
-	first_free = buf_dblwr->first_free;
+	shard->batch_running = true;
+	first_free = shard->first_free;
 
 	/* Now safe to release the mutex. Note that though no other
 	thread is allowed to post to the doublewrite batch flushing
 	but any threads working on single page flushes are allowed
 	to proceed. */
-	mutex_exit(&buf_dblwr->mutex);
+	mutex_exit(&shard->mutex);
 
-	write_buf = buf_dblwr->write_buf;
+	write_buf = shard->write_buf;
 
 	for (ulint len2 = 0, i = 0;
-	     i < buf_dblwr->first_free;
+	     i < shard->first_free;
 	     len2 += UNIV_PAGE_SIZE, i++) {
 
 		const buf_block_t*	block;
 
-		block = (buf_block_t*) buf_dblwr->buf_block_arr[i];
+		block = (buf_block_t*) shard->buf_block_arr[i];
 
 		if (buf_block_get_state(block) != BUF_BLOCK_FILE_PAGE
 		    || block->page.zip.data) {
@@ -1083,57 +1597,33 @@ try_again:
 		buf_dblwr_check_page_lsn(write_buf + len2);
 	}
 
-	/* Write out the first block of the doublewrite buffer */
-	len = ut_min(TRX_SYS_DOUBLEWRITE_BLOCK_SIZE,
-		     buf_dblwr->first_free) * UNIV_PAGE_SIZE;
-
-	fil_io(IORequestWrite, true,
-	       page_id_t(TRX_SYS_SPACE, buf_dblwr->block1), univ_page_size,
-	       0, len, (void*) write_buf, NULL);
-
-	if (buf_dblwr->first_free <= TRX_SYS_DOUBLEWRITE_BLOCK_SIZE) {
-		/* No unwritten pages in the second block. */
-		goto flush;
-	}
+	/* Write out the whole batch with one sequential write and sync
+	the doublewrite file. */
+	buf_dblwr_write_to_file(shard, 0, first_free, write_buf);
 
-	/* Write out the second block of the doublewrite buffer. */
-	len = (buf_dblwr->first_free - TRX_SYS_DOUBLEWRITE_BLOCK_SIZE)
-	       * UNIV_PAGE_SIZE;
-
-	write_buf = buf_dblwr->write_buf
-		    + TRX_SYS_DOUBLEWRITE_BLOCK_SIZE * UNIV_PAGE_SIZE;
-
-	fil_io(IORequestWrite, true,
-	       page_id_t(TRX_SYS_SPACE, buf_dblwr->block2), univ_page_size,
-	       0, len, (void*) write_buf, NULL);
-
-flush:
 	/* increment the doublewrite flushed pages counter */
-	srv_stats.dblwr_pages_written.add(buf_dblwr->first_free);
+	srv_stats.dblwr_pages_written.add(first_free);
 	srv_stats.dblwr_writes.inc();
 
-	/* Now flush the doublewrite buffer data to disk */
-	fil_flush(TRX_SYS_SPACE);
-
 	/* We know that the writes have been flushed to disk now
-	and in recovery we will find them in the doublewrite buffer
-	blocks. Next do the writes to the intended positions. */
+	and in recovery we will find them in the doublewrite file.
+	Next do the writes to the intended positions. */
 
-	/* Up to this point first_free and buf_dblwr->first_free are
-	same because we have set the buf_dblwr->batch_running flag
+	/* Up to this point first_free and shard->first_free are
+	same because we have set the shard->batch_running flag
 	disallowing any other thread to post any request but we
-	can't safely access buf_dblwr->first_free in the loop below.
+	can't safely access shard->first_free in the loop below.
 	This is so because it is possible that after we are done with
 	the last iteration and before we terminate the loop, the batch
 	gets finished in the IO helper thread and another thread posts
-	a new batch setting buf_dblwr->first_free to a higher value.
-	If this happens and we are using buf_dblwr->first_free in the
+	a new batch setting shard->first_free to a higher value.
+	If this happens and we are using shard->first_free in the
 	loop termination condition then we'll end up dispatching
 	the same block twice from two different threads. */
-	ut_ad(first_free == buf_dblwr->first_free);
+	ut_ad(first_free == shard->first_free);
 	for (ulint i = 0; i < first_free; i++) {
 		buf_dblwr_write_block_to_datafile(
-			buf_dblwr->buf_block_arr[i], false);
+			shard->buf_block_arr[i], false, true);
 	}
 
 	/* Wake possible simulated aio thread to actually post the
@@ -1143,47 +1633,105 @@ flush:
 	os_aio_simulated_wake_handler_threads();
 }
 
+/********************************************************************//**
+Flushes possible buffered writes from all the doublewrite memory buffers to
+disk, and also wakes up the aio thread if simulated aio is used. It is very
+important to call this function after a batch of writes has been posted,
+and also when we may have to wait for a page latch! Otherwise a deadlock
+of threads can occur. */
+void
+buf_dblwr_flush_buffered_writes(void)
+/*=================================*/
+{
+	if (!srv_use_doublewrite_buf || buf_dblwr == NULL) {
+		/* Sync the writes to the disk. */
+		buf_dblwr_sync_datafiles();
+		return;
+	}
+
+	ut_ad(!srv_read_only_mode);
+
+	for (ulint i = 0; i < buf_dblwr->n_files; ++i) {
+		buf_dblwr_shard_t*	shards
+			= &buf_dblwr->shards[i * BUF_FLUSH_N_TYPES];
+
+		buf_dblwr_flush_shard(&shards[BUF_FLUSH_LRU]);
+		buf_dblwr_flush_shard(&shards[BUF_FLUSH_LIST]);
+	}
+}
+
+/** Flushes possible buffered writes of one buffer pool instance and flush
+type from the doublewrite memory buffer to disk. This is called at the end
+of a flush batch.
+@param[in]	buf_pool	buffer pool instance
+@param[in]	flush_type	BUF_FLUSH_LRU or BUF_FLUSH_LIST */
+void
+buf_dblwr_flush_buffered_writes(
+	const buf_pool_t*	buf_pool,
+	buf_flush_t		flush_type)
+{
+	ut_ad(flush_type == BUF_FLUSH_LRU || flush_type == BUF_FLUSH_LIST);
+
+	if (!srv_use_doublewrite_buf || buf_dblwr == NULL) {
+		/* Sync the writes to the disk. */
+		buf_dblwr_sync_datafiles();
+		return;
+	}
+
+	ut_ad(!srv_read_only_mode);
+
+	const ulint	i = buf_pool_index(buf_pool);
+
+	buf_dblwr_flush_shard(
+		&buf_dblwr->shards[i * BUF_FLUSH_N_TYPES + flush_type]);
+}
+
 /** Posts a buffer page for writing. If the doublewrite memory buffer
-is full, calls buf_dblwr_flush_buffered_writes and waits for for free
-space to appear.
-@param[in]	bpage	buffer block to write */
+of the buffer pool instance and flush type is full, calls
+buf_dblwr_flush_buffered_writes and waits for for free space to appear.
+@param[in]	bpage		buffer block to write
+@param[in]	flush_type	BUF_FLUSH_LRU or BUF_FLUSH_LIST */
 void
 buf_dblwr_add_to_batch(
-	buf_page_t*	bpage)
+	buf_page_t*	bpage,
+	buf_flush_t	flush_type)
 {
 	ut_a(buf_page_in_file(bpage));
 	ut_ad(!mutex_own(&buf_pool_from_bpage(bpage)->LRU_list_mutex));
+	ut_ad(flush_type == BUF_FLUSH_LRU || flush_type == BUF_FLUSH_LIST);
+
+	buf_dblwr_shard_t*	shard = buf_dblwr_get_shard(bpage, flush_type);
 
 try_again:
-	mutex_enter(&buf_dblwr->mutex);
+	mutex_enter(&shard->mutex);
 
-	ut_a(buf_dblwr->first_free <= srv_doublewrite_batch_size);
+	ut_a(shard->first_free <= shard->n_slots);
 
-	if (buf_dblwr->batch_running) {
+	if (shard->batch_running) {
 
 		/* This not nearly as bad as it looks. There is only
-		page_cleaner thread which does background flushing
-		in batches therefore it is unlikely to be a contention
-		point. The only exception is when a user thread is
-		forced to do a flush batch because of a sync
+		one page_cleaner thread at a time which does background
+		flushing of a buffer pool instance in batches therefore it is
+		unlikely to be a contention point. The only exception is when
+		a user thread is forced to do a flush batch because of a sync
 		checkpoint. */
-		int64_t	sig_count = os_event_reset(buf_dblwr->b_event);
-		mutex_exit(&buf_dblwr->mutex);
+		int64_t	sig_count = os_event_reset(shard->b_event);
+		mutex_exit(&shard->mutex);
 
-		os_event_wait_low(buf_dblwr->b_event, sig_count);
+		os_event_wait_low(shard->b_event, sig_count);
 		goto try_again;
 	}
 
-	if (buf_dblwr->first_free == srv_doublewrite_batch_size) {
-		mutex_exit(&(buf_dblwr->mutex));
+	if (shard->first_free == shard->n_slots) {
+		mutex_exit(&shard->mutex);
 
-		buf_dblwr_flush_buffered_writes();
+		buf_dblwr_flush_shard(shard);
 
 		goto try_again;
 	}
 
-	byte*	p = buf_dblwr->write_buf
-		+ univ_page_size.physical() * buf_dblwr->first_free;
+	byte*	p = shard->write_buf
+		+ univ_page_size.physical() * shard->first_free;
 
 	if (bpage->size.is_compressed()) {
 		UNIV_MEM_ASSERT_RW(bpage->zip.data, bpage->size.physical());
@@ -1202,34 +1750,34 @@ try_again:
 		memcpy(p, ((buf_block_t*) bpage)->frame, bpage->size.logical());
 	}
 
-	buf_dblwr->buf_block_arr[buf_dblwr->first_free] = bpage;
+	shard->buf_block_arr[shard->first_free] = bpage;
 
-	buf_dblwr->first_free++;
-	buf_dblwr->b_reserved++;
+	shard->first_free++;
+	shard->b_reserved++;
 
-	ut_ad(!buf_dblwr->batch_running);
-	ut_ad(buf_dblwr->first_free == buf_dblwr->b_reserved);
-	ut_ad(buf_dblwr->b_reserved <= srv_doublewrite_batch_size);
+	ut_ad(!shard->batch_running);
+	ut_ad(shard->first_free == shard->b_reserved);
+	ut_ad(shard->b_reserved <= shard->n_slots);
 
-	if (buf_dblwr->first_free == srv_doublewrite_batch_size) {
-		mutex_exit(&(buf_dblwr->mutex));
+	if (shard->first_free == shard->n_slots) {
+		mutex_exit(&shard->mutex);
 
-		buf_dblwr_flush_buffered_writes();
+		buf_dblwr_flush_shard(shard);
 
 		return;
 	}
 
-	mutex_exit(&(buf_dblwr->mutex));
+	mutex_exit(&shard->mutex);
 }
 
 /********************************************************************//**
 Writes a page to the doublewrite buffer on disk, sync it, then write
 the page to the datafile and sync the datafile. This function is used
 for single page flushes. If all the buffers allocated for single page
-flushes in the doublewrite buffer are in use we wait here for one to
-become free. We are guaranteed that a slot will become free because any
-thread that is using a slot must also release the slot before leaving
-this function. */
+flushes in the doublewrite buffer of the buffer pool instance are in use
+we wait here for one to become free. We are guaranteed that a slot will
+become free because any thread that is using a slot must also release the
+slot before leaving this function. */
 void
 buf_dblwr_write_single_page(
 /*========================*/
@@ -1237,20 +1785,16 @@ buf_dblwr_write_single_page(
 	bool		sync)	/*!< in: true if sync IO requested */
 {
 	ulint		n_slots;
-	page_no_t	size;
-	page_no_t	offset;
-	page_no_t	i;
+	ulint		i;
 
 	ut_a(buf_page_in_file(bpage));
 	ut_a(srv_use_doublewrite_buf);
 	ut_a(buf_dblwr != NULL);
 
-	/* total number of slots available for single page flushes
-	starts from srv_doublewrite_batch_size to the end of the
-	buffer. */
-	size = 2 * TRX_SYS_DOUBLEWRITE_BLOCK_SIZE;
-	ut_a(size > srv_doublewrite_batch_size);
-	n_slots = size - srv_doublewrite_batch_size;
+	buf_dblwr_shard_t*	shard = buf_dblwr_get_shard(
+		bpage, BUF_FLUSH_SINGLE_PAGE);
+
+	n_slots = shard->n_slots;
 
 	if (buf_page_get_state(bpage) == BUF_BLOCK_FILE_PAGE) {
 
@@ -1267,87 +1811,66 @@ buf_dblwr_write_single_page(
 	}
 
 retry:
-	mutex_enter(&buf_dblwr->mutex);
-	if (buf_dblwr->s_reserved == n_slots) {
+	mutex_enter(&shard->mutex);
+	if (shard->s_reserved == n_slots) {
 
 		/* All slots are reserved. */
-		int64_t	sig_count = os_event_reset(buf_dblwr->s_event);
-		mutex_exit(&buf_dblwr->mutex);
-		os_event_wait_low(buf_dblwr->s_event, sig_count);
+		int64_t	sig_count = os_event_reset(shard->s_event);
+		mutex_exit(&shard->mutex);
+		os_event_wait_low(shard->s_event, sig_count);
 
 		goto retry;
 	}
 
-	for (i = srv_doublewrite_batch_size; i < size; ++i) {
+	for (i = 0; i < n_slots; ++i) {
 
-		if (!buf_dblwr->in_use[i]) {
+		if (!shard->in_use[i]) {
 			break;
 		}
 	}
 
 	/* We are guaranteed to find a slot. */
-	ut_a(i < size);
-	buf_dblwr->in_use[i] = true;
-	buf_dblwr->s_reserved++;
-	buf_dblwr->buf_block_arr[i] = bpage;
+	ut_a(i < n_slots);
+	shard->in_use[i] = true;
+	shard->s_reserved++;
+	shard->buf_block_arr[i] = bpage;
 
 	/* increment the doublewrite flushed pages counter */
 	srv_stats.dblwr_pages_written.inc();
 	srv_stats.dblwr_writes.inc();
 
-	mutex_exit(&buf_dblwr->mutex);
-
-	/* Lets see if we are going to write in the first or second
-	block of the doublewrite buffer. */
-	if (i < TRX_SYS_DOUBLEWRITE_BLOCK_SIZE) {
-		offset = buf_dblwr->block1 + i;
-	} else {
-		offset = buf_dblwr->block2 + i
-			 - TRX_SYS_DOUBLEWRITE_BLOCK_SIZE;
-	}
+	mutex_exit(&shard->mutex);
 
 	/* We deal with compressed and uncompressed pages a little
 	differently here. In case of uncompressed pages we can
 	directly write the block to the allocated slot in the
-	doublewrite buffer in the system tablespace and then after
-	syncing the system table space we can proceed to write the page
-	in the datafile.
+	doublewrite file and then after syncing the file we can
+	proceed to write the page in the datafile.
 	In case of compressed page we first do a memcpy of the block
 	to the in-memory buffer of doublewrite before proceeding to
 	write it. This is so because we want to pad the remaining
 	bytes in the doublewrite page with zeros. */
 
 	if (bpage->size.is_compressed()) {
-		memcpy(buf_dblwr->write_buf + univ_page_size.physical() * i,
-		       bpage->zip.data, bpage->size.physical());
+		byte*	p = shard->write_buf + univ_page_size.physical() * i;
 
-		memset(buf_dblwr->write_buf + univ_page_size.physical() * i
-		       + bpage->size.physical(), 0x0,
+		memcpy(p, bpage->zip.data, bpage->size.physical());
+
+		memset(p + bpage->size.physical(), 0x0,
 		       univ_page_size.physical() - bpage->size.physical());
 
-		fil_io(IORequestWrite, true,
-		       page_id_t(TRX_SYS_SPACE, offset), univ_page_size, 0,
-		       univ_page_size.physical(),
-		       (void*) (buf_dblwr->write_buf
-				+ univ_page_size.physical() * i),
-		       NULL);
+		buf_dblwr_write_to_file(shard, i, 1, p);
 	} else {
 		/* It is a regular page. Write it directly to the
 		doublewrite buffer */
-		fil_io(IORequestWrite, true,
-		       page_id_t(TRX_SYS_SPACE, offset), univ_page_size, 0,
-		       univ_page_size.physical(),
-		       (void*) ((buf_block_t*) bpage)->frame,
-		       NULL);
+		buf_dblwr_write_to_file(
+			shard, i, 1, ((buf_block_t*) bpage)->frame);
 	}
 
-	/* Now flush the doublewrite buffer data to disk */
-	fil_flush(TRX_SYS_SPACE);
-
 	/* We know that the write has been flushed to disk now
-	and during recovery we will find it in the doublewrite buffer
-	blocks. Next do the write to the intended position. */
-	buf_dblwr_write_block_to_datafile(bpage, sync);
+	and during recovery we will find it in the doublewrite file.
+	Next do the write to the intended position. */
+	buf_dblwr_write_block_to_datafile(bpage, sync, false);
 }
 
 /** Constructor
@@ -27,10 +27,13 @@ Created April 08, 2011 Vasil Dimov
 #include <stdarg.h>
 #include <stdio.h>
 #include <algorithm>
+#include <atomic>
 
 #include "buf0buf.h"
 #include "buf0dump.h"
 #include "dict0dict.h"
+#include "fil0fil.h"
+#include "mach0data.h"
 #include "my_compiler.h"
 #include "my_inttypes.h"
 #include "my_io.h"
@@ -73,6 +76,20 @@ typedef ib_uint64_t	buf_dump_t;
 #define BUF_DUMP_SPACE(a)	static_cast<space_id_t>((a) >> 32)
 #define BUF_DUMP_PAGE(a)	static_cast<page_no_t>((a) & 0xFFFFFFFFUL)
 
+/** Magic number at the start of a BUF_DUMP_FORMAT_BINARY dump. A text dump
+never starts with it, which is how a load tells the two formats apart. */
+static const char	BUF_DUMP_MAGIC[] = "IBPDUMP1";
+
+/** Length of BUF_DUMP_MAGIC in bytes */
+#define BUF_DUMP_MAGIC_LEN	8
+
+/** Number of dump entries that a buffer pool load thread reads at a time */
+#define BUF_LOAD_CHUNK		1024
+
+/** Maximum number of consecutive pages that a buffer pool load submits in
+one batch of asynchronous reads */
+#define BUF_LOAD_BATCH		64
+
 /*****************************************************************//**
 Wakes up the buffer pool dump/load thread and instructs it to start
 a dump. This function is called by MySQL code via buffer_pool_dump_now()
@@ -280,7 +297,10 @@ buf_dump(
 	buf_dump_status(STATUS_INFO, "Dumping buffer pool(s) to %s",
 			full_filename);
 
-	f = fopen(tmp_filename, "w");
+	const bool	binary
+		= srv_buf_pool_dump_format == BUF_DUMP_FORMAT_BINARY;
+
+	f = fopen(tmp_filename, binary ? "wb" : "w");
 	if (f == NULL) {
 		buf_dump_status(STATUS_ERR,
 				"Cannot open '%s' for writing: %s",
@@ -289,6 +309,16 @@ buf_dump(
 	}
 	/* else */
 
+	if (binary
+	    && fwrite(BUF_DUMP_MAGIC, BUF_DUMP_MAGIC_LEN, 1, f) != 1) {
+		fclose(f);
+		buf_dump_status(STATUS_ERR,
+				"Cannot write to '%s': %s",
+				tmp_filename, strerror(errno));
+		/* leave tmp_filename to exist */
+		return;
+	}
+
 	/* walk through each buffer pool */
 	for (i = 0; i < srv_buf_pool_instances && !SHOULD_QUIT(); i++) {
 		buf_pool_t*		buf_pool;
@@ -349,6 +379,38 @@ buf_dump(
 
 		mutex_exit(&buf_pool->LRU_list_mutex);
 
+		if (binary) {
+			/* Convert the entries to big-endian in place and
+			write the whole instance at once. */
+			for (j = 0; j < n_pages; j++) {
+				mach_write_to_8(
+					reinterpret_cast<byte*>(&dump[j]),
+					dump[j]);
+			}
+
+			if (fwrite(dump, sizeof(*dump), n_pages, f)
+			    != n_pages) {
+				ut_free(dump);
+				fclose(f);
+				buf_dump_status(STATUS_ERR,
+						"Cannot write to '%s': %s",
+						tmp_filename, strerror(errno));
+				/* leave tmp_filename to exist */
+				return;
+			}
+
+			buf_dump_status(
+				STATUS_VERBOSE,
+				"Dumping buffer pool"
+				" " ULINTPF "/" ULINTPF ","
+				" page " ULINTPF "/" ULINTPF,
+				i + 1, srv_buf_pool_instances,
+				n_pages, n_pages);
+
+			ut_free(dump);
+			continue;
+		}
+
 		for (j = 0; j < n_pages && !SHOULD_QUIT(); j++) {
 			ret = fprintf(f, SPACE_ID_PF "," PAGE_NO_PF "\n",
 				      BUF_DUMP_SPACE(dump[j]),
@@ -421,18 +483,21 @@ normal client queries.
 @param[in,out]	last_check_time		milliseconds since epoch of the last
 					time we did check if throttling is
 					needed, we do the check every
-					srv_io_capacity IO ops.
+					io_capacity IO ops.
 @param[in]	last_activity_count	activity count
 @param[in]	n_io			number of IO ops done since buffer
-					pool load has started */
+					pool load has started
+@param[in]	io_capacity		IO ops per second that this thread
+					may do while there is other activity */
 UNIV_INLINE
 void
 buf_load_throttle_if_needed(
 	ulint*	last_check_time,
 	ulint*	last_activity_count,
-	ulint	n_io)
+	ulint	n_io,
+	ulint	io_capacity)
 {
-	if (n_io % srv_io_capacity < srv_io_capacity - 1) {
+	if (n_io % io_capacity < io_capacity - 1) {
 		return;
 	}
 
@@ -442,7 +507,7 @@ buf_load_throttle_if_needed(
 		return;
 	}
 
-	/* srv_io_capacity IO operations have been performed by buffer pool
+	/* io_capacity IO operations have been performed by buffer pool
 	load since the last time we were here. */
 
 	/* If no other activity, then keep going without any delay. */
@@ -456,19 +521,19 @@ buf_load_throttle_if_needed(
 	ulint	elapsed_time = now - *last_check_time;
 
 	/* Notice that elapsed_time is not the time for the last
-	srv_io_capacity IO operations performed by BP load. It is the
+	io_capacity IO operations performed by BP load. It is the
 	time elapsed since the last time we detected that there has been
 	other activity. This has a small and acceptable deficiency, e.g.:
 	1. BP load runs and there is no other activity.
 	2. Other activity occurs, we run N IO operations after that and
-	   enter here (where 0 <= N < srv_io_capacity).
+	   enter here (where 0 <= N < io_capacity).
 	3. last_check_time is very old and we do not sleep at this time, but
 	   only update last_check_time and last_activity_count.
-	4. We run srv_io_capacity more IO operations and call this function
+	4. We run io_capacity more IO operations and call this function
 	   again.
 	5. There has been more other activity and thus we enter here.
 	6. Now last_check_time is recent and we sleep if necessary to prevent
-	   more than srv_io_capacity IO operations per second.
+	   more than io_capacity IO operations per second.
 	The deficiency is that we could have slept at 3., but for this we
 	would have to update last_check_time before the
 	"cur_activity_count == *last_activity_count" check and calling
@@ -482,52 +547,46 @@ buf_load_throttle_if_needed(
 	*last_activity_count = srv_get_activity_count();
 }
 
-/*****************************************************************//**
-Perform a buffer pool load from the file specified by
-innodb_buffer_pool_filename. If any errors occur then the value of
-innodb_buffer_pool_load_status will be set accordingly, see buf_load_status().
-The dump filename can be specified by (relative to srv_data_home):
-SET GLOBAL innodb_buffer_pool_filename='filename'; */
+/** Get the maximum number of dump entries that a buffer pool load will read.
+If the dump is larger than the buffer pool(s), then we ignore the extra
+trailing. This could happen if a dump is made, then buffer pool is shrunk
+and then load is attempted.
+@return maximum number of entries to load */
 static
-void
-buf_load()
-/*======*/
+ulint
+buf_load_max_entries()
+{
+	return(buf_pool_get_n_pages() * srv_buf_pool_instances);
+}
+
+/** Read a BUF_DUMP_FORMAT_TEXT dump.
+@param[in,out]	f		dump file, positioned at its start
+@param[in]	full_filename	name of the dump file
+@param[out]	dump		entries of the dump, NULL if it was empty
+@param[out]	dump_n		number of entries in dump
+@return false if the dump could not be read, the status has been set */
+static
+bool
+buf_load_parse_text(
+	FILE*		f,
+	const char*	full_filename,
+	buf_dump_t**	dump,
+	ulint*		dump_n)
 {
-	char		full_filename[OS_FILE_MAX_PATH];
-	char		now[32];
-	FILE*		f;
-	buf_dump_t*	dump;
-	ulint		dump_n;
-	ulint		total_buffer_pools_pages;
 	ulint		i;
 	ulint		space_id;
 	ulint		page_no;
 	int		fscanf_ret;
 
-	/* Ignore any leftovers from before */
-	buf_load_abort_flag = FALSE;
-
-	buf_dump_generate_path(full_filename, sizeof(full_filename));
-
-	buf_load_status(STATUS_INFO,
-			"Loading buffer pool(s) from %s", full_filename);
-
-	f = fopen(full_filename, "r");
-	if (f == NULL) {
-		buf_load_status(STATUS_ERR,
-				"Cannot open '%s' for reading: %s",
-				full_filename, strerror(errno));
-		return;
-	}
-	/* else */
+	*dump = NULL;
 
 	/* First scan the file to estimate how many entries are in it.
 	This file is tiny (approx 500KB per 1GB buffer pool), reading it
 	two times is fine. */
-	dump_n = 0;
+	*dump_n = 0;
 	while (fscanf(f, ULINTPF "," ULINTPF, &space_id, &page_no) == 2
 	       && !SHUTTING_DOWN()) {
-		dump_n++;
+		(*dump_n)++;
 	}
 
 	if (!SHUTTING_DOWN() && !feof(f)) {
@@ -538,46 +597,32 @@ buf_load()
 		} else {
 			what = "parsing";
 		}
-		fclose(f);
 		buf_load_status(STATUS_ERR, "Error %s '%s',"
 				" unable to load buffer pool (stage 1)",
 				what, full_filename);
-		return;
+		return(false);
 	}
 
-	/* If dump is larger than the buffer pool(s), then we ignore the
-	extra trailing. This could happen if a dump is made, then buffer
-	pool is shrunk and then load is attempted. */
-	total_buffer_pools_pages = buf_pool_get_n_pages()
-		* srv_buf_pool_instances;
-	if (dump_n > total_buffer_pools_pages) {
-		dump_n = total_buffer_pools_pages;
-	}
+	*dump_n = std::min(*dump_n, buf_load_max_entries());
 
-	if(dump_n != 0) {
-		dump = static_cast<buf_dump_t*>(ut_malloc_nokey(
-				dump_n * sizeof(*dump)));
-	} else {
-		fclose(f);
-		ut_sprintf_timestamp(now);
-		buf_load_status(STATUS_INFO,
-				"Buffer pool(s) load completed at %s"
-				" (%s was empty)", now, full_filename);
-		return;
+	if (*dump_n == 0) {
+		return(true);
 	}
 
-	if (dump == NULL) {
-		fclose(f);
+	*dump = static_cast<buf_dump_t*>(ut_malloc_nokey(
+			*dump_n * sizeof(**dump)));
+
+	if (*dump == NULL) {
 		buf_load_status(STATUS_ERR,
 				"Cannot allocate " ULINTPF " bytes: %s",
-				(ulint) (dump_n * sizeof(*dump)),
+				(ulint) (*dump_n * sizeof(**dump)),
 				strerror(errno));
-		return;
+		return(false);
 	}
 
 	rewind(f);
 
-	for (i = 0; i < dump_n && !SHUTTING_DOWN(); i++) {
+	for (i = 0; i < *dump_n && !SHUTTING_DOWN(); i++) {
 		fscanf_ret = fscanf(f, ULINTPF "," ULINTPF,
 				    &space_id, &page_no);
 
@@ -587,18 +632,18 @@ buf_load()
 			}
 			/* else */
 
-			ut_free(dump);
-			fclose(f);
+			ut_free(*dump);
+			*dump = NULL;
 			buf_load_status(STATUS_ERR,
 					"Error parsing '%s', unable"
 					" to load buffer pool (stage 2)",
 					full_filename);
-			return;
+			return(false);
 		}
 
 		if (space_id > ULINT32_MASK || page_no > ULINT32_MASK) {
-			ut_free(dump);
-			fclose(f);
+			ut_free(*dump);
+			*dump = NULL;
 			buf_load_status(STATUS_ERR,
 					"Error parsing '%s': bogus"
 					" space,page " ULINTPF "," ULINTPF
@@ -607,54 +652,169 @@ buf_load()
 					full_filename,
 					space_id, page_no,
 					i);
-			return;
+			return(false);
 		}
 
-		dump[i] = BUF_DUMP_CREATE(space_id, page_no);
+		(*dump)[i] = BUF_DUMP_CREATE(space_id, page_no);
 	}
 
 	/* Set dump_n to the actual number of initialized elements,
 	i could be smaller than dump_n here if the file got truncated after
 	we read it the first time. */
-	dump_n = i;
+	*dump_n = i;
 
-	fclose(f);
+	return(true);
+}
 
-	if (dump_n == 0) {
-		ut_free(dump);
-		ut_sprintf_timestamp(now);
-		buf_load_status(STATUS_INFO,
-				"Buffer pool(s) load completed at %s"
-				" (%s was empty)", now, full_filename);
-		return;
+/** Read a BUF_DUMP_FORMAT_BINARY dump.
+@param[in,out]	f		dump file, positioned after BUF_DUMP_MAGIC
+@param[in]	full_filename	name of the dump file
+@param[out]	dump		entries of the dump, NULL if it was empty
+@param[out]	dump_n		number of entries in dump
+@return false if the dump could not be read, the status has been set */
+static
+bool
+buf_load_parse_binary(
+	FILE*		f,
+	const char*	full_filename,
+	buf_dump_t**	dump,
+	ulint*		dump_n)
+{
+	long	size;
+
+	*dump = NULL;
+	*dump_n = 0;
+
+	if (fseek(f, 0, SEEK_END) != 0
+	    || (size = ftell(f)) < BUF_DUMP_MAGIC_LEN
+	    || fseek(f, BUF_DUMP_MAGIC_LEN, SEEK_SET) != 0) {
+		buf_load_status(STATUS_ERR, "Error reading '%s',"
+				" unable to load buffer pool (stage 1)",
+				full_filename);
+		return(false);
 	}
 
-	if (!SHUTTING_DOWN()) {
-		std::sort(dump, dump + dump_n);
+	if ((size - BUF_DUMP_MAGIC_LEN) % sizeof(**dump) != 0) {
+		buf_load_status(STATUS_ERR, "Error parsing '%s',"
+				" unable to load buffer pool (stage 1)",
+				full_filename);
+		return(false);
+	}
+
+	*dump_n = std::min(
+		static_cast<ulint>(size - BUF_DUMP_MAGIC_LEN)
+		/ sizeof(**dump),
+		buf_load_max_entries());
+
+	if (*dump_n == 0) {
+		return(true);
+	}
+
+	*dump = static_cast<buf_dump_t*>(ut_malloc_nokey(
+			*dump_n * sizeof(**dump)));
+
+	if (*dump == NULL) {
+		buf_load_status(STATUS_ERR,
+				"Cannot allocate " ULINTPF " bytes: %s",
+				(ulint) (*dump_n * sizeof(**dump)),
+				strerror(errno));
+		*dump_n = 0;
+		return(false);
+	}
+
+	ulint	n_read = fread(*dump, sizeof(**dump), *dump_n, f);
+
+	if (n_read != *dump_n && ferror(f)) {
+		ut_free(*dump);
+		*dump = NULL;
+		*dump_n = 0;
+		buf_load_status(STATUS_ERR,
+				"Error parsing '%s', unable"
+				" to load buffer pool (stage 2)",
+				full_filename);
+		return(false);
+	}
+
+	/* The file could have been truncated after we got its size. */
+	*dump_n = n_read;
+
+	for (ulint i = 0; i < *dump_n; i++) {
+		(*dump)[i] = mach_read_from_8(
+			reinterpret_cast<const byte*>(&(*dump)[i]));
+	}
+
+	return(true);
+}
+
+/** State of a buffer pool load that is shared by the threads reading the
+pages. The dump is split into chunks of BUF_LOAD_CHUNK entries that the
+threads claim one at a time. */
+struct buf_load_t {
+	/** Entries of the dump, sorted by (space, page) */
+	const buf_dump_t*	dump;
+
+	/** Number of entries in dump */
+	ulint			dump_n;
+
+	/** IO ops per second that each thread may do while there is
+	other activity */
+	ulint			io_capacity;
+
+	/** Start of the next chunk to claim */
+	std::atomic<ulint>	next;
+
+	/** Number of entries that have been processed */
+	std::atomic<ulint>	n_done;
+};
+
+/** Throttling state of one buffer pool load thread */
+struct buf_load_throttle_t {
+	/** Milliseconds since epoch of the last throttling check */
+	ulint	last_check_time;
+
+	/** Activity count at the last throttling check */
+	ulint	last_activity_count;
+
+	/** Number of pages that this thread has requested */
+	ulint	n_io;
+};
+
+/** Claim the next chunk of a buffer pool load and issue asynchronous reads
+for its pages. Runs of consecutive pages are submitted as one batch, so that
+the AIO layer can merge them into larger requests.
+@param[in,out]	load		buffer pool load
+@param[in,out]	throttle	throttling state of the calling thread
+@return false if there was no chunk left or the load should stop */
+static
+bool
+buf_load_next_chunk(
+	buf_load_t*		load,
+	buf_load_throttle_t*	throttle)
+{
+	if (buf_load_abort_flag || SHUTTING_DOWN()) {
+		return(false);
+	}
+
+	const ulint	begin = load->next.fetch_add(BUF_LOAD_CHUNK);
+
+	if (begin >= load->dump_n) {
+		return(false);
 	}
 
-	ulint		last_check_time = 0;
-	ulint		last_activity_cnt = 0;
+	const ulint	end = std::min(begin + BUF_LOAD_CHUNK, load->dump_n);
 
 	/* Avoid calling the expensive fil_space_acquire_silent() for each
 	page within the same tablespace. dump[] is sorted by (space, page),
 	so all pages from a given tablespace are consecutive. */
-	space_id_t	cur_space_id = BUF_DUMP_SPACE(dump[0]);
+	space_id_t	cur_space_id = BUF_DUMP_SPACE(load->dump[begin]);
 	fil_space_t*	space = fil_space_acquire_silent(cur_space_id);
 	page_size_t	page_size(space ? space->flags : 0);
+	ulint		n_batch = 0;
 
-#ifdef HAVE_PSI_STAGE_INTERFACE
-	PSI_stage_progress*	pfs_stage_progress
-		= mysql_set_stage(srv_stage_buffer_pool_load.m_key);
-#endif /* HAVE_PSI_STAGE_INTERFACE */
-
-	mysql_stage_set_work_estimated(pfs_stage_progress, dump_n);
-	mysql_stage_set_work_completed(pfs_stage_progress, 0);
-
-	for (i = 0; i < dump_n && !SHUTTING_DOWN(); i++) {
+	for (ulint i = begin; i < end; i++) {
 
 		/* space_id for this iteration of the loop */
-		const space_id_t this_space_id = BUF_DUMP_SPACE(dump[i]);
+		const space_id_t this_space_id = BUF_DUMP_SPACE(load->dump[i]);
 
 		if (this_space_id != cur_space_id) {
 			if (space != NULL) {
@@ -676,56 +836,205 @@ buf_load()
 		}
 
 		buf_read_page_background(
-			page_id_t(this_space_id, BUF_DUMP_PAGE(dump[i])),
-			page_size, true);
-
-		if (i % 64 == 63) {
+			page_id_t(this_space_id, BUF_DUMP_PAGE(load->dump[i])),
+			page_size, false);
+
+		/* Submit the batch at the end of a run of consecutive
+		pages of the same tablespace. */
+		if (++n_batch == BUF_LOAD_BATCH
+		    || i + 1 == end
+		    || load->dump[i + 1] != load->dump[i] + 1) {
 			os_aio_simulated_wake_handler_threads();
+			n_batch = 0;
 		}
 
-		/* Update the progress every 32 MiB, which is every Nth page,
-		where N = 32*1024^2 / page_size. */
-		static const ulint	update_status_every_n_mb = 32;
-		static const ulint	update_status_every_n_pages
-			= update_status_every_n_mb * 1024 * 1024
-			/ page_size.physical();
+		buf_load_throttle_if_needed(
+			&throttle->last_check_time,
+			&throttle->last_activity_count,
+			throttle->n_io++, load->io_capacity);
+	}
+
+	if (space != NULL) {
+		fil_space_release(space);
+	}
+
+	load->n_done.fetch_add(end - begin);
 
-		if (i % update_status_every_n_pages == 0) {
+	return(true);
+}
+
+/** Helper thread of a buffer pool load.
+@param[in,out]	load	buffer pool load */
+static
+void
+buf_load_thread(
+	buf_load_t*	load)
+{
+	buf_load_throttle_t	throttle = {0, 0, 0};
+
+	while (buf_load_next_chunk(load, &throttle)) {
+	}
+}
+
+/*****************************************************************//**
+Perform a buffer pool load from the file specified by
+innodb_buffer_pool_filename. If any errors occur then the value of
+innodb_buffer_pool_load_status will be set accordingly, see buf_load_status().
+The dump filename can be specified by (relative to srv_data_home):
+SET GLOBAL innodb_buffer_pool_filename='filename'; */
+static
+void
+buf_load()
+/*======*/
+{
+	char		full_filename[OS_FILE_MAX_PATH];
+	char		now[32];
+	FILE*		f;
+	buf_dump_t*	dump;
+	ulint		dump_n;
+	char		magic[BUF_DUMP_MAGIC_LEN];
+	bool		ok;
+
+	/* Ignore any leftovers from before */
+	buf_load_abort_flag = FALSE;
+
+	buf_dump_generate_path(full_filename, sizeof(full_filename));
+
+	buf_load_status(STATUS_INFO,
+			"Loading buffer pool(s) from %s", full_filename);
+
+	f = fopen(full_filename, "rb");
+	if (f == NULL) {
+		buf_load_status(STATUS_ERR,
+				"Cannot open '%s' for reading: %s",
+				full_filename, strerror(errno));
+		return;
+	}
+	/* else */
+
+	if (fread(magic, sizeof(magic), 1, f) == 1
+	    && memcmp(magic, BUF_DUMP_MAGIC, BUF_DUMP_MAGIC_LEN) == 0) {
+		ok = buf_load_parse_binary(f, full_filename, &dump, &dump_n);
+	} else {
+		rewind(f);
+		ok = buf_load_parse_text(f, full_filename, &dump, &dump_n);
+	}
+
+	fclose(f);
+
+	if (!ok) {
+		return;
+	}
+
+	if (dump_n == 0) {
+		ut_free(dump);
+		ut_sprintf_timestamp(now);
+		buf_load_status(STATUS_INFO,
+				"Buffer pool(s) load completed at %s"
+				" (%s was empty)", now, full_filename);
+		return;
+	}
+
+	if (!SHUTTING_DOWN()) {
+		std::sort(dump, dump + dump_n);
+	}
+
+	/* The dump is read by up to srv_buf_pool_load_threads threads, this
+	one included, which share srv_io_capacity between them. */
+	const ulint	n_chunks = (dump_n + BUF_LOAD_CHUNK - 1) / BUF_LOAD_CHUNK;
+	const ulint	n_threads = std::min(
+		static_cast<ulint>(srv_buf_pool_load_threads), n_chunks);
+
+	buf_load_t	load;
+
+	load.dump = dump;
+	load.dump_n = dump_n;
+	load.io_capacity = std::max(srv_io_capacity / n_threads, 1UL);
+	load.next.store(0);
+	load.n_done.store(0);
+
+#ifdef HAVE_PSI_STAGE_INTERFACE
+	PSI_stage_progress*	pfs_stage_progress
+		= mysql_set_stage(srv_stage_buffer_pool_load.m_key);
+#endif /* HAVE_PSI_STAGE_INTERFACE */
+
+	mysql_stage_set_work_estimated(pfs_stage_progress, dump_n);
+	mysql_stage_set_work_completed(pfs_stage_progress, 0);
+
+	Helper_threads	helpers;
+
+	for (ulint i = 1; i < n_threads; ++i) {
+		helpers.start(buf_load_thread_key, buf_load_thread, &load);
+	}
+
+	/* Update the progress every 32 MiB, which is every Nth page,
+	where N = 32*1024^2 / page_size. */
+	static const ulint	update_status_every_n_mb = 32;
+	const ulint		update_status_every_n_pages
+		= update_status_every_n_mb * 1024 * 1024 / UNIV_PAGE_SIZE;
+
+	buf_load_throttle_t	throttle = {0, 0, 0};
+	ulint			last_reported = 0;
+
+	/* Read chunks like the helper threads do, and keep reporting the
+	progress after there are no chunks left until all the claimed chunks
+	have been read. */
+	for (;;) {
+		const bool	more = buf_load_next_chunk(&load, &throttle);
+		const ulint	n_done = load.n_done.load();
+
+		if (n_done - last_reported >= update_status_every_n_pages) {
 			buf_load_status(STATUS_VERBOSE,
 					"Loaded " ULINTPF "/" ULINTPF " pages",
-					i + 1, dump_n);
-			mysql_stage_set_work_completed(pfs_stage_progress, i);
+					n_done, dump_n);
+			mysql_stage_set_work_completed(
+				pfs_stage_progress, n_done);
+			last_reported = n_done;
 		}
 
-		if (buf_load_abort_flag) {
-			if (space != NULL) {
-				fil_space_release(space);
+		if (!more) {
+			if (n_done == dump_n
+			    || buf_load_abort_flag || SHUTTING_DOWN()) {
+				break;
 			}
-			buf_load_abort_flag = FALSE;
-			ut_free(dump);
-			buf_load_status(
-				STATUS_INFO,
-				"Buffer pool(s) load aborted on request");
-			/* Premature end, set estimated = completed = i and
-			end the current stage event. */
-			mysql_stage_set_work_estimated(pfs_stage_progress, i);
-			mysql_stage_set_work_completed(pfs_stage_progress, i);
-#ifdef HAVE_PSI_STAGE_INTERFACE
-			mysql_end_stage();
-#endif /* HAVE_PSI_STAGE_INTERFACE */
-			return;
-		}
 
-		buf_load_throttle_if_needed(
-			&last_check_time, &last_activity_cnt, i);
+			os_thread_sleep(10000);
+		}
 	}
 
-	if (space != NULL) {
-		fil_space_release(space);
-	}
+	/* Stop the helper threads from claiming more chunks. */
+	load.next.store(dump_n);
+
+	helpers.join();
 
 	ut_free(dump);
 
+	if (buf_load_abort_flag) {
+		const ulint	n_done = load.n_done.load();
+
+		buf_load_abort_flag = FALSE;
+		buf_load_status(
+			STATUS_INFO,
+			"Buffer pool(s) load aborted on request");
+		/* Premature end, set estimated = completed = n_done and
+		end the current stage event. */
+		mysql_stage_set_work_estimated(pfs_stage_progress, n_done);
+		mysql_stage_set_work_completed(pfs_stage_progress, n_done);
+#ifdef HAVE_PSI_STAGE_INTERFACE
+		mysql_end_stage();
+#endif /* HAVE_PSI_STAGE_INTERFACE */
+		return;
+	}
+
+	/* The reads were asynchronous. Wait a while for them to finish, so
+	that the pages are in the buffer pool when we report completion. */
+	for (ulint i = 0;
+	     i < 1000 && buf_get_n_pending_read_ios() > 0
+	     && !buf_load_abort_flag && !SHUTTING_DOWN();
+	     ++i) {
+		os_thread_sleep(10000);
+	}
+
 	ut_sprintf_timestamp(now);
 
 	buf_load_status(STATUS_INFO,
@@ -24,6 +24,7 @@ Created 11/11/1995 Heikki Tuuri
 *******************************************************/
 
 #include <math.h>
+#include <algorithm>
 #include <my_dbug.h>
 #include <mysql/service_thd_wait.h>
 #include <sys/types.h>
@@ -123,6 +124,10 @@ struct page_cleaner_slot_t {
 	ulint			n_pages_requested;
 					/*!< number of requested pages
 					for the slot */
+	ulint			n_dirty;
+					/*!< length of the flush_list of the
+					instance when n_pages_requested was
+					computed */
 	/* These values are updated during state==PAGE_CLEANER_STATE_FLUSHING,
 	and commited with state==PAGE_CLEANER_STATE_FINISHED.
 	The consistency is protected by the 'state' */
@@ -202,8 +207,25 @@ the blocks on free list. If LRU list is very small then we can end up
 in thrashing. */
 #define BUF_LRU_MIN_LEN		256
 
+/** Upper limit of buf_pool_t::LRU_scan_depth, as a multiple of
+innodb_LRU_scan_depth */
+#define BUF_LRU_SCAN_DEPTH_MAX_FACTOR	8
+
 /* @} */
 
+/** Get the number of free blocks that the page cleaner tries to keep in the
+free list of a buffer pool instance.
+@param[in]	buf_pool	buffer pool instance
+@return free list target of the instance */
+static inline
+ulint
+buf_flush_LRU_scan_depth(
+	const buf_pool_t*	buf_pool)
+{
+	return(ut_max(static_cast<ulint>(srv_LRU_scan_depth),
+		      buf_pool->LRU_scan_depth));
+}
+
 /** Thread tasked with flushing dirty pages from the buffer pools.
 As of now we'll have only one coordinator.
 @param[in]	n_page_cleaners	Number of page cleaner threads to create */
@@ -1128,7 +1150,7 @@ buf_flush_write_block_low(
 		buf_dblwr_write_single_page(bpage, sync);
 	} else {
 		ut_ad(!sync);
-		buf_dblwr_add_to_batch(bpage);
+		buf_dblwr_add_to_batch(bpage, flush_type);
 	}
 
 	/* When doing single page flushing the IO is done synchronously
@@ -1673,7 +1695,7 @@ buf_free_from_unzip_LRU_list_batch(
 
 	while (block != NULL
 	       && count < max
-	       && free_len < srv_LRU_scan_depth
+	       && free_len < buf_flush_LRU_scan_depth(buf_pool)
 	       && lru_len > UT_LIST_GET_LEN(buf_pool->LRU) / 10) {
 
 		BPageMutex*	block_mutex = buf_page_get_mutex(&block->page);
@@ -1733,6 +1755,7 @@ buf_flush_LRU_list_batch(
 	ulint		free_len = UT_LIST_GET_LEN(buf_pool->free);
 	ulint		lru_len = UT_LIST_GET_LEN(buf_pool->LRU);
 	ulint		withdraw_depth;
+	const ulint	free_depth = buf_flush_LRU_scan_depth(buf_pool);
 
 	ut_ad(mutex_own(&buf_pool->LRU_list_mutex));
 
@@ -1740,7 +1763,7 @@ buf_flush_LRU_list_batch(
 
 	for (bpage = UT_LIST_GET_LAST(buf_pool->LRU);
 	     bpage != NULL && count + evict_count < max
-	     && free_len < srv_LRU_scan_depth + withdraw_depth
+	     && free_len < free_depth + withdraw_depth
 	     && lru_len > BUF_LRU_MIN_LEN;
 	     ++scanned,
 	     bpage = buf_pool->lru_hp.get()) {
@@ -2054,7 +2077,7 @@ buf_flush_end(
 	mutex_exit(&buf_pool->flush_state_mutex);
 
 	if (!srv_read_only_mode) {
-		buf_dblwr_flush_buffered_writes();
+		buf_dblwr_flush_buffered_writes(buf_pool, flush_type);
 	} else {
 		os_aio_simulated_wake_handler_threads();
 	}
@@ -2090,6 +2113,76 @@ buf_flush_wait_batch_end(
 	}
 }
 
+/** Write one page of the flush list to its file, and wait until the
+changes of the page up to an LSN are in the file. Unlike buf_flush_lists(),
+no other page is flushed.
+NOTE: The calling thread is not allowed to own any latches on pages!
+@param[in]	page_id		page to write
+@param[in]	lsn		end LSN of the last change that must be
+				written */
+void
+buf_flush_page_and_wait(
+	const page_id_t&	page_id,
+	lsn_t			lsn)
+{
+	buf_pool_t*	buf_pool = buf_pool_get(page_id);
+
+	for (;;) {
+		rw_lock_t*	hash_lock;
+		buf_page_t*	bpage = buf_page_hash_get_s_locked(
+			buf_pool, page_id, &hash_lock);
+
+		if (bpage == NULL) {
+			/* The page was written and evicted. */
+			return;
+		}
+
+		BPageMutex*	block_mutex = buf_page_get_mutex(bpage);
+
+		mutex_enter(block_mutex);
+
+		rw_lock_s_unlock(hash_lock);
+
+		if (bpage->oldest_modification == 0
+		    || bpage->oldest_modification > lsn) {
+
+			/* The changes up to lsn have been written. */
+			mutex_exit(block_mutex);
+			return;
+		}
+
+		buf_flush_t	flush_type = BUF_FLUSH_LIST;
+
+		if (buf_flush_ready_for_flush(bpage, BUF_FLUSH_LIST)) {
+
+			/* The following call releases the block mutex, and
+			the page stays I/O-fixed until the write completes. */
+			ut_a(buf_flush_page(
+				     buf_pool, bpage, BUF_FLUSH_LIST, false));
+
+			buf_dblwr_flush_buffered_writes(
+				buf_pool, BUF_FLUSH_LIST);
+
+		} else if (buf_page_get_io_fix(bpage) == BUF_IO_WRITE) {
+
+			/* Wait for the flush that is writing the page. */
+			flush_type = buf_page_get_flush_type(bpage);
+
+			mutex_exit(block_mutex);
+		} else {
+			mutex_exit(block_mutex);
+
+			os_thread_yield();
+
+			continue;
+		}
+
+		thd_wait_begin(NULL, THD_WAIT_DISKIO);
+		os_event_wait(buf_pool->no_flush[flush_type]);
+		thd_wait_end(NULL);
+	}
+}
+
 /** Do flushing batch of a given type.
 NOTE: The calling thread is not allowed to own any latches on pages!
 @param[in,out]	buf_pool	buffer pool instance
@@ -2359,7 +2452,8 @@ Clears up tail of the LRU list of a given buffer pool instance:
 * Put replaceable pages at the tail of LRU to the free list
 * Flush dirty pages at the tail of LRU to the disk
 The depth to which we scan each buffer pool is controlled by dynamic
-config parameter innodb_LRU_scan_depth.
+config parameter innodb_LRU_scan_depth, and raised for an instance whose
+free list keeps running dry, see pc_adapt_LRU_scan_depth().
 @param buf_pool buffer pool instance
 @return total pages flushed */
 static
@@ -2367,7 +2461,7 @@ ulint
 buf_flush_LRU_list(
 	buf_pool_t*	buf_pool)
 {
-	ulint	scan_depth, withdraw_depth;
+	ulint	scan_depth, withdraw_depth, free_depth;
 	ulint	n_flushed = 0;
 
 	ut_ad(buf_pool);
@@ -2376,12 +2470,12 @@ buf_flush_LRU_list(
 	We cap it with current LRU size. */
 	scan_depth = UT_LIST_GET_LEN(buf_pool->LRU);
 	withdraw_depth = buf_get_withdraw_depth(buf_pool);
+	free_depth = buf_flush_LRU_scan_depth(buf_pool);
 
-	if (withdraw_depth > srv_LRU_scan_depth) {
+	if (withdraw_depth > free_depth) {
 		scan_depth = ut_min(withdraw_depth, scan_depth);
 	} else {
-		scan_depth = ut_min(static_cast<ulint>(srv_LRU_scan_depth),
-				    scan_depth);
+		scan_depth = ut_min(free_depth, scan_depth);
 	}
 
 	/* Currently one of page_cleaners is the only thread
@@ -2493,6 +2587,44 @@ af_get_pct_for_lsn(
 		/ 7.5));
 }
 
+/** Calculates a correction to af_get_pct_for_lsn() from the history of the
+checkpoint age. The age is compared with a target of half the async flushing
+point: the correction grows for as long as the age stays above the target,
+and shrinks again once the age falls below it. This lets the page cleaner
+catch up with a burst of redo before user threads reach the async and sync
+flushing points and have to flush pages themselves.
+Only called by the page cleaner coordinator.
+@param[in]	age	current age of LSN
+@return percent of io_capacity to add to the redo based flushing */
+static
+ulint
+af_get_pct_for_lsn_correction(
+	lsn_t	age)
+{
+	/* Accumulated error, in percent of the target age */
+	static int64_t	integral = 0;
+
+	const lsn_t	target = log_get_max_modified_age_async() / 2;
+
+	if (!srv_adaptive_flushing || target == 0) {
+		integral = 0;
+		return(0);
+	}
+
+	/* Distance from the target in percent, positive when we are
+	behind. */
+	const int64_t	error = (static_cast<int64_t>(age)
+				 - static_cast<int64_t>(target))
+		* 100 / static_cast<int64_t>(target);
+
+	integral = std::max<int64_t>(
+		0, std::min<int64_t>(integral + error / 4, 100));
+
+	const int64_t	pct = std::max<int64_t>(error, 0) / 2 + integral;
+
+	return(static_cast<ulint>(std::min<int64_t>(pct, 100)));
+}
+
 /*********************************************************************//**
 This function is called approximately once every second by the
 page_cleaner thread. Based on various factors it decides if there is a
@@ -2520,6 +2652,7 @@ page_cleaner_flush_pages_recommendation(
 	ulint			n_pages = 0;
 	ulint			pct_for_dirty = 0;
 	ulint			pct_for_lsn = 0;
+	ulint			pct_for_lsn_correction = 0;
 	ulint			pct_total = 0;
 
 	cur_lsn = log_get_lsn();
@@ -2654,19 +2787,24 @@ page_cleaner_flush_pages_recommendation(
 
 	pct_for_dirty = af_get_pct_for_dirty();
 	pct_for_lsn = af_get_pct_for_lsn(age);
+	pct_for_lsn_correction = af_get_pct_for_lsn_correction(age);
 
-	pct_total = ut_max(pct_for_dirty, pct_for_lsn);
+	pct_total = ut_max(pct_for_dirty,
+			   pct_for_lsn + pct_for_lsn_correction);
 
 	/* Estimate pages to be flushed for the lsn progress */
 	ulint	sum_pages_for_lsn = 0;
+	ulint	sum_dirty = 0;
 	lsn_t	target_lsn = oldest_lsn
 			     + lsn_avg_rate * buf_flush_lsn_scan_factor;
 
 	for (ulint i = 0; i < srv_buf_pool_instances; i++) {
 		buf_pool_t*	buf_pool = buf_pool_from_array(i);
 		ulint		pages_for_lsn = 0;
+		ulint		n_dirty;
 
 		buf_flush_list_mutex_enter(buf_pool);
+		n_dirty = UT_LIST_GET_LEN(buf_pool->flush_list);
 		for (buf_page_t* b = UT_LIST_GET_LAST(buf_pool->flush_list);
 		     b != NULL;
 		     b = UT_LIST_GET_PREV(list, b)) {
@@ -2678,12 +2816,14 @@ page_cleaner_flush_pages_recommendation(
 		buf_flush_list_mutex_exit(buf_pool);
 
 		sum_pages_for_lsn += pages_for_lsn;
+		sum_dirty += n_dirty;
 
 		mutex_enter(&page_cleaner->mutex);
 		ut_ad(page_cleaner->slots[i].state
 		      == PAGE_CLEANER_STATE_NONE);
 		page_cleaner->slots[i].n_pages_requested
 			= pages_for_lsn / buf_flush_lsn_scan_factor + 1;
+		page_cleaner->slots[i].n_dirty = n_dirty;
 		mutex_exit(&page_cleaner->mutex);
 	}
 
@@ -2710,12 +2850,21 @@ page_cleaner_flush_pages_recommendation(
 	ut_ad(page_cleaner->n_slots_finished == 0);
 
 	for (ulint i = 0; i < srv_buf_pool_instances; i++) {
-		/* if REDO has enough of free space,
-		don't care about age distribution of pages */
-		page_cleaner->slots[i].n_pages_requested = pct_for_lsn > 30 ?
-			page_cleaner->slots[i].n_pages_requested
-			* n_pages / sum_pages_for_lsn + 1
-			: n_pages / srv_buf_pool_instances;
+		page_cleaner_slot_t*	slot = &page_cleaner->slots[i];
+
+		if (pct_for_lsn + pct_for_lsn_correction > 30) {
+			slot->n_pages_requested = slot->n_pages_requested
+				* n_pages / sum_pages_for_lsn + 1;
+		} else if (sum_dirty > 0) {
+			/* if REDO has enough of free space, don't care
+			about age distribution of pages, but give each
+			instance its share of the dirty pages */
+			slot->n_pages_requested = n_pages * slot->n_dirty
+				/ sum_dirty;
+		} else {
+			slot->n_pages_requested = n_pages
+				/ srv_buf_pool_instances;
+		}
 	}
 	mutex_exit(&page_cleaner->mutex);
 
@@ -2727,12 +2876,46 @@ page_cleaner_flush_pages_recommendation(
 	MONITOR_SET(MONITOR_FLUSH_LSN_AVG_RATE, lsn_avg_rate);
 	MONITOR_SET(MONITOR_FLUSH_PCT_FOR_DIRTY, pct_for_dirty);
 	MONITOR_SET(MONITOR_FLUSH_PCT_FOR_LSN, pct_for_lsn);
+	MONITOR_SET(MONITOR_FLUSH_PCT_FOR_LSN_CORRECTION,
+		    pct_for_lsn_correction);
 
 	*lsn_limit = LSN_MAX;
 
 	return(n_pages);
 }
 
+/** Adjusts the free list target of each buffer pool instance. An instance
+whose free list was found empty by user threads since the last call gets
+twice the target, up to BUF_LRU_SCAN_DEPTH_MAX_FACTOR times
+innodb_LRU_scan_depth and a quarter of the instance. Otherwise the target
+moves back towards innodb_LRU_scan_depth by a quarter of the difference.
+Called by the page cleaner coordinator about once per second. */
+static
+void
+pc_adapt_LRU_scan_depth()
+{
+	const ulint	min_depth = srv_LRU_scan_depth;
+
+	for (ulint i = 0; i < srv_buf_pool_instances; i++) {
+		buf_pool_t*	buf_pool = buf_pool_from_array(i);
+		const ulint	n_free_waits = buf_pool->n_free_waits;
+		ulint		depth = buf_flush_LRU_scan_depth(buf_pool);
+
+		if (n_free_waits != buf_pool->n_free_waits_last) {
+			depth = ut_min(
+				depth * 2,
+				ut_min(min_depth
+				       * BUF_LRU_SCAN_DEPTH_MAX_FACTOR,
+				       buf_pool->curr_size / 4));
+		} else {
+			depth -= (depth - min_depth) / 4;
+		}
+
+		buf_pool->LRU_scan_depth = ut_max(depth, min_depth);
+		buf_pool->n_free_waits_last = n_free_waits;
+	}
+}
+
 /*********************************************************************//**
 Puts the page_cleaner thread to sleep if it has finished work in less
 than a second
@@ -2884,11 +3067,16 @@ pc_request(
 }
 
 /**
-Do flush for one slot.
+Do flush for one slot. Each page cleaner thread looks for a requested slot
+starting from its own number, so that with as many page cleaners as buffer
+pool instances every instance is usually flushed by the same thread.
+@param[in]	id	number of the page cleaner thread, 0 for the
+			coordinator
 @return	the number of the slots which has not been treated yet. */
 static
 ulint
-pc_flush_slot(void)
+pc_flush_slot(
+	ulint	id)
 {
 	ulint	lru_tm = 0;
 	ulint	list_tm = 0;
@@ -2899,9 +3087,11 @@ pc_flush_slot(void)
 
 	if (page_cleaner->n_slots_requested > 0) {
 		page_cleaner_slot_t*	slot = NULL;
-		ulint			i;
+		ulint			i = 0;
+		ulint			n;
 
-		for (i = 0; i < page_cleaner->n_slots; i++) {
+		for (n = 0; n < page_cleaner->n_slots; n++) {
+			i = (id + n) % page_cleaner->n_slots;
 			slot = &page_cleaner->slots[i];
 
 			if (slot->state == PAGE_CLEANER_STATE_REQUESTED) {
@@ -2911,7 +3101,7 @@ pc_flush_slot(void)
 
 		/* slot should be found because
 		page_cleaner->n_slots_requested > 0 */
-		ut_a(i < page_cleaner->n_slots);
+		ut_a(n < page_cleaner->n_slots);
 
 		buf_pool_t* buf_pool = buf_pool_from_array(i);
 
@@ -2936,6 +3126,10 @@ pc_flush_slot(void)
 		/* Flush pages from end of LRU if required */
 		slot->n_flushed_lru = buf_flush_LRU_list(buf_pool);
 
+		/* Wake up the threads waiting for a free block in
+		buf_LRU_get_free_block() */
+		os_event_set(buf_pool->free_event);
+
 		lru_tm = ut_time_ms() - lru_tm;
 		lru_pass++;
 
@@ -3228,7 +3422,7 @@ buf_flush_page_coordinator_thread(size_t n_page_cleaners)
 		case BUF_FLUSH_LRU:
 			/* Flush pages from end of LRU if required */
 			pc_request(0, LSN_MAX);
-			while (pc_flush_slot() > 0) {}
+			while (pc_flush_slot(0) > 0) {}
 			pc_wait_finished(&n_flushed_lru, &n_flushed_list);
 			break;
 
@@ -3236,7 +3430,7 @@ buf_flush_page_coordinator_thread(size_t n_page_cleaners)
 			/* Flush all pages */
 			do {
 				pc_request(ULINT_MAX, LSN_MAX);
-				while (pc_flush_slot() > 0) {}
+				while (pc_flush_slot(0) > 0) {}
 			} while (!pc_wait_finished(&n_flushed_lru,
 						   &n_flushed_list));
 			break;
@@ -3314,6 +3508,8 @@ buf_flush_page_coordinator_thread(size_t n_page_cleaners)
 
 			next_loop_time = curr_time + 1000;
 			n_flushed_last = n_evicted = 0;
+
+			pc_adapt_LRU_scan_depth();
 		}
 
 		if (ret_sleep != OS_SYNC_TIME_EXCEEDED
@@ -3331,7 +3527,7 @@ buf_flush_page_coordinator_thread(size_t n_page_cleaners)
 			ulint tm = ut_time_ms();
 
 			/* Coordinator also treats requests */
-			while (pc_flush_slot() > 0) {}
+			while (pc_flush_slot(0) > 0) {}
 
 			/* only coordinator is using these counters,
 			so no need to protect by lock. */
@@ -3375,7 +3571,7 @@ buf_flush_page_coordinator_thread(size_t n_page_cleaners)
 			ulint tm = ut_time_ms();
 
 			/* Coordinator also treats requests */
-			while (pc_flush_slot() > 0) {
+			while (pc_flush_slot(0) > 0) {
 				/* No op */
 			}
 
@@ -3435,7 +3631,30 @@ buf_flush_page_coordinator_thread(size_t n_page_cleaners)
 			}
 
 		} else {
-			/* no activity, but woken up by event */
+			/* no activity, but woken up by event, possibly by
+			threads waiting for a free block: refill the free
+			lists */
+			pc_request(0, LSN_MAX);
+
+			while (pc_flush_slot(0) > 0) {}
+
+			ulint	n_flushed_lru = 0;
+			ulint	n_flushed_list = 0;
+
+			pc_wait_finished(&n_flushed_lru, &n_flushed_list);
+
+			if (n_flushed_lru > 0) {
+				buf_flush_stats(0, n_flushed_lru);
+
+				MONITOR_INC_VALUE_CUMULATIVE(
+					MONITOR_LRU_BATCH_FLUSH_TOTAL_PAGE,
+					MONITOR_LRU_BATCH_FLUSH_COUNT,
+					MONITOR_LRU_BATCH_FLUSH_PAGES,
+					n_flushed_lru);
+			}
+
+			n_evicted += n_flushed_lru;
+
 			n_flushed = 0;
 		}
 
@@ -3466,7 +3685,7 @@ buf_flush_page_coordinator_thread(size_t n_page_cleaners)
 	do {
 		pc_request(ULINT_MAX, LSN_MAX);
 
-		while (pc_flush_slot() > 0) {}
+		while (pc_flush_slot(0) > 0) {}
 
 		ulint	n_flushed_lru = 0;
 		ulint	n_flushed_list = 0;
@@ -3500,7 +3719,7 @@ buf_flush_page_coordinator_thread(size_t n_page_cleaners)
 	do {
 		pc_request(ULINT_MAX, LSN_MAX);
 
-		while (pc_flush_slot() > 0) {}
+		while (pc_flush_slot(0) > 0) {}
 
 		ulint	n_flushed_lru = 0;
 		ulint	n_flushed_list = 0;
@@ -3545,7 +3764,7 @@ buf_flush_page_cleaner_thread()
 {
 	my_thread_init();
 	mutex_enter(&page_cleaner->mutex);
-	++page_cleaner->n_workers;
+	const ulint	id = ++page_cleaner->n_workers;
 	mutex_exit(&page_cleaner->mutex);
 
 #ifdef UNIV_LINUX
@@ -3568,7 +3787,7 @@ buf_flush_page_cleaner_thread()
 			break;
 		}
 
-		pc_flush_slot();
+		pc_flush_slot(id);
 	}
 
 	mutex_enter(&page_cleaner->mutex);
@@ -68,6 +68,14 @@ allowed to point to either end of the LRU list. */
 # error "BUF_LRU_NON_OLD_MIN_LEN >= BUF_LRU_OLD_MIN_LEN"
 #endif
 
+/** How many times buf_LRU_get_free_block() waits for the page cleaner to
+refill the free list before it flushes a page itself */
+static const ulint BUF_LRU_CLEANER_MAX_WAITS = 2;
+
+/** How long buf_LRU_get_free_block() waits for the page cleaner at a time,
+in microseconds */
+static const ulint BUF_LRU_CLEANER_WAIT_TIMEOUT = 10000;
+
 /** When dropping the search hash index entries before deleting an ibd
 file, we build a local array of pages belonging to that tablespace
 in the buffer pool. Following is the size of that array.
@@ -1356,6 +1364,9 @@ we put it to free list to be used.
     * scan LRU up to srv_LRU_scan_depth to find a clean block
     * the above will put the block on free list
     * success:retry the free list
+  * wake up the page cleaner and wait for it to finish an LRU batch
+    of this instance, up to BUF_LRU_CLEANER_MAX_WAITS times
+    * retry the free list
   * flush one dirty page from tail of LRU to disk
     * the above will put the block on free list
     * success: retry the free list
@@ -1375,6 +1386,7 @@ buf_LRU_get_free_block(
 	bool		freed		= false;
 	ulint		n_iterations	= 0;
 	ulint		flush_failures	= 0;
+	ulint		n_cleaner_waits	= 0;
 	bool		mon_value_was	= false;
 	bool		started_monitor	= false;
 
@@ -1429,6 +1441,35 @@ loop:
 		goto loop;
 	}
 
+	if (n_iterations == 0 && n_cleaner_waits == 0) {
+		os_atomic_increment_ulint(&buf_pool->n_free_waits, 1);
+	}
+
+	/* Let the page cleaner refill the free list with an LRU batch
+	rather than flushing a page from this thread, as long as the page
+	cleaner keeps up. */
+	if (n_cleaner_waits < BUF_LRU_CLEANER_MAX_WAITS
+	    && buf_page_cleaner_is_active
+	    && !srv_read_only_mode
+	    && !recv_recovery_is_on()) {
+
+		int64_t	sig_count = os_event_reset(buf_pool->free_event);
+
+		++n_cleaner_waits;
+
+		if (UT_LIST_GET_LEN(buf_pool->free) == 0) {
+			MONITOR_INC(MONITOR_LRU_GET_FREE_CLEANER_WAITS);
+
+			os_event_set(buf_flush_event);
+
+			os_event_wait_time_low(
+				buf_pool->free_event,
+				BUF_LRU_CLEANER_WAIT_TIMEOUT, sig_count);
+		}
+
+		goto loop;
+	}
+
 	if (n_iterations > 20
 	    && srv_buf_pool_old_size == srv_buf_pool_size) {
 
@@ -1482,6 +1523,8 @@ loop:
 	involved (particularly in case of compressed pages). We
 	can do that in a separate patch sometime in future. */
 
+	os_atomic_increment_ulint(&buf_pool->n_single_flushes, 1);
+
 	if (!buf_flush_single_page_from_LRU(buf_pool)) {
 		MONITOR_INC(MONITOR_LRU_SINGLE_FLUSH_FAILURE_COUNT);
 		++flush_failures;
@@ -2140,6 +2183,8 @@ buf_LRU_block_free_non_file_page(
 	ut_ad(!block->page.in_flush_list);
 	ut_ad(!block->page.in_LRU_list);
 
+	page_cur_search_cache_free(block);
+
 #ifdef UNIV_DEBUG
 	/* Wipe contents of page to reveal possible stale pointers to it */
 	memset(block->frame, '\0', UNIV_PAGE_SIZE);
@@ -705,6 +705,98 @@ buf_read_ahead_linear(
 	return(count);
 }
 
+/** Issues read requests for B-tree leaf pages that a scan is about to
+visit. The page numbers are taken from the node pointers of the parent page
+or from the sibling link of the current leaf by btr_pcur_t, so unlike
+buf_read_ahead_linear() this works no matter how the leaves are laid out
+in the tablespace. Pages that already are in the buffer pool, pages beyond
+the end of the tablespace and change buffer bitmap pages are skipped.
+NOTE: the calling thread may own latches on pages: this function never waits
+for a page latch.
+@param[in]	space_id	tablespace id
+@param[in]	page_size	page size
+@param[in]	page_nos	page numbers, in the order of the scan
+@param[in]	n_pages		number of elements in page_nos
+@return number of page read requests issued */
+ulint
+buf_read_ahead_leaves(
+	space_id_t		space_id,
+	const page_size_t&	page_size,
+	const page_no_t*	page_nos,
+	ulint			n_pages)
+{
+	if (srv_startup_is_before_trx_rollback_phase) {
+		/* No read-ahead to avoid thread deadlocks */
+		return(0);
+	}
+
+	ulint	space_size;
+
+	if (fil_space_t* space = fil_space_acquire(space_id)) {
+
+		space_size = space->size;
+
+		fil_space_release(space);
+	} else {
+		return(0);
+	}
+
+	ulint	count = 0;
+
+	os_aio_simulated_put_read_threads_to_sleep();
+
+	for (ulint i = 0; i < n_pages; i++) {
+
+		const page_id_t	page_id(space_id, page_nos[i]);
+
+		if (page_id.page_no() >= space_size
+		    || ibuf_bitmap_page(page_id, page_size)) {
+
+			continue;
+		}
+
+		buf_pool_t*	buf_pool = buf_pool_get(page_id);
+
+		os_rmb;
+
+		if (buf_pool->n_pend_reads
+		    > buf_pool->curr_size / BUF_READ_AHEAD_PEND_LIMIT) {
+
+			break;
+		}
+
+		dberr_t	err;
+		ulint	n_read = buf_read_page_low(
+			&err, false, IORequest::DO_NOT_WAKE,
+			BUF_READ_ANY_PAGE, page_id, page_size, false);
+
+		buf_pool->stat.n_ra_pages_read += n_read;
+		count += n_read;
+
+		if (err == DB_TABLESPACE_DELETED) {
+			break;
+		}
+	}
+
+	/* In simulated aio we wake the aio handler threads only after
+	queuing all aio requests, in native aio the following call does
+	nothing: */
+
+	os_aio_simulated_wake_handler_threads();
+
+	if (count) {
+		DBUG_PRINT("ib_buf", ("leaf read-ahead %lu pages, "
+				      UINT32PF ":" UINT32PF,
+				      count, space_id, page_nos[0]));
+
+		/* Read ahead is considered one I/O operation for the
+		purpose of LRU policy decision. */
+		buf_LRU_stat_inc_io();
+	}
+
+	return(count);
+}
+
 /********************************************************************//**
 Issues read requests for pages which the ibuf module wants to read in, in
 order to contract the insert buffer tree. Technically, this function is like
@@ -30,6 +30,7 @@ Created Jan 06, 2010 Vasil Dimov
 
 #include <mysql_com.h>
 #include <algorithm>
+#include <atomic>
 #include <map>
 #include <vector>
 
@@ -37,6 +38,7 @@ Created Jan 06, 2010 Vasil Dimov
 #include "dyn0buf.h"
 #include "ha_prototypes.h"
 #include "lob0lob.h"
+#include "os0thread-create.h"
 #include "pars0pars.h"
 #include "row0sel.h"
 #include "trx0trx.h"
@@ -2067,6 +2069,91 @@ found_level:
 	DBUG_VOID_RETURN;
 }
 
+/** Number of index analysis helper threads that are running, across all
+the tables. Limited to MAX_STATS_ANALYZE_THREADS, because the threads are
+counted in srv_max_n_threads. */
+static std::atomic<ulint>	dict_stats_n_analyze_threads(0);
+
+/** Indexes of a table that are analyzed concurrently by
+dict_stats_update_persistent(). Each index is analyzed by one thread;
+dict_stats_analyze_index() only writes to the statistics members of the
+index that it is given. */
+struct dict_stats_analyze_t {
+	/** Table whose indexes are analyzed */
+	dict_table_t*		table;
+
+	/** Indexes to analyze, the clustered index first */
+	std::vector<dict_index_t*, ut_allocator<dict_index_t*>>	todo;
+
+	/** Next entry of todo[] to analyze */
+	std::atomic<ulint>	next;
+};
+
+/** Analyze indexes from the todo[] list until there are no more. The
+secondary indexes are skipped once the table is being dropped, like in
+the serial analysis.
+@param[in,out]	analyze		concurrent analysis */
+static
+void
+dict_stats_analyze_next(
+	dict_stats_analyze_t*	analyze)
+{
+	for (;;) {
+		const ulint	k = analyze->next.fetch_add(1);
+
+		if (k >= analyze->todo.size()) {
+			break;
+		}
+
+		dict_index_t*	index = analyze->todo[k];
+
+		if (index->is_clustered()
+		    || !(analyze->table->stats_bg_flag & BG_STAT_SHOULD_QUIT)) {
+
+			dict_stats_analyze_index(index);
+		}
+	}
+}
+
+/** Analyze the indexes in the todo[] list with up to
+srv_stats_analyze_threads threads. The calling thread takes part in the
+work, and does all of it if no helper threads are available.
+@param[in,out]	analyze		concurrent analysis; todo[] is filled in
+				by the caller */
+static
+void
+dict_stats_analyze_concurrently(
+	dict_stats_analyze_t*	analyze)
+{
+	ulint	n_threads = std::min(
+		ulint(srv_stats_analyze_threads), analyze->todo.size()) - 1;
+
+	/* Reserve the helper threads. */
+	ulint	active = dict_stats_n_analyze_threads.load();
+
+	do {
+		n_threads = std::min(
+			n_threads,
+			active < MAX_STATS_ANALYZE_THREADS
+			? MAX_STATS_ANALYZE_THREADS - active : 0);
+	} while (!dict_stats_n_analyze_threads.compare_exchange_weak(
+			 active, active + n_threads));
+
+	Helper_threads	helpers;
+
+	for (ulint i = 0; i < n_threads; ++i) {
+		helpers.start(
+			dict_stats_analyze_thread_key,
+			dict_stats_analyze_next, analyze);
+	}
+
+	dict_stats_analyze_next(analyze);
+
+	helpers.join();
+
+	dict_stats_n_analyze_threads.fetch_sub(n_threads);
+}
+
 /*********************************************************************//**
 Calculates new estimates for table and index statistics. This function
 is relatively slow and is used to calculate persistent statistics that
@@ -2079,6 +2166,7 @@ dict_stats_update_persistent(
 	dict_table_t*	table)		/*!< in/out: table */
 {
 	dict_index_t*	index;
+	dict_stats_analyze_t	analyze;
 
 	DEBUG_PRINTF("%s(table=%s)\n", __func__, table->name);
 
@@ -2101,38 +2189,47 @@ dict_stats_update_persistent(
 
 	ut_ad(!dict_index_is_ibuf(index));
 
-	dict_stats_analyze_index(index);
-
-	ulint	n_unique = dict_index_get_n_unique(index);
+	analyze.table = table;
+	analyze.next.store(0);
+	analyze.todo.push_back(index);
 
-	table->stat_n_rows = index->stat_n_diff_key_vals[n_unique - 1];
+	/* collect the other indexes from the table, if any */
 
-	table->stat_clustered_index_size = index->stat_index_size;
+	for (dict_index_t* sec = index->next(); sec != NULL;
+	     sec = sec->next()) {
 
-	/* analyze other indexes from the table, if any */
+		ut_ad(!dict_index_is_ibuf(sec));
 
-	table->stat_sum_of_other_index_sizes = 0;
-
-	for (index = index->next(); index != NULL; index = index->next()) {
-
-		ut_ad(!dict_index_is_ibuf(index));
-
-		if (index->type & DICT_FTS || dict_index_is_spatial(index)) {
+		if (sec->type & DICT_FTS || dict_index_is_spatial(sec)) {
 			continue;
 		}
 
-		dict_stats_empty_index(index);
+		dict_stats_empty_index(sec);
 
-		if (dict_stats_should_ignore_index(index)) {
+		if (dict_stats_should_ignore_index(sec)) {
 			continue;
 		}
 
-		if (!(table->stats_bg_flag & BG_STAT_SHOULD_QUIT)) {
-			dict_stats_analyze_index(index);
-		}
+		analyze.todo.push_back(sec);
+	}
+
+	if (srv_stats_analyze_threads > 1 && analyze.todo.size() > 1) {
+		dict_stats_analyze_concurrently(&analyze);
+	} else {
+		dict_stats_analyze_next(&analyze);
+	}
+
+	ulint	n_unique = dict_index_get_n_unique(index);
+
+	table->stat_n_rows = index->stat_n_diff_key_vals[n_unique - 1];
+
+	table->stat_clustered_index_size = index->stat_index_size;
+
+	table->stat_sum_of_other_index_sizes = 0;
 
+	for (ulint k = 1; k < analyze.todo.size(); k++) {
 		table->stat_sum_of_other_index_sizes
-			+= index->stat_index_size;
+			+= analyze.todo[k]->stat_index_size;
 	}
 
 	table->stats_last_recalc = ut_time();
@@ -58,6 +58,7 @@ Created 10/25/1995 Heikki Tuuri
 # include "buf0lru.h"
 # include "ibuf0ibuf.h"
 # include "os0event.h"
+# include "os0thread-create.h"
 # include "sync0sync.h"
 #else /* !UNIV_HOTBACKUP */
 # include "log0log.h"
@@ -75,18 +76,21 @@ mysql_pfs_key_t  innodb_tablespace_open_file_key;
 
 fil_space_t*	fil_space_t::s_sys_space;
 
-/** Tries to close a file in the LRU list. The caller must hold the fil_sys
-mutex. This function will release the fil sys mutex temporarily.
+struct fil_shard_t;
+
+/** Tries to close a file in the LRU list of a shard. The caller must hold
+the shard mutex. This function will release the shard mutex temporarily.
 @return true if success, false if should retry later; since i/o's
 generally complete in < 100 ms, and as InnoDB writes at most 128 pages
 from the buffer pool in a batch, and then immediately flushes the
 files, there is a good chance that the next time we find a suitable
 node from the LRU list.
+@param[in,out]	shard	shard whose LRU list to look at
 @param[in] print_info   if true, prints information why it
 			cannot close a file */
 static
 bool
-fil_try_to_close_file_in_LRU(bool print_info);
+fil_try_to_close_file_in_LRU(fil_shard_t* shard, bool print_info);
 
 /*
 		IMPLEMENTATION OF THE TABLESPACE MEMORY CACHE
@@ -163,10 +167,10 @@ ulint	fil_n_log_flushes			= 0;
 /** Number of pending redo log flushes */
 ulint	fil_n_pending_log_flushes		= 0;
 /** Number of pending tablespace flushes */
-ulint	fil_n_pending_tablespace_flushes	= 0;
+std::atomic<ulint>	fil_n_pending_tablespace_flushes;
 
 /** Number of files currently open */
-ulint	fil_n_file_opened			= 0;
+std::atomic<ulint>	fil_n_file_opened;
 
 enum fil_load_status {
 	/** The tablespace file(s) were found and valid. */
@@ -822,12 +826,24 @@ Fil_Open::deleted(space_id_t space_id)
 	return(true);
 }
 
-/** The tablespace memory cache; also the totality of logs (the log
-data space) is stored here; below we talk about tablespaces, but also
-the ib_logfiles form a 'space' and it is handled here */
-struct fil_system_t {
+/** Number of shards of the tablespace memory cache that the data files are
+distributed to, by tablespace ID. */
+static const size_t	FIL_N_SHARDS = 64;
+
+/** The redo log files are kept in a shard of their own, after the data file
+shards, so that log writes never wait for the mutex of a data file shard. */
+static const size_t	FIL_LOG_SHARD = FIL_N_SHARDS;
+
+/** A partition of the tablespace memory cache. Each tablespace belongs to
+exactly one shard, see fil_shard_get(). The shard mutex protects the lists
+and hashes below, and the mutable fields of the fil_space_t and fil_node_t
+objects of the tablespaces in the shard. */
+struct fil_shard_t {
+	char		pad[INNOBASE_CACHE_LINE_SIZE];
+					/*!< Padding, to prevent false
+					sharing between the shard mutexes */
 #ifndef UNIV_HOTBACKUP
-	ib_mutex_t	mutex;		/*!< The mutex protecting the cache */
+	ib_mutex_t	mutex;		/*!< The mutex protecting the shard */
 #endif /* !UNIV_HOTBACKUP */
 
 	Spaces		spaces;		/*!< Tablespace instances hashed on
@@ -836,9 +852,6 @@ struct fil_system_t {
 	Names		names;		/*!< Tablespace instances hashed on
 					the space name */
 
-	/** Track the mapping from tablespace ID to file name on disk. */
-	Fil_Open	m_open;
-
 	UT_LIST_BASE_NODE_T(fil_node_t) LRU;
 					/*!< base node for the LRU list of the
 					most recently used open files with no
@@ -856,19 +869,42 @@ struct fil_system_t {
 					unflushed writes; those spaces have
 					at least one file node where
 					modification_counter > flush_counter */
-	ulint		n_open;		/*!< number of files currently open */
-	ulint		max_n_open;	/*!< n_open is not allowed to exceed
-					this */
 	int64_t		modification_counter;/*!< when we write to a file we
 					increment this by one */
+	UT_LIST_BASE_NODE_T(fil_space_t) space_list;
+					/*!< list of all file spaces of
+					the shard */
+};
+
+/** The tablespace memory cache; also the totality of logs (the log
+data space) is stored here; below we talk about tablespaces, but also
+the ib_logfiles form a 'space' and it is handled here.
+
+Lookups by name, and the changes that must be atomic with respect to all
+the tablespaces (creating and renaming a tablespace, assigning a space id),
+are done while holding the mutexes of all the shards, see
+fil_mutex_enter_all(). A thread that holds one shard mutex must never wait
+for another one, except through fil_mutex_enter_all(), which acquires the
+mutexes in ascending order and must be called without holding any of them. */
+struct fil_system_t {
+	fil_shard_t	shards[FIL_N_SHARDS + 1];
+					/*!< The data file shards, followed
+					by the redo log shard */
+
+	/** Track the mapping from tablespace ID to file name on disk. */
+	Fil_Open	m_open;
+
+	std::atomic<ulint>
+			n_open;		/*!< number of files currently open */
+	ulint		max_n_open;	/*!< n_open is not allowed to exceed
+					this */
 	space_id_t	max_assigned_id;/*!< maximum space id in the existing
 					tables, or assigned during the time
 					mysqld has been up; at an InnoDB
 					startup we scan the data dictionary
 					and set here the maximum of the
-					space id's of the tables there */
-	UT_LIST_BASE_NODE_T(fil_space_t) space_list;
-					/*!< list of all file spaces */
+					space id's of the tables there;
+					protected by all the shard mutexes */
 	bool		space_id_reuse_warned;
 					/* !< true if fil_space_create()
 					has issued a warning about
@@ -884,6 +920,58 @@ static ulint	srv_data_read;
 static ulint	srv_data_written;
 #endif /* UNIV_HOTBACKUP */
 
+/** Get the shard that a tablespace belongs to.
+@param[in]	space_id	tablespace ID
+@return the shard */
+static inline
+fil_shard_t*
+fil_shard_get(space_id_t space_id)
+{
+	if (space_id == dict_sys_t::s_log_space_first_id) {
+
+		return(&fil_system->shards[FIL_LOG_SHARD]);
+	}
+
+	return(&fil_system->shards[space_id % FIL_N_SHARDS]);
+}
+
+/** Acquire the mutexes of all the shards, in ascending order. The caller
+must not hold any of them. */
+static
+void
+fil_mutex_enter_all()
+{
+	for (auto& shard : fil_system->shards) {
+		mutex_enter(&shard.mutex);
+	}
+}
+
+/** Release the mutexes acquired by fil_mutex_enter_all(). */
+static
+void
+fil_mutex_exit_all()
+{
+	for (auto& shard : fil_system->shards) {
+		mutex_exit(&shard.mutex);
+	}
+}
+
+#ifdef UNIV_DEBUG
+/** @return true if the calling thread owns the mutexes of all the shards */
+static
+bool
+fil_mutex_own_all()
+{
+	for (auto& shard : fil_system->shards) {
+		if (!mutex_own(&shard.mutex)) {
+			return(false);
+		}
+	}
+
+	return(true);
+}
+#endif /* UNIV_DEBUG */
+
 /** Determine if user has explicitly disabled fsync(). */
 #ifndef _WIN32
 # define fil_buffering_disabled(s)	\
@@ -927,7 +1015,7 @@ fil_validate_skip(void)
 
 /********************************************************************//**
 Determines if a file node belongs to the least-recently-used list.
-@return true if the file belongs to fil_system->LRU mutex. */
+@return true if the file belongs to the LRU list of its shard. */
 UNIV_INLINE
 bool
 fil_space_belongs_in_lru(
@@ -952,10 +1040,10 @@ fil_space_belongs_in_lru(
 
 Prepares a file node for i/o. Opens the file if it is closed. Updates the
 pending i/o's field in the node and the system appropriately. Takes the node
-off the LRU list if it is in the LRU list. The caller must hold the fil_sys
-mutex.
+off the LRU list if it is in the LRU list. The caller must hold the mutex of
+the shard of the tablespace.
 @param[in]	node		File node
-@param[in]	system		Tablespace memory cache
+@param[in]	shard		Shard of the tablespace
 @param[in]	space		Tablespace instance
 @param[in]	extend		true if file is being extended
 @return false if the file can't be opened, otherwise true */
@@ -963,7 +1051,7 @@ static
 bool
 fil_node_prepare_for_io(
 	fil_node_t*	node,
-	fil_system_t*	system,
+	fil_shard_t*	shard,
 	fil_space_t*	space,
 	bool		extend);
 
@@ -971,13 +1059,13 @@ fil_node_prepare_for_io(
 Updates the data structures when an i/o operation finishes. Updates the
 pending i/o's field in the node appropriately.
 @param[in,out] node		file node
-@param[in,out] system		tablespace instance
+@param[in,out] shard		shard of the tablespace
 @param[in] type			IO context */
 static
 void
 fil_node_complete_io(
 	fil_node_t*		node,
-	fil_system_t*		system,
+	fil_shard_t*		shard,
 	const IORequest&	type);
 
 /** Reads data from a space to a buffer. Remember that the possible incomplete
@@ -1041,11 +1129,13 @@ static
 fil_space_t*
 fil_space_get_by_id(space_id_t id)
 {
-	ut_ad(mutex_own(&fil_system->mutex));
+	fil_shard_t*	shard = fil_shard_get(id);
 
-	auto	it = fil_system->spaces.find(id);
+	ut_ad(mutex_own(&shard->mutex));
 
-	if (it == fil_system->spaces.end()) {
+	auto	it = shard->spaces.find(id);
+
+	if (it == shard->spaces.end()) {
 		return(nullptr);
 	}
 
@@ -1055,23 +1145,28 @@ fil_space_get_by_id(space_id_t id)
 }
 
 /** Returns the table space by a given name, NULL if not found.
+The caller must hold the mutexes of all the shards.
 @param[in]	name		Tablespace name to search for.
 @return nullptr if not found */
 static
 fil_space_t*
 fil_space_get_by_name(const char* name)
 {
-	ut_ad(mutex_own(&fil_system->mutex));
+	ut_ad(fil_mutex_own_all());
 
-	auto	it = fil_system->names.find(name);
+	for (auto& shard : fil_system->shards) {
 
-	if (it == fil_system->names.end()) {
-		return(nullptr);
-	}
+		auto	it = shard.names.find(name);
 
-	ut_ad(it->second->magic_n == FIL_SPACE_MAGIC_N);
+		if (it != shard.names.end()) {
 
-	return(it->second);
+			ut_ad(it->second->magic_n == FIL_SPACE_MAGIC_N);
+
+			return(it->second);
+		}
+	}
+
+	return(nullptr);
 }
 
 #ifndef UNIV_HOTBACKUP
@@ -1087,9 +1182,11 @@ should be used instead.
 fil_space_t*
 fil_space_get(space_id_t id)
 {
-	mutex_enter(&fil_system->mutex);
+	fil_shard_t*	shard = fil_shard_get(id);
+
+	mutex_enter(&shard->mutex);
 	fil_space_t*	space = fil_space_get_by_id(id);
-	mutex_exit(&fil_system->mutex);
+	mutex_exit(&shard->mutex);
 
 	return(space);
 }
@@ -1107,7 +1204,9 @@ fil_space_get_latch(
 
 	ut_ad(fil_system);
 
-	mutex_enter(&fil_system->mutex);
+	fil_shard_t*	shard = fil_shard_get(id);
+
+	mutex_enter(&shard->mutex);
 
 	space = fil_space_get_by_id(id);
 
@@ -1117,7 +1216,7 @@ fil_space_get_latch(
 		*flags = space->flags;
 	}
 
-	mutex_exit(&fil_system->mutex);
+	mutex_exit(&shard->mutex);
 
 	return(&(space->latch));
 }
@@ -1133,13 +1232,15 @@ fil_space_get_type(space_id_t id)
 
 	ut_ad(fil_system);
 
-	mutex_enter(&fil_system->mutex);
+	fil_shard_t*	shard = fil_shard_get(id);
+
+	mutex_enter(&shard->mutex);
 
 	space = fil_space_get_by_id(id);
 
 	ut_a(space);
 
-	mutex_exit(&fil_system->mutex);
+	mutex_exit(&shard->mutex);
 
 	return(space->purpose);
 }
@@ -1156,20 +1257,22 @@ fil_space_set_imported(space_id_t id)
 {
 	ut_ad(fil_system != NULL);
 
-	mutex_enter(&fil_system->mutex);
+	fil_shard_t*	shard = fil_shard_get(id);
+
+	mutex_enter(&shard->mutex);
 
 	fil_space_t*	space = fil_space_get_by_id(id);
 
 	ut_ad(space->purpose == FIL_TYPE_IMPORT);
 	space->purpose = FIL_TYPE_TABLESPACE;
 
-	mutex_exit(&fil_system->mutex);
+	mutex_exit(&shard->mutex);
 }
 #endif /* !UNIV_HOTBACKUP */
 
 /**********************************************************************//**
 Checks if all the file nodes in a space are flushed. The caller must hold
-the fil_system mutex.
+the mutex of the shard of the tablespace.
 @return true if all are flushed */
 static
 bool
@@ -1177,7 +1280,7 @@ fil_space_is_flushed(
 /*=================*/
 	fil_space_t*	space)	/*!< in: space */
 {
-	ut_ad(mutex_own(&fil_system->mutex));
+	ut_ad(mutex_own(&fil_shard_get(space->id)->mutex));
 
 	for (const fil_node_t* node = UT_LIST_GET_FIRST(space->chain);
 	     node != NULL;
@@ -1271,7 +1374,9 @@ fil_node_create_low(
 	node->init_size = size;
 	node->max_size = max_pages;
 
-	mutex_enter(&fil_system->mutex);
+	fil_shard_t*	shard = fil_shard_get(space->id);
+
+	mutex_enter(&shard->mutex);
 
 	space->size += size;
 
@@ -1315,7 +1420,7 @@ fil_node_create_low(
 	node->atomic_write = atomic_write;
 
 	UT_LIST_ADD_LAST(space->chain, node);
-	mutex_exit(&fil_system->mutex);
+	mutex_exit(&shard->mutex);
 
 	return(node);
 }
@@ -1349,7 +1454,7 @@ fil_node_create(
 }
 
 /** Open a file node of a tablespace.
-The caller must own the fil_system mutex.
+The caller must own the shard mutex.
 @param[in,out]	node		File node
 @param[in]	extend		true if the file is being extended
 @return false if the file can't be opened, otherwise true */
@@ -1366,8 +1471,9 @@ fil_node_open_file(fil_node_t* node, bool extend)
 	ulint		min_size;
 	bool		read_only_mode;
 	fil_space_t*	space = node->space;
+	fil_shard_t*	shard = fil_shard_get(space->id);
 
-	ut_ad(mutex_own(&fil_system->mutex));
+	ut_ad(mutex_own(&shard->mutex));
 	ut_a(node->n_pending == 0);
 	ut_a(!node->is_open);
 
@@ -1381,11 +1487,11 @@ fil_node_open_file(fil_node_t* node, bool extend)
 			break;
 		}
 
-		mutex_exit(&fil_system->mutex);
+		mutex_exit(&shard->mutex);
 
 		os_thread_sleep(100000);
 
-		mutex_enter(&fil_system->mutex);
+		mutex_enter(&shard->mutex);
 	}
 
 	if (node->is_open) {
@@ -1396,12 +1502,22 @@ fil_node_open_file(fil_node_t* node, bool extend)
 	read_only_mode = !fsp_is_system_temporary(space->id)
 		&& srv_read_only_mode;
 
-	if (node->size == 0
-	    || (space->size_in_header == 0
+	/* Page 0 of a file-per-table tablespace can hold the Zstandard
+	dictionary that its compressed pages need; it must be known before
+	the first page is read, which may well be during redo apply. */
+	const bool	check_dict = !space->zstd_dict_checked
 		&& space->purpose == FIL_TYPE_TABLESPACE
 		&& node == UT_LIST_GET_FIRST(space->chain)
-		&& undo::is_active(space->id)
-		&& srv_startup_is_before_trx_rollback_phase)) {
+		&& fsp_is_file_per_table(space->id, space->flags);
+
+	const bool	read_header = node->size == 0
+		|| (space->size_in_header == 0
+		    && space->purpose == FIL_TYPE_TABLESPACE
+		    && node == UT_LIST_GET_FIRST(space->chain)
+		    && undo::is_active(space->id)
+		    && srv_startup_is_before_trx_rollback_phase);
+
+	if (read_header || check_dict) {
 		/* We do not know the size of the file yet. First we
 		open the file in the normal mode, no async I/O here,
 		for simplicity. Then do some checks, and close the
@@ -1423,9 +1539,9 @@ retry:
 			if (err == EMFILE + 100) {
 
 				/* Note: This call will release the
-				file system mutex temporarily. */
+				shard mutex temporarily. */
 
-				if (fil_try_to_close_file_in_LRU(true)) {
+				if (fil_try_to_close_file_in_LRU(shard, true)) {
 					goto retry;
 				}
 			}
@@ -1517,7 +1633,7 @@ retry:
 				<< "!";
 		}
 
-		{
+		if (read_header) {
 			page_no_t	size		= fsp_header_get_field(
 				page, FSP_SIZE);
 			page_no_t	free_limit	= fsp_header_get_field(
@@ -1533,11 +1649,34 @@ retry:
 			space->free_len = free_len;
 		}
 
+		if (check_dict) {
+			ulint		dict_len;
+			const byte*	dict_data = fsp_header_get_zstd_dict(
+				page, page_size, &dict_len);
+
+			if (dict_data != NULL) {
+				ut_ad(space->zstd_dict == NULL);
+
+				space->zstd_dict = Compression::create_dictionary(
+					dict_data, dict_len,
+					srv_compression_zstd_level);
+
+				if (space->zstd_dict == NULL) {
+					ib::error()
+						<< "Cannot load the Zstandard"
+						" dictionary of " << node->name;
+				}
+			}
+
+			space->zstd_dict_checked = true;
+		}
+
 		ut_free(buf2);
 
 		/* For encrypted tablespace, we need to check the
 		encrytion key and iv(initial vector) is readed. */
-		if (FSP_FLAGS_GET_ENCRYPTION(flags)
+		if (read_header
+		    && FSP_FLAGS_GET_ENCRYPTION(flags)
 		    && !recv_recovery_is_on()) {
 			if (space->encryption_type != Encryption::AES) {
 				ib::error()
@@ -1598,17 +1737,17 @@ add_size:
 
 		++node->in_use;
 
-		/* At this point it is safe to release fil_system mutex. No
+		/* At this point it is safe to release the shard mutex. No
 		other thread can rename, delete or close the file because
 		we have set the node->in_use flag. */
 
-		mutex_exit(&fil_system->mutex);
+		mutex_exit(&shard->mutex);
 
 		fil_system->m_open.enter();
 		fil_system->m_open.log(node->space->id, node->name);
 		fil_system->m_open.exit();
 
-		mutex_enter(&fil_system->mutex);
+		mutex_enter(&shard->mutex);
 
 		ut_a(node->in_use > 0);
 		--node->in_use;
@@ -1617,7 +1756,7 @@ add_size:
 	if (fil_space_belongs_in_lru(space)) {
 
 		/* Put the node to the LRU list */
-		UT_LIST_ADD_FIRST(fil_system->LRU, node);
+		UT_LIST_ADD_FIRST(shard->LRU, node);
 	}
 
 	/* Set the open flag after writing the MLOG_FILE_OPEN log record. */
@@ -1636,7 +1775,9 @@ static
 void
 fil_node_close_file(fil_node_t* node, bool lru_close)
 {
-	ut_ad(mutex_own(&(fil_system->mutex)));
+	fil_shard_t*	shard = fil_shard_get(node->space->id);
+
+	ut_ad(mutex_own(&shard->mutex));
 
 	ut_a(node->is_open);
 	ut_a(node->in_use == 0);
@@ -1661,10 +1802,10 @@ fil_node_close_file(fil_node_t* node, bool lru_close)
 
 	if (fil_space_belongs_in_lru(node->space)) {
 
-		ut_a(UT_LIST_GET_LEN(fil_system->LRU) > 0);
+		ut_a(UT_LIST_GET_LEN(shard->LRU) > 0);
 
 		/* The node is in the LRU list, remove it */
-		UT_LIST_REMOVE(fil_system->LRU, node);
+		UT_LIST_REMOVE(shard->LRU, node);
 	}
 
 	/* Temporary tablespace is recreated on startup. It is never
@@ -1683,11 +1824,11 @@ fil_node_close_file(fil_node_t* node, bool lru_close)
 			++node->in_use;
 
 			/* At this point it is safe to release
-			fil_system mutex. No other thread can rename, delete
+			shard mutex. No other thread can rename, delete
 			or close the file because we have set the
 			node->in_use flag. */
 
-			mutex_exit(&fil_system->mutex);
+			mutex_exit(&shard->mutex);
 		}
 
 		fil_system->m_open.enter();
@@ -1695,7 +1836,7 @@ fil_node_close_file(fil_node_t* node, bool lru_close)
 		fil_system->m_open.exit();
 
 		if (lru_close) {
-			mutex_enter(&fil_system->mutex);
+			mutex_enter(&shard->mutex);
 
 			ut_a(node->in_use > 0);
 			--node->in_use;
@@ -1703,29 +1844,29 @@ fil_node_close_file(fil_node_t* node, bool lru_close)
 	}
 }
 
-/** Tries to close a file in the LRU list. The caller must hold the fil_sys
-mutex.
+/** Tries to close a file in the LRU list of a shard. The caller must hold
+the shard mutex.
 @return true if success, false if should retry later; since i/o's
 generally complete in < 100 ms, and as InnoDB writes at most 128 pages
 from the buffer pool in a batch, and then immediately flushes the
 files, there is a good chance that the next time we find a suitable
 node from the LRU list.
-Will release the fil_system->mutex if the file was closed
+Will release the shard mutex temporarily if the file was closed
+@param[in,out]	shard	shard whose LRU list to look at
 @param[in] print_info   if true, prints information why it
 			cannot close a file */
 static
 bool
-fil_try_to_close_file_in_LRU(bool print_info)
-
+fil_try_to_close_file_in_LRU(fil_shard_t* shard, bool print_info)
 {
-	ut_ad(mutex_own(&fil_system->mutex));
+	ut_ad(mutex_own(&shard->mutex));
 
 	if (print_info) {
 		ib::info() << "fil_sys open file LRU len "
-			<< UT_LIST_GET_LEN(fil_system->LRU);
+			<< UT_LIST_GET_LEN(shard->LRU);
 	}
 
-	for (auto node = UT_LIST_GET_LAST(fil_system->LRU);
+	for (auto node = UT_LIST_GET_LAST(shard->LRU);
 	     node != NULL;
 	     node = UT_LIST_GET_PREV(LRU, node)) {
 
@@ -1733,7 +1874,7 @@ fil_try_to_close_file_in_LRU(bool print_info)
 		    && node->n_pending_flushes == 0
 		    && node->in_use == 0) {
 
-			/* Will release the fil_system->mutex. */
+			/* Will release the shard mutex. */
 			fil_node_close_file(node, true);
 
 			return(true);
@@ -1766,10 +1907,45 @@ fil_try_to_close_file_in_LRU(bool print_info)
 	return(false);
 }
 
+/** Try to close files in the LRU lists of all the shards except one, until
+the number of open files is below the limit. The caller must not hold any
+shard mutex.
+@param[in]	skip		shard that was already tried
+@param[in]	print_info	if true, prints information why a file
+				cannot be closed */
+static
+void
+fil_try_to_close_files_in_other_LRUs(
+	const fil_shard_t*	skip,
+	bool			print_info)
+{
+	for (auto& shard : fil_system->shards) {
+
+		if (fil_system->n_open < fil_system->max_n_open) {
+
+			return;
+		}
+
+		if (&shard == skip) {
+			continue;
+		}
+
+		mutex_enter(&shard.mutex);
+
+		while (fil_system->n_open >= fil_system->max_n_open
+		       && fil_try_to_close_file_in_LRU(&shard, print_info)) {
+			;
+		}
+
+		mutex_exit(&shard.mutex);
+	}
+}
+
 /*******************************************************************//**
-Reserves the fil_system mutex and tries to make sure we can open at least one
-file while holding it. This should be called before calling
-fil_node_prepare_for_io(), because that function may need to open a file. */
+Reserves the mutex of the shard of a tablespace and tries to make sure we
+can open at least one file while holding it. This should be called before
+calling fil_node_prepare_for_io(), because that function may need to open a
+file. */
 static
 void
 fil_mutex_enter_and_prepare_for_io(
@@ -1781,9 +1957,10 @@ fil_mutex_enter_and_prepare_for_io(
 	bool		print_info	= false;
 	ulint		count		= 0;
 	ulint		count2		= 0;
+	fil_shard_t*	shard		= fil_shard_get(space_id);
 
 	for (;;) {
-		mutex_enter(&fil_system->mutex);
+		mutex_enter(&shard->mutex);
 
 		if (space_id == 0 || dict_sys_t::is_reserved(space_id)) {
 			/* We keep log files and system tablespace files always
@@ -1807,7 +1984,7 @@ fil_mutex_enter_and_prepare_for_io(
 					" time " << count2;
 			}
 
-			mutex_exit(&fil_system->mutex);
+			mutex_exit(&shard->mutex);
 
 #ifndef UNIV_HOTBACKUP
 
@@ -1856,9 +2033,10 @@ fil_mutex_enter_and_prepare_for_io(
 		/* Too many files are open, try to close some */
 		do {
 			/* Note: This function will release the
-			fil_system->mutex when it closes the file. */
+			shard mutex when it closes the file. */
 
-			success = fil_try_to_close_file_in_LRU(print_info);
+			success = fil_try_to_close_file_in_LRU(
+				shard, print_info);
 
 		} while (success
 			 && fil_system->n_open >= fil_system->max_n_open);
@@ -1868,6 +2046,19 @@ fil_mutex_enter_and_prepare_for_io(
 			return;
 		}
 
+		/* No file of this shard could be closed, look at the
+		files of the other shards. */
+		mutex_exit(&shard->mutex);
+
+		fil_try_to_close_files_in_other_LRUs(shard, print_info);
+
+		mutex_enter(&shard->mutex);
+
+		if (fil_system->n_open < fil_system->max_n_open) {
+			/* Ok */
+			return;
+		}
+
 		if (count >= 2) {
 			ib::warn() << "Too many (" << fil_system->n_open
 				<< ") files stay open while the maximum"
@@ -1879,7 +2070,7 @@ fil_mutex_enter_and_prepare_for_io(
 			return;
 		}
 
-		mutex_exit(&fil_system->mutex);
+		mutex_exit(&shard->mutex);
 
 #ifndef UNIV_HOTBACKUP
 		/* Wake the i/o-handler threads to make sure pending i/o's are
@@ -1906,7 +2097,9 @@ fil_node_close_to_free(
 	fil_node_t*	node,
 	fil_space_t*	space)
 {
-	ut_ad(mutex_own(&fil_system->mutex));
+	fil_shard_t*	shard = fil_shard_get(space->id);
+
+	ut_ad(mutex_own(&shard->mutex));
 	ut_a(node->magic_n == FIL_NODE_MAGIC_N);
 	ut_a(node->n_pending == 0);
 	ut_a(node->in_use == 0);
@@ -1928,11 +2121,11 @@ fil_node_close_to_free(
 
 			space->is_in_unflushed_spaces = false;
 
-			UT_LIST_REMOVE(fil_system->unflushed_spaces, space);
+			UT_LIST_REMOVE(shard->unflushed_spaces, space);
 		}
 
 		/* TODO: set second parameter to true, so to release
-		fil_system mutex before logging tablespace name and id.
+		shard mutex before logging tablespace name and id.
 		To go around Bug#26271853 - POTENTIAL DEADLOCK BETWEEN
 		FIL_SYSTEM MUTEX AND LOG MUTEX */
 		fil_node_close_file(node, true);
@@ -1948,21 +2141,23 @@ void
 fil_space_detach(
 	fil_space_t*	space)
 {
-	ut_ad(mutex_own(&fil_system->mutex));
+	fil_shard_t*	shard = fil_shard_get(space->id);
+
+	ut_ad(mutex_own(&shard->mutex));
 
-	fil_system->spaces.erase(space->id);
+	shard->spaces.erase(space->id);
 
-	fil_system->names.erase(space->name);
+	shard->names.erase(space->name);
 
 	if (space->is_in_unflushed_spaces) {
 
 		ut_ad(!fil_buffering_disabled(space));
 		space->is_in_unflushed_spaces = false;
 
-		UT_LIST_REMOVE(fil_system->unflushed_spaces, space);
+		UT_LIST_REMOVE(shard->unflushed_spaces, space);
 	}
 
-	UT_LIST_REMOVE(fil_system->space_list, space);
+	UT_LIST_REMOVE(shard->space_list, space);
 
 	ut_a(space->magic_n == FIL_SPACE_MAGIC_N);
 	ut_a(space->n_pending_flushes == 0);
@@ -1998,6 +2193,8 @@ fil_space_free_low(fil_space_t* space)
 
 	rw_lock_free(&space->latch);
 
+	Compression::free_dictionary(space->zstd_dict);
+
 	ut_free(space->name);
 	ut_free(space);
 }
@@ -2016,14 +2213,16 @@ fil_space_free(
 {
 	ut_ad(id != TRX_SYS_SPACE);
 
-	mutex_enter(&fil_system->mutex);
+	fil_shard_t*	shard = fil_shard_get(id);
+
+	mutex_enter(&shard->mutex);
 	fil_space_t*	space = fil_space_get_by_id(id);
 
 	if (space != NULL) {
 		fil_space_detach(space);
 	}
 
-	mutex_exit(&fil_system->mutex);
+	mutex_exit(&shard->mutex);
 
 	if (space != NULL) {
 		if (x_latched) {
@@ -2059,13 +2258,15 @@ fil_space_create(
 
 	/* Must set back to active before returning from function. */
 	clone_mark_abort(true);
-	mutex_enter(&fil_system->mutex);
+
+	/* The name must be unique in all the shards. */
+	fil_mutex_enter_all();
 
 	/* Look for a matching tablespace. */
 	fil_space_t*	space = fil_space_get_by_name(name);
 
 	if (space != NULL) {
-		mutex_exit(&fil_system->mutex);
+		fil_mutex_exit_all();
 
 		ib::warn() << "Tablespace '" << name << "' exists in the"
 			" cache with id " << space->id << " != " << id;
@@ -2081,7 +2282,7 @@ fil_space_create(
 			<< "' with id " << id
 			<< " to the tablespace memory cache, but tablespace '"
 			<< name << "' already exists in the cache!";
-		mutex_exit(&fil_system->mutex);
+		fil_mutex_exit_all();
 		clone_mark_active();
 		return(NULL);
 	}
@@ -2123,28 +2324,30 @@ fil_space_create(
 		ut_d(space->latch.set_temp_fsp());
 	}
 
+	fil_shard_t*	shard = fil_shard_get(id);
+
 	{
-		auto	it = fil_system->spaces.insert(
+		auto	it = shard->spaces.insert(
 			Spaces::value_type(id, space));
 
 		ut_a(it.second);
 	}
 
 	{
-		auto	it = fil_system->names.insert(
+		auto	it = shard->names.insert(
 			Names::value_type(space->name, space));
 
 		ut_a(it.second);
 	}
 
-	UT_LIST_ADD_LAST(fil_system->space_list, space);
+	UT_LIST_ADD_LAST(shard->space_list, space);
 
 	if (!dict_sys_t::is_reserved(id) && id > fil_system->max_assigned_id) {
 
 		fil_system->max_assigned_id = id;
 	}
 
-	mutex_exit(&fil_system->mutex);
+	fil_mutex_exit_all();
 
 	clone_mark_active();
 	return(space);
@@ -2163,7 +2366,7 @@ fil_assign_new_space_id(
 	space_id_t	id;
 	bool	success;
 
-	mutex_enter(&fil_system->mutex);
+	fil_mutex_enter_all();
 
 	id = *space_id;
 
@@ -2196,14 +2399,15 @@ fil_assign_new_space_id(
 		*space_id = SPACE_UNKNOWN;
 	}
 
-	mutex_exit(&fil_system->mutex);
+	fil_mutex_exit_all();
 
 	return(success);
 }
 
 /*******************************************************************//**
 Returns a pointer to the fil_space_t that is in the memory cache
-associated with a space id. The caller must lock fil_system->mutex.
+associated with a space id. The caller must hold the mutex of the shard of
+the tablespace.
 @return file_space_t pointer, NULL if space not found */
 UNIV_INLINE
 fil_space_t*
@@ -2229,15 +2433,15 @@ fil_space_get_space(
 	case FIL_TYPE_IMPORT:
 		ut_a(id != 0);
 
-		mutex_exit(&fil_system->mutex);
+		mutex_exit(&fil_shard_get(id)->mutex);
 
 		/* It is possible that the space gets evicted at this point
 		before the fil_mutex_enter_and_prepare_for_io() acquires
-		the fil_system->mutex. Check for this after completing the
+		the shard mutex. Check for this after completing the
 		call to fil_mutex_enter_and_prepare_for_io(). */
 		fil_mutex_enter_and_prepare_for_io(id);
 
-		/* We are still holding the fil_system->mutex. Check if
+		/* We are still holding the shard mutex. Check if
 		the space is still in memory cache. */
 		space = fil_space_get_by_id(id);
 		if (space == NULL) {
@@ -2254,13 +2458,15 @@ fil_space_get_space(
 		the file yet; the following calls will open it and update the
 		size fields */
 
-		if (!fil_node_prepare_for_io(node, fil_system, space, false)) {
+		fil_shard_t*	shard = fil_shard_get(id);
+
+		if (!fil_node_prepare_for_io(node, shard, space, false)) {
 			/* The single-table tablespace can't be opened,
 			because the ibd file is missing. */
 			return(NULL);
 		}
 
-		fil_node_complete_io(node, fil_system, IORequestRead);
+		fil_node_complete_io(node, shard, IORequestRead);
 	}
 
 	return(space);
@@ -2282,23 +2488,25 @@ fil_space_get_first_path(space_id_t id)
 	ut_ad(fil_system);
 	ut_a(id);
 
+	fil_shard_t*	shard = fil_shard_get(id);
+
 	fil_mutex_enter_and_prepare_for_io(id);
 
 	space = fil_space_get_space(id);
 
 	if (space == NULL) {
-		mutex_exit(&fil_system->mutex);
+		mutex_exit(&shard->mutex);
 
 		return(NULL);
 	}
 
-	ut_ad(mutex_own(&fil_system->mutex));
+	ut_ad(mutex_own(&shard->mutex));
 
 	node = UT_LIST_GET_FIRST(space->chain);
 
 	path = mem_strdup(node->name);
 
-	mutex_exit(&fil_system->mutex);
+	mutex_exit(&shard->mutex);
 
 	return(path);
 }
@@ -2316,13 +2524,15 @@ fil_space_get_size(
 	page_no_t	size;
 
 	ut_ad(fil_system);
-	mutex_enter(&fil_system->mutex);
+	fil_shard_t*	shard = fil_shard_get(id);
+
+	mutex_enter(&shard->mutex);
 
 	space = fil_space_get_space(id);
 
 	size = space ? space->size : 0;
 
-	mutex_exit(&fil_system->mutex);
+	mutex_exit(&shard->mutex);
 
 	return(size);
 }
@@ -2334,20 +2544,22 @@ in the memory cache.
 ulint
 fil_space_get_flags(space_id_t space_id)
 {
-	mutex_enter(&fil_system->mutex);
+	fil_shard_t*	shard = fil_shard_get(space_id);
+
+	mutex_enter(&shard->mutex);
 
 	fil_space_t*	space = fil_space_get_space(space_id);
 
 	if (space == nullptr) {
 
-		mutex_exit(&fil_system->mutex);
+		mutex_exit(&shard->mutex);
 
 		return(ULINT_UNDEFINED);
 	}
 
 	ulint	flags = space->flags;
 
-	mutex_exit(&fil_system->mutex);
+	mutex_exit(&shard->mutex);
 
 	return(flags);
 }
@@ -2359,7 +2571,9 @@ fil_space_get_flags(space_id_t space_id)
 bool
 fil_space_open(space_id_t space_id)
 {
-	mutex_enter(&fil_system->mutex);
+	fil_shard_t*	shard = fil_shard_get(space_id);
+
+	mutex_enter(&shard->mutex);
 
 	fil_space_t*	space = fil_space_get_by_id(space_id);
 
@@ -2369,13 +2583,13 @@ fil_space_open(space_id_t space_id)
 
 		if (!node->is_open && !fil_node_open_file(node, false)) {
 
-			mutex_exit(&fil_system->mutex);
+			mutex_exit(&shard->mutex);
 
 			return(false);
 		}
 	}
 
-	mutex_exit(&fil_system->mutex);
+	mutex_exit(&shard->mutex);
 
 	return(true);
 }
@@ -2389,12 +2603,14 @@ fil_space_close(space_id_t space_id)
 		return;
 	}
 
-	mutex_enter(&fil_system->mutex);
+	fil_shard_t*	shard = fil_shard_get(space_id);
+
+	mutex_enter(&shard->mutex);
 
 	fil_space_t*	space = fil_space_get_by_id(space_id);
 
 	if (space == NULL) {
-		mutex_exit(&fil_system->mutex);
+		mutex_exit(&shard->mutex);
 		return;
 	}
 
@@ -2407,7 +2623,7 @@ fil_space_close(space_id_t space_id)
 		}
 	}
 
-	mutex_exit(&fil_system->mutex);
+	mutex_exit(&shard->mutex);
 }
 
 /** Returns the page size of the space and whether it is compressed or not.
@@ -2448,10 +2664,18 @@ fil_init(
 	fil_system = static_cast<fil_system_t*>(
 		ut_zalloc_nokey(sizeof(*fil_system)));
 
-	mutex_create(LATCH_ID_FIL_SYSTEM, &fil_system->mutex);
+	for (auto& shard : fil_system->shards) {
 
-	new(&fil_system->names) Names();
-	new(&fil_system->spaces) Spaces();
+		mutex_create(LATCH_ID_FIL_SHARD, &shard.mutex);
+
+		new(&shard.names) Names();
+		new(&shard.spaces) Spaces();
+
+		UT_LIST_INIT(shard.LRU, &fil_node_t::LRU);
+		UT_LIST_INIT(shard.space_list, &fil_space_t::space_list);
+		UT_LIST_INIT(shard.unflushed_spaces,
+			     &fil_space_t::unflushed_spaces);
+	}
 
 	if (fil_scanned != nullptr) {
 
@@ -2464,84 +2688,92 @@ fil_init(
 		new(&fil_system->m_open) Fil_Open();
 	}
 
-	UT_LIST_INIT(fil_system->LRU, &fil_node_t::LRU);
-	UT_LIST_INIT(fil_system->space_list, &fil_space_t::space_list);
-	UT_LIST_INIT(fil_system->unflushed_spaces,
-		     &fil_space_t::unflushed_spaces);
-
 	fil_system->max_n_open = max_n_open;
 }
 
-/*******************************************************************//**
-Opens all log files and system tablespace data files. They stay open until the
-database server shutdown. This should be called at a server startup after the
-space objects for the log and the system tablespace have been created. The
-purpose of this operation is to make sure we never run out of file descriptors
-if we need to read from the insert buffer or to write to the log. */
+/** Open the files of a tablespace if it is a log or system tablespace.
+The caller must hold the mutex of the shard of the tablespace.
+@param[in,out]	space	tablespace */
+static
 void
-fil_open_log_and_system_tablespace_files(void)
-/*==========================================*/
+fil_open_log_and_system_tablespace(fil_space_t* space)
 {
-	fil_space_t*	space;
+	fil_node_t*	node;
 
-	mutex_enter(&fil_system->mutex);
+	ut_ad(mutex_own(&fil_shard_get(space->id)->mutex));
 
-	for (space = UT_LIST_GET_FIRST(fil_system->space_list);
-	     space != NULL;
-	     space = UT_LIST_GET_NEXT(space_list, space)) {
+	if (fil_space_belongs_in_lru(space)) {
 
-		fil_node_t*	node;
+		return;
+	}
 
-		if (fil_space_belongs_in_lru(space)) {
+	if (space->id == TRX_SYS_SPACE) {
 
-			continue;
-		}
+		ut_a(fil_space_t::s_sys_space == nullptr
+		     || fil_space_t::s_sys_space == space);
+
+		fil_space_t::s_sys_space = space;
+	}
 
-		if (space->id == TRX_SYS_SPACE) {
+	for (node = UT_LIST_GET_FIRST(space->chain);
+	     node != NULL;
+	     node = UT_LIST_GET_NEXT(chain, node)) {
 
-			ut_a(fil_space_t::s_sys_space == nullptr
-			     || fil_space_t::s_sys_space == space);
+		if (!node->is_open) {
 
-			fil_space_t::s_sys_space = space;
+			if (!fil_node_open_file(node, false)) {
+				/* This func is called during server's
+				startup. If some file of log or system
+				tablespace is missing, the server
+				can't start successfully. So we should
+				assert for it. */
+				ut_a(0);
+			}
 		}
 
-		for (node = UT_LIST_GET_FIRST(space->chain);
-		     node != NULL;
-		     node = UT_LIST_GET_NEXT(chain, node)) {
+		if (fil_system->max_n_open < 10 + fil_system->n_open) {
 
-			if (!node->is_open) {
+			ib::warn() << "You must raise the value of"
+				" innodb_open_files in my.cnf!"
+				" Remember that InnoDB keeps all"
+				" log files and all system"
+				" tablespace files open"
+				" for the whole time mysqld is"
+				" running, and needs to open also"
+				" some .ibd files if the"
+				" file-per-table storage model is used."
+				" Current open files "
+				<< fil_system->n_open
+				<< ", max allowed open files "
+				<< fil_system->max_n_open
+				<< ".";
+		}
+	}
+}
 
-				if (!fil_node_open_file(node, false)) {
-					/* This func is called during server's
-					startup. If some file of log or system
-					tablespace is missing, the server
-					can't start successfully. So we should
-					assert for it. */
-					ut_a(0);
-				}
-			}
+/*******************************************************************//**
+Opens all log files and system tablespace data files. They stay open until the
+database server shutdown. This should be called at a server startup after the
+space objects for the log and the system tablespace have been created. The
+purpose of this operation is to make sure we never run out of file descriptors
+if we need to read from the insert buffer or to write to the log. */
+void
+fil_open_log_and_system_tablespace_files(void)
+/*==========================================*/
+{
+	for (auto& shard : fil_system->shards) {
 
-			if (fil_system->max_n_open < 10 + fil_system->n_open) {
-
-				ib::warn() << "You must raise the value of"
-					" innodb_open_files in my.cnf!"
-					" Remember that InnoDB keeps all"
-					" log files and all system"
-					" tablespace files open"
-					" for the whole time mysqld is"
-					" running, and needs to open also"
-					" some .ibd files if the"
-					" file-per-table storage model is used."
-					" Current open files "
-					<< fil_system->n_open
-					<< ", max allowed open files "
-					<< fil_system->max_n_open
-					<< ".";
-			}
+		mutex_enter(&shard.mutex);
+
+		for (auto space = UT_LIST_GET_FIRST(shard.space_list);
+		     space != NULL;
+		     space = UT_LIST_GET_NEXT(space_list, space)) {
+
+			fil_open_log_and_system_tablespace(space);
 		}
-	}
 
-	mutex_exit(&fil_system->mutex);
+		mutex_exit(&shard.mutex);
+	}
 }
 
 /*******************************************************************//**
@@ -2551,30 +2783,33 @@ void
 fil_close_all_files(void)
 /*=====================*/
 {
-	fil_space_t*	space;
+	for (auto& shard : fil_system->shards) {
 
-	mutex_enter(&fil_system->mutex);
+		fil_space_t*	space;
 
-	for (space = UT_LIST_GET_FIRST(fil_system->space_list);
-	     space != NULL; ) {
-		fil_node_t*	node;
-		fil_space_t*	prev_space = space;
+		mutex_enter(&shard.mutex);
 
-		for (node = UT_LIST_GET_FIRST(space->chain);
-		     node != NULL;
-		     node = UT_LIST_GET_NEXT(chain, node)) {
+		for (space = UT_LIST_GET_FIRST(shard.space_list);
+		     space != NULL; ) {
+			fil_node_t*	node;
+			fil_space_t*	prev_space = space;
 
-			if (node->is_open) {
-				fil_node_close_file(node, false);
+			for (node = UT_LIST_GET_FIRST(space->chain);
+			     node != NULL;
+			     node = UT_LIST_GET_NEXT(chain, node)) {
+
+				if (node->is_open) {
+					fil_node_close_file(node, false);
+				}
 			}
+
+			space = UT_LIST_GET_NEXT(space_list, space);
+			fil_space_detach(prev_space);
+			fil_space_free_low(prev_space);
 		}
 
-		space = UT_LIST_GET_NEXT(space_list, space);
-		fil_space_detach(prev_space);
-		fil_space_free_low(prev_space);
+		mutex_exit(&shard.mutex);
 	}
-
-	mutex_exit(&fil_system->mutex);
 }
 
 /*******************************************************************//**
@@ -2586,10 +2821,12 @@ fil_close_log_files(
 	bool	free)	/*!< in: whether to free the memory object */
 {
 	fil_space_t*	space;
+	fil_shard_t*	shard = &fil_system->shards[FIL_LOG_SHARD];
 
-	mutex_enter(&fil_system->mutex);
+	/* The redo log files are kept in a shard of their own. */
+	mutex_enter(&shard->mutex);
 
-	space = UT_LIST_GET_FIRST(fil_system->space_list);
+	space = UT_LIST_GET_FIRST(shard->space_list);
 
 	while (space != NULL) {
 		fil_node_t*	node;
@@ -2619,17 +2856,21 @@ fil_close_log_files(
 		}
 	}
 
-	mutex_exit(&fil_system->mutex);
+	mutex_exit(&shard->mutex);
 }
 
-/** Iterate through all persistent tablespace files (FIL_TYPE_TABLESPACE)
-returning the nodes via callback function cbk.
+/** Iterate through the persistent tablespace files (FIL_TYPE_TABLESPACE) of
+a shard, returning the nodes via callback function cbk. The callback is
+invoked while holding the shard mutex.
+@param[in,out]	shard		shard
 @param[in]	include_log	include log files
 @param[in]	context		callback function context
 @param[in]	callback	callback function
 @return any error returned by the callback function. */
+static
 dberr_t
-fil_iterate_tablespace_files(
+fil_iterate_shard_files(
+	fil_shard_t*	shard,
 	bool		include_log,
 	void*		context,
 	fil_node_cbk_t*	callback)
@@ -2637,9 +2878,9 @@ fil_iterate_tablespace_files(
 	fil_space_t*	space;
 	dberr_t		err = DB_SUCCESS;
 
-	mutex_enter(&fil_system->mutex);
+	mutex_enter(&shard->mutex);
 
-	space = UT_LIST_GET_FIRST(fil_system->space_list);
+	space = UT_LIST_GET_FIRST(shard->space_list);
 
 	while (space != nullptr) {
 		fil_node_t*	node;
@@ -2673,7 +2914,35 @@ fil_iterate_tablespace_files(
 		space = UT_LIST_GET_NEXT(space_list, space);
 	}
 
-	mutex_exit(&fil_system->mutex);
+	mutex_exit(&shard->mutex);
+	return(err);
+}
+
+/** Iterate through all persistent tablespace files (FIL_TYPE_TABLESPACE)
+returning the nodes via callback function cbk.
+@param[in]	include_log	include log files
+@param[in]	context		callback function context
+@param[in]	callback	callback function
+@return any error returned by the callback function. */
+dberr_t
+fil_iterate_tablespace_files(
+	bool		include_log,
+	void*		context,
+	fil_node_cbk_t*	callback)
+{
+	dberr_t		err = DB_SUCCESS;
+
+	for (auto& shard : fil_system->shards) {
+
+		err = fil_iterate_shard_files(
+			&shard, include_log, context, callback);
+
+		if (err != DB_SUCCESS) {
+
+			break;
+		}
+	}
+
 	return(err);
 }
 
@@ -2689,14 +2958,14 @@ fil_set_max_space_id_if_bigger(
 		ib::fatal() << "Max tablespace id is too high, " << max_id;
 	}
 
-	mutex_enter(&fil_system->mutex);
+	fil_mutex_enter_all();
 
 	if (fil_system->max_assigned_id < max_id) {
 
 		fil_system->max_assigned_id = max_id;
 	}
 
-	mutex_exit(&fil_system->mutex);
+	fil_mutex_exit_all();
 }
 
 /** Write the flushed LSN to the page header of the first page in the
@@ -2748,7 +3017,9 @@ fil_space_acquire_low(
 {
 	fil_space_t*	space;
 
-	mutex_enter(&fil_system->mutex);
+	fil_shard_t*	shard = fil_shard_get(id);
+
+	mutex_enter(&shard->mutex);
 
 	space = fil_space_get_by_id(id);
 
@@ -2763,7 +3034,7 @@ fil_space_acquire_low(
 		space->n_pending_ops++;
 	}
 
-	mutex_exit(&fil_system->mutex);
+	mutex_exit(&shard->mutex);
 
 	return(space);
 }
@@ -2796,11 +3067,13 @@ void
 fil_space_release(
 	fil_space_t*	space)
 {
-	mutex_enter(&fil_system->mutex);
+	fil_shard_t*	shard = fil_shard_get(space->id);
+
+	mutex_enter(&shard->mutex);
 	ut_ad(space->magic_n == FIL_SPACE_MAGIC_N);
 	ut_ad(space->n_pending_ops > 0);
 	space->n_pending_ops--;
-	mutex_exit(&fil_system->mutex);
+	mutex_exit(&shard->mutex);
 }
 
 /** Write a log record about an operation on a tablespace file.
@@ -3138,7 +3411,7 @@ fil_check_pending_ops(
 	fil_space_t*	space,
 	ulint		count)
 {
-	ut_ad(mutex_own(&fil_system->mutex));
+	ut_ad(space == NULL || mutex_own(&fil_shard_get(space->id)->mutex));
 
 	const ulint	n_pending_ops = space ? space->n_pending_ops : 0;
 
@@ -3170,7 +3443,7 @@ fil_check_pending_io(
 	fil_node_t**	node,		/*!< out: Node in space list */
 	ulint		count)		/*!< in: number of attempts so far */
 {
-	ut_ad(mutex_own(&fil_system->mutex));
+	ut_ad(mutex_own(&fil_shard_get(space->id)->mutex));
 	ut_a(space->n_pending_ops == 0);
 
 	switch (operation) {
@@ -3224,23 +3497,25 @@ fil_check_pending_operations(
 
 	*space = 0;
 
-	mutex_enter(&fil_system->mutex);
+	fil_shard_t*	shard = fil_shard_get(id);
+
+	mutex_enter(&shard->mutex);
 	fil_space_t* sp = fil_space_get_by_id(id);
 	if (sp) {
 		sp->stop_new_ops = true;
 	}
-	mutex_exit(&fil_system->mutex);
+	mutex_exit(&shard->mutex);
 
 	/* Check for pending operations. */
 
 	do {
-		mutex_enter(&fil_system->mutex);
+		mutex_enter(&shard->mutex);
 
 		sp = fil_space_get_by_id(id);
 
 		count = fil_check_pending_ops(sp, count);
 
-		mutex_exit(&fil_system->mutex);
+		mutex_exit(&shard->mutex);
 
 		if (count > 0) {
 			os_thread_sleep(20000);
@@ -3253,12 +3528,12 @@ fil_check_pending_operations(
 	*path = 0;
 
 	do {
-		mutex_enter(&fil_system->mutex);
+		mutex_enter(&shard->mutex);
 
 		sp = fil_space_get_by_id(id);
 
 		if (sp == NULL) {
-			mutex_exit(&fil_system->mutex);
+			mutex_exit(&shard->mutex);
 			return(DB_TABLESPACE_NOT_FOUND);
 		}
 
@@ -3270,7 +3545,7 @@ fil_check_pending_operations(
 			*path = mem_strdup(node->name);
 		}
 
-		mutex_exit(&fil_system->mutex);
+		mutex_exit(&shard->mutex);
 
 		if (count > 0) {
 			os_thread_sleep(20000);
@@ -3515,10 +3790,12 @@ fil_delete_tablespace(
 
 	/* Must set back to active before returning from function. */
 	clone_mark_abort(true);
-	mutex_enter(&fil_system->mutex);
+	fil_shard_t*	shard = fil_shard_get(id);
+
+	mutex_enter(&shard->mutex);
 
 	/* Double check the sanity of pending ops after reacquiring
-	the fil_system::mutex. */
+	the shard mutex. */
 	if (const fil_space_t* s = fil_space_get_by_id(id)) {
 		ut_a(s == space);
 		ut_a(space->n_pending_ops == 0);
@@ -3530,7 +3807,7 @@ fil_delete_tablespace(
 
 		fil_space_detach(space);
 
-		mutex_exit(&fil_system->mutex);
+		mutex_exit(&shard->mutex);
 
 		fil_space_free_low(space);
 
@@ -3544,7 +3821,7 @@ fil_delete_tablespace(
 			err = DB_IO_ERROR;
 		}
 	} else {
-		mutex_exit(&fil_system->mutex);
+		mutex_exit(&shard->mutex);
 		err = DB_TABLESPACE_NOT_FOUND;
 	}
 
@@ -3606,7 +3883,9 @@ fil_truncate_tablespace(
 
 	/* Step-3: Truncate the tablespace and accordingly update
 	the fil_space_t handler that is used to access this tablespace. */
-	mutex_enter(&fil_system->mutex);
+	fil_shard_t*	shard = fil_shard_get(space_id);
+
+	mutex_enter(&shard->mutex);
 	fil_space_t*	space = fil_space_get_by_id(space_id);
 
 	/* The following code must change when InnoDB supports
@@ -3633,7 +3912,7 @@ fil_truncate_tablespace(
 		}
 	}
 
-	mutex_exit(&fil_system->mutex);
+	mutex_exit(&shard->mutex);
 
 	return(success);
 }
@@ -3646,7 +3925,9 @@ fil_space_inc_redo_skipped_count(space_id_t id)
 {
 	fil_space_t*	space;
 
-	mutex_enter(&fil_system->mutex);
+	fil_shard_t*	shard = fil_shard_get(id);
+
+	mutex_enter(&shard->mutex);
 
 	space = fil_space_get_by_id(id);
 
@@ -3654,7 +3935,7 @@ fil_space_inc_redo_skipped_count(space_id_t id)
 
 	space->redo_skipped_count++;
 
-	mutex_exit(&fil_system->mutex);
+	mutex_exit(&shard->mutex);
 }
 
 /** Decrease redo skipped count for a tablespace.
@@ -3664,7 +3945,9 @@ fil_space_dec_redo_skipped_count(space_id_t id)
 {
 	fil_space_t*	space;
 
-	mutex_enter(&fil_system->mutex);
+	fil_shard_t*	shard = fil_shard_get(id);
+
+	mutex_enter(&shard->mutex);
 
 	space = fil_space_get_by_id(id);
 
@@ -3673,7 +3956,7 @@ fil_space_dec_redo_skipped_count(space_id_t id)
 
 	space->redo_skipped_count--;
 
-	mutex_exit(&fil_system->mutex);
+	mutex_exit(&shard->mutex);
 }
 
 /**
@@ -3686,7 +3969,9 @@ fil_space_is_redo_skipped(space_id_t id)
 	fil_space_t*	space;
 	bool		is_redo_skipped;
 
-	mutex_enter(&fil_system->mutex);
+	fil_shard_t*	shard = fil_shard_get(id);
+
+	mutex_enter(&shard->mutex);
 
 	space = fil_space_get_by_id(id);
 
@@ -3694,7 +3979,7 @@ fil_space_is_redo_skipped(space_id_t id)
 
 	is_redo_skipped = space->redo_skipped_count > 0;
 
-	mutex_exit(&fil_system->mutex);
+	mutex_exit(&shard->mutex);
 
 	return(is_redo_skipped);
 }
@@ -3928,7 +4213,7 @@ retry:
 			" the file is being extended.";
 	}
 
-	mutex_enter(&fil_system->mutex);
+	fil_mutex_enter_all();
 
 	space = fil_space_get_by_id(id);
 
@@ -3942,14 +4227,14 @@ retry:
 			<< old_path
 			<< "' in a rename operation should have that id.";
 
-		mutex_exit(&fil_system->mutex);
+		fil_mutex_exit_all();
 		return(false);
 
 	} else if (count > 25000) {
 
 		space->stop_ios = false;
 
-		mutex_exit(&fil_system->mutex);
+		fil_mutex_exit_all();
 
 		return(false);
 
@@ -3961,7 +4246,7 @@ retry:
 
 		space->stop_ios = false;
 
-		mutex_exit(&fil_system->mutex);
+		fil_mutex_exit_all();
 
 		return(false);
 
@@ -3973,7 +4258,7 @@ retry:
 
 			if (new_space == space) {
 
-				mutex_exit(&fil_system->mutex);
+				fil_mutex_exit_all();
 
 				return(true);
 
@@ -3986,7 +4271,7 @@ retry:
 
 				space->stop_ios = false;
 
-				mutex_exit(&fil_system->mutex);
+				fil_mutex_exit_all();
 
 				return(false);
 			}
@@ -4016,7 +4301,7 @@ retry:
 		ut_ad(strchr(old_file_name, OS_PATH_SEPARATOR) != NULL);
 		ut_ad(strchr(new_file_name, OS_PATH_SEPARATOR) != NULL);
 
-		mutex_exit(&fil_system->mutex);
+		fil_mutex_exit_all();
 
 		/* Rename ddl log is for rollback, so we exchange old file
 		name with new file name. */
@@ -4055,7 +4340,7 @@ retry:
 		fil_node_close_file(node, false);
 	}
 
-	mutex_exit(&fil_system->mutex);
+	fil_mutex_exit_all();
 
 	if (sleep) {
 		os_thread_sleep(20000);
@@ -4092,9 +4377,9 @@ retry:
 	}
 #endif /* !UNIV_HOTBACKUP */
 
-	/* log_sys->mutex is above fil_system->mutex in the latching order */
+	/* log_sys->mutex is above the shard mutexes in the latching order */
 	ut_ad(log_mutex_own());
-	mutex_enter(&fil_system->mutex);
+	fil_mutex_enter_all();
 
 	ut_ad(space->name == old_space_name);
 	/* We already checked these. */
@@ -4134,11 +4419,13 @@ retry:
 	ut_ad(space->name == old_space_name);
 
 	if (success) {
-		fil_system->names.erase(space->name);
+		fil_shard_t*	shard = fil_shard_get(id);
+
+		shard->names.erase(space->name);
 
 		space->name = new_space_name;
 
-		auto	it = fil_system->names.insert(
+		auto	it = shard->names.insert(
 			Names::value_type(space->name, space));
 
 		ut_a(it.second);
@@ -4151,7 +4438,7 @@ retry:
 
 	ut_ad(space->stop_ios);
 	space->stop_ios = false;
-	mutex_exit(&fil_system->mutex);
+	fil_mutex_exit_all();
 
 	ut_free(old_file_name);
 	ut_free(old_space_name);
@@ -4169,11 +4456,11 @@ fil_rename_tablespace_by_name(
 	const char*     old_name,
 	const char*	new_name)
 {
-	mutex_enter(&fil_system->mutex);
+	fil_mutex_enter_all();
 	fil_space_t*	space = fil_space_get_by_name(old_name);
 
 	if (!space) {
-		mutex_exit(&fil_system->mutex);
+		fil_mutex_exit_all();
 		ib::error()
 			<< "Cannot find space for " << old_name
 			<< " in tablespace memory cache";
@@ -4184,7 +4471,7 @@ fil_rename_tablespace_by_name(
 	auto    new_space = fil_space_get_by_name(new_name);
 
 	if (new_space != nullptr) {
-		mutex_exit(&fil_system->mutex);
+		fil_mutex_exit_all();
 		if (new_space->id != space->id) {
 			ib::error()
 				<< new_name
@@ -4199,11 +4486,13 @@ fil_rename_tablespace_by_name(
 	char*	new_space_name = mem_strdup(new_name);
 	char*	old_space_name = space->name;
 
-	fil_system->names.erase(space->name);
+	fil_shard_t*	shard = fil_shard_get(space->id);
+
+	shard->names.erase(space->name);
 	space->name = new_space_name;
-	auto	it = fil_system->names.insert(
+	auto	it = shard->names.insert(
 		Names::value_type(space->name, space));
-	mutex_exit(&fil_system->mutex);
+	fil_mutex_exit_all();
 	ut_a(it.second);
 	ut_free(old_space_name);
 
@@ -4658,7 +4947,9 @@ fil_space_read_name_and_filepath(
 	*name = NULL;
 	*filepath = NULL;
 
-	mutex_enter(&fil_system->mutex);
+	fil_shard_t*	shard = fil_shard_get(space_id);
+
+	mutex_enter(&shard->mutex);
 
 	fil_space_t*	space = fil_space_get_by_id(space_id);
 
@@ -4671,7 +4962,7 @@ fil_space_read_name_and_filepath(
 		success = true;
 	}
 
-	mutex_exit(&fil_system->mutex);
+	mutex_exit(&shard->mutex);
 
 	return(success);
 }
@@ -4751,9 +5042,11 @@ fil_ibd_open_for_recovery(
 {
 	/* If the a space is already in the file system cache with this
 	space ID, then there is nothing to do. */
-	mutex_enter(&fil_system->mutex);
+	fil_shard_t*	shard = fil_shard_get(space_id);
+
+	mutex_enter(&shard->mutex);
 	space = fil_space_get_by_id(space_id);
-	mutex_exit(&fil_system->mutex);
+	mutex_exit(&shard->mutex);
 
 	if (space != NULL) {
 
@@ -4901,9 +5194,9 @@ fil_ibd_open_for_recovery(
 	file than delete it, because if there is a bug, we do not want to
 	destroy valuable data. */
 
-	mutex_enter(&fil_system->mutex);
+	mutex_enter(&shard->mutex);
 	space = fil_space_get_by_id(space_id);
-	mutex_exit(&fil_system->mutex);
+	mutex_exit(&shard->mutex);
 
 	if (space != NULL) {
 		ib::info() << "Renaming data file '" << file.filepath()
@@ -5008,7 +5301,7 @@ fil_space_for_table_exists_in_mem(
 
 	ut_ad(fil_system);
 
-	mutex_enter(&fil_system->mutex);
+	fil_mutex_enter_all();
 
 	/* Look if there is a space with the same id */
 
@@ -5016,7 +5309,7 @@ fil_space_for_table_exists_in_mem(
 
 	/* name is NULL when replay DELETE ddl log. */
 	if (name == NULL) {
-		mutex_exit(&fil_system->mutex);
+		fil_mutex_exit_all();
 
 		if (space != NULL) {
 			return(true);
@@ -5038,17 +5331,19 @@ fil_space_for_table_exists_in_mem(
 		tablespace name does not exist.  Replace the temporary
 		name with this name and return this space. */
 
-		fil_system->names.erase(space->name);
+		fil_shard_t*	shard = fil_shard_get(space->id);
+
+		shard->names.erase(space->name);
 		ut_free(space->name);
 
 		space->name = mem_strdup(name);
 
-		auto	it = fil_system->names.insert(
+		auto	it = shard->names.insert(
 			Names::value_type(space->name, space));
 
 		ut_a(it.second);
 
-		mutex_exit(&fil_system->mutex);
+		fil_mutex_exit_all();
 
 		return(true);
 	}
@@ -5058,7 +5353,7 @@ fil_space_for_table_exists_in_mem(
 		    && !srv_sys_tablespaces_open) {
 
 			/* No need to check the name */
-			mutex_exit(&fil_system->mutex);
+			fil_mutex_exit_all();
 			return(true);
 		}
 
@@ -5067,7 +5362,7 @@ fil_space_for_table_exists_in_mem(
 		if (space == fnamespace) {
 			/* Found */
 
-			mutex_exit(&fil_system->mutex);
+			fil_mutex_exit_all();
 
 			return(true);
 		}
@@ -5084,14 +5379,14 @@ fil_space_for_table_exists_in_mem(
 	    && !row_is_mysql_tmp_table_name(name)) {
 
 		/* Atomic DDL's "ddl_log" will adjust the tablespace name */
-		mutex_exit(&fil_system->mutex);
+		fil_mutex_exit_all();
 
 		return(true);
 	}
 
 	if (!print_err_if_not_exist) {
 
-		mutex_exit(&fil_system->mutex);
+		fil_mutex_exit_all();
 
 		return(false);
 	}
@@ -5113,7 +5408,7 @@ fil_space_for_table_exists_in_mem(
 error_exit:
 		ib::warn() << TROUBLESHOOT_DATADICT_MSG;
 
-		mutex_exit(&fil_system->mutex);
+		fil_mutex_exit_all();
 
 		return(false);
 	}
@@ -5134,7 +5429,7 @@ error_exit:
 		goto error_exit;
 	}
 
-	mutex_exit(&fil_system->mutex);
+	fil_mutex_exit_all();
 
 	return(false);
 }
@@ -5148,13 +5443,13 @@ space_id_t
 fil_space_get_id_by_name(
 	const char*	tablespace)
 {
-	mutex_enter(&fil_system->mutex);
+	fil_mutex_enter_all();
 
 	/* Search for a space with the same name. */
 	fil_space_t*	space = fil_space_get_by_name(tablespace);
 	space_id_t	id = (space == NULL) ? SPACE_UNKNOWN : space->id;
 
-	mutex_exit(&fil_system->mutex);
+	fil_mutex_exit_all();
 
 	return(id);
 }
@@ -5235,6 +5530,8 @@ fil_space_extend(
 
 	DBUG_EXECUTE_IF("fil_space_print_xdes_pages",
 			space->print_xdes_pages("xdes_pages.log"););
+
+	fil_shard_t*	shard = fil_shard_get(space->id);
 retry:
 	bool		success = true;
 
@@ -5242,7 +5539,7 @@ retry:
 
 	if (space->size >= size) {
 		/* Space already big enough */
-		mutex_exit(&fil_system->mutex);
+		mutex_exit(&shard->mutex);
 		return(true);
 	}
 
@@ -5261,24 +5558,24 @@ retry:
 		driven mechanism but the entire module is peppered with
 		polling code. */
 
-		mutex_exit(&fil_system->mutex);
+		mutex_exit(&shard->mutex);
 		os_thread_sleep(100000);
 		goto retry;
 	}
 
-	if (!fil_node_prepare_for_io(node, fil_system, space, true)) {
+	if (!fil_node_prepare_for_io(node, shard, space, true)) {
 		/* The tablespace data file, such as .ibd file, is missing */
 		ut_a(node->in_use > 0);
 		--node->in_use;
-		mutex_exit(&fil_system->mutex);
+		mutex_exit(&shard->mutex);
 
 		return(false);
 	}
 
-	/* At this point it is safe to release fil_system mutex. No
+	/* At this point it is safe to release the shard mutex. No
 	other thread can rename, delete or close the file because
 	we have set the node->in_use flag. */
-	mutex_exit(&fil_system->mutex);
+	mutex_exit(&shard->mutex);
 
 	page_no_t	pages_added;
 
@@ -5379,7 +5676,7 @@ retry:
 		os_has_said_disk_full = FALSE;
 	}
 
-	mutex_enter(&fil_system->mutex);
+	mutex_enter(&shard->mutex);
 
 	node->size += pages_added;
 	space->size += pages_added;
@@ -5387,7 +5684,7 @@ retry:
 	ut_a(node->in_use > 0);
 	--node->in_use;
 
-	fil_node_complete_io(node, fil_system, IORequestWrite);
+	fil_node_complete_io(node, shard, IORequestWrite);
 
 #ifndef UNIV_HOTBACKUP
 	/* Keep the last data file size info up to date, rounded to
@@ -5404,7 +5701,7 @@ retry:
 	}
 #endif /* !UNIV_HOTBACKUP */
 
-	mutex_exit(&fil_system->mutex);
+	mutex_exit(&shard->mutex);
 
 	fil_flush(space->id);
 
@@ -5429,42 +5726,38 @@ fil_extend_tablespaces_to_stored_len(void)
 
 	buf = ut_malloc_nokey(UNIV_PAGE_SIZE);
 
-	mutex_enter(&fil_system->mutex);
+	/* No need to protect the iteration with the shard mutexes, because
+	this is a single-threaded operation */
+	for (auto& shard : fil_system->shards) {
 
-	for (fil_space_t* space = UT_LIST_GET_FIRST(fil_system->space_list);
-	     space != NULL;
-	     space = UT_LIST_GET_NEXT(space_list, space)) {
+		for (fil_space_t* space = UT_LIST_GET_FIRST(shard.space_list);
+		     space != NULL;
+		     space = UT_LIST_GET_NEXT(space_list, space)) {
 
-		ut_a(space->purpose == FIL_TYPE_TABLESPACE);
+			ut_a(space->purpose == FIL_TYPE_TABLESPACE);
 
-		mutex_exit(&fil_system->mutex); /* no need to protect with a
-					      mutex, because this is a
-					      single-threaded operation */
-		error = fil_read(
-			page_id_t(space->id, 0),
-			page_size_t(space->flags),
-			0, univ_page_size.physical(), buf);
+			error = fil_read(
+				page_id_t(space->id, 0),
+				page_size_t(space->flags),
+				0, univ_page_size.physical(), buf);
 
-		ut_a(error == DB_SUCCESS);
+			ut_a(error == DB_SUCCESS);
 
-		size_in_header = fsp_header_get_field(buf, FSP_SIZE);
+			size_in_header = fsp_header_get_field(buf, FSP_SIZE);
 
-		success = fil_space_extend(space, size_in_header);
-		if (!success) {
-			ib::error() << "Could not extend the tablespace of "
-				<< space->name  << " to the size stored in"
-				" header, " << size_in_header << " pages;"
-				" size after extension " << actual_size
-				<< " pages. Check that you have free disk"
-				" space and retry!";
-			ut_a(success);
+			success = fil_space_extend(space, size_in_header);
+			if (!success) {
+				ib::error() << "Could not extend the tablespace of "
+					<< space->name  << " to the size stored in"
+					" header, " << size_in_header << " pages;"
+					" size after extension " << actual_size
+					<< " pages. Check that you have free disk"
+					" space and retry!";
+				ut_a(success);
+			}
 		}
-
-		mutex_enter(&fil_system->mutex);
 	}
 
-	mutex_exit(&fil_system->mutex);
-
 	ut_free(buf);
 }
 #endif
@@ -5486,7 +5779,9 @@ fil_space_reserve_free_extents(
 
 	ut_ad(fil_system);
 
-	mutex_enter(&fil_system->mutex);
+	fil_shard_t*	shard = fil_shard_get(id);
+
+	mutex_enter(&shard->mutex);
 
 	space = fil_space_get_by_id(id);
 
@@ -5499,7 +5794,7 @@ fil_space_reserve_free_extents(
 		success = true;
 	}
 
-	mutex_exit(&fil_system->mutex);
+	mutex_exit(&shard->mutex);
 
 	return(success);
 }
@@ -5516,7 +5811,9 @@ fil_space_release_free_extents(
 
 	ut_ad(fil_system);
 
-	mutex_enter(&fil_system->mutex);
+	fil_shard_t*	shard = fil_shard_get(id);
+
+	mutex_enter(&shard->mutex);
 
 	space = fil_space_get_by_id(id);
 
@@ -5525,7 +5822,7 @@ fil_space_release_free_extents(
 
 	space->n_reserved_extents -= n_reserved;
 
-	mutex_exit(&fil_system->mutex);
+	mutex_exit(&shard->mutex);
 }
 
 /*******************************************************************//**
@@ -5541,7 +5838,9 @@ fil_space_get_n_reserved_extents(
 
 	ut_ad(fil_system);
 
-	mutex_enter(&fil_system->mutex);
+	fil_shard_t*	shard = fil_shard_get(id);
+
+	mutex_enter(&shard->mutex);
 
 	space = fil_space_get_by_id(id);
 
@@ -5549,7 +5848,7 @@ fil_space_get_n_reserved_extents(
 
 	n = space->n_reserved_extents;
 
-	mutex_exit(&fil_system->mutex);
+	mutex_exit(&shard->mutex);
 
 	return(n);
 }
@@ -5560,10 +5859,10 @@ fil_space_get_n_reserved_extents(
 
 Prepares a file node for i/o. Opens the file if it is closed. Updates the
 pending i/o's field in the node and the system appropriately. Takes the node
-off the LRU list if it is in the LRU list. The caller must hold the fil_sys
-mutex.
+off the LRU list if it is in the LRU list. The caller must hold the mutex of
+the shard of the tablespace.
 @param[in]	node		File node
-@param[in]	system		Tablespace memory cache
+@param[in]	shard		Shard of the tablespace
 @param[in]	space		Tablespace instance
 @param[in]	extend		true if file is being extended
 @return false if the file can't be opened, otherwise true */
@@ -5571,12 +5870,15 @@ static
 bool
 fil_node_prepare_for_io(
 	fil_node_t*	node,
-	fil_system_t*	system,
+	fil_shard_t*	shard,
 	fil_space_t*	space,
 	bool		extend)
 {
-	ut_ad(node && system && space);
-	ut_ad(mutex_own(&(system->mutex)));
+	ut_ad(node && shard && space);
+	ut_ad(mutex_own(&shard->mutex));
+	ut_ad(shard == fil_shard_get(space->id));
+
+	fil_system_t*	system = fil_system;
 
 	if (system->n_open > system->max_n_open + 5) {
 
@@ -5609,9 +5911,9 @@ fil_node_prepare_for_io(
 	if (node->n_pending == 0 && fil_space_belongs_in_lru(space)) {
 		/* The node is in the LRU list, remove it */
 
-		ut_a(UT_LIST_GET_LEN(system->LRU) > 0);
+		ut_a(UT_LIST_GET_LEN(shard->LRU) > 0);
 
-		UT_LIST_REMOVE(system->LRU, node);
+		UT_LIST_REMOVE(shard->LRU, node);
 	}
 
 	node->n_pending++;
@@ -5627,11 +5929,12 @@ void
 fil_node_complete_io(
 /*=================*/
 	fil_node_t*	node,	/*!< in: file node */
-	fil_system_t*	system,	/*!< in: tablespace memory cache */
+	fil_shard_t*	shard,	/*!< in: shard of the tablespace */
 	const IORequest&type)	/*!< in: IO_TYPE_*, marks the node as
 				modified if TYPE_IS_WRITE() */
 {
-	ut_ad(mutex_own(&system->mutex));
+	ut_ad(mutex_own(&shard->mutex));
+	ut_ad(shard == fil_shard_get(node->space->id));
 	ut_a(node->n_pending > 0);
 
 	--node->n_pending;
@@ -5643,9 +5946,9 @@ fil_node_complete_io(
 		ut_ad(!srv_read_only_mode
 		      || fsp_is_system_temporary(node->space->id));
 
-		++system->modification_counter;
+		++shard->modification_counter;
 
-		node->modification_counter = system->modification_counter;
+		node->modification_counter = shard->modification_counter;
 
 		if (fil_buffering_disabled(node->space)) {
 
@@ -5660,14 +5963,14 @@ fil_node_complete_io(
 			node->space->is_in_unflushed_spaces = true;
 
 			UT_LIST_ADD_FIRST(
-				system->unflushed_spaces, node->space);
+				shard->unflushed_spaces, node->space);
 		}
 	}
 
 	if (node->n_pending == 0 && fil_space_belongs_in_lru(node->space)) {
 
 		/* The node must be put back to the LRU list */
-		UT_LIST_ADD_FIRST(system->LRU, node);
+		UT_LIST_ADD_FIRST(shard->LRU, node);
 	}
 }
 
@@ -5838,9 +6141,11 @@ fil_io(
 		srv_stats.data_written.add(len);
 	}
 
-	/* Reserve the fil_system mutex and make sure that we can open at
+	/* Reserve the shard mutex and make sure that we can open at
 	least one file while holding it, if the file is not already open */
 
+	fil_shard_t*	shard = fil_shard_get(page_id.space());
+
 	fil_mutex_enter_and_prepare_for_io(page_id.space());
 
 	fil_space_t*	space = fil_space_get_by_id(page_id.space());
@@ -5852,7 +6157,7 @@ fil_io(
 		&& !sync
 		&& space->stop_new_ops)) {
 
-		mutex_exit(&fil_system->mutex);
+		mutex_exit(&shard->mutex);
 
 		if (!req_type.ignore_missing()) {
 			if (space == NULL) {
@@ -5886,7 +6191,7 @@ fil_io(
 		if (node == NULL) {
 
 			if (req_type.ignore_missing()) {
-				mutex_exit(&fil_system->mutex);
+				mutex_exit(&shard->mutex);
 				return(DB_ERROR);
 			}
 
@@ -5915,7 +6220,7 @@ fil_io(
 				/* Handle page which is outside the truncated
 				tablespace bounds when recovering from a crash
 				that happened during a truncation */
-				mutex_exit(&fil_system->mutex);
+				mutex_exit(&shard->mutex);
 				return(DB_TABLESPACE_DELETED);
 			}
 
@@ -5925,10 +6230,10 @@ fil_io(
 	}
 
 	/* Open file if closed */
-	if (!fil_node_prepare_for_io(node, fil_system, space, false)) {
+	if (!fil_node_prepare_for_io(node, shard, space, false)) {
 		if (fil_type_is_data(space->purpose)
 		    && fsp_is_ibd_tablespace(space->id)) {
-			mutex_exit(&fil_system->mutex);
+			mutex_exit(&shard->mutex);
 
 			if (!req_type.ignore_missing()) {
 				ib::error()
@@ -5963,8 +6268,8 @@ fil_io(
 			/* If we can tolerate the non-existent pages, we
 			should return with DB_ERROR and let caller decide
 			what to do. */
-			fil_node_complete_io(node, fil_system, req_type);
-			mutex_exit(&fil_system->mutex);
+			fil_node_complete_io(node, shard, req_type);
+			mutex_exit(&shard->mutex);
 			return(DB_ERROR);
 		}
 
@@ -5973,8 +6278,8 @@ fil_io(
 			space->name, byte_offset, len, req_type.is_read());
 	}
 
-	/* Now we have made the changes in the data structures of fil_system */
-	mutex_exit(&fil_system->mutex);
+	/* Now we have made the changes in the data structures of the shard */
+	mutex_exit(&shard->mutex);
 
 	/* Calculate the low 32 bits and the high 32 bits of the file offset */
 
@@ -6034,6 +6339,12 @@ fil_io(
 		req_type.clear_compressed();
 	}
 
+	/* Reads may have to decompress pages written with the dictionary
+	even if the table has not been opened with COMPRESSION yet. */
+	if (page_id.page_no() > 0) {
+		req_type.compression_dictionary(space->zstd_dict);
+	}
+
 	/* Set encryption information. */
 	fil_io_set_encryption(req_type, page_id, space);
 
@@ -6089,11 +6400,11 @@ fil_io(
 		/* The i/o operation is already completed when we return from
 		os_aio: */
 
-		mutex_enter(&fil_system->mutex);
+		mutex_enter(&shard->mutex);
 
-		fil_node_complete_io(node, fil_system, req_type);
+		fil_node_complete_io(node, shard, req_type);
 
-		mutex_exit(&fil_system->mutex);
+		mutex_exit(&shard->mutex);
 
 		ut_ad(fil_validate_skip());
 	}
@@ -6130,11 +6441,13 @@ fil_aio_wait(
 
 	srv_set_io_thread_op_info(segment, "complete io for fil node");
 
-	mutex_enter(&fil_system->mutex);
+	fil_shard_t*	shard = fil_shard_get(node->space->id);
+
+	mutex_enter(&shard->mutex);
 
-	fil_node_complete_io(node, fil_system, type);
+	fil_node_complete_io(node, shard, type);
 
-	mutex_exit(&fil_system->mutex);
+	mutex_exit(&shard->mutex);
 
 	ut_ad(fil_validate_skip());
 
@@ -6179,14 +6492,16 @@ fil_flush(
 	fil_node_t*	node;
 	pfs_os_file_t	file;
 
-	mutex_enter(&fil_system->mutex);
+	fil_shard_t*	shard = fil_shard_get(space_id);
+
+	mutex_enter(&shard->mutex);
 
 	fil_space_t*	space = fil_space_get_by_id(space_id);
 
 	if (space == NULL
 	    || space->purpose == FIL_TYPE_TEMPORARY
 	    || space->stop_new_ops) {
-		mutex_exit(&fil_system->mutex);
+		mutex_exit(&shard->mutex);
 
 		return;
 	}
@@ -6209,7 +6524,7 @@ fil_flush(
 		}
 #endif /* UNIV_DEBUG */
 
-		mutex_exit(&fil_system->mutex);
+		mutex_exit(&shard->mutex);
 		return;
 	}
 
@@ -6254,11 +6569,11 @@ retry:
 
 			int64_t	sig_count = os_event_reset(node->sync_event);
 
-			mutex_exit(&fil_system->mutex);
+			mutex_exit(&shard->mutex);
 
 			os_event_wait_low(node->sync_event, sig_count);
 
-			mutex_enter(&fil_system->mutex);
+			mutex_enter(&shard->mutex);
 
 			if (node->flush_counter >= old_mod_counter) {
 
@@ -6272,11 +6587,11 @@ retry:
 		file = node->handle;
 		node->n_pending_flushes++;
 
-		mutex_exit(&fil_system->mutex);
+		mutex_exit(&shard->mutex);
 
 		os_file_flush(file);
 
-		mutex_enter(&fil_system->mutex);
+		mutex_enter(&shard->mutex);
 
 		os_event_set(node->sync_event);
 
@@ -6291,7 +6606,7 @@ skip_flush:
 				space->is_in_unflushed_spaces = false;
 
 				UT_LIST_REMOVE(
-					fil_system->unflushed_spaces,
+					shard->unflushed_spaces,
 					space);
 			}
 		}
@@ -6313,7 +6628,7 @@ skip_flush:
 
 	space->n_pending_flushes--;
 
-	mutex_exit(&fil_system->mutex);
+	mutex_exit(&shard->mutex);
 }
 
 /** Flush to disk the writes in file spaces of the given type
@@ -6322,43 +6637,42 @@ possibly cached by the OS.
 void
 fil_flush_file_spaces(uint8_t purpose)
 {
-	ulint		n_space_ids;
-
 	ut_ad((purpose & FIL_TYPE_TABLESPACE) || (purpose & FIL_TYPE_LOG));
 
-	mutex_enter(&fil_system->mutex);
-
-	n_space_ids = UT_LIST_GET_LEN(fil_system->unflushed_spaces);
-	if (n_space_ids == 0) {
-
-		mutex_exit(&fil_system->mutex);
-		return;
-	}
-
 	/* Assemble a list of space ids to flush.  Previously, we
-	traversed fil_system->unflushed_spaces and called UT_LIST_GET_NEXT()
+	traversed the unflushed_spaces list and called UT_LIST_GET_NEXT()
 	on a space that was just removed from the list by fil_flush().
-	Thus, the space could be dropped and the memory overwritten. */
+	Thus, the space could be dropped and the memory overwritten.
+	The shards are visited one at a time so that flushing one shard
+	does not block I/O on the others. */
 	using Space_Ids = std::vector<space_id_t, ut_allocator<space_id_t>>;
 
 	Space_Ids	space_ids;
 
-	space_ids.reserve(n_space_ids);
+	for (auto& shard : fil_system->shards) {
+
+		/* The log shard only holds FIL_TYPE_LOG spaces. */
+		if (&shard == &fil_system->shards[FIL_LOG_SHARD]
+		    && !(purpose & FIL_TYPE_LOG)) {
+
+			continue;
+		}
 
-	n_space_ids = 0;
+		mutex_enter(&shard.mutex);
 
-	for (auto space = UT_LIST_GET_FIRST(fil_system->unflushed_spaces);
-	     space != nullptr;
-	     space = UT_LIST_GET_NEXT(unflushed_spaces, space)) {
+		for (auto space = UT_LIST_GET_FIRST(shard.unflushed_spaces);
+		     space != nullptr;
+		     space = UT_LIST_GET_NEXT(unflushed_spaces, space)) {
 
-		if ((to_int(space->purpose) & purpose)
-		    && !space->stop_new_ops) {
+			if ((to_int(space->purpose) & purpose)
+			    && !space->stop_new_ops) {
 
-			space_ids.push_back(space->id);
+				space_ids.push_back(space->id);
+			}
 		}
-	}
 
-	mutex_exit(&fil_system->mutex);
+		mutex_exit(&shard.mutex);
+	}
 
 	/* Flush the spaces.  It will not hurt to call fil_flush() on
 	a non-existing space id. */
@@ -6391,7 +6705,7 @@ struct	Check {
 	@return		number of open file nodes */
 	static ulint validate(const fil_space_t* space)
 	{
-		ut_ad(mutex_own(&fil_system->mutex));
+		ut_ad(mutex_own(&fil_shard_get(space->id)->mutex));
 		Check	check;
 		ut_list_validate(space->chain, check);
 		ut_a(space->size == check.m_size);
@@ -6413,29 +6727,32 @@ fil_validate(void)
 {
 	ulint		n_open		= 0;
 
-	mutex_enter(&fil_system->mutex);
+	fil_mutex_enter_all();
 
-	/* Look for spaces in the hash table */
+	for (auto& shard : fil_system->shards) {
 
-	for (auto& elem : fil_system->spaces) {
+		/* Look for spaces in the hash table */
 
-		n_open += Check::validate(elem.second);
-	}
+		for (auto& elem : shard.spaces) {
 
-	ut_a(fil_system->n_open == n_open);
+			n_open += Check::validate(elem.second);
+		}
 
-	UT_LIST_CHECK(fil_system->LRU);
+		UT_LIST_CHECK(shard.LRU);
 
-	for (auto fil_node = UT_LIST_GET_FIRST(fil_system->LRU);
-	     fil_node != 0;
-	     fil_node = UT_LIST_GET_NEXT(LRU, fil_node)) {
+		for (auto fil_node = UT_LIST_GET_FIRST(shard.LRU);
+		     fil_node != 0;
+		     fil_node = UT_LIST_GET_NEXT(LRU, fil_node)) {
 
-		ut_a(fil_node->is_open);
-		ut_a(fil_node->n_pending == 0);
-		ut_a(fil_space_belongs_in_lru(fil_node->space));
+			ut_a(fil_node->is_open);
+			ut_a(fil_node->n_pending == 0);
+			ut_a(fil_space_belongs_in_lru(fil_node->space));
+		}
 	}
 
-	mutex_exit(&fil_system->mutex);
+	ut_a(fil_system->n_open == n_open);
+
+	fil_mutex_exit_all();
 
 	return(true);
 }
@@ -6517,17 +6834,22 @@ fil_close(void)
 		return;
 	}
 
-	call_destructor(&fil_system->names);
+	for (auto& shard : fil_system->shards) {
 
-	call_destructor(&fil_system->spaces);
+		call_destructor(&shard.names);
 
-	call_destructor(&fil_system->m_open);
+		call_destructor(&shard.spaces);
+
+		ut_a(UT_LIST_GET_LEN(shard.LRU) == 0);
+		ut_a(UT_LIST_GET_LEN(shard.unflushed_spaces) == 0);
+		ut_a(UT_LIST_GET_LEN(shard.space_list) == 0);
 
-	ut_a(UT_LIST_GET_LEN(fil_system->LRU) == 0);
-	ut_a(UT_LIST_GET_LEN(fil_system->unflushed_spaces) == 0);
-	ut_a(UT_LIST_GET_LEN(fil_system->space_list) == 0);
+		mutex_free(&shard.mutex);
+	}
+
+	call_destructor(&fil_system->m_open);
 
-	mutex_free(&fil_system->mutex);
+	ut_a(fil_system->n_open == 0);
 
 	ut_free(fil_system);
 	fil_system = NULL;
@@ -6566,6 +6888,9 @@ struct fil_iterator_t {
 	byte*		io_buffer;		/*!< Buffer to use for IO */
 	byte*		encryption_key;		/*!< Encryption key */
 	byte*		encryption_iv;		/*!< Encryption iv */
+	Compression::Dictionary*
+			zstd_dict;		/*!< Zstandard dictionary
+						from page 0, or NULL */
 };
 
 /********************************************************************//**
@@ -6602,6 +6927,26 @@ fil_iterate(
 	ulint	read_type = IORequest::READ;
 	ulint	write_type = IORequest::WRITE;
 
+	/* With a CRC32 checksum algorithm, the checksums of all the pages
+	of a read are calculated together before the pages are visited. */
+	using Pages = std::vector<const byte*, ut_allocator<const byte*>>;
+	using Checksums = std::vector<uint32_t, ut_allocator<uint32_t>>;
+
+	Pages		pages;
+	Checksums	checksums;
+	uint32_t*	page_crc32s = NULL;
+
+	if (!callback.get_page_size().is_compressed()
+	    && !fsp_is_checksum_disabled(space_id)
+	    && (srv_checksum_algorithm == SRV_CHECKSUM_ALGORITHM_CRC32
+		|| srv_checksum_algorithm
+		== SRV_CHECKSUM_ALGORITHM_STRICT_CRC32)) {
+
+		pages.resize(iter.n_io_buffers);
+		checksums.resize(iter.n_io_buffers);
+		page_crc32s = &checksums[0];
+	}
+
 	for (offset = iter.start; offset < iter.end; offset += n_bytes) {
 
 		byte*	io_buffer = iter.io_buffer;
@@ -6649,6 +6994,8 @@ fil_iterate(
 			read_request.encryption_algorithm(Encryption::AES);
 		}
 
+		read_request.compression_dictionary(iter.zstd_dict);
+
 		err = os_file_read(
 			read_request, iter.file, io_buffer, offset,
 			(ulint) n_bytes);
@@ -6664,11 +7011,25 @@ fil_iterate(
 		os_offset_t	page_off = offset;
 		ulint		n_pages_read = (ulint) n_bytes / iter.page_size;
 
+		if (page_crc32s != NULL) {
+			ut_ad(n_pages_read <= pages.size());
+
+			for (ulint i = 0; i < n_pages_read; ++i) {
+				pages[i] = io_buffer + i * iter.page_size;
+			}
+
+			buf_calc_page_crc32_batch(
+				&pages[0], n_pages_read, page_crc32s);
+		}
+
 		for (ulint i = 0; i < n_pages_read; ++i) {
 
 			buf_block_set_file_page(
 				block, page_id_t(space_id, page_no++));
 
+			callback.m_page_crc32 = page_crc32s == NULL
+				? NULL : &page_crc32s[i];
+
 			if ((err = callback(page_off, block)) != DB_SUCCESS) {
 
 				return(err);
@@ -6840,6 +7201,18 @@ fil_tablespace_iterate(
 		iter.encryption_key = table->encryption_key;
 		iter.encryption_iv = table->encryption_iv;
 
+		/* Pages compressed with a Zstandard dictionary can only be
+		read with the dictionary stored in page 0. */
+		ulint		dict_len;
+		const byte*	dict_data = fsp_header_get_zstd_dict(
+			page, callback.get_page_size(), &dict_len);
+
+		iter.zstd_dict = dict_data == NULL
+			? NULL
+			: Compression::create_dictionary(
+				dict_data, dict_len,
+				srv_compression_zstd_level);
+
 		/* Check encryption is matched or not. */
 		ulint	space_flags = callback.get_space_flags();
 		if (FSP_FLAGS_GET_ENCRYPTION(space_flags)) {
@@ -6877,6 +7250,8 @@ fil_tablespace_iterate(
 
 			ut_free(io_buffer);
 		}
+
+		Compression::free_dictionary(iter.zstd_dict);
 	}
 
 	if (err == DB_SUCCESS) {
@@ -6974,34 +7349,41 @@ fil_get_space_names(
 	fil_space_t*	space;
 	dberr_t		err = DB_SUCCESS;
 
-	mutex_enter(&fil_system->mutex);
+	for (auto& shard : fil_system->shards) {
 
-	for (space = UT_LIST_GET_FIRST(fil_system->space_list);
-	     space != NULL;
-	     space = UT_LIST_GET_NEXT(space_list, space)) {
+		mutex_enter(&shard.mutex);
 
-		if (space->purpose == FIL_TYPE_TABLESPACE) {
-			ulint	len;
-			char*	name;
+		for (space = UT_LIST_GET_FIRST(shard.space_list);
+		     space != NULL;
+		     space = UT_LIST_GET_NEXT(space_list, space)) {
 
-			len = ::strlen(space->name);
-			name = UT_NEW_ARRAY_NOKEY(char, len + 1);
+			if (space->purpose == FIL_TYPE_TABLESPACE) {
+				ulint	len;
+				char*	name;
 
-			if (name == 0) {
-				/* Caller to free elements allocated so far. */
-				err = DB_OUT_OF_MEMORY;
-				break;
+				len = ::strlen(space->name);
+				name = UT_NEW_ARRAY_NOKEY(char, len + 1);
+
+				if (name == 0) {
+					/* Caller to free elements allocated so far. */
+					err = DB_OUT_OF_MEMORY;
+					break;
+				}
+
+				memcpy(name, space->name, len);
+				name[len] = 0;
+
+				space_name_list.push_back(name);
 			}
+		}
 
-			memcpy(name, space->name, len);
-			name[len] = 0;
+		mutex_exit(&shard.mutex);
 
-			space_name_list.push_back(name);
+		if (err != DB_SUCCESS) {
+			break;
 		}
 	}
 
-	mutex_exit(&fil_system->mutex);
-
 	return(err);
 }
 
@@ -7010,20 +7392,25 @@ Once started, the caller must keep calling this until it returns NULL.
 fil_space_acquire() and fil_space_release() are invoked here which
 blocks a concurrent operation from dropping the tablespace.
 @param[in]	prev_node	Pointer to the previous fil_node_t.
-If NULL, use the first fil_space_t on fil_system->space_list.
+If NULL, use the first fil_space_t of the first shard.
 @return pointer to the next fil_node_t.
 @retval NULL if this was the last file node */
 const fil_node_t*
 fil_node_next(
 	const fil_node_t*	prev_node)
 {
+	fil_shard_t*		shard;
 	fil_space_t*		space;
 	const fil_node_t*	node = prev_node;
 
-	mutex_enter(&fil_system->mutex);
-
 	if (node == NULL) {
-		space = UT_LIST_GET_FIRST(fil_system->space_list);
+		/* The system tablespace is always present in the
+		first shard, and it is loaded first. */
+		shard = &fil_system->shards[0];
+
+		mutex_enter(&shard->mutex);
+
+		space = UT_LIST_GET_FIRST(shard->space_list);
 
 		/* We can trust that space is not NULL because at least the
 		system tablespace is always present and loaded first. */
@@ -7031,16 +7418,26 @@ fil_node_next(
 
 		node = UT_LIST_GET_FIRST(space->chain);
 		ut_ad(node != NULL);
-	} else {
-		space = node->space;
-		ut_ad(space->n_pending_ops > 0);
-		node = UT_LIST_GET_NEXT(chain, node);
 
-		if (node == NULL) {
-			/* Move on to the next fil_space_t */
-			space->n_pending_ops--;
-			space = UT_LIST_GET_NEXT(space_list, space);
+		mutex_exit(&shard->mutex);
+
+		return(node);
+	}
+
+	space = node->space;
+	shard = fil_shard_get(space->id);
+
+	mutex_enter(&shard->mutex);
+
+	ut_ad(space->n_pending_ops > 0);
+	node = UT_LIST_GET_NEXT(chain, node);
+
+	if (node == NULL) {
+		/* Move on to the next fil_space_t */
+		space->n_pending_ops--;
+		space = UT_LIST_GET_NEXT(space_list, space);
 
+		for (;;) {
 			/* Skip spaces that are being
 			created by fil_ibd_create(),
 			or dropped. */
@@ -7054,11 +7451,26 @@ fil_node_next(
 				space->n_pending_ops++;
 				node = UT_LIST_GET_FIRST(space->chain);
 				ut_ad(node != NULL);
+				break;
 			}
+
+			/* Continue with the first fil_space_t of the
+			next shard, if any. */
+			mutex_exit(&shard->mutex);
+
+			if (shard == &fil_system->shards[FIL_N_SHARDS]) {
+				return(NULL);
+			}
+
+			++shard;
+
+			mutex_enter(&shard->mutex);
+
+			space = UT_LIST_GET_FIRST(shard->space_list);
 		}
 	}
 
-	mutex_exit(&fil_system->mutex);
+	mutex_exit(&shard->mutex);
 
 	return(node);
 }
@@ -7198,6 +7610,9 @@ fil_set_compression(
 		switch (srv_debug_compress) {
 		case Compression::LZ4:
 		case Compression::ZLIB:
+#ifdef HAVE_LIBZSTD
+		case Compression::ZSTD:
+#endif /* HAVE_LIBZSTD */
 		case Compression::NONE:
 
 			compression.m_type =
@@ -7252,6 +7667,60 @@ fil_get_compression(space_id_t space_id)
 	return(space == NULL ? Compression::NONE : space->compression_type);
 }
 
+/** Claim the right to train a Zstandard dictionary for a tablespace.
+@param[in,out]	space		tablespace, acquired by the caller
+@param[in]	min_size	minimum tablespace size in pages
+@return true if the caller must train and call fil_zstd_dict_train_end() */
+bool
+fil_zstd_dict_train_start(
+	fil_space_t*	space,
+	page_no_t	min_size)
+{
+	fil_shard_t*	shard = fil_shard_get(space->id);
+
+	mutex_enter(&shard->mutex);
+
+	bool	start = space->compression_type == Compression::ZSTD
+		&& space->zstd_dict_checked
+		&& space->zstd_dict == NULL
+		&& !space->zstd_dict_training
+		&& !space->stop_new_ops
+		&& space->size >= min_size;
+
+	if (start) {
+		space->zstd_dict_training = true;
+	}
+
+	mutex_exit(&shard->mutex);
+
+	return(start);
+}
+
+/** Finish training a Zstandard dictionary. The dictionary must already
+be durable in page 0, because pages compressed with it can be written
+as soon as this returns.
+@param[in,out]	space		tablespace
+@param[in]	dict		trained dictionary, or NULL on failure */
+void
+fil_zstd_dict_train_end(
+	fil_space_t*			space,
+	Compression::Dictionary*	dict)
+{
+	fil_shard_t*	shard = fil_shard_get(space->id);
+
+	mutex_enter(&shard->mutex);
+
+	ut_ad(space->zstd_dict_training);
+	ut_ad(space->zstd_dict == NULL);
+
+	/* After a failed attempt the space stays marked as training, so
+	that it is not sampled again on every open until restart. */
+	space->zstd_dict = dict;
+	space->zstd_dict_training = dict == NULL;
+
+	mutex_exit(&shard->mutex);
+}
+
 /** Set the encryption type for the tablespace
 @param[in] space_id		Space ID of tablespace for which to set
 @param[in] algorithm		Encryption algorithm
@@ -7271,12 +7740,14 @@ fil_set_encryption(
 		return(DB_IO_NO_ENCRYPT_TABLESPACE);
 	}
 
-	mutex_enter(&fil_system->mutex);
+	fil_shard_t*	shard = fil_shard_get(space_id);
+
+	mutex_enter(&shard->mutex);
 
 	fil_space_t*	space = fil_space_get_by_id(space_id);
 
 	if (space == NULL) {
-		mutex_exit(&fil_system->mutex);
+		mutex_exit(&shard->mutex);
 		return(DB_NOT_FOUND);
 	}
 
@@ -7298,7 +7769,7 @@ fil_set_encryption(
 	ut_ad(algorithm != Encryption::NONE);
 	space->encryption_type = algorithm;
 
-	mutex_exit(&fil_system->mutex);
+	mutex_exit(&shard->mutex);
 
 	return(DB_SUCCESS);
 }
@@ -7312,50 +7783,53 @@ fil_encryption_rotate()
 	mtr_t		mtr;
 	byte		encrypt_info[ENCRYPTION_INFO_SIZE_V2];
 
-	for (space = UT_LIST_GET_FIRST(fil_system->space_list);
-	     space != NULL; ) {
-		/* Skip unencypted tablespaces. */
-		/* Encrypted redo log tablespaces is handled in function
-		log_rotate_encryption. */
-		if (fsp_is_system_or_temp_tablespace(space->id)
-		    || space->purpose == FIL_TYPE_LOG) {
-			space = UT_LIST_GET_NEXT(space_list, space);
-			continue;
-		}
+	for (auto& shard : fil_system->shards) {
 
-		/* Skip the undo tablespace when it's in default
-		key status, since it's the first server startup
-		after bootstrap, and the server uuid is not ready
-		yet. */
-		if (fsp_is_undo_tablespace(space->id)
-		    && Encryption::master_key_id ==
-			ENCRYPTION_DEFAULT_MASTER_KEY_ID) {
-			space = UT_LIST_GET_NEXT(space_list, space);
-			continue;
-		}
+		for (space = UT_LIST_GET_FIRST(shard.space_list);
+		     space != NULL; ) {
+			/* Skip unencypted tablespaces. */
+			/* Encrypted redo log tablespaces is handled in function
+			log_rotate_encryption. */
+			if (fsp_is_system_or_temp_tablespace(space->id)
+			    || space->purpose == FIL_TYPE_LOG) {
+				space = UT_LIST_GET_NEXT(space_list, space);
+				continue;
+			}
 
-		/* Rotate the encrypted tablespaces. */
-		if (space->encryption_type != Encryption::NONE) {
+			/* Skip the undo tablespace when it's in default
+			key status, since it's the first server startup
+			after bootstrap, and the server uuid is not ready
+			yet. */
+			if (fsp_is_undo_tablespace(space->id)
+			    && Encryption::master_key_id ==
+				ENCRYPTION_DEFAULT_MASTER_KEY_ID) {
+				space = UT_LIST_GET_NEXT(space_list, space);
+				continue;
+			}
 
-			mtr_start(&mtr);
+			/* Rotate the encrypted tablespaces. */
+			if (space->encryption_type != Encryption::NONE) {
 
-			mtr_x_lock_space(space, &mtr);
+				mtr_start(&mtr);
 
-			memset(encrypt_info, 0, ENCRYPTION_INFO_SIZE_V2);
+				mtr_x_lock_space(space, &mtr);
+
+				memset(encrypt_info, 0, ENCRYPTION_INFO_SIZE_V2);
+
+				if (!fsp_header_rotate_encryption(space,
+								  encrypt_info,
+								  &mtr)) {
+					mtr_commit(&mtr);
+					return(false);
+				}
 
-			if (!fsp_header_rotate_encryption(space,
-							  encrypt_info,
-							  &mtr)) {
 				mtr_commit(&mtr);
-				return(false);
 			}
 
-			mtr_commit(&mtr);
+			space = UT_LIST_GET_NEXT(space_list, space);
+			DBUG_EXECUTE_IF("ib_crash_during_rotation_for_encryption",
+					DBUG_SUICIDE(););
 		}
-
-		space = UT_LIST_GET_NEXT(space_list, space);
-		DBUG_EXECUTE_IF("ib_crash_during_rotation_for_encryption",
-				DBUG_SUICIDE(););
 	}
 
 	return(true);
@@ -9273,13 +9747,77 @@ fil_tokenize_paths(
 	dirs.erase(std::unique(dirs.begin(), dirs.end() ), dirs.end());
 }
 
+/** Files found by the directory scan */
+using Scanned_files = std::vector<std::string>;
+
+/** Tablespace ID read from the header of each scanned file */
+using Scanned_ids = std::vector<space_id_t, ut_allocator<space_id_t>>;
+
+/** Minimum number of files for each tablespace header reader thread */
+static const size_t	FIL_SCAN_FILES_PER_THREAD = 64;
+
+/** Read the tablespace ID from the header of a range of scanned files.
+@param[in]	filenames	files found by the directory scan
+@param[in]	start		index of the first file to read
+@param[in]	end		one past the index of the last file to read
+@param[out]	space_ids	tablespace ID of each file, or SPACE_UNKNOWN
+				if it could not be read
+@param[in,out]	n_running	number of running readers, decremented
+				when done, can be nullptr */
+static
+void
+fil_scan_read_space_ids(
+	const Scanned_files*	filenames,
+	size_t			start,
+	size_t			end,
+	Scanned_ids*		space_ids,
+	std::atomic<size_t>*	n_running)
+{
+	for (size_t i = start; i < end; ++i) {
+
+		const auto&	filename = (*filenames)[i];
+
+		std::ifstream	ifs(filename, std::ios::binary);
+
+		if (!ifs) {
+			ib::warn() << "Unable to open '" << filename << "'";
+			continue;
+		}
+
+		ifs.seekg(FIL_PAGE_SPACE_ID, ifs.beg);
+
+		char	buf[sizeof(space_id_t)];
+
+		ifs.read(buf, sizeof(buf));
+
+		if (!ifs.good() || (size_t) ifs.gcount() < sizeof(buf)) {
+
+			ib::warn()
+				<< "Unable to read tablespace ID from"
+				<< " '" << filename << "'";
+		} else {
+
+			(*space_ids)[i] = mach_read_from_4(
+				reinterpret_cast<byte*>(buf));
+		}
+
+		ifs.close();
+	}
+
+	if (n_running != nullptr) {
+		n_running->fetch_sub(1);
+	}
+}
+
 /** Discover tablespaces by reading the header from .ibd files.
+The headers are read in parallel by up to srv_n_read_io_threads
+threads, the results are merged by the calling thread.
 @param[in]	directories	Directories to scan
 @return DB_SUCCESS if all goes well */
 dberr_t
 fil_scan_for_tablespaces(const std::string& directories)
 {
-	using Dirs = std::vector<std::string>;
+	using Dirs = Scanned_files;
 
 	ib::info() << "Directories to scan '" << directories << "'";
 
@@ -9288,7 +9826,6 @@ fil_scan_for_tablespaces(const std::string& directories)
 
 	fil_tokenize_paths(directories, dirs, ";");
 
-	/* Should be trivial to parallelize the scan and ID check. */
 	for (const auto& dir : dirs) {
 
 		ib::info() << "Scanning '" << dir << "'";
@@ -9324,47 +9861,65 @@ fil_scan_for_tablespaces(const std::string& directories)
 
 	Duplicates	duplicates;
 
-	for (const auto& filename : filenames) {
+	const size_t	n_files = filenames.size();
+	Scanned_ids	space_ids(n_files, SPACE_UNKNOWN);
+	size_t		n_threads = 1;
 
-		std::ifstream	ifs(filename, std::ios::binary);
+#ifndef UNIV_HOTBACKUP
+	n_threads = std::min(
+		static_cast<size_t>(srv_n_read_io_threads),
+		(n_files + FIL_SCAN_FILES_PER_THREAD - 1)
+		/ FIL_SCAN_FILES_PER_THREAD);
 
-		if (!ifs) {
-			ib::warn() << "Unable to open '" << filename << "'";
-			continue;
-		}
+	n_threads = std::max(n_threads, static_cast<size_t>(1));
+#endif /* !UNIV_HOTBACKUP */
 
-		ifs.seekg(FIL_PAGE_SPACE_ID, ifs.beg);
+	const size_t		per_thread
+		= (n_files + n_threads - 1) / n_threads;
+	std::atomic<size_t>	n_running(n_threads - 1);
 
-		char	buf[sizeof(space_id_t)];
+#ifndef UNIV_HOTBACKUP
+	/* The calling thread reads the first range itself. */
+	for (size_t i = 1; i < n_threads; ++i) {
 
-		ifs.read(buf, sizeof(buf));
+		const size_t	start = i * per_thread;
 
-		if (!ifs.good() || (size_t) ifs.gcount() < sizeof(buf)) {
+		os_thread_create(
+			fil_scan_thread_key, fil_scan_read_space_ids,
+			&filenames, start, std::min(start + per_thread, n_files),
+			&space_ids, &n_running);
+	}
+#endif /* !UNIV_HOTBACKUP */
 
-			ib::warn()
-				<< "Unable to read tablespace ID from"
-				<< " '" << filename << "'";
-		} else {
+	fil_scan_read_space_ids(
+		&filenames, 0, std::min(per_thread, n_files), &space_ids,
+		nullptr);
 
-			space_id_t	space_id;
+	while (n_running.load() > 0) {
+		os_thread_sleep(1000);
+	}
 
-			space_id = mach_read_from_4(
-				reinterpret_cast<byte*>(buf));
+	/* Merge the results in the order of the directory scan, so that
+	the duplicate detection is the same as that of a serial scan. */
+	for (size_t i = 0; i < n_files; ++i) {
 
-			const auto it = fil_scanned->m_spaces.find(space_id);
+		const space_id_t	space_id = space_ids[i];
 
-			if (it != fil_scanned->m_spaces.end()) {
+		if (space_id == SPACE_UNKNOWN) {
+			continue;
+		}
 
-				ut_a(it->second.m_id == space_id);
+		const auto it = fil_scanned->m_spaces.find(space_id);
 
-				duplicates.insert(space_id);
-			}
+		if (it != fil_scanned->m_spaces.end()) {
+
+			ut_a(it->second.m_id == space_id);
 
-			fil_scanned->load(
-				space_id, filename, Fil_Open::Nodes::INIT, 0);
+			duplicates.insert(space_id);
 		}
 
-		ifs.close();
+		fil_scanned->load(
+			space_id, filenames[i], Fil_Open::Nodes::INIT, 0);
 	}
 
 	dberr_t	err;
@@ -9420,9 +9975,10 @@ fil_check_extend_space(
 		return(DB_CANNOT_OPEN_FILE);
 	}
 
-	mutex_exit(&fil_system->mutex);
-
 	fil_space_t*	space = node->space;
+	fil_shard_t*	shard = fil_shard_get(space->id);
+
+	mutex_exit(&shard->mutex);
 
 	if (space->size < space->size_in_header) {
 
@@ -9441,7 +9997,7 @@ fil_check_extend_space(
 		}
 	}
 
-	mutex_enter(&fil_system->mutex);
+	mutex_enter(&shard->mutex);
 
 	/* Close node if it was opened by current function */
 	if (open_node) {
@@ -41,12 +41,15 @@ Created 11/29/1995 Heikki Tuuri
 
 # include "btr0btr.h"
 # include "btr0sea.h"
+# include "buf0flu.h"
 # include "dict0boot.h"
 # include "fut0fut.h"
 # include "ibuf0ibuf.h"
 # include "log0log.h"
+# include "os0thread-create.h"
 # include "srv0srv.h"
 # include "srv0start.h"
+# include "ut0crc32.h"
 #endif /* UNIV_HOTBACKUP */
 #include "dict0mem.h"
 #include "fsp0sysspace.h"
@@ -1003,6 +1006,286 @@ fsp_header_rotate_encryption(
 					   mtr));
 }
 
+/** Magic number of a Zstandard dictionary in page 0 */
+static const byte	FSP_ZSTD_DICT_MAGIC[] = { 'Z', 'D', 'C', '1' };
+
+/** Number of pages sampled to train a Zstandard dictionary */
+static const ulint	FSP_ZSTD_DICT_N_SAMPLES = 256;
+
+/** Minimum number of usable samples to train a Zstandard dictionary */
+static const ulint	FSP_ZSTD_DICT_MIN_SAMPLES = 32;
+
+/** First page number that is sampled to train a Zstandard dictionary:
+pages before it are file management pages */
+static const page_no_t	FSP_ZSTD_DICT_FIRST_PAGE = FSP_FIRST_INODE_PAGE_NO + 1;
+
+/** Get the offset of the Zstandard dictionary header in page 0.
+@param[in]	page_size	page size
+@return offset of the dictionary header */
+static
+ulint
+fsp_header_get_zstd_dict_offset(
+	const page_size_t&	page_size)
+{
+	return(fsp_header_get_sdi_offset(page_size) + FSP_SDI_HEADER_LEN);
+}
+
+/** Get the maximum length of a Zstandard dictionary in page 0.
+@param[in]	page_size	page size
+@return maximum length in bytes */
+static
+ulint
+fsp_header_get_zstd_dict_max_len(
+	const page_size_t&	page_size)
+{
+	return(page_size.physical() - FIL_PAGE_DATA_END
+	       - fsp_header_get_zstd_dict_offset(page_size)
+	       - FSP_ZSTD_DICT_HEADER_LEN);
+}
+
+/** Read the Zstandard dictionary stored in page 0.
+@param[in]	page		page 0 of the tablespace
+@param[in]	page_size	page size
+@param[out]	len		length of the dictionary in bytes
+@return dictionary contents inside page, or NULL if there is none */
+const byte*
+fsp_header_get_zstd_dict(
+	const page_t*		page,
+	const page_size_t&	page_size,
+	ulint*			len)
+{
+	if (page_size.is_compressed()) {
+		return(NULL);
+	}
+
+	const byte*	ptr = page + fsp_header_get_zstd_dict_offset(page_size);
+
+	if (memcmp(ptr, FSP_ZSTD_DICT_MAGIC, sizeof FSP_ZSTD_DICT_MAGIC)) {
+		return(NULL);
+	}
+
+	*len = mach_read_from_4(ptr + 4);
+
+	if (*len == 0 || *len > fsp_header_get_zstd_dict_max_len(page_size)) {
+		return(NULL);
+	}
+
+	const byte*	dict = ptr + FSP_ZSTD_DICT_HEADER_LEN;
+
+	if (mach_read_from_4(ptr + 8) != ut_crc32(dict, *len)) {
+		return(NULL);
+	}
+
+	return(dict);
+}
+
+/** Copy sample pages of a tablespace for dictionary training.
+@param[in]	space		tablespace
+@param[in]	page_size	page size
+@param[in]	n_pages		number of initialised pages in the tablespace
+@param[out]	samples		page contents, back to back
+@param[out]	sizes		length of each sample
+@return number of samples copied */
+static
+ulint
+fsp_zstd_dict_sample(
+	const fil_space_t*	space,
+	const page_size_t&	page_size,
+	page_no_t		n_pages,
+	byte*			samples,
+	size_t*			sizes)
+{
+	const ulint	content_len = page_size.physical() - FIL_PAGE_DATA;
+	const page_no_t	step = std::max<page_no_t>(
+		1, (n_pages - FSP_ZSTD_DICT_FIRST_PAGE)
+		/ FSP_ZSTD_DICT_N_SAMPLES);
+	ulint		n_samples = 0;
+
+	for (page_no_t page_no = FSP_ZSTD_DICT_FIRST_PAGE;
+	     page_no < n_pages && n_samples < FSP_ZSTD_DICT_N_SAMPLES;
+	     page_no += step) {
+
+		if (space->stop_new_ops
+		    || srv_shutdown_state != SRV_SHUTDOWN_NONE) {
+
+			/* Too few samples to train on */
+			return(0);
+		}
+
+		mtr_t	mtr;
+
+		mtr_start(&mtr);
+
+		buf_block_t*	block = buf_page_get_gen(
+			page_id_t(space->id, page_no), page_size, RW_S_LATCH,
+			NULL, BUF_GET_POSSIBLY_FREED, __FILE__, __LINE__,
+			&mtr);
+
+		const page_t*	page = buf_block_get_frame(block);
+
+		switch (fil_page_get_type(page)) {
+		case FIL_PAGE_INDEX:
+		case FIL_PAGE_SDI:
+		case FIL_PAGE_TYPE_BLOB:
+			memcpy(samples + n_samples * content_len,
+			       page + FIL_PAGE_DATA, content_len);
+			sizes[n_samples++] = content_len;
+			break;
+		}
+
+		mtr_commit(&mtr);
+	}
+
+	return(n_samples);
+}
+
+/** Write a Zstandard dictionary to page 0 and make it durable.
+@param[in]	space_id	tablespace id
+@param[in]	page_size	page size
+@param[in]	dict		dictionary contents
+@param[in]	len		length of the dictionary */
+static
+void
+fsp_header_write_zstd_dict(
+	space_id_t		space_id,
+	const page_size_t&	page_size,
+	const byte*		dict,
+	ulint			len)
+{
+	ut_ad(len <= fsp_header_get_zstd_dict_max_len(page_size));
+
+	mtr_t	mtr;
+
+	mtr_start(&mtr);
+
+	buf_block_t*	block = buf_page_get(
+		page_id_t(space_id, 0), page_size, RW_SX_LATCH, &mtr);
+	buf_block_dbg_add_level(block, SYNC_FSP_PAGE);
+
+	byte*	ptr = buf_block_get_frame(block)
+		+ fsp_header_get_zstd_dict_offset(page_size);
+
+	mlog_write_string(ptr + FSP_ZSTD_DICT_HEADER_LEN, dict, len, &mtr);
+	mlog_write_ulint(ptr + 8, ut_crc32(dict, len), MLOG_4BYTES, &mtr);
+	mlog_write_ulint(ptr + 4, len, MLOG_4BYTES, &mtr);
+	mlog_write_string(ptr, FSP_ZSTD_DICT_MAGIC,
+			  sizeof FSP_ZSTD_DICT_MAGIC, &mtr);
+
+	mtr_commit(&mtr);
+
+	/* Page 0 must reach the file before any page that is compressed
+	with the dictionary, or that page could not be read back after a
+	crash. Write page 0 alone, through the doublewrite buffer. */
+	buf_flush_page_and_wait(page_id_t(space_id, 0), mtr.commit_lsn());
+
+	fil_flush(space_id);
+}
+
+/** Number of Zstandard dictionary training threads that are running */
+std::atomic<ulint>	fsp_zstd_dict_n_threads(0);
+
+/** Zstandard dictionary training thread. Trains a dictionary from the
+pages of a tablespace and stores it in page 0. Sampling is abandoned at
+shutdown or when the tablespace is being dropped.
+@param[in,out]	space	tablespace, acquired by fsp_header_train_zstd_dict()
+			and released here */
+static
+void
+fsp_zstd_dict_thread(
+	fil_space_t*	space)
+{
+	const space_id_t	space_id = space->id;
+	const page_size_t	page_size(space->flags);
+	const page_no_t		n_pages = std::min(space->size,
+						   space->free_limit);
+	const ulint		content_len
+		= page_size.physical() - FIL_PAGE_DATA;
+	const ulint		max_len = std::min<ulint>(
+		srv_compression_zstd_dict_size,
+		fsp_header_get_zstd_dict_max_len(page_size));
+
+	byte*	samples = static_cast<byte*>(ut_malloc_nokey(
+		FSP_ZSTD_DICT_N_SAMPLES * content_len + max_len));
+	size_t*	sizes = static_cast<size_t*>(ut_malloc_nokey(
+		FSP_ZSTD_DICT_N_SAMPLES * sizeof(*sizes)));
+
+	Compression::Dictionary*	dict = NULL;
+
+	if (samples != NULL && sizes != NULL) {
+		byte*	dict_data = samples
+			+ FSP_ZSTD_DICT_N_SAMPLES * content_len;
+
+		ulint	n_samples = fsp_zstd_dict_sample(
+			space, page_size, n_pages, samples, sizes);
+
+		ulint	len = n_samples < FSP_ZSTD_DICT_MIN_SAMPLES
+			? 0
+			: Compression::train_dictionary(
+				samples, sizes, n_samples, dict_data, max_len);
+
+		if (len > 0) {
+			dict = Compression::create_dictionary(
+				dict_data, len, srv_compression_zstd_level);
+		}
+
+		if (dict != NULL) {
+			fsp_header_write_zstd_dict(
+				space_id, page_size, dict_data, len);
+
+			ib::info() << "Trained a Zstandard dictionary of "
+				<< len << " bytes from " << n_samples
+				<< " pages of " << space->name;
+		}
+	}
+
+	ut_free(samples);
+	ut_free(sizes);
+
+	fil_zstd_dict_train_end(space, dict);
+
+	fil_space_release(space);
+
+	fsp_zstd_dict_n_threads.fetch_sub(1);
+}
+
+/** Start training a Zstandard dictionary in the background for a
+tablespace that uses COMPRESSION="zstd", if innodb_compression_zstd_dict_size
+is set and the tablespace has none yet. Pages compressed after the
+dictionary is stored in page 0 use it.
+@param[in]	space_id	tablespace id */
+void
+fsp_header_train_zstd_dict(
+	space_id_t	space_id)
+{
+	if (srv_compression_zstd_dict_size == 0
+	    || srv_read_only_mode
+	    || srv_force_recovery > 0
+	    || recv_recovery_is_on()
+	    || srv_shutdown_state != SRV_SHUTDOWN_NONE) {
+		return;
+	}
+
+	fil_space_t*	space = fil_space_acquire_silent(space_id);
+
+	if (space == NULL) {
+		return;
+	}
+
+	if (!fil_zstd_dict_train_start(
+		    space,
+		    FSP_ZSTD_DICT_FIRST_PAGE + FSP_ZSTD_DICT_MIN_SAMPLES)) {
+
+		fil_space_release(space);
+		return;
+	}
+
+	/* Shutdown waits for the thread, see
+	srv_any_background_threads_are_active(). */
+	fsp_zstd_dict_n_threads.fetch_add(1);
+
+	os_thread_create(fsp_zstd_dict_thread_key, fsp_zstd_dict_thread, space);
+}
+
 /** Initializes the space header of a new created space and creates also the
 insert buffer tree root if space == 0.
 @param[in]	space_id	space id
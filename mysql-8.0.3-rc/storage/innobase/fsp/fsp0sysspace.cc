@@ -550,7 +550,13 @@ SysTablespace::read_lsn_and_check_flags(lsn_t* flushed_lsn)
 	ut_a(it->order() == 0);
 
 
-	buf_dblwr_init_or_load_pages(it->handle(), it->filepath());
+	err = buf_dblwr_init_or_load_pages(it->handle(), it->filepath());
+
+	if (err != DB_SUCCESS) {
+		it->close();
+
+		return(err);
+	}
 
 	/* Check the contents of the first page of the
 	first datafile. */
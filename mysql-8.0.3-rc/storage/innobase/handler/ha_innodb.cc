@@ -126,6 +126,7 @@ this program; if not, write to the Free Software Foundation, Inc.,
 #include "row0ins.h"
 #include "row0merge.h"
 #include "row0mysql.h"
+#include "row0pread.h"
 #include "row0quiesce.h"
 #include "row0sel.h"
 #include "row0upd.h"
@@ -334,6 +335,7 @@ static const char* innodb_debug_compress_names[] = {
 	"zlib",
 	"lz4",
 	"lz4hc",
+	"zstd",
 	NullS
 };
 
@@ -426,6 +428,22 @@ static TYPELIB innodb_default_row_format_typelib = {
 	NULL
 };
 
+/** Possible values of system variable "innodb_buffer_pool_dump_format". */
+static const char* innodb_buffer_pool_dump_format_names[] = {
+	"text",		/* BUF_DUMP_FORMAT_TEXT */
+	"binary",	/* BUF_DUMP_FORMAT_BINARY */
+	NullS
+};
+
+/** Used to define an enumerate type of the system variable
+innodb_buffer_pool_dump_format. */
+static TYPELIB innodb_buffer_pool_dump_format_typelib = {
+	array_elements(innodb_buffer_pool_dump_format_names) - 1,
+	"innodb_buffer_pool_dump_format_typelib",
+	innodb_buffer_pool_dump_format_names,
+	NULL
+};
+
 /* The following counter is used to convey information to InnoDB
 about server activity: in case of normal DML ops it is not
 sensible to call srv_active_wake_master_thread after each
@@ -586,6 +604,7 @@ is defined */
 static PSI_mutex_info all_innodb_mutexes[] = {
 	PSI_MUTEX_KEY(autoinc_mutex, 0, 0, PSI_DOCUMENT_ME),
 	PSI_MUTEX_KEY(autoinc_persisted_mutex, 0, 0, PSI_DOCUMENT_ME),
+	PSI_MUTEX_KEY(ahi_build_queue_mutex, 0, 0, PSI_DOCUMENT_ME),
 #  ifndef PFS_SKIP_BUFFER_MUTEX_RWLOCK
 	PSI_MUTEX_KEY(buffer_block_mutex, 0, 0, PSI_DOCUMENT_ME),
 #  endif /* !PFS_SKIP_BUFFER_MUTEX_RWLOCK */
@@ -650,7 +669,8 @@ static PSI_mutex_info all_innodb_mutexes[] = {
 	PSI_MUTEX_KEY(trx_pool_mutex, 0, 0, PSI_DOCUMENT_ME),
 	PSI_MUTEX_KEY(trx_pool_manager_mutex, 0, 0, PSI_DOCUMENT_ME),
 	PSI_MUTEX_KEY(srv_sys_mutex, 0, 0, PSI_DOCUMENT_ME),
-	PSI_MUTEX_KEY(lock_mutex, 0, 0, PSI_DOCUMENT_ME),
+	PSI_MUTEX_KEY(lock_sys_page_mutex, 0, 0, PSI_DOCUMENT_ME),
+	PSI_MUTEX_KEY(lock_sys_table_mutex, 0, 0, PSI_DOCUMENT_ME),
 	PSI_MUTEX_KEY(lock_wait_mutex, 0, 0, PSI_DOCUMENT_ME),
 	PSI_MUTEX_KEY(trx_mutex, 0, 0, PSI_DOCUMENT_ME),
 	PSI_MUTEX_KEY(srv_threads_mutex, 0, 0, PSI_DOCUMENT_ME),
@@ -663,6 +683,7 @@ static PSI_mutex_info all_innodb_mutexes[] = {
 	PSI_MUTEX_KEY(rtr_path_mutex, 0, 0, PSI_DOCUMENT_ME),
 	PSI_MUTEX_KEY(rtr_ssn_mutex, 0, 0, PSI_DOCUMENT_ME),
 	PSI_MUTEX_KEY(trx_sys_mutex, 0, 0, PSI_DOCUMENT_ME),
+	PSI_MUTEX_KEY(mvcc_view_mutex, 0, 0, PSI_DOCUMENT_ME),
 	PSI_MUTEX_KEY(zip_pad_mutex, 0, 0, PSI_DOCUMENT_ME),
 	PSI_MUTEX_KEY(master_key_id_mutex, 0, 0, PSI_DOCUMENT_ME),
 	PSI_MUTEX_KEY(sync_array_mutex, 0, 0, PSI_DOCUMENT_ME),
@@ -687,6 +708,8 @@ static PSI_rwlock_info all_innodb_rwlocks[] = {
 	PSI_RWLOCK_KEY(dict_persist_checkpoint, 0, PSI_DOCUMENT_ME),
 	PSI_RWLOCK_KEY(fil_space_latch, 0, PSI_DOCUMENT_ME),
 	PSI_RWLOCK_KEY(checkpoint_lock, 0, PSI_DOCUMENT_ME),
+	PSI_RWLOCK_KEY(log_sn_lock, 0, PSI_DOCUMENT_ME),
+	PSI_RWLOCK_KEY(lock_sys_latch, 0, PSI_DOCUMENT_ME),
 	PSI_RWLOCK_KEY(undo_spaces_lock, 0, PSI_DOCUMENT_ME),
 	PSI_RWLOCK_KEY(rsegs_lock, 0, PSI_DOCUMENT_ME),
 	PSI_RWLOCK_KEY(fts_cache_rw_lock, 0, PSI_DOCUMENT_ME),
@@ -706,14 +729,25 @@ performance schema instrumented if "UNIV_PFS_THREAD"
 is defined */
 static PSI_thread_info	all_innodb_threads[] = {
 	PSI_KEY(archiver_thread, 0, 0, PSI_DOCUMENT_ME),
+	PSI_KEY(btr_search_build_thread, 0, 0, PSI_DOCUMENT_ME),
+	PSI_KEY(buf_dblwr_recover_thread, 0, 0, PSI_DOCUMENT_ME),
 	PSI_KEY(buf_dump_thread, 0, 0, PSI_DOCUMENT_ME),
+	PSI_KEY(buf_load_thread, 0, 0, PSI_DOCUMENT_ME),
+	PSI_KEY(dict_stats_analyze_thread, 0, 0, PSI_DOCUMENT_ME),
 	PSI_KEY(dict_stats_thread, 0, 0, PSI_DOCUMENT_ME),
+	PSI_KEY(fil_scan_thread, 0, 0, PSI_DOCUMENT_ME),
+	PSI_KEY(fsp_zstd_dict_thread, 0, 0, PSI_DOCUMENT_ME),
+	PSI_KEY(ibuf_merge_thread, 0, 0, PSI_DOCUMENT_ME),
 	PSI_KEY(io_handler_thread, 0, 0, PSI_DOCUMENT_ME),
 	PSI_KEY(io_ibuf_thread, 0, 0, PSI_DOCUMENT_ME),
 	PSI_KEY(io_log_thread, 0, 0, PSI_DOCUMENT_ME),
 	PSI_KEY(io_read_thread, 0, 0, PSI_DOCUMENT_ME),
 	PSI_KEY(io_write_thread, 0, 0, PSI_DOCUMENT_ME),
+	PSI_KEY(lock_deadlock_detector_thread, 0, 0, PSI_DOCUMENT_ME),
+	PSI_KEY(log_flusher_thread, 0, 0, PSI_DOCUMENT_ME),
+	PSI_KEY(log_writer_thread, 0, 0, PSI_DOCUMENT_ME),
 	PSI_KEY(buf_resize_thread, 0, 0, PSI_DOCUMENT_ME),
+	PSI_KEY(recv_apply_thread, 0, 0, PSI_DOCUMENT_ME),
 	PSI_KEY(recv_writer_thread, 0, 0, PSI_DOCUMENT_ME),
 	PSI_KEY(srv_error_monitor_thread, 0, 0, PSI_DOCUMENT_ME),
 	PSI_KEY(srv_lock_timeout_thread, 0, 0, PSI_DOCUMENT_ME),
@@ -723,10 +757,12 @@ static PSI_thread_info	all_innodb_threads[] = {
 	PSI_KEY(srv_worker_thread, 0, 0, PSI_DOCUMENT_ME),
 	PSI_KEY(trx_recovery_rollback_thread, 0, 0, PSI_DOCUMENT_ME),
 	PSI_KEY(page_flush_thread, 0, 0, PSI_DOCUMENT_ME),
+	PSI_KEY(parallel_read_thread, 0, 0, PSI_DOCUMENT_ME),
 	PSI_KEY(page_flush_coordinator_thread, 0, 0, PSI_DOCUMENT_ME),
 	PSI_KEY(fts_optimize_thread, 0, 0, PSI_DOCUMENT_ME),
 	PSI_KEY(fts_parallel_merge_thread, 0, 0, PSI_DOCUMENT_ME),
-	PSI_KEY(fts_parallel_tokenization_thread, 0, 0, PSI_DOCUMENT_ME)
+	PSI_KEY(fts_parallel_tokenization_thread, 0, 0, PSI_DOCUMENT_ME),
+	PSI_KEY(index_build_thread, 0, 0, PSI_DOCUMENT_ME)
 };
 # endif /* UNIV_PFS_THREAD */
 
@@ -2576,7 +2612,7 @@ Compression::is_none(const char* algorithm)
 	return(false);
 }
 
-/** Check for supported COMPRESS := (ZLIB | LZ4 | NONE) supported values
+/** Check for supported COMPRESS := (ZLIB | LZ4 | ZSTD | NONE) supported values
 @param[in]	algorithm	Name of the compression algorithm
 @param[out]	compression	The compression algorithm
 @return DB_SUCCESS or DB_UNSUPPORTED */
@@ -2597,6 +2633,12 @@ Compression::check(
 
 		compression->m_type = LZ4;
 
+#ifdef HAVE_LIBZSTD
+	} else if (innobase_strcasecmp(algorithm, "zstd") == 0) {
+
+		compression->m_type = ZSTD;
+#endif /* HAVE_LIBZSTD */
+
 	} else {
 		return(DB_UNSUPPORTED);
 	}
@@ -4285,6 +4327,15 @@ innodb_init_params()
 	srv_use_native_aio = FALSE;
 #endif
 
+#ifdef LINUX_IO_URING
+	/* io_uring is only used as a backend of Linux native AIO. */
+	if (!srv_use_native_aio) {
+		srv_use_io_uring = FALSE;
+	}
+#else
+	srv_use_io_uring = FALSE;
+#endif /* LINUX_IO_URING */
+
 #ifndef _WIN32
 	acquire_sysvar_source_service();
 	/* Check if innodb_dedicated_server == ON and O_DIRECT is supported */
@@ -4328,19 +4379,28 @@ innodb_init_params()
 	srv_max_n_threads = 1   /* io_ibuf_thread */
 			    + 1 /* io_log_thread */
 			    + 1 /* lock_wait_timeout_thread */
+			    + 1 /* lock_deadlock_detector_thread */
 			    + 1 /* srv_error_monitor_thread */
 			    + 1 /* srv_monitor_thread */
 			    + 1 /* srv_master_thread */
 			    + 1 /* srv_purge_coordinator_thread */
 			    + 1 /* buf_dump_thread */
 			    + 1 /* dict_stats_thread */
+			    + 1 /* btr_search_build_thread */
+			    + 1 /* ibuf_merge_thread */
 			    + 1 /* fts_optimize_thread */
 			    + 1 /* recv_writer_thread */
+			    + srv_n_recv_apply_threads
+			    + MAX_PARALLEL_READ_THREADS
+			    + MAX_INDEX_BUILD_THREADS
+			    + MAX_BUF_LOAD_THREADS
+			    + MAX_STATS_ANALYZE_THREADS
 			    + 1 /* trx_rollback_or_clean_all_recovered */
 			    + 128 /* added as margin, for use of
 				  InnoDB Memcached etc. */
 			    + max_connections
 			    + srv_n_read_io_threads
+			    + srv_n_read_io_threads /* buf_dblwr_recover_thread */
 			    + srv_n_write_io_threads
 			    + srv_n_purge_threads
 			    + srv_n_page_cleaners
@@ -7110,6 +7170,7 @@ reload:
 		ut_error;
 
 	case DB_SUCCESS:
+		fsp_header_train_zstd_dict(m_prebuilt->table->space);
 		break;
 	}
 
@@ -9805,10 +9866,19 @@ ha_innobase::general_fetch(
 			DB_FORCED_ABORT, 0,  m_user_thd));
 	}
 
-	innobase_srv_conc_enter_innodb(m_prebuilt);
-
 	dberr_t	ret;
 
+	/* Serve the rest of the batch that the previous call prefetched
+	without entering InnoDB again. */
+	if (!intrinsic && row_search_fetch_cached(buf, m_prebuilt, direction)) {
+
+		srv_stats.n_rows_read.add(thd_get_thread_id(trx->mysql_thd), 1);
+
+		DBUG_RETURN(0);
+	}
+
+	innobase_srv_conc_enter_innodb(m_prebuilt);
+
 	if (!intrinsic) {
 
 		ret = row_search_mvcc(
@@ -17838,11 +17908,7 @@ ha_innobase::external_lock(
 		} else if (trx->isolation_level <= TRX_ISO_READ_COMMITTED
 			   && MVCC::is_view_active(trx->read_view)) {
 
-			mutex_enter(&trx_sys->mutex);
-
 			trx_sys->mvcc->view_close(trx->read_view, true);
-
-			mutex_exit(&trx_sys->mutex);
 		}
 	}
 
@@ -18505,11 +18571,7 @@ ha_innobase::store_lock(
 			/* At low transaction isolation levels we let
 			each consistent read set its own snapshot */
 
-			mutex_enter(&trx_sys->mutex);
-
 			trx_sys->mvcc->view_close(trx->read_view, true);
-
-			mutex_exit(&trx_sys->mutex);
 		}
 	}
 
@@ -20697,14 +20759,14 @@ checkpoint_now_set(
 {
 	if (*(bool*) save && !srv_checkpoint_disabled) {
 
-		while (log_sys->last_checkpoint_lsn < log_sys->lsn) {
+		while (log_sys->last_checkpoint_lsn < log_get_lsn()) {
 
 			log_make_checkpoint_at(LSN_MAX, TRUE);
 
 			fil_flush_file_spaces(to_int(FIL_TYPE_LOG));
 		}
 
-		fil_write_flushed_lsn(log_sys->lsn);
+		fil_write_flushed_lsn(log_get_lsn());
 	}
 }
 
@@ -20943,10 +21005,10 @@ innodb_log_checksums_update(
 	bool	check = *static_cast<bool*>(var_ptr)
 		= *static_cast<const bool*>(save);
 
-	/* Make sure we are the only log user */
-	mutex_enter(&log_sys->mutex);
+	/* Make sure that no log write is calculating the checksums */
+	log_write_mutex_enter();
 	innodb_log_checksums_func_update(check);
-	mutex_exit(&log_sys->mutex);
+	log_write_mutex_exit();
 }
 
 static SHOW_VAR innodb_status_variables_export[]= {
@@ -21074,6 +21136,24 @@ static MYSQL_SYSVAR_ULONG(purge_threads, srv_n_purge_threads,
   1,			/* Minimum value */
   MAX_PURGE_THREADS, 0);/* Maximum value */
 
+static MYSQL_SYSVAR_ULONG(recovery_apply_threads, srv_n_recv_apply_threads,
+  PLUGIN_VAR_OPCMDARG | PLUGIN_VAR_READONLY,
+  "Number of threads that apply redo log records to pages in crash"
+  " recovery, from 1 to 64. Default is 4.",
+  NULL, NULL,
+  4,			/* Default setting */
+  1,			/* Minimum value */
+  MAX_RECV_APPLY_THREADS, 0);/* Maximum value */
+
+static MYSQL_SYSVAR_ULONG(parallel_read_threads, srv_parallel_read_threads,
+  PLUGIN_VAR_OPCMDARG,
+  "Number of threads that scan the clustered index for COUNT(*) and"
+  " CHECK TABLE, from 1 to 256. Default is 4.",
+  NULL, NULL,
+  4,			/* Default setting */
+  1,			/* Minimum value */
+  MAX_PARALLEL_READ_THREADS, 0);/* Maximum value */
+
 static MYSQL_SYSVAR_ULONG(sync_array_size, srv_sync_array_size,
   PLUGIN_VAR_OPCMDARG | PLUGIN_VAR_READONLY,
   "Size of the mutex/lock wait array.",
@@ -21222,6 +21302,15 @@ static MYSQL_SYSVAR_ULONGLONG(stats_persistent_sample_pages,
   " statistics (by ANALYZE, default 20)",
   NULL, NULL, 20, 1, ~0ULL, 0);
 
+static MYSQL_SYSVAR_ULONG(stats_analyze_threads, srv_stats_analyze_threads,
+  PLUGIN_VAR_OPCMDARG,
+  "Number of threads that analyze the indexes of a table concurrently"
+  " when calculating persistent statistics, from 1 to 64. Default is 4.",
+  NULL, NULL,
+  4,			/* Default setting */
+  1,			/* Minimum value */
+  MAX_STATS_ANALYZE_THREADS, 0);/* Maximum value */
+
 static MYSQL_SYSVAR_BOOL(adaptive_hash_index, btr_search_enabled,
   PLUGIN_VAR_OPCMDARG,
   "Enable InnoDB adaptive hash index (enabled by default). "
@@ -21236,6 +21325,12 @@ static MYSQL_SYSVAR_ULONG(adaptive_hash_index_parts, btr_ahi_parts,
   "Number of InnoDB Adapative Hash Index Partitions. (default = 8). ",
   NULL, NULL, 8, 1, 512, 0);
 
+static MYSQL_SYSVAR_BOOL(page_search_cache, srv_page_search_cache,
+  PLUGIN_VAR_NOCMDARG,
+  "Whether frequently searched index pages cache the key prefixes of"
+  " their page directory slots to speed up the search within the page.",
+  NULL, NULL, FALSE);
+
 static MYSQL_SYSVAR_ULONG(replication_delay, srv_replication_delay,
   PLUGIN_VAR_RQCMDARG,
   "Replication thread delay (ms) on the slave server if"
@@ -21248,6 +21343,22 @@ static MYSQL_SYSVAR_UINT(compression_level, page_zip_level,
   ", 1 is fastest, 9 is best compression and default is 6.",
   NULL, NULL, DEFAULT_COMPRESSION_LEVEL, 0, 9, 0);
 
+static MYSQL_SYSVAR_ULONG(compression_zstd_level, srv_compression_zstd_level,
+  PLUGIN_VAR_RQCMDARG,
+  "Zstandard level used for COMPRESSION=\"zstd\" tables. 1 is fastest,"
+  " 22 is best compression and default is 3.",
+  NULL, NULL, 3, 1, 22, 0);
+
+static MYSQL_SYSVAR_ULONG(compression_zstd_dict_size,
+  srv_compression_zstd_dict_size,
+  PLUGIN_VAR_RQCMDARG,
+  "Maximum size in bytes of the Zstandard dictionary trained in the"
+  " background from the pages of a COMPRESSION=\"zstd\" table after it is"
+  " first opened, and stored in"
+  " its tablespace header, which also limits its size. 0 (the default)"
+  " disables dictionaries.",
+  NULL, NULL, 0, 0, 32768, 0);
+
 static MYSQL_SYSVAR_BOOL(log_compressed_pages, page_zip_log_pages,
        PLUGIN_VAR_OPCMDARG,
   "Enables/disables the logging of entire compressed page images."
@@ -21316,7 +21427,8 @@ static MYSQL_SYSVAR_ULONG(page_hash_locks, srv_n_page_hash_locks,
 
 static MYSQL_SYSVAR_ULONG(doublewrite_batch_size, srv_doublewrite_batch_size,
   PLUGIN_VAR_OPCMDARG | PLUGIN_VAR_READONLY,
-  "Number of pages reserved in doublewrite buffer for batch flushing",
+  "Number of pages reserved in the doublewrite file of each buffer pool"
+  " instance for LRU batch flushing, and as many for flush list batch flushing",
   NULL, NULL, 120, 1, 127, 0);
 #endif /* defined UNIV_DEBUG || defined UNIV_PERF_DEBUG */
 
@@ -21345,6 +21457,13 @@ static MYSQL_SYSVAR_ULONG(buffer_pool_dump_pct, srv_buf_pool_dump_pct,
   "Dump only the hottest N% of each buffer pool, defaults to 25",
   NULL, NULL, 25, 1, 100, 0);
 
+static MYSQL_SYSVAR_ENUM(buffer_pool_dump_format, srv_buf_pool_dump_format,
+  PLUGIN_VAR_RQCMDARG,
+  "Format of the buffer pool dump file. Possible values are TEXT (default),"
+  " one space,page line per page, and BINARY, which is smaller and faster"
+  " to write. A load accepts both formats",
+  NULL, NULL, BUF_DUMP_FORMAT_TEXT, &innodb_buffer_pool_dump_format_typelib);
+
 #ifdef UNIV_DEBUG
 static MYSQL_SYSVAR_STR(buffer_pool_evict, srv_buffer_pool_evict,
   PLUGIN_VAR_RQCMDARG,
@@ -21362,6 +21481,15 @@ static MYSQL_SYSVAR_BOOL(buffer_pool_load_abort, innodb_buffer_pool_load_abort,
   "Abort a currently running load of the buffer pool",
   NULL, buffer_pool_load_abort, FALSE);
 
+static MYSQL_SYSVAR_ULONG(buffer_pool_load_threads, srv_buf_pool_load_threads,
+  PLUGIN_VAR_OPCMDARG,
+  "Number of threads that read the pages of a buffer pool load,"
+  " from 1 to 64. Default is 4.",
+  NULL, NULL,
+  4,			/* Default setting */
+  1,			/* Minimum value */
+  MAX_BUF_LOAD_THREADS, 0);/* Maximum value */
+
 /* there is no point in changing this during runtime, thus readonly */
 static MYSQL_SYSVAR_BOOL(buffer_pool_load_at_startup, srv_buffer_pool_load_at_startup,
   PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_READONLY | PLUGIN_VAR_NOPERSIST,
@@ -21398,6 +21526,13 @@ static MYSQL_SYSVAR_BOOL(deadlock_detect, innobase_deadlock_detect,
   " and we rely on innodb_lock_wait_timeout in case of deadlock.",
   NULL, NULL, TRUE);
 
+static MYSQL_SYSVAR_BOOL(deadlock_detect_async, innobase_deadlock_detect_async,
+  PLUGIN_VAR_NOCMDARG,
+  "Search for deadlocks in a background thread instead of in the thread"
+  " that starts a lock wait (default OFF). Only used if"
+  " innodb_deadlock_detect is ON.",
+  NULL, NULL, FALSE);
+
 static MYSQL_SYSVAR_LONG(fill_factor, innobase_fill_factor,
   PLUGIN_VAR_RQCMDARG,
   "Percentage of B-tree page filled during bulk insert",
@@ -21459,6 +21594,15 @@ static MYSQL_SYSVAR_ULONG(sort_buffer_size, srv_sort_buf_size,
   "Memory buffer size for index creation",
   NULL, NULL, 1048576, 65536, 64<<20, 0);
 
+static MYSQL_SYSVAR_ULONG(index_build_threads, srv_index_build_threads,
+  PLUGIN_VAR_OPCMDARG,
+  "Number of threads that sort and load secondary indexes concurrently"
+  " in index creation, from 1 to 64. Default is 4.",
+  NULL, NULL,
+  4,			/* Default setting */
+  1,			/* Minimum value */
+  MAX_INDEX_BUILD_THREADS, 0);/* Maximum value */
+
 static MYSQL_SYSVAR_ULONGLONG(online_alter_log_max_size, srv_online_max_size,
   PLUGIN_VAR_RQCMDARG,
   "Maximum modification log file size for online index creation",
@@ -21519,6 +21663,12 @@ static MYSQL_SYSVAR_ULONG(log_write_ahead_size, srv_log_write_ahead_size,
   NULL, innodb_log_write_ahead_size_update,
   8*1024L, OS_FILE_LOG_BLOCK_SIZE, UNIV_PAGE_SIZE_DEF, OS_FILE_LOG_BLOCK_SIZE);
 
+static MYSQL_SYSVAR_ULONG(log_wait_spin_rounds, srv_log_wait_spin_rounds,
+  PLUGIN_VAR_RQCMDARG,
+  "Number of rounds a thread spins waiting for the log writer or the log"
+  " flusher thread before it goes to sleep (0 by default, no spinning)",
+  NULL, NULL, 0L, 0L, 1000000L, 0);
+
 static MYSQL_SYSVAR_UINT(old_blocks_pct, innobase_old_blocks_pct,
   PLUGIN_VAR_RQCMDARG,
   "Percentage of the buffer pool to reserve for 'old' blocks.",
@@ -21650,6 +21800,12 @@ static MYSQL_SYSVAR_BOOL(use_native_aio, srv_use_native_aio,
   "Use native AIO if supported on this platform.",
   NULL, NULL, TRUE);
 
+static MYSQL_SYSVAR_BOOL(use_io_uring, srv_use_io_uring,
+  PLUGIN_VAR_NOCMDARG | PLUGIN_VAR_READONLY,
+  "Use io_uring instead of libaio for native AIO on Linux, if supported"
+  " by the kernel (default OFF). Only used if innodb_use_native_aio is ON.",
+  NULL, NULL, FALSE);
+
 #ifdef HAVE_LIBNUMA
 static MYSQL_SYSVAR_BOOL(numa_interleave, srv_numa_interleave,
   PLUGIN_VAR_NOCMDARG | PLUGIN_VAR_READONLY,
@@ -21738,6 +21894,13 @@ static MYSQL_SYSVAR_ULONG(read_ahead_threshold, srv_read_ahead_threshold,
   " trigger a readahead.",
   NULL, NULL, 56, 0, 64, 0);
 
+static MYSQL_SYSVAR_ULONG(read_ahead_leaf_pages, srv_read_ahead_leaf_pages,
+  PLUGIN_VAR_RQCMDARG,
+  "Maximum number of B-tree leaf pages that an index scan reads ahead of"
+  " its position. The depth grows with the number of consecutive pages"
+  " scanned. 0 disables the leaf read-ahead.",
+  NULL, NULL, 32, 0, 256, 0);
+
 static MYSQL_SYSVAR_STR(monitor_enable, innobase_enable_monitor_counter,
   PLUGIN_VAR_RQCMDARG,
   "Turn on a monitor counter",
@@ -21824,6 +21987,12 @@ static MYSQL_SYSVAR_UINT(trx_rseg_n_slots_debug, trx_rseg_n_slots_debug,
   "Debug flags for InnoDB to limit TRX_RSEG_N_SLOTS for trx_rsegf_undo_find_free()",
   NULL, NULL, 0, 0, 1024, 0);
 
+static MYSQL_SYSVAR_UINT(recovery_apply_pages_per_thread_debug,
+  recv_apply_pages_per_thread_debug, PLUGIN_VAR_RQCMDARG,
+  "Minimum number of pages in a crash recovery apply batch for each apply"
+  " thread (0=default of 256).",
+  NULL, NULL, 0, 0, 256, 0);
+
 static MYSQL_SYSVAR_UINT(limit_optimistic_insert_debug,
   btr_cur_limit_optimistic_insert_debug, PLUGIN_VAR_RQCMDARG,
   "Artificially limit the number of records per B-tree page (0=unlimited).",
@@ -21898,11 +22067,13 @@ static struct st_mysql_sys_var* innobase_system_variables[]= {
   MYSQL_SYSVAR(buffer_pool_dump_now),
   MYSQL_SYSVAR(buffer_pool_dump_at_shutdown),
   MYSQL_SYSVAR(buffer_pool_dump_pct),
+  MYSQL_SYSVAR(buffer_pool_dump_format),
 #ifdef UNIV_DEBUG
   MYSQL_SYSVAR(buffer_pool_evict),
 #endif /* UNIV_DEBUG */
   MYSQL_SYSVAR(buffer_pool_load_now),
   MYSQL_SYSVAR(buffer_pool_load_abort),
+  MYSQL_SYSVAR(buffer_pool_load_threads),
   MYSQL_SYSVAR(buffer_pool_load_at_startup),
   MYSQL_SYSVAR(lru_scan_depth),
   MYSQL_SYSVAR(flush_neighbors),
@@ -21911,6 +22082,8 @@ static struct st_mysql_sys_var* innobase_system_variables[]= {
   MYSQL_SYSVAR(commit_concurrency),
   MYSQL_SYSVAR(concurrency_tickets),
   MYSQL_SYSVAR(compression_level),
+  MYSQL_SYSVAR(compression_zstd_level),
+  MYSQL_SYSVAR(compression_zstd_dict_size),
   MYSQL_SYSVAR(data_file_path),
   MYSQL_SYSVAR(temp_data_file_path),
   MYSQL_SYSVAR(data_home_dir),
@@ -21942,11 +22115,13 @@ static struct st_mysql_sys_var* innobase_system_variables[]= {
   MYSQL_SYSVAR(force_load_corrupted),
   MYSQL_SYSVAR(lock_wait_timeout),
   MYSQL_SYSVAR(deadlock_detect),
+  MYSQL_SYSVAR(deadlock_detect_async),
   MYSQL_SYSVAR(page_size),
   MYSQL_SYSVAR(log_buffer_size),
   MYSQL_SYSVAR(log_file_size),
   MYSQL_SYSVAR(log_files_in_group),
   MYSQL_SYSVAR(log_write_ahead_size),
+  MYSQL_SYSVAR(log_wait_spin_rounds),
   MYSQL_SYSVAR(log_group_home_dir),
   MYSQL_SYSVAR(log_compressed_pages),
   MYSQL_SYSVAR(max_dirty_pages_pct),
@@ -21971,14 +22146,17 @@ static struct st_mysql_sys_var* innobase_system_variables[]= {
   MYSQL_SYSVAR(stats_transient_sample_pages),
   MYSQL_SYSVAR(stats_persistent),
   MYSQL_SYSVAR(stats_persistent_sample_pages),
+  MYSQL_SYSVAR(stats_analyze_threads),
   MYSQL_SYSVAR(stats_auto_recalc),
   MYSQL_SYSVAR(adaptive_hash_index),
   MYSQL_SYSVAR(adaptive_hash_index_parts),
+  MYSQL_SYSVAR(page_search_cache),
   MYSQL_SYSVAR(stats_method),
   MYSQL_SYSVAR(replication_delay),
   MYSQL_SYSVAR(status_file),
   MYSQL_SYSVAR(strict_mode),
   MYSQL_SYSVAR(sort_buffer_size),
+  MYSQL_SYSVAR(index_build_threads),
   MYSQL_SYSVAR(online_alter_log_max_size),
   MYSQL_SYSVAR(scan_directories),
   MYSQL_SYSVAR(sync_spin_loops),
@@ -21991,6 +22169,7 @@ static struct st_mysql_sys_var* innobase_system_variables[]= {
   MYSQL_SYSVAR(autoinc_lock_mode),
   MYSQL_SYSVAR(version),
   MYSQL_SYSVAR(use_native_aio),
+  MYSQL_SYSVAR(use_io_uring),
 #ifdef HAVE_LIBNUMA
   MYSQL_SYSVAR(numa_interleave),
 #endif /* HAVE_LIBNUMA */
@@ -22002,6 +22181,7 @@ static struct st_mysql_sys_var* innobase_system_variables[]= {
 #endif /* UNIV_DEBUG || UNIV_IBUF_DEBUG */
   MYSQL_SYSVAR(random_read_ahead),
   MYSQL_SYSVAR(read_ahead_threshold),
+  MYSQL_SYSVAR(read_ahead_leaf_pages),
   MYSQL_SYSVAR(read_only),
   MYSQL_SYSVAR(io_capacity),
   MYSQL_SYSVAR(io_capacity_max),
@@ -22011,6 +22191,8 @@ static struct st_mysql_sys_var* innobase_system_variables[]= {
   MYSQL_SYSVAR(monitor_reset),
   MYSQL_SYSVAR(monitor_reset_all),
   MYSQL_SYSVAR(purge_threads),
+  MYSQL_SYSVAR(recovery_apply_threads),
+  MYSQL_SYSVAR(parallel_read_threads),
   MYSQL_SYSVAR(purge_batch_size),
 #ifdef UNIV_DEBUG
   MYSQL_SYSVAR(background_drop_list_empty),
@@ -22044,6 +22226,7 @@ static struct st_mysql_sys_var* innobase_system_variables[]= {
   MYSQL_SYSVAR(print_ddl_logs),
 #ifdef UNIV_DEBUG
   MYSQL_SYSVAR(trx_rseg_n_slots_debug),
+  MYSQL_SYSVAR(recovery_apply_pages_per_thread_debug),
   MYSQL_SYSVAR(limit_optimistic_insert_debug),
   MYSQL_SYSVAR(trx_purge_view_update_only_debug),
   MYSQL_SYSVAR(fil_make_page_dirty_debug),
@@ -22604,11 +22787,18 @@ bool ha_innobase::is_record_buffer_wanted(ha_rows* const max_rows) const
 		return false;
 	}
 
-	/* Limit the number of rows in the buffer to 100 for now. We may want
-	to fine-tune this later, possibly taking record size and page size into
-	account. The optimizer might allocate an even smaller buffer if it
-	thinks a smaller number of rows will be fetched. */
-	*max_rows = 100;
+	/* Ask for as many rows as fit in a leaf page of the index, so that
+	row_search_mvcc() restores the cursor and latches a page about once
+	per page rather than once per 100 rows. The optimizer limits the
+	total size of the buffer, and it might allocate an even smaller buffer
+	if it thinks a smaller number of rows will be fetched. */
+	const ulint	min_rec_len = dict_index_calc_min_rec_len(
+		m_prebuilt->index);
+
+	*max_rows = ut_min(
+		ut_max(srv_page_size / ut_max(min_rec_len, ulint(1)),
+		       ulint(100)),
+		ulint(MYSQL_FETCH_BATCH_MAX));
 	return true;
 }
 
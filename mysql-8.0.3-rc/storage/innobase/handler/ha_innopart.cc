@@ -273,6 +273,7 @@ Ha_innopart_share::open_one_table_part(
 			ut_error;
 
 		case DB_SUCCESS:
+			fsp_header_train_zstd_dict(part_table->space);
 			break;
 		}
 	}
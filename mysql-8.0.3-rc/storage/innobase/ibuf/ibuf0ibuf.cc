@@ -203,6 +203,12 @@ uint	ibuf_debug;
 /** The insert buffer control structure */
 ibuf_t*	ibuf			= NULL;
 
+/** Event to wake up ibuf_merge_thread() */
+os_event_t	ibuf_merge_event;
+
+/** true if ibuf_merge_thread() is running */
+bool		ibuf_merge_thread_active	= false;
+
 #ifdef UNIV_IBUF_COUNT_DEBUG
 /** Number of tablespaces in the ibuf_counts array */
 #define IBUF_COUNT_N_SPACES	4
@@ -300,6 +306,19 @@ const ulint		IBUF_MERGE_THRESHOLD = 4;
 batch, in order to merge the entries for them in the insert buffer */
 const ulint		IBUF_MAX_N_PAGES_MERGED = IBUF_MERGE_AREA;
 
+/** In ibuf_merge_pages_in_order() at most this number of pages of one
+tablespace is read to memory in one batch */
+const ulint		IBUF_MAX_N_PAGES_MERGED_IN_ORDER = 32;
+
+/** Position of a merge that sweeps the ibuf tree in key order */
+struct ibuf_merge_pos_t {
+	/** tablespace of the next page to merge */
+	space_id_t	space;
+
+	/** next page to merge */
+	page_no_t	page_no;
+};
+
 /** If the combined size of the ibuf trees exceeds ibuf->max_size by this
 many pages, we start to contract it in connection to inserts there, using
 non-synchronous contract */
@@ -463,6 +482,8 @@ ibuf_close(void)
 
 	mutex_free(&ibuf_bitmap_mutex);
 
+	os_event_destroy(ibuf_merge_event);
+
 	dict_table_t*	ibuf_table = ibuf->index->table;
 	rw_lock_free(&ibuf->index->lock);
 	dict_mem_index_free(ibuf->index);
@@ -516,6 +537,8 @@ ibuf_init_at_db_start(void)
 
 	mutex_create(LATCH_ID_IBUF, &ibuf_mutex);
 
+	ibuf_merge_event = os_event_create(0);
+
 	mutex_create(LATCH_ID_IBUF_BITMAP, &ibuf_bitmap_mutex);
 
 	mutex_create(LATCH_ID_IBUF_PESSIMISTIC_INSERT,
@@ -2625,18 +2648,100 @@ ibuf_merge_space(
 	return(n_pages);
 }
 
+/** Contract the change buffer by reading the pages of one tablespace, in
+ascending page number order, starting at a position that is carried over
+from the previous call. Unlike ibuf_merge_pages(), repeated calls visit
+every buffered page once before returning to the same part of the tree,
+and the reads of one batch are sequential within the tablespace.
+@param[in,out]	pos		position of the sweep
+@param[out]	n_pages		number of pages merged
+@param[in]	sync		whether the caller waits for the read of
+the last page of the batch to complete
+@return a lower limit for the combined size in bytes of entries which
+will be merged from ibuf trees to the pages read, 0 if ibuf is
+empty */
+static MY_ATTRIBUTE((warn_unused_result))
+ulint
+ibuf_merge_pages_in_order(
+	ibuf_merge_pos_t*	pos,
+	ulint*			n_pages,
+	bool			sync)
+{
+	page_no_t	page_nos[IBUF_MAX_N_PAGES_MERGED_IN_ORDER];
+	space_id_t	space_ids[IBUF_MAX_N_PAGES_MERGED_IN_ORDER];
+	ulint		sum_sizes = 0;
+
+	*n_pages = 0;
+
+	/* When the end of the tree is reached, start over from the
+	beginning once. */
+	for (ulint n_tries = 0; *n_pages == 0 && n_tries < 2; ++n_tries) {
+		mtr_t		mtr;
+		btr_pcur_t	pcur;
+		mem_heap_t*	heap = mem_heap_create(512);
+		dtuple_t*	tuple = ibuf_search_tuple_build(
+			pos->space, pos->page_no, heap);
+
+		ibuf_mtr_start(&mtr);
+
+		btr_pcur_open(
+			ibuf->index, tuple, PAGE_CUR_GE, BTR_SEARCH_LEAF,
+			&pcur, &mtr);
+
+		mem_heap_free(heap);
+
+		ut_ad(page_validate(btr_pcur_get_page(&pcur), ibuf->index));
+
+		const rec_t*	rec = ibuf_get_user_rec(&pcur, &mtr);
+
+		if (rec != NULL) {
+			sum_sizes = ibuf_get_merge_pages(
+				&pcur, ibuf_rec_get_space(&mtr, rec),
+				IBUF_MAX_N_PAGES_MERGED_IN_ORDER,
+				page_nos, space_ids, n_pages, &mtr);
+		}
+
+		ibuf_mtr_commit(&mtr);
+		btr_pcur_close(&pcur);
+
+		if (*n_pages > 0) {
+			pos->space = space_ids[*n_pages - 1];
+			pos->page_no = page_nos[*n_pages - 1] + 1;
+		} else if (pos->space == 0 && pos->page_no == 0) {
+			/* The whole tree was searched. */
+			break;
+		} else {
+			pos->space = 0;
+			pos->page_no = 0;
+		}
+	}
+
+	if (*n_pages == 0) {
+		return(0);
+	}
+
+	MONITOR_INC_VALUE(MONITOR_IBUF_MERGE_READ_PAGES, *n_pages);
+
+	buf_read_ibuf_merge_pages(sync, space_ids, page_nos, *n_pages);
+
+	return(sum_sizes + 1);
+}
+
 /** Contract the change buffer by reading pages to the buffer pool.
 @param[out]	n_pages		number of pages merged
 @param[in]	sync		whether the caller waits for
 the issued reads to complete
+@param[in,out]	pos		position of an in-order sweep over the
+tree, or NULL to merge around a random position
 @return a lower limit for the combined size in bytes of entries which
 will be merged from ibuf trees to the pages read, 0 if ibuf is
 empty */
 static MY_ATTRIBUTE((warn_unused_result))
 ulint
 ibuf_merge(
-	ulint*		n_pages,
-	bool		sync)
+	ulint*			n_pages,
+	bool			sync,
+	ibuf_merge_pos_t*	pos)
 {
 	*n_pages = 0;
 
@@ -2651,6 +2756,8 @@ ibuf_merge(
 	} else if (ibuf_debug) {
 		return(0);
 #endif /* UNIV_DEBUG || UNIV_IBUF_DEBUG */
+	} else if (pos != NULL) {
+		return(ibuf_merge_pages_in_order(pos, n_pages, sync));
 	} else {
 		return(ibuf_merge_pages(n_pages, sync));
 	}
@@ -2687,6 +2794,11 @@ ibuf_merge_in_background(
 	ulint	n_pag2;
 	ulint	n_pages;
 
+	/* Only the master thread calls this. It sweeps the tree in order,
+	so that a slow shutdown reads every page with buffered changes
+	once instead of looking for them at random positions. */
+	static ibuf_merge_pos_t	merge_pos;
+
 #if defined UNIV_DEBUG || defined UNIV_IBUF_DEBUG
 	if (srv_ibuf_disable_background_merge) {
 		return(0);
@@ -2717,7 +2829,7 @@ ibuf_merge_in_background(
 	while (sum_pages < n_pages) {
 		ulint	n_bytes;
 
-		n_bytes = ibuf_merge(&n_pag2, false);
+		n_bytes = ibuf_merge(&n_pag2, false, &merge_pos);
 
 		if (n_bytes == 0) {
 			return(sum_bytes);
@@ -2760,6 +2872,22 @@ ibuf_contract_after_insert(
 
 	sync = (size >= max_size + IBUF_CONTRACT_ON_INSERT_SYNC);
 
+	if (ibuf_merge_thread_active) {
+
+		/* Let ibuf_merge_thread() do the merge, unless the change
+		buffer has grown so far beyond its maximum size that the
+		inserting threads have to be throttled. */
+
+		os_event_set(ibuf_merge_event);
+
+		if (!sync) {
+			MONITOR_INC(MONITOR_IBUF_MERGE_REQUESTS);
+			return;
+		}
+	}
+
+	MONITOR_INC(MONITOR_IBUF_MERGE_SYNC_CONTRACTIONS);
+
 	/* Contract at least entry_size many bytes */
 	sum_sizes = 0;
 	size = 1;
@@ -2771,6 +2899,54 @@ ibuf_contract_after_insert(
 	} while (size > 0 && sum_sizes < entry_size);
 }
 
+/** Merges the change buffer in the background whenever inserts to it have
+made it grow beyond its maximum size, so that the inserting threads do not
+have to read the pages to merge themselves. */
+void
+ibuf_merge_thread()
+{
+	ibuf_merge_pos_t	merge_pos = {0, 0};
+
+	my_thread_init();
+
+	ibuf_merge_thread_active = true;
+
+	while (srv_shutdown_state == SRV_SHUTDOWN_NONE) {
+
+		int64_t	sig_count = os_event_reset(ibuf_merge_event);
+
+		/* Dirty reads, see ibuf_contract_after_insert() */
+		if (ibuf->size < ibuf->max_size
+#if defined UNIV_DEBUG || defined UNIV_IBUF_DEBUG
+		    || srv_ibuf_disable_background_merge
+#endif /* UNIV_DEBUG || UNIV_IBUF_DEBUG */
+		    ) {
+
+			MONITOR_SET(MONITOR_IBUF_MERGE_BACKLOG, 0);
+
+			os_event_wait_low(ibuf_merge_event, sig_count);
+
+			continue;
+		}
+
+		MONITOR_SET(MONITOR_IBUF_MERGE_BACKLOG,
+			    ibuf->size - ibuf->max_size);
+
+		ulint	n_pages;
+
+		/* Wait for the last read of each batch, so that the
+		merges keep pace with the reads. */
+		if (ibuf_merge(&n_pages, true, &merge_pos) == 0) {
+
+			os_event_wait_low(ibuf_merge_event, sig_count);
+		}
+	}
+
+	ibuf_merge_thread_active = false;
+
+	my_thread_end();
+}
+
 /*********************************************************************//**
 Determine if an insert buffer record has been encountered already.
 @return TRUE if a new record, FALSE if possible duplicate */
@@ -842,13 +842,18 @@ struct btr_cur_t {
 					NULL */
 	ulint		fold;		/*!< fold value used in the search if
 					flag is BTR_CUR_HASH */
+	page_no_t	parent_page_no;	/*!< the level 1 page through which
+					the last descent reached the leaf
+					level, or FIL_NULL; only a hint,
+					used by the leaf read-ahead of
+					btr_pcur_t */
 	/* @} */
 	btr_path_t*	path_arr;	/*!< in estimating the number of
 					rows in range, we store in this array
 					information of the path through
 					the tree */
 	rtr_info_t*	rtr_info;	/*!< rtree search info */
-	btr_cur_t():thr(NULL), rtr_info(NULL) {}
+	btr_cur_t():thr(NULL), parent_page_no(FIL_NULL), rtr_info(NULL) {}
 					/* default values */
 };
 
@@ -533,6 +533,20 @@ struct btr_pcur_t{
 	byte*		old_rec_buf;
 	/** old_rec_buf size if old_rec_buf is not NULL */
 	ulint		buf_size;
+	/*-----------------------------*/
+	/* The following fields drive the leaf read-ahead, see
+	btr_pcur_read_ahead() */
+
+	/** number of consecutive moves to a neighbouring leaf page in
+	the direction read_ahead_forward; the read-ahead depth grows with
+	it up to srv_read_ahead_leaf_pages */
+	ulint		read_ahead_moves;
+	/** true if the moves were to the next page, false if they were
+	to the previous page */
+	bool		read_ahead_forward;
+	/** number of leaf pages ahead of the cursor that read-ahead has
+	already been requested for */
+	ulint		read_ahead_issued;
 
 	/** Return the index of this persistent cursor */
 	dict_index_t*	index() const { return(btr_cur.index); }
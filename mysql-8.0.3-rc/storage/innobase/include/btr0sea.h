@@ -57,6 +57,18 @@ btr_search_disable(
 void
 btr_search_enable();
 
+/** Builds page hash indexes that searches have queued with
+btr_search_info_update(), so that the searching threads do not have to
+hash all the records of a page themselves. */
+void
+btr_search_build_thread();
+
+/** Discard the queued page hash index build requests for an index and wait
+until the build thread no longer uses the index.
+@param[in]	index	index that is being dropped */
+void
+btr_search_build_discard(const dict_index_t* index);
+
 /********************************************************************//**
 Returns search info for an index.
 @return search info; search mutex reserved */
@@ -72,7 +84,8 @@ btr_search_get_info(
 btr_search_t*
 btr_search_info_create(mem_heap_t* heap);
 
-/** Returns the value of ref_count. The value is protected by latch.
+/** Returns the value of ref_count plus the number of pending page hash index
+build requests. The values are protected by latches.
 @param[in]	info		search info
 @param[in]	index		index identifier
 @return ref_count value. */
@@ -309,6 +322,27 @@ struct btr_search_t{
 				the same prefix should be indexed in the
 				hash index */
 	/*---------------------- @} */
+	ulint	n_pending;	/*!< number of page hash index build
+				requests for this index that are queued
+				for or being processed by
+				btr_search_build_thread(); protected by
+				the build queue mutex */
+	/* @{ The following fields are not protected by any latch.
+	They are updated for one in BTR_SEARCH_SAMPLE_RATE hash
+	searches. */
+	ulint	n_sampled_hits;	/*!< sampled successful hash searches
+				since the hit ratio was last checked */
+	ulint	n_sampled_misses;
+				/*!< sampled failed hash searches
+				since the hit ratio was last checked */
+	ibool	ahi_disabled;	/*!< TRUE if hash searches on this index
+				have been turned off because too few of
+				them succeeded */
+	ulint	n_disabled;	/*!< number of times ahi_disabled was
+				set; doubles the time it stays set */
+	ulint	n_skipped;	/*!< number of searches since
+				ahi_disabled was set */
+	/* @} */
 #ifdef UNIV_SEARCH_PERF_STAT
 	ulint	n_hash_succ;	/*!< number of successful hash searches thus
 				far */
@@ -337,6 +371,12 @@ extern rw_lock_t**		btr_search_latches;
 /** The adaptive hash index */
 extern btr_search_sys_t*	btr_search_sys;
 
+/** Event to wake up btr_search_build_thread() */
+extern os_event_t		btr_search_build_event;
+
+/** true if btr_search_build_thread() is running */
+extern bool			btr_search_build_thread_active;
+
 #ifdef UNIV_SEARCH_PERF_STAT
 /** Number of successful adaptive hash index lookups */
 extern ulint	btr_search_n_succ;
@@ -357,6 +397,21 @@ pattern */
 the hash index */
 #define BTR_SEARCH_ON_HASH_LIMIT	3
 
+/** One in this many hash searches of a thread updates the hit and miss
+samples of the index; must be a power of 2 */
+#define BTR_SEARCH_SAMPLE_RATE		16
+
+/** The hit ratio of an index is checked after this many samples */
+#define BTR_SEARCH_SAMPLE_WINDOW	256
+
+/** Hash searches are turned off for an index if fewer than this percentage
+of the sampled searches succeeded */
+#define BTR_SEARCH_MIN_HIT_PCT		25
+
+/** Number of searches after which hash searches are tried again on an index
+where they were turned off for the first time */
+#define BTR_SEARCH_REENABLE_LIMIT	16384
+
 #include "btr0sea.ic"
 
 #endif
@@ -38,6 +38,7 @@ Created 11/5/1995 Heikki Tuuri
 #include "os0proc.h"
 #include "log0log.h"
 #include "srv0srv.h"
+#include <atomic>
 #include <ostream>
 #include "buf/buf.h"
 
@@ -200,6 +201,11 @@ struct buf_pool_info_t{
 	ulint	unzip_cur;		/*!< buf_LRU_stat_cur.unzip, num
 					pages decompressed in current
 					interval */
+
+	/* Counters for free list refilling */
+	ulint	LRU_scan_depth;		/*!< buf_pool->LRU_scan_depth */
+	ulint	n_free_waits;		/*!< buf_pool->n_free_waits */
+	ulint	n_single_flushes;	/*!< buf_pool->n_single_flushes */
 };
 
 /** The occupied bytes of lists in all buffer pools */
@@ -367,14 +373,17 @@ buf_page_get_known_nowait(
 /** Given a tablespace id and page number tries to get that page. If the
 page is not in the buffer pool it is not loaded and NULL is returned.
 Suitable for using when holding the lock_sys_t::mutex.
-@param[in]	page_id	page id
-@param[in]	file	file name
-@param[in]	line	line where called
-@param[in]	mtr	mini-transaction
+@param[in]	page_id		page id
+@param[in]	possibly_freed	whether the page may have been freed,
+				as when the page number is only a hint
+@param[in]	file		file name
+@param[in]	line		line where called
+@param[in]	mtr		mini-transaction
 @return pointer to a page or NULL */
 const buf_block_t*
 buf_page_try_get_func(
 	const page_id_t&	page_id,
+	bool			possibly_freed,
 	const char*		file,
 	ulint			line,
 	mtr_t*			mtr);
@@ -386,7 +395,15 @@ when holding the lock_sys_t::mutex.
 @param[in]	mtr	mini-transaction
 @return the page if in buffer pool, NULL if not */
 #define buf_page_try_get(page_id, mtr)	\
-	buf_page_try_get_func((page_id), __FILE__, __LINE__, mtr);
+	buf_page_try_get_func((page_id), false, __FILE__, __LINE__, mtr);
+
+/** Tries to get a page whose page number may be stale, so that the page
+may have been freed in the meantime. The caller must validate the contents.
+@param[in]	page_id	page identifier
+@param[in]	mtr	mini-transaction
+@return the page if in buffer pool, NULL if not */
+#define buf_page_try_get_possibly_freed(page_id, mtr)	\
+	buf_page_try_get_func((page_id), true, __FILE__, __LINE__, mtr);
 
 /** Get read access to a compressed page (usually of type
 FIL_PAGE_TYPE_ZBLOB or FIL_PAGE_TYPE_ZBLOB2).
@@ -1579,6 +1596,22 @@ struct buf_block_t{
 					x-latch on the block, or (3) the block
 					must belong to an intrinsic table */
 	/* @} */
+	/** @name Page search cache fields */
+	/* @{ */
+
+	std::atomic<ulint>
+			n_cur_searches;	/*!< counter which controls building
+					of the search cache for the page;
+					accessed with relaxed loads and
+					stores, and not written while the
+					search cache is current */
+	page_search_cache_t*
+			search_cache;	/*!< key prefixes of sampled page
+					directory slots, or NULL; allocated
+					under the block mutex by a thread
+					holding a latch on the block, and
+					freed when the block is freed */
+	/* @} */
 	/** @name Hash search fields (unprotected)
 	NOTE that these fields are NOT protected by any semaphore! */
 	/* @{ */
@@ -2039,6 +2072,28 @@ struct buf_pool_t{
 					we flush a batch from the
 					buffer pool. Accessed protected by
 					memory barriers. */
+	ulint		LRU_scan_depth;	/*!< number of free blocks that the
+					page cleaner tries to keep in the
+					free list, raised above
+					srv_LRU_scan_depth while user threads
+					keep finding the free list empty.
+					Written by the page cleaner
+					coordinator, read without latching */
+	ulint		n_free_waits;	/*!< number of times a user thread
+					found the free list empty and had to
+					wait for the page cleaner or flush a
+					page itself. Updated atomically */
+	ulint		n_free_waits_last;
+					/*!< n_free_waits when LRU_scan_depth
+					was last adjusted. Accessed only by
+					the page cleaner coordinator */
+	ulint		n_single_flushes;
+					/*!< number of single page flushes done
+					by user threads that could not get a
+					free block. Updated atomically */
+	os_event_t	free_event;	/*!< set by the page cleaner after an
+					LRU batch of this instance, to wake up
+					the threads waiting for a free block */
 
 	lsn_t		track_page_lsn;	/* Pagge Tracking start LSN. */
 
@@ -44,6 +44,18 @@ buf_calc_page_crc32(
 	const byte*	page,
 	bool		use_legacy_big_endian = false);
 
+/** Calculates the CRC32 checksums of several pages at once, for example all
+the pages of one read request. The result for each page is the same as
+buf_calc_page_crc32() returns, but the pages are checksummed in parallel.
+@param[in]	pages		buffer pages (UNIV_PAGE_SIZE bytes each)
+@param[in]	n_pages		number of pages
+@param[out]	crc32s		checksum of each page */
+void
+buf_calc_page_crc32_batch(
+	const byte* const*	pages,
+	ulint			n_pages,
+	uint32_t*		crc32s);
+
 /********************************************************************//**
 Calculates a page checksum which is stored to the page when it is written
 to a file. Note that we must be careful to calculate the same value on
@@ -93,10 +105,21 @@ public:
 		const page_size_t&	page_size,
 		bool			skip_checksum) :
 		m_check_lsn(check_lsn), m_read_buf(read_buf),
-		m_page_size(page_size), m_skip_checksum(skip_checksum) {}
+		m_page_size(page_size), m_skip_checksum(skip_checksum),
+		m_crc32(), m_crc32_known(false) {}
 
 	virtual ~BlockReporter() {}
 
+	/** Use a CRC32 checksum of the page that was calculated in advance,
+	typically by buf_calc_page_crc32_batch() for a whole read batch.
+	@param[in]	crc32		checksum as buf_calc_page_crc32()
+					returns it for this page */
+	void set_crc32(uint32_t crc32)
+	{
+		m_crc32 = crc32;
+		m_crc32_known = true;
+	}
+
 	/** Checks if a page is corrupt.
 	@retval	true	if page is corrupt
 	@retval	false	if page is not corrupt */
@@ -288,6 +311,10 @@ protected:
 	const page_size_t&	m_page_size;
 	/** Skip checksum verification but compare only data. */
 	bool			m_skip_checksum;
+	/** CRC32 checksum of the page if m_crc32_known */
+	uint32_t		m_crc32;
+	/** Whether m_crc32 was set with set_crc32() */
+	bool			m_crc32_known;
 };
 
 #endif /* buf0checksum_h */
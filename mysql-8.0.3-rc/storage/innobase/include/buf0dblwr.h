@@ -86,12 +86,14 @@ buf_dblwr_page_inside(
 	page_no_t	page_no);	/*!< in: page number */
 
 /** Posts a buffer page for writing. If the doublewrite memory buffer
-is full, calls buf_dblwr_flush_buffered_writes and waits for for free
-space to appear.
-@param[in]	bpage	buffer block to write */
+of the buffer pool instance and flush type is full, calls
+buf_dblwr_flush_buffered_writes and waits for for free space to appear.
+@param[in]	bpage		buffer block to write
+@param[in]	flush_type	BUF_FLUSH_LRU or BUF_FLUSH_LIST */
 void
 buf_dblwr_add_to_batch(
-	buf_page_t*	bpage);
+	buf_page_t*	bpage,
+	buf_flush_t	flush_type);
 
 /********************************************************************//**
 Flush a batch of writes to the datafiles that have already been
@@ -100,14 +102,25 @@ void
 buf_dblwr_sync_datafiles();
 
 /********************************************************************//**
-Flushes possible buffered writes from the doublewrite memory buffer to disk,
-and also wakes up the aio thread if simulated aio is used. It is very
+Flushes possible buffered writes from all the doublewrite memory buffers to
+disk, and also wakes up the aio thread if simulated aio is used. It is very
 important to call this function after a batch of writes has been posted,
 and also when we may have to wait for a page latch! Otherwise a deadlock
 of threads can occur. */
 void
 buf_dblwr_flush_buffered_writes(void);
 /*=================================*/
+
+/** Flushes possible buffered writes of one buffer pool instance and flush
+type from the doublewrite memory buffer to disk. This is called at the end
+of a flush batch.
+@param[in]	buf_pool	buffer pool instance
+@param[in]	flush_type	BUF_FLUSH_LRU or BUF_FLUSH_LIST */
+void
+buf_dblwr_flush_buffered_writes(
+	const buf_pool_t*	buf_pool,
+	buf_flush_t		flush_type);
+
 /********************************************************************//**
 Writes a page to the doublewrite buffer on disk, sync it, then write
 the page to the datafile and sync the datafile. This function is used
@@ -129,13 +142,29 @@ tablespace they belong to.
 void
 buf_dblwr_recover_pages(fil_space_t* space);
 
-/** Doublewrite control struct */
-struct buf_dblwr_t{
+/** Free the memory that holds the pages read from the doublewrite buffer
+and the doublewrite files at startup. Must be called after
+recv_sys->dblwr.pages has been cleared. */
+void
+buf_dblwr_free_recv_buf();
+
+/** A doublewrite file. There is one file for each buffer pool instance. */
+struct buf_dblwr_file_t{
+	pfs_os_file_t	handle;	/*!< file handle */
+	char*		path;	/*!< file path */
+};
+
+/** Doublewrite buffer of one buffer pool instance and flush type. Each
+shard owns a region of the doublewrite file of its buffer pool instance,
+so that the page cleaners and the threads doing single page flushes of
+different instances do not serialize on one mutex and one write buffer. */
+struct buf_dblwr_shard_t{
 	ib_mutex_t	mutex;	/*!< mutex protecting the first_free
 				field and write_buf */
-	page_no_t	block1;	/*!< the page number of the first
-				doublewrite block (64 pages) */
-	page_no_t	block2;	/*!< page number of the second block */
+	buf_dblwr_file_t* file;	/*!< doublewrite file that the region
+				of this shard is in */
+	page_no_t	offset;	/*!< first page of the region in file */
+	ulint		n_slots;/*!< number of pages in the region */
 	page_no_t	first_free;/*!< first free position in write_buf
 				measured in units of UNIV_PAGE_SIZE */
 	ulint		b_reserved;/*!< number of slots currently reserved
@@ -163,6 +192,23 @@ struct buf_dblwr_t{
 				cached to write_buf */
 };
 
+/** Doublewrite control struct */
+struct buf_dblwr_t{
+	page_no_t	block1;	/*!< the page number of the first
+				doublewrite block (64 pages) in the
+				system tablespace */
+	page_no_t	block2;	/*!< page number of the second block */
+	ulint		n_files;/*!< number of doublewrite files, equal
+				to srv_buf_pool_instances, or 0 in
+				read-only mode */
+	buf_dblwr_file_t* files;/*!< doublewrite files */
+	buf_dblwr_shard_t* shards;/*!< BUF_FLUSH_N_TYPES shards for each
+				file, indexed by
+				instance * BUF_FLUSH_N_TYPES + flush_type */
+	byte*		recv_buf_unaligned;/*!< pages read from the
+				doublewrite buffer at startup, pointed to
+				by recv_sys->dblwr.pages */
+};
 
 #endif /* UNIV_HOTBACKUP */
 
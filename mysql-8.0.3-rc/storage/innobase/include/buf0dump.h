@@ -28,6 +28,15 @@ Created April 08, 2011 Vasil Dimov
 
 #include "univ.i"
 
+/** Format of the buffer pool dump file, innodb_buffer_pool_dump_format */
+enum buf_dump_format_t {
+	/** One "space,page" line per page */
+	BUF_DUMP_FORMAT_TEXT,
+	/** A magic number followed by one 8-byte big-endian
+	(space << 32 | page) per page */
+	BUF_DUMP_FORMAT_BINARY
+};
+
 /*****************************************************************//**
 Wakes up the buffer pool dump/load thread and instructs it to start
 a dump. This function is called by MySQL code via buffer_pool_dump_now()
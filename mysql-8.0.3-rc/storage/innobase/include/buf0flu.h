@@ -279,6 +279,18 @@ buf_flush_page(
 	buf_flush_t	flush_type,
 	bool		sync);
 
+/** Write one page of the flush list to its file, and wait until the
+changes of the page up to an LSN are in the file. Unlike buf_flush_lists(),
+no other page is flushed.
+NOTE: The calling thread is not allowed to own any latches on pages!
+@param[in]	page_id		page to write
+@param[in]	lsn		end LSN of the last change that must be
+				written */
+void
+buf_flush_page_and_wait(
+	const page_id_t&	page_id,
+	lsn_t			lsn);
+
 /** Check if the block is modified and ready for flushing.
 @param[in]	bpage		buffer control block, must be buf_page_in_file()
 @param[in]	flush_type	type of flush
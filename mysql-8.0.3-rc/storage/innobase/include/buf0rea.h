@@ -110,6 +110,22 @@ buf_read_ahead_linear(
 	const page_size_t&	page_size,
 	ibool			inside_ibuf);
 
+/** Issues read requests for B-tree leaf pages that a scan is about to
+visit, in the order given. Pages that are already in the buffer pool are
+skipped. The calling thread may own latches on pages: this function never
+waits for a page latch.
+@param[in]	space_id	tablespace id
+@param[in]	page_size	page size
+@param[in]	page_nos	page numbers, in the order of the scan
+@param[in]	n_pages		number of elements in page_nos
+@return number of page read requests issued */
+ulint
+buf_read_ahead_leaves(
+	space_id_t		space_id,
+	const page_size_t&	page_size,
+	const page_no_t*	page_nos,
+	ulint			n_pages);
+
 /********************************************************************//**
 Issues read requests for pages which the ibuf module wants to read in, in
 order to contract the insert buffer tree. Technically, this function is like
@@ -1945,7 +1945,8 @@ struct dict_table_t {
 
 	/** Count of the number of record locks on this table. We use this to
 	determine whether we can evict the table from the dictionary cache.
-	It is protected by lock_sys->mutex. */
+	Record locks on different pages may be created and released
+	concurrently, therefore it is updated with atomic operations. */
 	ulint					n_rec_locks;
 
 #ifndef UNIV_DEBUG
@@ -36,6 +36,7 @@ Created 10/25/1995 Heikki Tuuri
 #include "ibuf0types.h"
 #endif /* !UNIV_HOTBACKUP */
 
+#include <atomic>
 #include <list>
 #include <vector>
 
@@ -176,6 +177,16 @@ struct fil_space_t {
 	/** Compression algorithm */
 	Compression::Type	compression_type;
 
+	/** Zstandard dictionary stored in page 0, or NULL. Set at most
+	once and freed with the tablespace. */
+	Compression::Dictionary*	zstd_dict;
+
+	/** true once page 0 was checked for a Zstandard dictionary */
+	bool			zstd_dict_checked;
+
+	/** true while a dictionary is being trained for this space */
+	bool			zstd_dict_training;
+
 	/** Encryption algorithm */
 	Encryption::Type	encryption_type;
 
@@ -487,10 +498,10 @@ extern ulint	fil_n_log_flushes;
 /** Number of pending redo log flushes */
 extern ulint	fil_n_pending_log_flushes;
 /** Number of pending tablespace flushes */
-extern ulint	fil_n_pending_tablespace_flushes;
+extern std::atomic<ulint>	fil_n_pending_tablespace_flushes;
 
 /** Number of files currently open */
-extern ulint	fil_n_file_opened;
+extern std::atomic<ulint>	fil_n_file_opened;
 
 #ifndef UNIV_HOTBACKUP
 /** Look up a tablespace.
@@ -1201,7 +1212,8 @@ struct PageCallback {
 	PageCallback()
 		:
 		m_page_size(0, 0, false),
-		m_filepath() UNIV_NOTHROW {}
+		m_filepath(),
+		m_page_crc32() UNIV_NOTHROW {}
 
 	virtual ~PageCallback() UNIV_NOTHROW {}
 
@@ -1262,6 +1274,10 @@ struct PageCallback {
 	/** Physical file path. */
 	const char*		m_filepath;
 
+	/** CRC32 checksum of the page passed to operator(), calculated for
+	all the pages of a read batch at once, or NULL if not calculated */
+	const uint32_t*		m_page_crc32;
+
 protected:
 	// Disable copying
 	PageCallback(const PageCallback&);
@@ -1363,6 +1379,26 @@ Compression::Type
 fil_get_compression(space_id_t space_id)
 	MY_ATTRIBUTE((warn_unused_result));
 
+/** Claim the right to train a Zstandard dictionary for a tablespace.
+@param[in,out]	space		tablespace, acquired by the caller
+@param[in]	min_size	minimum tablespace size in pages
+@return true if the caller must train and call fil_zstd_dict_train_end() */
+bool
+fil_zstd_dict_train_start(
+	fil_space_t*	space,
+	page_no_t	min_size)
+	MY_ATTRIBUTE((warn_unused_result));
+
+/** Finish training a Zstandard dictionary. The dictionary must already
+be durable in page 0, because pages compressed with it can be written
+as soon as this returns.
+@param[in,out]	space		tablespace
+@param[in]	dict		trained dictionary, or NULL on failure */
+void
+fil_zstd_dict_train_end(
+	fil_space_t*			space,
+	Compression::Dictionary*	dict);
+
 void
 fil_io_set_encryption(
 	IORequest&		req_type,
@@ -37,6 +37,8 @@ Created 12/18/1995 Heikki Tuuri
 
 #include "fsp0types.h"
 
+#include <atomic>
+
 /* @defgroup Tablespace Header Constants (moved from fsp0fsp.c) @{ */
 
 /** Offset of the space header within a file page */
@@ -46,6 +48,10 @@ Created 12/18/1995 Heikki Tuuri
 and SDI version(4) at Page 0 */
 #define FSP_SDI_HEADER_LEN	8
 
+/** The number of bytes in front of a Zstandard dictionary stored in page 0,
+after the SDI header: magic(4), dictionary length(4) and its checksum(4) */
+#define FSP_ZSTD_DICT_HEADER_LEN	12
+
 /* The data structures in files are defined just as byte strings in C */
 typedef	byte	fsp_header_t;
 typedef	byte	xdes_t;
@@ -472,6 +478,29 @@ fsp_header_rotate_encryption(
 	byte*			encrypt_info,
 	mtr_t*			mtr);
 
+/** Read the Zstandard dictionary stored in page 0.
+@param[in]	page		page 0 of the tablespace
+@param[in]	page_size	page size
+@param[out]	len		length of the dictionary in bytes
+@return dictionary contents inside page, or NULL if there is none */
+const byte*
+fsp_header_get_zstd_dict(
+	const page_t*		page,
+	const page_size_t&	page_size,
+	ulint*			len);
+
+/** Number of Zstandard dictionary training threads that are running */
+extern std::atomic<ulint>	fsp_zstd_dict_n_threads;
+
+/** Start training a Zstandard dictionary in the background for a
+tablespace that uses COMPRESSION="zstd", if innodb_compression_zstd_dict_size
+is set and the tablespace has none yet. Pages compressed after the
+dictionary is stored in page 0 use it.
+@param[in]	space_id	tablespace id */
+void
+fsp_header_train_zstd_dict(
+	space_id_t	space_id);
+
 /** Initializes the space header of a new created space and creates also the
 insert buffer tree root if space == 0.
 @param[in]	space_id	space id
@@ -67,6 +67,12 @@ extern ibuf_use_t	ibuf_use;
 /** The insert buffer control structure */
 extern ibuf_t*		ibuf;
 
+/** Event to wake up ibuf_merge_thread() */
+extern os_event_t	ibuf_merge_event;
+
+/** true if ibuf_merge_thread() is running */
+extern bool		ibuf_merge_thread_active;
+
 /* The purpose of the insert buffer is to reduce random disk access.
 When we wish to insert a record into a non-unique secondary index and
 the B-tree leaf page where the record belongs to is not in the buffer
@@ -363,6 +369,12 @@ ulint
 ibuf_merge_in_background(
 	bool	full);
 
+/** Merges the change buffer in the background whenever inserts to it have
+made it grow beyond its maximum size, so that the inserting threads do not
+have to read the pages to merge themselves. */
+void
+ibuf_merge_thread();
+
 /** Contracts insert buffer trees by reading pages referring to space_id
 to the buffer pool.
 @returns number of pages merged.*/
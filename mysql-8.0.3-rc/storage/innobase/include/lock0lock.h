@@ -27,6 +27,9 @@ Created 5/7/1996 Heikki Tuuri
 #define lock0lock_h
 
 #include "univ.i"
+
+#include <atomic>
+
 #include "buf0types.h"
 #include "trx0types.h"
 #include "mtr0types.h"
@@ -39,12 +42,17 @@ Created 5/7/1996 Heikki Tuuri
 #include "ut0vec.h"
 #include "gis0rtree.h"
 #include "lock0prdt.h"
+#include "sync0sharded_rw.h"
 
 // Forward declaration
 class ReadView;
 
 extern bool	innobase_deadlock_detect;
 
+/** true if deadlocks are searched for by the background deadlock detector
+thread instead of by the thread enqueueing a lock wait */
+extern bool	innobase_deadlock_detect_async;
+
 /*********************************************************************//**
 Gets the size of a lock struct.
 @return size in bytes */
@@ -781,6 +789,18 @@ lock_table_has_locks(
 void
 lock_wait_timeout_thread();
 
+/** A thread which searches the waits-for graph of the suspended transactions
+for cycles and resolves them, when innodb_deadlock_detect_async is set. */
+void
+lock_deadlock_detector_thread();
+
+/** Search the waits-for graph of the transactions which are suspended in a
+lock wait for cycles, and resolve each of them by rolling back the lightest
+transaction on the cycle. The caller must not hold any latches.
+@return number of transactions chosen as deadlock victims */
+ulint
+lock_deadlock_detect_and_resolve();
+
 /********************************************************************//**
 Releases a user OS thread waiting for a lock to be released, if the
 thread is already suspended. */
@@ -933,15 +953,61 @@ struct lock_op_t{
 
 typedef ib_mutex_t LockMutex;
 
-/** The lock system struct */
+/** Number of shards of the lock_sys global latch */
+#define LOCK_SYS_N_LATCH_SHARDS		8
+
+/** Number of shards protecting the record lock queues and the table
+lock queues, each */
+#define LOCK_SYS_N_SHARDS		256
+
+/** A mutex protecting a subset of the lock queues, padded so that no
+two of them share a cache line */
+struct lock_sys_shard_t {
+	char		pad[INNOBASE_CACHE_LINE_SIZE];
+						/*!< padding */
+	LockMutex	mutex;			/*!< the mutex */
+};
+
+/** The lock system struct.
+
+The lock queues are protected by a two-level latching scheme:
+
+1. latch, the global latch. Taking it in X mode (lock_mutex_enter())
+gives exclusive access to all of the lock system, as the single
+lock_sys->mutex used to. This is done for deadlock detection, lock
+waits, operations which span several pages or tables (page splits and
+merges, lock inheritance, table-wide operations), printing and any other
+uncommon path.
+
+2. page_shards and table_shards. A thread which holds latch in S mode
+may access the record lock queues of a page only while holding the
+page_mutex() of the page, and the lock queue of a table only while
+holding the table_mutex() of the table. Record locks on all of the pages
+which hash to the same cell of rec_hash share a shard, because they share
+the hash chain.
+
+The common cases of acquiring a record lock or a table lock with no
+conflicting requests, and of releasing the locks of a transaction, are
+done in S mode so that transactions working on different pages do not
+contend with each other. Anything that changes lock_sys state which is
+not local to a single lock queue, such as n_waiting and the VATS ages,
+requires X mode. */
 struct lock_sys_t {
 	char		pad1[INNOBASE_CACHE_LINE_SIZE];
 						/*!< padding to prevent other
 						memory update hotspots from
 						residing on the same memory
 						cache line */
-	LockMutex	mutex;			/*!< Mutex protecting the
-						locks */
+	Sharded_rw_lock	latch;			/*!< Global latch protecting
+						the locks, see above */
+	lock_sys_shard_t*
+			page_shards;		/*!< LOCK_SYS_N_SHARDS mutexes
+						protecting the record lock
+						queues, see page_mutex() */
+	lock_sys_shard_t*
+			table_shards;		/*!< LOCK_SYS_N_SHARDS mutexes
+						protecting the table lock
+						queues, see table_mutex() */
 	hash_table_t*	rec_hash;		/*!< hash table of the record
 						locks */
 	hash_table_t*	prdt_hash;		/*!< hash table of the predicate
@@ -961,7 +1027,8 @@ struct lock_sys_t {
 						protected by
 						lock_sys->wait_mutex */
 	int		n_waiting;		/*!< Number of slots in use.
-						Protected by lock_sys->mutex */
+						Modified with lock_sys
+						x-latched */
 	ibool		rollback_complete;
 						/*!< TRUE if rollback of all
 						recovered transactions is
@@ -978,14 +1045,35 @@ struct lock_sys_t {
 	bool		timeout_thread_active;	/*!< True if the timeout thread
 						is running */
 
+	os_event_t	deadlock_event;		/*!< Set when a transaction is
+						suspended in a lock wait and
+						innodb_deadlock_detect_async
+						is set, to wake up the
+						deadlock detector thread */
+
+	bool		deadlock_thread_active;	/*!< True if the deadlock
+						detector thread is running */
+
 	/** Marker value before trx_t::age. */
 	uint64_t	mark_age_updated;
 
 #ifdef UNIV_DEBUG
 	/** Lock timestamp counter */
-	uint64_t	m_seq;
+	std::atomic<uint64_t>	m_seq;
 #endif /* UNIV_DEBUG */
 
+	/** Get the mutex protecting the record lock queues of a page.
+	The caller must hold latch in S mode: the mapping changes when
+	rec_hash is resized.
+	@param[in]	space	tablespace id
+	@param[in]	page_no	page number
+	@return mutex of the shard of the page */
+	inline LockMutex* page_mutex(space_id_t space, page_no_t page_no) const;
+
+	/** Get the mutex protecting the lock queue of a table.
+	@param[in]	table	table
+	@return mutex of the shard of the table */
+	inline LockMutex* table_mutex(const dict_table_t* table) const;
 };
 
 /*************************************************************//**
@@ -1032,23 +1120,59 @@ lock_rec_trx_wait(
 /** The lock system */
 extern lock_sys_t*	lock_sys;
 
-/** Test if lock_sys->mutex can be acquired without waiting. */
+/** Try to x-latch the lock_sys global latch without waiting.
+@return 0 if the latch was acquired, nonzero if it was not */
 #define lock_mutex_enter_nowait() 		\
-	(lock_sys->mutex.trylock(__FILE__, __LINE__))
+	(!lock_sys->latch.x_lock_nowait())
 
-/** Test if lock_sys->mutex is owned. */
-#define lock_mutex_own() (lock_sys->mutex.is_owned())
+/** Test if the lock_sys global latch is x-latched by the calling thread. */
+#define lock_mutex_own() (lock_sys->latch.x_own())
 
-/** Acquire the lock_sys->mutex. */
+/** X-latch the lock_sys global latch, which gives exclusive access to all
+of the lock queues. */
 #define lock_mutex_enter() do {			\
-	mutex_enter(&lock_sys->mutex);		\
+	lock_sys->latch.x_lock();		\
 } while (0)
 
-/** Release the lock_sys->mutex. */
+/** Release the x-latch on the lock_sys global latch. */
 #define lock_mutex_exit() do {			\
-	lock_sys->mutex.exit();			\
+	lock_sys->latch.x_unlock();		\
+} while (0)
+
+/** S-latch the lock_sys global latch. The caller must then latch the
+page_mutex() or the table_mutex() of the lock queue it accesses.
+@return shard of the latch, to be passed to lock_sys_s_exit() */
+#define lock_sys_s_enter() (lock_sys->latch.s_lock())
+
+/** Release the s-latch on the lock_sys global latch.
+@param[in]	shard	value returned by lock_sys_s_enter() */
+#define lock_sys_s_exit(shard) do {		\
+	lock_sys->latch.s_unlock(shard);	\
 } while (0)
 
+#ifdef UNIV_DEBUG
+/** Test if the lock_sys global latch is s-latched by the calling thread. */
+#define lock_sys_s_own() (lock_sys->latch.s_own())
+
+/** Test if the lock_sys global latch is latched in any mode by the calling
+thread. */
+#define lock_sys_own() (lock_mutex_own() || lock_sys_s_own())
+
+/** Test if the calling thread may access the record lock queues of a page,
+that is, if it x-latches lock_sys, or s-latches it and owns the page
+mutex. */
+#define lock_sys_page_own(space, page_no)			\
+	(lock_mutex_own()					\
+	 || (lock_sys_s_own()					\
+	     && lock_sys->page_mutex(space, page_no)->is_owned()))
+
+/** Test if the calling thread may access the lock queue of a table. */
+#define lock_sys_table_own(table)				\
+	(lock_mutex_own()					\
+	 || (lock_sys_s_own()					\
+	     && lock_sys->table_mutex(table)->is_owned()))
+#endif /* UNIV_DEBUG */
+
 /** Test if lock_sys->wait_mutex is owned. */
 #define lock_wait_mutex_own() (lock_sys->wait_mutex.is_owned())
 
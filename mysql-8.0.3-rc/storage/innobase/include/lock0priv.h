@@ -928,7 +928,8 @@ private:
 	Setup the context from the requirements */
 	void init(const page_t* page)
 	{
-		ut_ad(lock_mutex_own());
+		ut_ad(lock_sys_page_own(m_rec_id.m_space_id,
+					m_rec_id.m_page_no));
 		ut_ad(!srv_read_only_mode);
 		ut_ad(m_index->is_clustered()
 		      || !dict_index_is_online_ddl(m_index));
@@ -34,10 +34,15 @@ Created 12/9/1995 Heikki Tuuri
 #define log0log_h
 
 #include "univ.i"
+
+#include <atomic>
+
 #include "dyn0buf.h"
 #ifndef UNIV_HOTBACKUP
 #include "sync0rw.h"
+#include "sync0sharded_rw.h"
 #endif /* !UNIV_HOTBACKUP */
+#include "ut0link_buf.h"
 
 extern const char* const ib_logfile_basename;
 
@@ -69,21 +74,10 @@ step which modifies the database, is started */
 typedef ulint (*log_checksum_func_t)(const byte* log_block);
 
 /** Pointer to the log checksum calculation function. Protected with
-log_sys->mutex. */
+log_sys->write_mutex. */
 extern log_checksum_func_t log_checksum_algorithm_ptr;
 
 #ifndef UNIV_HOTBACKUP
-/** Append a string to the log.
-@param[in]	str		string
-@param[in]	len		string length
-@param[out]	start_lsn	start LSN of the log record
-@return end lsn of the log record, zero if did not succeed */
-UNIV_INLINE
-lsn_t
-log_reserve_and_write_fast(
-	const void*	str,
-	ulint		len,
-	lsn_t*		start_lsn);
 /***********************************************************************//**
 Checks if there is need for a log buffer flush or a new checkpoint, and does
 this if yes. Any database operation should call this when it has modified
@@ -109,26 +103,107 @@ void
 log_margin_checkpoint_age(
 	ulint	len);
 
-/** Open the log for log_write_low. The log must be closed with log_close.
-@param[in]	len	length of the data to be written
-@return start lsn of the log record */
+/** Translate a number of data bytes written to the log since its
+beginning (sn) to the corresponding lsn, which also counts the headers
+and trailers of the log blocks.
+@param[in]	sn	number of data bytes
+@return lsn */
+UNIV_INLINE
 lsn_t
-log_reserve_and_open(
-	ulint	len);
-/************************************************************//**
-Writes to the log the string given. It is assumed that the caller holds the
-log mutex. */
+log_translate_sn_to_lsn(
+	lsn_t	sn);
+
+/** Translate an lsn to the number of data bytes written to the log up
+to that lsn (sn). The lsn must not point into a block header or trailer.
+@param[in]	lsn	log sequence number
+@return sn */
+UNIV_INLINE
+lsn_t
+log_translate_lsn_to_sn(
+	lsn_t	lsn);
+
+/** S-lock the log buffer. Mini-transactions hold this while they
+reserve and fill their part of the log buffer; holding it in X mode
+freezes the current lsn and guarantees that all the log up to it has
+been copied to the log buffer.
+@return shard to pass to log_buffer_s_lock_exit() */
+UNIV_INLINE
+size_t
+log_buffer_s_lock_enter();
+
+/** Release the log buffer s-lock.
+@param[in]	shard	value returned by log_buffer_s_lock_enter() */
+UNIV_INLINE
 void
-log_write_low(
-/*==========*/
-	const byte*	str,		/*!< in: string */
-	ulint		str_len);	/*!< in: string length */
-/************************************************************//**
-Closes the log.
-@return lsn */
+log_buffer_s_lock_exit(
+	size_t	shard);
+
+/** X-lock the log buffer. */
+UNIV_INLINE
+void
+log_buffer_x_lock_enter();
+
+/** Release the log buffer x-lock. */
+UNIV_INLINE
+void
+log_buffer_x_lock_exit();
+
+/** Reserve space in the log buffer for a group of log records. This only
+advances the lsn with an atomic fetch-and-add, so that concurrent
+mini-transactions can then copy their log records to the log buffer in
+parallel. The caller must hold the log buffer s-lock.
+@param[in]	len		length of the log records in bytes
+@param[out]	start_lsn	start lsn of the reserved range
+@param[out]	end_lsn		end lsn of the reserved range */
+UNIV_INLINE
+void
+log_buffer_reserve(
+	ulint	len,
+	lsn_t*	start_lsn,
+	lsn_t*	end_lsn);
+
+/** Wait until the log buffer has room for a range reserved by
+log_buffer_reserve(), that is, until the log written to the log files
+is recent enough for the range not to overwrite unwritten log.
+@param[in]	end_lsn		end lsn of the reserved range */
+void
+log_buffer_wait_for_space(
+	lsn_t	end_lsn);
+
+/** Copy a string to a range of the log buffer which was reserved by
+log_buffer_reserve(), skipping the log block headers and trailers.
+@param[in]	str	string
+@param[in]	len	string length
+@param[in]	lsn	lsn where the string starts
+@return lsn where the string ends */
 lsn_t
-log_close(void);
-/*===========*/
+log_buffer_write(
+	const byte*	str,
+	ulint		len,
+	lsn_t		lsn);
+
+/** Close a range of the log buffer which was reserved by
+log_buffer_reserve() and filled with log_buffer_write(). Sets the first
+record group offsets of the log blocks that were started in the range,
+reports the range as complete to the log writer, and checks whether a log
+flush or a checkpoint is needed.
+@param[in]	start_lsn	start lsn of the range
+@param[in]	end_lsn		end lsn of the range */
+void
+log_buffer_close(
+	lsn_t	start_lsn,
+	lsn_t	end_lsn);
+
+/** Make the log buffer continue the log from a given lsn, e.g. after the
+recovery or when the log files have been recreated.
+@param[in]	lsn		the new current lsn
+@param[in]	last_block	the log block which contains lsn, as
+read from the log files, or NULL if lsn starts a new block */
+void
+log_buffer_reset(
+	lsn_t		lsn,
+	const byte*	last_block);
+
 /************************************************************//**
 Gets the current lsn.
 @return current lsn */
@@ -234,6 +309,17 @@ void
 log_buffer_sync_in_background(
 /*==========================*/
 	bool	flush);	/*!< in: flush the logs to disk */
+
+/** Start the log writer and the log flusher threads. From then on,
+log_write_up_to() waits for them instead of writing the log itself. */
+void
+log_start_background_threads();
+
+/** Stop the log writer and the log flusher threads and wait until they
+have exited. log_write_up_to() writes the log itself afterwards. */
+void
+log_stop_background_threads();
+
 /** Make a checkpoint. Note that this function does not flush dirty
 blocks from the buffer pool: it only checks what is lsn of the oldest
 modification in the pool, and writes information about the lsn in
@@ -561,6 +647,24 @@ extern bool	innodb_log_checksums;
 					.._HDR_NO */
 #define	LOG_BLOCK_TRL_SIZE	4	/* trailer size in bytes */
 
+/** Number of bytes of log records that fit in one log block */
+#define LOG_BLOCK_DATA_SIZE	(OS_FILE_LOG_BLOCK_SIZE - LOG_BLOCK_HDR_SIZE \
+				 - LOG_BLOCK_TRL_SIZE)
+
+/** Number of slots in log_sys->recent_written. This bounds how far the
+mini-transactions may run ahead of the oldest one which has not yet
+finished copying its log records to the log buffer. */
+#define LOG_RECENT_WRITTEN_SIZE	(1024 * 1024)
+
+/** Number of shards of log_sys->sn_lock */
+#define LOG_SN_LOCK_SHARDS	32
+
+/** Number of events in log_sys->write_events and log_sys->flush_events.
+A thread waiting for the log to be written or flushed up to a given lsn
+waits on the event of the log block which contains that lsn, so that the
+threads waiting for different blocks are not all woken up at once. */
+#define LOG_WAIT_EVENTS		64
+
 /* Offsets inside the checkpoint pages (redo log format version 1) */
 #define LOG_CHECKPOINT_NO		0
 #define LOG_CHECKPOINT_LSN		8
@@ -666,46 +770,63 @@ struct log_group_t{
 	UT_LIST_NODE_T(log_group_t)	log_groups;
 };
 
-/** Redo log buffer */
+/** Redo log buffer.
+
+The log buffer is a ring: the byte at lsn L is stored at buf[L % buf_size],
+block headers and trailers included. Mini-transactions reserve a range of
+lsn by advancing sn with an atomic fetch-and-add, copy their log records to
+the range in parallel and then report the range in recent_written. The log
+writer finds the lsn up to which there are no holes in the log buffer from
+recent_written, formats the block headers and writes the log up to there. */
 struct log_t{
 	char		pad1[INNOBASE_CACHE_LINE_SIZE];
 					/*!< Padding to prevent other memory
 					update hotspots from residing on the
 					same memory cache line */
-	lsn_t		lsn;		/*!< log sequence number */
-	ulint		buf_free;	/*!< first free offset within the log
-					buffer in use */
-#ifndef UNIV_HOTBACKUP
+	std::atomic<lsn_t>
+			sn;		/*!< number of data bytes reserved in
+					the log so far, not counting block
+					headers and trailers; the current lsn
+					is log_translate_sn_to_lsn(sn) */
 	char		pad2[INNOBASE_CACHE_LINE_SIZE];/*!< Padding */
+#ifndef UNIV_HOTBACKUP
+	Sharded_rw_lock	sn_lock;	/*!< s-locked by the mini-transactions
+					while they reserve and fill a range
+					of the log buffer; x-locked to freeze
+					the lsn and to resize the buffer */
+	Link_buf<lsn_t>*
+			recent_written;	/*!< ranges of the log buffer that
+					have been filled; the tail is only
+					advanced by the thread holding
+					write_mutex */
+	char		pad3[INNOBASE_CACHE_LINE_SIZE];/*!< Padding */
 	LogSysMutex	mutex;		/*!< mutex protecting the log */
 	LogSysMutex	write_mutex;	/*!< mutex protecting writing to log
 					file and accessing to log_group_t */
-	char		pad3[INNOBASE_CACHE_LINE_SIZE];/*!< Padding */
+	char		pad4[INNOBASE_CACHE_LINE_SIZE];/*!< Padding */
 	FlushOrderMutex	log_flush_order_mutex;/*!< mutex to serialize access to
 					the flush list when we are putting
 					dirty blocks in the list. The idea
 					behind this mutex is to be able
-					to release log_sys->mutex during
-					mtr_commit and still ensure that
-					insertions in the flush_list happen
-					in the LSN order. */
+					to reserve log buffer space outside
+					of any mutex during mtr_commit and
+					still ensure that insertions in the
+					flush_list happen in the LSN order. */
 #endif /* !UNIV_HOTBACKUP */
-	byte*		buf_ptr;	/*!< unaligned log buffer, which should
-					be of double of buf_size */
-	byte*		buf;		/*!< log buffer currently in use;
-					this could point to either the first
-					half of the aligned(buf_ptr) or the
-					second half in turns, so that log
-					write/flush to disk don't block
-					concurrent mtrs which will write
-					log to this buffer */
-	bool		first_in_use;	/*!< true if buf points to the first
-					half of the aligned(buf_ptr), false
-					if the second half */
-	ulint		buf_size;	/*!< log buffer size of each in bytes */
-	ulint		max_buf_free;	/*!< recommended maximum value of
-					buf_free for the buffer in use, after
-					which the buffer is flushed */
+	byte*		buf_ptr;	/*!< unaligned log buffer */
+	byte*		buf;		/*!< the log buffer ring, aligned to
+					OS_FILE_LOG_BLOCK_SIZE */
+	ulint		buf_size;	/*!< log buffer size in bytes */
+	byte*		write_buf_ptr;	/*!< unaligned write buffer */
+	byte*		write_buf;	/*!< the log writer copies the blocks
+					to be written here from the ring and
+					fills in their headers and trailers */
+	ulint		write_buf_size;	/*!< write buffer size in bytes; big
+					enough for buf_size bytes and the
+					write-ahead padding */
+	ulint		max_buf_free;	/*!< recommended maximum amount of
+					unwritten log in the log buffer,
+					after which the buffer is flushed */
 	bool		check_flush_or_checkpoint;
 					/*!< this is set when there may
 					be need to flush the log buffer, or
@@ -728,16 +849,9 @@ struct log_t{
 
 	/** The fields involved in the log buffer flush @{ */
 
-	ulint		buf_next_to_write;/*!< first offset in the log buffer
-					where the byte content may not exist
-					written to file, e.g., the start
-					offset of a log record catenated
-					later; this is advanced when a flush
-					operation is completed to all the log
-					groups */
-	volatile bool	is_extending;	/*!< this is set to true during extend
-					the log buffer size */
-	lsn_t		write_lsn;	/*!< last written lsn */
+	lsn_t		write_lsn;	/*!< last written lsn; the log
+					buffer holds the log from the block
+					which contains this lsn onwards */
 	lsn_t		current_flush_lsn;/*!< end lsn for the current running
 					write + flush operation */
 	lsn_t		flushed_to_disk_lsn;
@@ -754,6 +868,32 @@ struct log_t{
 					owning the log mutex, but NOTE that
 					to set this event, the
 					thread MUST own the log mutex! */
+	std::atomic<bool>
+			threads_enabled;/*!< true while the log writer and
+					the log flusher threads are running;
+					log_write_up_to() then waits for them
+					instead of writing the log itself */
+	bool		writer_is_active;/*!< true if the log writer thread
+					is running */
+	bool		flusher_is_active;/*!< true if the log flusher thread
+					is running */
+	os_event_t	writer_event;	/*!< set to wake up the log writer
+					thread */
+	os_event_t	flusher_event;	/*!< set to wake up the log flusher
+					thread */
+	os_event_t	threads_exit_event;
+					/*!< set when the log writer or the
+					log flusher thread exits */
+	std::atomic<lsn_t>
+			flush_requested_lsn;/*!< largest lsn up to which
+					a thread has asked the log flusher to
+					flush the log */
+	os_event_t*	write_events;	/*!< LOG_WAIT_EVENTS events, set when
+					write_lsn moves past the log blocks
+					they are assigned to */
+	os_event_t*	flush_events;	/*!< LOG_WAIT_EVENTS events, set when
+					flushed_to_disk_lsn moves past the log
+					blocks they are assigned to */
 	ulint		n_log_ios;	/*!< number of log i/os initiated thus
 					far */
 	ulint		n_log_ios_old;	/*!< number of log i/o's at the
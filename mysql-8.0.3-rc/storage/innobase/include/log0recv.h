@@ -603,6 +603,12 @@ use these free frames to read in pages when we start applying the
 log records to the database. */
 extern ulint	recv_n_pool_free_frames;
 
+#if defined UNIV_DEBUG && !defined UNIV_HOTBACKUP
+/** Minimum number of pages in an apply batch for each apply thread, or 0
+for the default. Lowered by tests to apply small batches concurrently. */
+extern uint	recv_apply_pages_per_thread_debug;
+#endif /* UNIV_DEBUG && !UNIV_HOTBACKUP */
+
 #include "log0recv.ic"
 
 #endif
@@ -707,6 +707,14 @@ public:
 		m_compression.m_type = type;
 	}
 
+	/** Set the Zstandard dictionary of the tablespace, used both to
+	compress writes and to decompress reads.
+	@param[in]	dict	dictionary, or NULL */
+	void compression_dictionary(const Compression::Dictionary* dict)
+	{
+		m_compression.m_dict = dict;
+	}
+
 	/** Get the compression algorithm.
 	@return the compression algorithm */
 	Compression compression_algorithm() const
@@ -2003,10 +2011,31 @@ be other, synchronous, pending writes. */
 void
 os_aio_wait_until_no_pending_writes();
 
-/** Wakes up simulated aio i/o-handler threads if they have something to do. */
+/** Wakes up simulated aio i/o-handler threads if they have something to do.
+With io_uring, submits the requests that were queued with
+IORequest::DO_NOT_WAKE. */
 void
 os_aio_simulated_wake_handler_threads();
 
+/** A memory region that is used as a buffer for asynchronous I/O */
+struct os_aio_region_t {
+	/** Start of the region */
+	void*		ptr;
+
+	/** Length of the region in bytes */
+	ulint		len;
+};
+
+/** Register the memory regions that are used as I/O buffers, such as the
+buffer pool chunks, with the native AIO backend. With io_uring, requests
+for buffers inside the regions use registered buffers, so that the kernel
+does not have to map the pages for each request. Any previously registered
+regions are unregistered first. This is a no-op for the other backends.
+@param[in]	regions		memory regions, or nullptr
+@param[in]	n_regions	number of regions, 0 to only unregister */
+void
+os_aio_register_buffers(const os_aio_region_t* regions, ulint n_regions);
+
 /** This function can be called if one wants to post a batch of reads and
 prefers an i/o-handler thread to handle them all at once later. You must
 call os_aio_simulated_wake_handler_threads later to ensure the threads
@@ -2146,14 +2175,16 @@ not then the source contents are left unchanged and DB_SUCCESS is returned.
 				copied to this page
 @param[in,out]	dst		Scratch area to use for decompression
 @param[in]	dst_len		Size of the scratch area in bytes
+@param[in]	dict		Zstandard dictionary of the tablespace, or NULL
 @return DB_SUCCESS or error code */
 
 dberr_t
 os_file_decompress_page(
-	bool		dblwr_recover,
-	byte*		src,
-	byte*		dst,
-	ulint		dst_len)
+	bool				dblwr_recover,
+	byte*				src,
+	byte*				dst,
+	ulint				dst_len,
+	const Compression::Dictionary*	dict)
 	MY_ATTRIBUTE((warn_unused_result));
 
 /** Normalizes a directory path for the current OS:
@@ -27,6 +27,7 @@ Created 2016-May-17 Sunny Bains
 #define os0thread_create_h
 
 #include "univ.i"
+#include "os0event.h"
 #include "os0thread.h"
 
 #include <my_thread.h>
@@ -169,5 +170,74 @@ create_detached_thread(mysql_pfs_key_t pfs_key, F&& f, Args&& ... args)
 #define os_thread_create(k, ...)	create_detached_thread(0, __VA_ARGS__)
 #endif /* UNIV_PFS_THREAD */
 
+/** Detached helper threads that work for the thread that started them.
+The starting thread waits for all of them to return with join(). */
+class Helper_threads {
+public:
+	Helper_threads()
+		:
+		m_n_running(1),
+		m_event(os_event_create(0))
+	{
+	}
+
+	~Helper_threads()
+	{
+		ut_ad(m_n_running.load() == 0);
+
+		os_event_destroy(m_event);
+	}
+
+	/** Start a helper thread.
+	@param[in]	pfs_key		Performance schema thread key
+	@param[in]	f		Callable instance
+	@param[in]	args		zero or more args */
+	template<typename F, typename ... Args>
+	void start(mysql_pfs_key_t pfs_key, F&& f, Args&& ... args)
+	{
+		ut_ad(m_n_running.load() > 0);
+
+		m_n_running.fetch_add(1);
+
+		auto	task = std::bind(
+			std::forward<F>(f), std::forward<Args>(args) ...);
+
+		os_thread_create(pfs_key, [this, task]() mutable {
+			task();
+			exit();
+		});
+	}
+
+	/** Wait until all the helper threads have returned from their
+	callable. Must be called exactly once, by the starting thread. */
+	void join()
+	{
+		/* Drop the reference of the starting thread, which keeps
+		the count above zero while helper threads are being started. */
+		if (m_n_running.fetch_sub(1) > 1) {
+			/* The last helper thread sets the event exactly once.
+			The event is set under its own mutex, so the event can
+			be destroyed as soon as the wait returns. */
+			os_event_wait(m_event);
+		}
+	}
+
+private:
+	/** Called by a helper thread when its callable has returned. */
+	void exit()
+	{
+		if (m_n_running.fetch_sub(1) == 1) {
+			os_event_set(m_event);
+		}
+	}
+
+	/** Number of running helper threads, plus one for the starting
+	thread until it calls join() */
+	std::atomic<ulint>	m_n_running;
+
+	/** Set when the last helper thread exits */
+	os_event_t		m_event;
+};
+
 #endif /* !os0thread_create_h */
 
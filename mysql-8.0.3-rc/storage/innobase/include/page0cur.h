@@ -348,6 +348,12 @@ page_cur_search_with_match_bytes(
 	ulint*			ilow_matched_fields,
 	ulint*			ilow_matched_bytes,
 	page_cur_t*		cursor);
+/** Free the search cache of a buffer block, if it has one. The block must
+not be accessible to other threads.
+@param[in,out]	block	buffer block */
+void
+page_cur_search_cache_free(
+	buf_block_t*	block);
 /***********************************************************//**
 Positions a page cursor on a randomly chosen user record on a page. If there
 are no user records, sets the cursor on the infimum record. */
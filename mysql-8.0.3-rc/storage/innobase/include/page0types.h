@@ -130,6 +130,8 @@ typedef	byte		page_header_t;
 typedef	byte		page_t;
 /** Index page cursor */
 struct page_cur_t;
+/** Cache of the key prefixes of the page directory of an index page */
+struct page_search_cache_t;
 
 /** Compressed index page */
 typedef byte		page_zip_t;
@@ -32,7 +32,30 @@ Created 2/16/1997 Heikki Tuuri
 #include "read0types.h"
 #include "univ.i"
 
-/** The MVCC read view manager */
+/** Number of shards of the MVCC read view lists */
+#define MVCC_N_SHARDS		16
+
+/** Number of published snapshots of the active transactions; a reader can
+copy a snapshot while this many newer ones are being published */
+#define MVCC_N_SNAPSHOTS	4
+
+/** The MVCC read view manager.
+
+The views are kept in MVCC_N_SHARDS lists, each protected by its own mutex,
+so that threads opening and closing views do not contend on a single mutex.
+A view stays in the shard where it was created until it is freed.
+
+A view copies the ids of the active read-write transactions from the latest
+snapshot published by publish_snapshot(), without acquiring trx_sys->mutex.
+Snapshots are published by the threads that modify trx_sys->rw_trx_ids, which
+makes starting and committing a read-write transaction O(n) in the number of
+active transactions, in return for read views that do not take any global
+latch.
+
+A view reads the snapshot and is added to its list while the mutex of its
+shard is held, and purge looks for the oldest view while holding the mutexes
+of all the shards. Hence a view that purge does not see is created from a
+snapshot published after the one that purge uses. */
 class MVCC {
 public:
 	/** Constructor
@@ -40,7 +63,7 @@ public:
 	explicit MVCC(ulint size);
 
 	/** Destructor.
-	Free all the views in the m_free list */
+	Free all the views in the m_free lists */
 	~MVCC();
 
 	/**
@@ -53,12 +76,15 @@ public:
 	/**
 	Close a view created by the above function.
 	@param view		view allocated by trx_open.
-	@param own_mutex	true if caller owns trx_sys_t::mutex */
-	void view_close(ReadView*& view, bool own_mutex);
+	@param remove		true to move the view to the free list now,
+				false to only mark it closed, so that the next
+				view_open() of an AC-NL-RO transaction can
+				reuse it. The caller must not hold
+				trx_sys_t::mutex if true. */
+	void view_close(ReadView*& view, bool remove);
 
 	/**
-	Release a view that is inactive but not closed. Caller must own
-	the trx_sys_t::mutex.
+	Release a view that is inactive but not closed.
 	@param view		View to release */
 	void view_release(ReadView*& view);
 
@@ -73,6 +99,12 @@ public:
 	@return the number of active views */
 	ulint size() const;
 
+	/** Publish a copy of trx_sys->rw_trx_ids for the views created
+	later. Must be called with trx_sys->mutex held, after every
+	modification of trx_sys->rw_trx_ids.
+	@return number of the published snapshot */
+	uint64_t publish_snapshot();
+
 	/**
 	@return true if the view is active and valid */
 	static bool is_view_active(ReadView* view)
@@ -88,38 +120,70 @@ public:
 	static void set_view_creator_trx_id(ReadView* view, trx_id_t id);
 
 private:
+	typedef UT_LIST_BASE_NODE_T(ReadView) view_list_t;
+
+	/** A shard of the view lists */
+	struct shard_t {
+		/** Padding, so that no two mutexes share a cache line */
+		char		pad[INNOBASE_CACHE_LINE_SIZE];
+
+		/** Mutex protecting the lists */
+		ib_mutex_t	mutex;
+
+		/** Free views ready for reuse. */
+		view_list_t	m_free;
+
+		/** Active and closed views, the closed views will have the
+		creator trx id set to TRX_ID_MAX */
+		view_list_t	m_views;
+	};
 
 	/**
-	Validates a read view list. */
-	bool validate() const;
+	Validates a read view list.
+	@param shard		shard whose list to validate */
+	bool validate(const shard_t& shard) const;
 
 	/**
 	Find a free view from the active list, if none found then allocate
 	a new view. This function will also attempt to move delete marked
 	views from the active list to the freed list.
+	@param shard		shard of the view, whose mutex the caller
+				holds
 	@return a view to use */
-	inline ReadView* get_view();
+	inline ReadView* get_view(ulint shard);
 
 	/**
 	Get the oldest view in the system. It will also move the delete
-	marked read views from the views list to the freed list.
+	marked read views from the views list to the freed list. The caller
+	must hold the mutexes of all the shards.
 	@return oldest view if found or NULL */
 	inline ReadView* get_oldest_view() const;
 
+	/** Take the snapshot of the active transactions for a view, from
+	the latest published snapshot if possible, else from
+	trx_sys->rw_trx_ids under trx_sys->mutex. The caller must hold the
+	mutex of the shard that the view will be added to, or the mutexes of
+	all the shards.
+	@param view		view to prepare
+	@param id		creator transaction id */
+	void view_prepare(ReadView* view, trx_id_t id);
+
 private:
 	// Prevent copying
 	MVCC(const MVCC&);
 	MVCC& operator=(const MVCC&);
 
 private:
-	typedef UT_LIST_BASE_NODE_T(ReadView) view_list_t;
+	/** The shards of the view lists */
+	shard_t*		m_shards;
 
-	/** Free views ready for reuse. */
-	view_list_t		m_free;
+	/** Ring of the last published snapshots */
+	trx_ids_snapshot_t*	m_snapshots;
 
-	/** Active and closed views, the closed views will have the
-	creator trx id set to TRX_ID_MAX */
-	view_list_t		m_views;
+	/** Number of the latest published snapshot; it is in
+	m_snapshots[m_snapshot_no % MVCC_N_SNAPSHOTS]. Modified with
+	trx_sys->mutex held. */
+	std::atomic<uint64_t>	m_snapshot_no;
 };
 
 #endif /* read0read_h */
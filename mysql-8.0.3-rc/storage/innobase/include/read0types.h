@@ -27,6 +27,7 @@ Created 2/16/1997 Heikki Tuuri
 #define read0types_h
 
 #include <algorithm>
+#include <atomic>
 #include "dict0mem.h"
 
 #include "trx0types.h"
@@ -34,6 +35,38 @@ Created 2/16/1997 Heikki Tuuri
 // Friend declaration
 class MVCC;
 
+/** Maximum number of transaction ids in a published snapshot. If more
+read-write transactions are active, read views are created from
+trx_sys_t::rw_trx_ids under trx_sys_t::mutex. */
+static const ulint	TRX_IDS_SNAPSHOT_SIZE = 1024;
+
+/** Copy of trx_sys_t::rw_trx_ids and of the limits of a read view, which is
+published by the threads that modify trx_sys_t::rw_trx_ids, so that read
+views can be created without acquiring trx_sys_t::mutex.
+
+The copy is written under trx_sys_t::mutex and read without any latch. The
+writer makes m_version odd while it modifies the copy. A reader must discard
+what it has read if m_version was odd, or has changed by the time it has
+finished reading. */
+struct trx_ids_snapshot_t {
+	/** Incremented before and after each modification */
+	std::atomic<uint64_t>	m_version;
+
+	/** trx_sys_t::max_trx_id when the copy was made */
+	trx_id_t		m_low_limit_id;
+
+	/** The smallest trx_t::no in trx_sys_t::serialisation_list, or
+	m_low_limit_id if the list was empty */
+	trx_id_t		m_low_limit_no;
+
+	/** Number of elements of m_ids, or ULINT_UNDEFINED if
+	trx_sys_t::rw_trx_ids did not fit in m_ids */
+	ulint			m_n_ids;
+
+	/** Sorted copy of trx_sys_t::rw_trx_ids */
+	trx_id_t		m_ids[TRX_IDS_SNAPSHOT_SIZE];
+};
+
 /** Read view lists the trx ids of those transactions for which a consistent
 read should not see the modifications to the database. */
 
@@ -266,6 +299,14 @@ private:
 	@param id		Creator transaction id */
 	inline void prepare(trx_id_t id);
 
+	/** Opens a read view from a published snapshot of the active
+	transactions, without acquiring trx_sys_t::mutex.
+	@param[in]	id		creator transaction id
+	@param[in]	snapshot	published snapshot
+	@return false if the snapshot was being modified while it was read,
+	or if it does not contain the transaction ids */
+	inline bool prepare(trx_id_t id, const trx_ids_snapshot_t& snapshot);
+
 	/**
 	Complete the read view creation */
 	inline void complete();
@@ -321,6 +362,14 @@ private:
 	/** AC-NL-RO transaction view that has been "closed". */
 	bool		m_closed;
 
+	/** Number of the published snapshot of the active transactions that
+	the view was created from. Views created later have a larger or equal
+	number. */
+	uint64_t	m_snapshot_no;
+
+	/** Shard of MVCC whose lists contain this view */
+	ulint		m_shard;
+
 	typedef UT_LIST_NODE_T(ReadView) node_t;
 
 	/** List of read views in trx_sys */
@@ -622,6 +622,9 @@ struct mysql_row_templ_t {
 #define MYSQL_FETCH_CACHE_SIZE		8
 /* After fetching this many rows, we start caching them in fetch_cache */
 #define MYSQL_FETCH_CACHE_THRESHOLD	4
+/* Upper bound of the number of rows that we ask the server to allocate in
+a Record_buffer, so that row_search_mvcc() can fill a batch per call */
+#define MYSQL_FETCH_BATCH_MAX		1000
 
 #define ROW_PREBUILT_ALLOCATED	78540783
 #define ROW_PREBUILT_FREED	26423527
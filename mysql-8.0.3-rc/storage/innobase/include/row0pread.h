@@ -0,0 +1,179 @@
+/*****************************************************************************
+
+Copyright (c) 2017, Oracle and/or its affiliates. All Rights Reserved.
+
+This program is free software; you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation; version 2 of the License.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Suite 500, Boston, MA 02110-1335 USA
+
+*****************************************************************************/
+
+/**************************************************//**
+@file include/row0pread.h
+Parallel read of a clustered index: the index is split into key ranges at
+the boundaries of the upper level B-tree nodes, and the ranges are scanned
+by a pool of threads in the read view of one transaction.
+
+Created Oct 17, 2017
+*******************************************************/
+
+#ifndef row0pread_h
+#define row0pread_h
+
+#include "univ.i"
+
+#include <atomic>
+#include <functional>
+#include <vector>
+
+#include "data0types.h"
+#include "dict0types.h"
+#include "mem0mem.h"
+#include "read0types.h"
+#include "rem0types.h"
+#include "trx0types.h"
+#include "ut0new.h"
+
+/** Maximum value of innodb_parallel_read_threads */
+#define MAX_PARALLEL_READ_THREADS	256
+
+/** Number of threads that read a clustered index in parallel, for
+COUNT(*) and CHECK TABLE */
+extern ulong	srv_parallel_read_threads;
+
+/** Reads the records of a clustered index with a pool of threads. Each
+record that is visible in the read view, and not delete-marked, is passed
+to a callback. The records of one range are passed in key order by one
+thread; the ranges are in key order, but are processed concurrently.
+
+Usage:
+	Parallel_reader	reader(index, trx, n_threads);
+
+	reader.partition();
+	... allocate per-range state for reader.n_ranges() ranges ...
+	err = reader.run([&](const Parallel_reader::Ctx& ctx) { ... }); */
+class Parallel_reader {
+public:
+	/** A visible record, passed to the callback */
+	struct Ctx {
+		/** Thread that reads the record, 0 .. n_threads() - 1 */
+		size_t		m_thread_id;
+
+		/** Range that contains the record, 0 .. n_ranges() - 1 */
+		size_t		m_range;
+
+		/** The record, or its version in the read view */
+		const rec_t*	m_rec;
+
+		/** rec_get_offsets(m_rec, index) */
+		const ulint*	m_offsets;
+	};
+
+	/** Callback for each visible record. Returning an error other
+	than DB_SUCCESS stops the read. */
+	using F = std::function<dberr_t(const Ctx&)>;
+
+	/** Constructor
+	@param[in]	index		clustered index to read
+	@param[in]	trx		transaction whose read view is used,
+					or whose interrupted state is checked
+					if it has no read view (READ
+					UNCOMMITTED)
+	@param[in]	n_threads	maximum number of threads to use,
+					including the calling thread */
+	Parallel_reader(dict_index_t* index, trx_t* trx, size_t n_threads);
+
+	/** Destructor */
+	~Parallel_reader();
+
+	/** Split the index into key ranges at the node pointers of the
+	highest B-tree level that has enough of them for the threads. */
+	void partition();
+
+	/** @return number of ranges, valid after partition() */
+	size_t n_ranges() const
+	{
+		return(m_ranges.size());
+	}
+
+	/** @return number of threads, valid after partition() */
+	size_t n_threads() const
+	{
+		return(m_n_threads);
+	}
+
+	/** Read the ranges, the calling thread takes part in the read.
+	@param[in]	f	callback for each visible record
+	@return DB_SUCCESS, DB_INTERRUPTED, or the error returned by f */
+	dberr_t run(F&& f);
+
+private:
+	/** A range of the index: [m_start, m_end). A NULL key is the low
+	or high end of the index. */
+	struct Range {
+		/** First key of the range, or NULL */
+		const dtuple_t*	m_start;
+
+		/** First key after the range, or NULL */
+		const dtuple_t*	m_end;
+	};
+
+	using Ranges = std::vector<Range, ut_allocator<Range>>;
+
+	/** Read one range.
+	@param[in]	thread_id	thread that reads the range
+	@param[in]	range		range to read
+	@param[in]	f		callback for each visible record
+	@return DB_SUCCESS or error code */
+	dberr_t read_range(size_t thread_id, size_t range, const F& f);
+
+	/** Read ranges until there are no more or an error occurs.
+	@param[in]	thread_id	thread id
+	@param[in]	f		callback for each visible record */
+	void worker(size_t thread_id, const F* f);
+
+	/** Copy the key of a node pointer record.
+	@param[in]	rec		node pointer record
+	@param[in]	offsets		rec_get_offsets(rec, m_index)
+	@return the key, allocated from m_heap */
+	const dtuple_t* copy_key(const rec_t* rec, const ulint* offsets);
+
+	// Disable copying
+	Parallel_reader(const Parallel_reader&) = delete;
+	Parallel_reader& operator=(const Parallel_reader&) = delete;
+
+private:
+	/** The clustered index */
+	dict_index_t*		m_index;
+
+	/** The transaction */
+	trx_t*			m_trx;
+
+	/** The read view, NULL for READ UNCOMMITTED */
+	ReadView*		m_view;
+
+	/** Number of threads to use */
+	size_t			m_n_threads;
+
+	/** The key ranges */
+	Ranges			m_ranges;
+
+	/** Memory for the range keys */
+	mem_heap_t*		m_heap;
+
+	/** Next range to read */
+	std::atomic<size_t>	m_next_range;
+
+	/** The first error, DB_SUCCESS if none. Set once. */
+	std::atomic<int>	m_err;
+};
+
+#endif /* row0pread_h */
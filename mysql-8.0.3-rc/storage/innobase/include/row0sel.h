@@ -193,6 +193,23 @@ row_search_no_mvcc(
 	ulint		direction)
 	MY_ATTRIBUTE((warn_unused_result));
 
+/** Returns the next row of the batch that an earlier call of
+row_search_mvcc() prefetched into the server's record buffer or into the
+prefetch cache of the handle. No mini-transaction, cursor restoration or
+page latch is involved, so a caller that reads rows in a loop should try
+this before calling row_search_mvcc().
+@param[out]	buf		buffer for the fetched row in MySQL format
+@param[in,out]	prebuilt	prebuilt struct for the table handler
+@param[in]	direction	ROW_SEL_NEXT or ROW_SEL_PREV
+@return true if a row was returned in buf, false if the batch is exhausted
+and row_search_mvcc() must be called */
+bool
+row_search_fetch_cached(
+	byte*		buf,
+	row_prebuilt_t*	prebuilt,
+	ulint		direction)
+	MY_ATTRIBUTE((warn_unused_result));
+
 /** Searches for rows in the database using cursor.
 Function is mainly used for tables that are shared accorss connection and
 so it employs technique that can help re-construct the rows that
@@ -200,11 +200,13 @@ enum monitor_id_t {
 
 	MONITOR_LRU_GET_FREE_LOOPS,
 	MONITOR_LRU_GET_FREE_WAITS,
+	MONITOR_LRU_GET_FREE_CLEANER_WAITS,
 
 	MONITOR_FLUSH_AVG_PAGE_RATE,
 	MONITOR_FLUSH_LSN_AVG_RATE,
 	MONITOR_FLUSH_PCT_FOR_DIRTY,
 	MONITOR_FLUSH_PCT_FOR_LSN,
+	MONITOR_FLUSH_PCT_FOR_LSN_CORRECTION,
 	MONITOR_FLUSH_SYNC_WAITS,
 	MONITOR_FLUSH_ADAPTIVE_TOTAL_PAGE,
 	MONITOR_FLUSH_ADAPTIVE_COUNT,
@@ -309,6 +311,10 @@ enum monitor_id_t {
 	MONITOR_DML_PURGE_DELAY,
 	MONITOR_PURGE_STOP_COUNT,
 	MONITOR_PURGE_RESUME_COUNT,
+	MONITOR_PURGE_N_RECS,
+	MONITOR_PURGE_N_THREADS,
+	MONITOR_PURGE_N_TABLES,
+	MONITOR_PURGE_MAX_THREAD_RECS,
 
 	/* Recovery related counters */
 	MONITOR_MODULE_RECOVERY,
@@ -327,6 +333,8 @@ enum monitor_id_t {
 	MONITOR_OVLD_LOG_WRITE_REQUEST,
 	MONITOR_OVLD_LOG_WRITES,
 	MONITOR_OVLD_LOG_PADDED,
+	MONITOR_LOG_WAIT_SPIN_HITS,
+	MONITOR_LOG_WAIT_EVENT_WAITS,
 
 	/* Page Manager related counters */
 	MONITOR_MODULE_PAGE,
@@ -354,6 +362,9 @@ enum monitor_id_t {
 	MONITOR_ADAPTIVE_HASH_ROW_REMOVED,
 	MONITOR_ADAPTIVE_HASH_ROW_REMOVE_NOT_FOUND,
 	MONITOR_ADAPTIVE_HASH_ROW_UPDATED,
+	MONITOR_ADAPTIVE_HASH_PAGE_QUEUED,
+	MONITOR_ADAPTIVE_HASH_INDEX_DISABLED,
+	MONITOR_ADAPTIVE_HASH_INDEX_ENABLED,
 
 	/* Tablespace related counters */
 	MONITOR_MODULE_FIL_SYSTEM,
@@ -369,6 +380,10 @@ enum monitor_id_t {
 	MONITOR_OVLD_IBUF_MERGE_DISCARD_PURGE,
 	MONITOR_OVLD_IBUF_MERGES,
 	MONITOR_OVLD_IBUF_SIZE,
+	MONITOR_IBUF_MERGE_REQUESTS,
+	MONITOR_IBUF_MERGE_SYNC_CONTRACTIONS,
+	MONITOR_IBUF_MERGE_READ_PAGES,
+	MONITOR_IBUF_MERGE_BACKLOG,
 
 	/* Counters for server operations */
 	MONITOR_MODULE_SERVER,
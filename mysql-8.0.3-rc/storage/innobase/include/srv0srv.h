@@ -212,6 +212,14 @@ extern	ulong	srv_adaptive_max_sleep_delay;
 /** Sort buffer size in index creation */
 extern ulong	srv_sort_buf_size;
 
+/** Maximum number of threads that sort and load the secondary indexes
+in index creation */
+#define MAX_INDEX_BUILD_THREADS	64
+
+/** Number of threads that sort and load the secondary indexes in index
+creation */
+extern ulong	srv_index_build_threads;
+
 /** Maximum modification log file size for online index creation */
 extern unsigned long long	srv_online_max_size;
 
@@ -220,6 +228,9 @@ OS (provided we compiled Innobase with it in), otherwise we will
 use simulated aio we build below with threads.
 Currently we support native aio on windows and linux */
 extern bool	srv_use_native_aio;
+/** If this flag is TRUE and native aio is used on Linux, then the
+requests are submitted and reaped through io_uring instead of libaio */
+extern bool	srv_use_io_uring;
 extern bool	srv_numa_interleave;
 #endif /* !UNIV_HOTBACKUP */
 
@@ -275,6 +286,9 @@ extern ulong	srv_log_buffer_size;
 extern ulong	srv_flush_log_at_trx_commit;
 extern uint	srv_flush_log_at_timeout;
 extern ulong	srv_log_write_ahead_size;
+/** Number of rounds to spin waiting for the log writer or flusher thread
+before sleeping on an event */
+extern ulong	srv_log_wait_spin_rounds;
 extern bool	srv_adaptive_flushing;
 extern bool	srv_flush_sync;
 
@@ -312,12 +326,19 @@ extern ulint	srv_buf_pool_base_size;
 extern long long	srv_buf_pool_curr_size;
 /** Dump this % of each buffer pool during BP dump */
 extern ulong	srv_buf_pool_dump_pct;
+/** Format of the buffer pool dump file, see buf_dump_format_t */
+extern ulong	srv_buf_pool_dump_format;
+/** Maximum number of threads that read the pages of a buffer pool load */
+#define MAX_BUF_LOAD_THREADS	64
+/** Number of threads that read the pages of a buffer pool load */
+extern ulong	srv_buf_pool_load_threads;
 /** Lock table size in bytes */
 extern ulint	srv_lock_table_size;
 
 extern ulint	srv_n_file_io_threads;
 extern bool	srv_random_read_ahead;
 extern ulong	srv_read_ahead_threshold;
+extern ulong	srv_read_ahead_leaf_pages;
 extern ulong	srv_n_read_io_threads;
 extern ulong	srv_n_write_io_threads;
 
@@ -380,6 +401,18 @@ extern unsigned long long	srv_stats_persistent_sample_pages;
 extern bool			srv_stats_auto_recalc;
 extern bool			srv_stats_include_delete_marked;
 
+/** Maximum number of threads that analyze the indexes of a table when
+persistent statistics are calculated */
+#define MAX_STATS_ANALYZE_THREADS	64
+
+/** Number of threads that analyze the indexes of a table when persistent
+statistics are calculated */
+extern ulong			srv_stats_analyze_threads;
+
+/** Whether hot index pages keep a cache of the key prefixes of their
+page directory slots for page_cur_search_with_match() */
+extern bool	srv_page_search_cache;
+
 extern ibool	srv_use_doublewrite_buf;
 extern ulong	srv_doublewrite_batch_size;
 extern ulong	srv_checksum_algorithm;
@@ -442,6 +475,12 @@ extern const char* srv_io_thread_function[];
 /* the number of purge threads to use from the worker pool (currently 0 or 1) */
 extern ulong srv_n_purge_threads;
 
+/** Maximum number of threads that apply redo log records in recovery */
+#define MAX_RECV_APPLY_THREADS	64
+
+/** Number of threads that apply a batch of redo log records in recovery */
+extern ulong srv_n_recv_apply_threads;
+
 /* the number of pages to purge in one batch */
 extern ulong srv_purge_batch_size;
 
@@ -466,19 +505,32 @@ extern srv_stats_t	srv_stats;
 
 # ifdef UNIV_PFS_THREAD
 extern mysql_pfs_key_t	archiver_thread_key;
+extern mysql_pfs_key_t	btr_search_build_thread_key;
+extern mysql_pfs_key_t	buf_dblwr_recover_thread_key;
 extern mysql_pfs_key_t	buf_dump_thread_key;
+extern mysql_pfs_key_t	buf_load_thread_key;
 extern mysql_pfs_key_t	buf_resize_thread_key;
+extern mysql_pfs_key_t	dict_stats_analyze_thread_key;
 extern mysql_pfs_key_t	dict_stats_thread_key;
+extern mysql_pfs_key_t	ibuf_merge_thread_key;
+extern mysql_pfs_key_t	fil_scan_thread_key;
+extern mysql_pfs_key_t	fsp_zstd_dict_thread_key;
 extern mysql_pfs_key_t	fts_optimize_thread_key;
 extern mysql_pfs_key_t	fts_parallel_merge_thread_key;
 extern mysql_pfs_key_t	fts_parallel_tokenization_thread_key;
+extern mysql_pfs_key_t	index_build_thread_key;
 extern mysql_pfs_key_t	io_handler_thread_key;
 extern mysql_pfs_key_t	io_ibuf_thread_key;
 extern mysql_pfs_key_t	io_log_thread_key;
 extern mysql_pfs_key_t	io_read_thread_key;
 extern mysql_pfs_key_t	io_write_thread_key;
+extern mysql_pfs_key_t	lock_deadlock_detector_thread_key;
+extern mysql_pfs_key_t	log_flusher_thread_key;
+extern mysql_pfs_key_t	log_writer_thread_key;
 extern mysql_pfs_key_t	page_flush_coordinator_thread_key;
 extern mysql_pfs_key_t	page_flush_thread_key;
+extern mysql_pfs_key_t	parallel_read_thread_key;
+extern mysql_pfs_key_t	recv_apply_thread_key;
 extern mysql_pfs_key_t	recv_writer_thread_key;
 extern mysql_pfs_key_t	srv_error_monitor_thread_key;
 extern mysql_pfs_key_t	srv_lock_timeout_thread_key;
@@ -623,6 +675,13 @@ enum srv_stats_method_name_enum {
 
 typedef enum srv_stats_method_name_enum		srv_stats_method_name_t;
 
+/** Zstandard level of transparent page compression */
+extern ulong	srv_compression_zstd_level;
+
+/** Maximum size in bytes of the Zstandard dictionary trained for a
+tablespace, or 0 to compress without dictionaries */
+extern ulong	srv_compression_zstd_dict_size;
+
 #ifdef UNIV_DEBUG
 /** Force all user tables to use page compression. */
 extern ulong	srv_debug_compress;
@@ -925,6 +984,7 @@ struct srv_slot_t{
 #else /* !UNIV_HOTBACKUP */
 # define srv_use_adaptive_hash_indexes		FALSE
 # define srv_use_native_aio			FALSE
+# define srv_use_io_uring			FALSE
 # define srv_numa_interleave			FALSE
 # define srv_force_recovery			0UL
 # define srv_set_io_thread_op_info(t,info)	((void) 0)
@@ -80,7 +80,10 @@ rw_lock_own(
 #define rw_lock_sx_unlock_inline(M, P, F, L)	((void)0)
 #define sync_check_lock(A,B)			((void)0)
 #define rw_lock_s_lock_nowait(M, F, L)		true
+#define rw_lock_x_lock_nowait(M)		true
 #define rw_lock_own_flagged(A,B)		true
+#define rw_lock_create(K, L, level)		((void)0)
+#define rw_lock_free(L)				((void)0)
 #endif /* UNIV_LIBRARY */
 
 /** Counters for RW locks. */
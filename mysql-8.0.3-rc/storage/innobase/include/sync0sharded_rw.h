@@ -0,0 +1,175 @@
+/*****************************************************************************
+
+Copyright (c) 2017, Oracle and/or its affiliates. All Rights Reserved.
+
+This program is free software; you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation; version 2 of the License.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Suite 500, Boston, MA 02110-1335 USA
+
+*****************************************************************************/
+
+/**************************************************//**
+@file include/sync0sharded_rw.h
+Sharded rw-lock: readers lock a single shard chosen at random, writers lock
+all of the shards. This makes s-locking cheap and free of cache line ping-pong
+for latches which are s-locked very often and x-locked very rarely.
+
+Created Sep 4, 2017
+*******************************************************/
+
+#ifndef sync0sharded_rw_h
+#define sync0sharded_rw_h
+
+#include "univ.i"
+
+#ifndef UNIV_HOTBACKUP
+
+#include "sync0rw.h"
+#include "ut0counter.h"
+#include "ut0new.h"
+
+/** Rw-lock which is split into a number of cache line aligned shards. */
+class Sharded_rw_lock {
+public:
+	/** Create the shards.
+	@param[in]	key		performance schema key
+	@param[in]	latch_level	latch level of each of the shards
+	@param[in]	n_shards	number of shards */
+	void create(
+		mysql_pfs_key_t	key,
+		latch_level_t	latch_level,
+		size_t		n_shards)
+	{
+		ut_a(n_shards > 0);
+
+		m_n_shards = n_shards;
+
+		m_shards = UT_NEW_ARRAY_NOKEY(Shard, n_shards);
+
+		for (size_t i = 0; i < n_shards; ++i) {
+			rw_lock_create(key, &m_shards[i].lock, latch_level);
+		}
+	}
+
+	/** Free the shards. */
+	void free()
+	{
+		ut_a(m_shards != NULL);
+
+		for (size_t i = 0; i < m_n_shards; ++i) {
+			rw_lock_free(&m_shards[i].lock);
+		}
+
+		UT_DELETE_ARRAY(m_shards);
+
+		m_shards = NULL;
+		m_n_shards = 0;
+	}
+
+	/** S-lock one of the shards.
+	@return the shard that was locked; must be passed to s_unlock() */
+	size_t s_lock()
+	{
+		const size_t	shard = counter_indexer_t<>::get_rnd_index()
+			% m_n_shards;
+
+		rw_lock_s_lock(&m_shards[shard].lock);
+
+		return(shard);
+	}
+
+	/** Release a shard that was s-locked by s_lock().
+	@param[in]	shard	shard returned by s_lock() */
+	void s_unlock(size_t shard)
+	{
+		ut_ad(shard < m_n_shards);
+
+		rw_lock_s_unlock(&m_shards[shard].lock);
+	}
+
+	/** X-lock all of the shards, always in the same order. */
+	void x_lock()
+	{
+		for (size_t i = 0; i < m_n_shards; ++i) {
+			rw_lock_x_lock(&m_shards[i].lock);
+		}
+	}
+
+	/** Try to x-lock all of the shards without waiting.
+	@return true if all of the shards were x-locked; if false is returned,
+	none of the shards is locked */
+	bool x_lock_nowait()
+	{
+		for (size_t i = 0; i < m_n_shards; ++i) {
+
+			if (!rw_lock_x_lock_nowait(&m_shards[i].lock)) {
+
+				while (i-- > 0) {
+					rw_lock_x_unlock(&m_shards[i].lock);
+				}
+
+				return(false);
+			}
+		}
+
+		return(true);
+	}
+
+	/** Release all of the shards. */
+	void x_unlock()
+	{
+		for (size_t i = 0; i < m_n_shards; ++i) {
+			rw_lock_x_unlock(&m_shards[i].lock);
+		}
+	}
+
+#ifdef UNIV_DEBUG
+	/** @return true if the calling thread holds the x-lock */
+	bool x_own()
+	{
+		return(rw_lock_own(&m_shards[0].lock, RW_LOCK_X));
+	}
+
+	/** @return true if the calling thread holds an s-lock on one of
+	the shards */
+	bool s_own()
+	{
+		for (size_t i = 0; i < m_n_shards; ++i) {
+
+			if (rw_lock_own(&m_shards[i].lock, RW_LOCK_S)) {
+				return(true);
+			}
+		}
+
+		return(false);
+	}
+#endif /* UNIV_DEBUG */
+
+private:
+	/** A shard, padded so that no two shards share a cache line */
+	struct Shard {
+		/** Padding */
+		char		pad[INNOBASE_CACHE_LINE_SIZE];
+
+		/** The rw-lock of this shard */
+		rw_lock_t	lock;
+	};
+
+	/** Array of m_n_shards shards */
+	Shard*		m_shards;
+
+	/** Number of shards */
+	size_t		m_n_shards;
+};
+
+#endif /* !UNIV_HOTBACKUP */
+
+#endif /* sync0sharded_rw_h */
@@ -83,6 +83,7 @@ instrumentation due to their large number of instances. */
 /* Key defines to register InnoDB mutexes with performance schema */
 extern mysql_pfs_key_t	autoinc_mutex_key;
 extern mysql_pfs_key_t	autoinc_persisted_mutex_key;
+extern mysql_pfs_key_t	ahi_build_queue_mutex_key;
 #ifndef PFS_SKIP_BUFFER_MUTEX_RWLOCK
 extern mysql_pfs_key_t	buffer_block_mutex_key;
 #endif /* !PFS_SKIP_BUFFER_MUTEX_RWLOCK */
@@ -147,9 +148,11 @@ extern mysql_pfs_key_t	trx_undo_mutex_key;
 extern mysql_pfs_key_t	trx_mutex_key;
 extern mysql_pfs_key_t	trx_pool_mutex_key;
 extern mysql_pfs_key_t	trx_pool_manager_mutex_key;
-extern mysql_pfs_key_t	lock_mutex_key;
+extern mysql_pfs_key_t	lock_sys_page_mutex_key;
+extern mysql_pfs_key_t	lock_sys_table_mutex_key;
 extern mysql_pfs_key_t	lock_wait_mutex_key;
 extern mysql_pfs_key_t	trx_sys_mutex_key;
+extern mysql_pfs_key_t	mvcc_view_mutex_key;
 extern mysql_pfs_key_t	srv_sys_mutex_key;
 extern mysql_pfs_key_t	srv_threads_mutex_key;
 #ifndef PFS_SKIP_EVENT_MUTEX
@@ -180,6 +183,8 @@ extern	mysql_pfs_key_t	buf_block_debug_latch_key;
 extern	mysql_pfs_key_t	dict_operation_lock_key;
 extern  mysql_pfs_key_t	dict_persist_checkpoint_key;
 extern	mysql_pfs_key_t	checkpoint_lock_key;
+extern	mysql_pfs_key_t	log_sn_lock_key;
+extern	mysql_pfs_key_t	lock_sys_latch_key;
 extern	mysql_pfs_key_t	undo_spaces_lock_key;
 extern	mysql_pfs_key_t	rsegs_lock_key;
 extern	mysql_pfs_key_t	fil_space_latch_key;
@@ -216,6 +216,8 @@ enum latch_level_t {
 
 	SYNC_ANY_LATCH,
 
+	SYNC_FIL_SHARD,
+
 	SYNC_DOUBLEWRITE,
 
 	SYNC_PAGE_ARCH_OPER,
@@ -254,6 +256,8 @@ enum latch_level_t {
 	SYNC_THREADS,
 	SYNC_TRX,
 	SYNC_TRX_SYS,
+	SYNC_MVCC_VIEW,
+	SYNC_LOCK_SYS_SHARD,
 	SYNC_LOCK_SYS,
 	SYNC_LOCK_WAIT_SYS,
 
@@ -325,6 +329,7 @@ up its meta-data. See sync0debug.c. */
 enum latch_id_t {
 	LATCH_ID_NONE = 0,
 	LATCH_ID_AUTOINC,
+	LATCH_ID_AHI_BUILD_QUEUE,
 	LATCH_ID_BUF_BLOCK_MUTEX,
 	LATCH_ID_BUF_POOL_ZIP,
 	LATCH_ID_BUF_POOL_LRU_LIST,
@@ -335,7 +340,7 @@ enum latch_id_t {
 	LATCH_ID_CACHE_LAST_READ,
 	LATCH_ID_DICT_FOREIGN_ERR,
 	LATCH_ID_DICT_SYS,
-	LATCH_ID_FIL_SYSTEM,
+	LATCH_ID_FIL_SHARD,
 	LATCH_ID_FLUSH_LIST,
 	LATCH_ID_FTS_BG_THREADS,
 	LATCH_ID_FTS_DELETE,
@@ -384,8 +389,11 @@ enum latch_id_t {
 	LATCH_ID_TRX_POOL_MANAGER,
 	LATCH_ID_TRX,
 	LATCH_ID_LOCK_SYS,
+	LATCH_ID_LOCK_SYS_PAGE,
+	LATCH_ID_LOCK_SYS_TABLE,
 	LATCH_ID_LOCK_SYS_WAIT,
 	LATCH_ID_TRX_SYS,
+	LATCH_ID_MVCC_VIEW,
 	LATCH_ID_SRV_SYS,
 	LATCH_ID_SRV_SYS_TASKS,
 	LATCH_ID_PAGE_ZIP_STAT_PER_INDEX,
@@ -407,6 +415,7 @@ enum latch_id_t {
 	LATCH_ID_BUF_BLOCK_DEBUG,
 	LATCH_ID_DICT_OPERATION,
 	LATCH_ID_CHECKPOINT,
+	LATCH_ID_LOG_SN,
 	LATCH_ID_RSEGS,
 	LATCH_ID_UNDO_SPACES,
 	LATCH_ID_FIL_SPACE,
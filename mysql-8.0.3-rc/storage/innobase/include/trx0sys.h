@@ -28,6 +28,8 @@ Created 3/26/1996 Heikki Tuuri
 
 #include "univ.i"
 
+#include <atomic>
+
 #include "buf0buf.h"
 #include "fil0fil.h"
 #include "trx0types.h"
@@ -478,6 +480,15 @@ struct trx_sys_t {
 	trx_ut_list_t	serialisation_list;
 					/*!< Ordered on trx_t::no of all the
 					currenrtly active RW transactions */
+	std::atomic<trx_t*>
+			serialisation_queue;
+					/*!< Committing transactions that wait
+					for a serialisation number, linked by
+					trx_t::serialisation_next. Pushed
+					without holding the mutex and taken
+					as a whole by the leader of the
+					batch, the transaction that was
+					pushed to the empty queue. */
 #ifdef UNIV_DEBUG
 	trx_id_t	rw_max_trx_id;	/*!< Max trx id of read-write
 					transactions which exist or existed */
@@ -28,6 +28,7 @@ Created 3/26/1996 Heikki Tuuri
 
 #include <set>
 #include <list>
+#include <atomic>
 
 #include "ha_prototypes.h"
 
@@ -938,6 +939,22 @@ struct trx_t {
 					when trx->in_rw_trx_list. Initially
 					set to TRX_ID_MAX. */
 
+	trx_t*		serialisation_next;
+					/*!< next transaction in
+					trx_sys->serialisation_queue */
+
+	std::atomic<bool>
+			in_serialisation_queue;
+					/*!< true while the transaction waits
+					in trx_sys->serialisation_queue for
+					the leader of its batch to assign
+					trx->no */
+
+	os_event_t	serialisation_event;
+					/*!< set by the leader of the batch
+					when it has cleared
+					in_serialisation_queue */
+
 	/** State of the trx from the point of view of concurrency control
 	and the valid state transitions.
 
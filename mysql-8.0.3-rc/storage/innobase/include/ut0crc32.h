@@ -54,6 +54,23 @@ extern ut_crc32_func_t	ut_crc32_legacy_big_endian;
 but very slow). */
 extern ut_crc32_func_t	ut_crc32_byte_by_byte;
 
+/********************************************************************//**
+Calculates the CRC32 of several buffers of the same length at once, which
+is faster than one at a time because the buffers are checksummed in
+parallel.
+@param bufs - buffers over which to calculate CRC32.
+@param len - length of each buffer in bytes.
+@param n - number of buffers.
+@param crcs - out: CRC32 of each buffer, as ut_crc32() would return it */
+typedef void	(*ut_crc32_batch_func_t)(
+	const byte* const*	bufs,
+	ulint			len,
+	ulint			n,
+	uint32_t*		crcs);
+
+/** Pointer to the batch CRC32 calculation function. */
+extern ut_crc32_batch_func_t	ut_crc32_batch;
+
 /** Flag that tells whether the CPU supports CRC32 or not.
 The CRC32 instructions are part of the SSE4.2 instruction set. */
 extern bool		ut_crc32_cpu_enabled;
@@ -0,0 +1,176 @@
+/*****************************************************************************
+
+Copyright (c) 2017, Oracle and/or its affiliates. All Rights Reserved.
+
+This program is free software; you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation; version 2 of the License.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Suite 500, Boston, MA 02110-1335 USA
+
+*****************************************************************************/
+
+/**************************************************//**
+@file include/ut0link_buf.h
+Link buffer: tracks which ranges of a monotonically growing position space
+have been completed by concurrent producers, so that a single consumer can
+find the largest position up to which there are no holes.
+
+Created Sep 4, 2017
+*******************************************************/
+
+#ifndef ut0link_buf_h
+#define ut0link_buf_h
+
+#include "univ.i"
+
+#include <atomic>
+
+#include "ut0dbg.h"
+#include "ut0new.h"
+
+/** Concurrent data structure which tracks completed ranges [from, to).
+
+Producers report their ranges with add_link() in any order. Links are stored
+in a ring of slots indexed by the start of the range; a slot holds the length
+of the range, or zero if no range starting there has been reported yet.
+
+A single consumer (which must be serialised by the caller) calls
+advance_tail() to follow the links from the current tail as long as they
+exist, which yields the largest position up to which all the ranges have
+been reported.
+
+A producer must not report a range which starts at or beyond
+tail() + capacity(), because its slot could still be in use; has_space()
+tells whether that is the case.
+@tparam	Position	type of the positions */
+template <typename Position = uint64_t>
+class Link_buf {
+public:
+	/** Constructor.
+	@param[in]	capacity	number of slots; must be a power of two */
+	explicit Link_buf(size_t capacity)
+		:
+		m_capacity(capacity),
+		m_links(UT_NEW_ARRAY_NOKEY(std::atomic<Position>, capacity)),
+		m_tail(0)
+	{
+		ut_a(capacity > 1);
+		ut_a((capacity & (capacity - 1)) == 0);
+
+		for (size_t i = 0; i < capacity; ++i) {
+			m_links[i].store(0, std::memory_order_relaxed);
+		}
+	}
+
+	/** Destructor. */
+	~Link_buf()
+	{
+		UT_DELETE_ARRAY(m_links);
+	}
+
+	/** Report that the range [from, to) has been completed.
+	All the writes done by the calling thread before this call are
+	visible to the thread which observes the range in advance_tail().
+	@param[in]	from	start of the range
+	@param[in]	to	end of the range */
+	void add_link(Position from, Position to)
+	{
+		ut_ad(to > from);
+		ut_ad(has_space(from));
+
+		m_links[slot(from)].store(to - from, std::memory_order_release);
+	}
+
+	/** Follow the reported links starting at the tail, and move the tail
+	to the end of the last one of them. The caller must make sure that
+	only one thread at a time executes this.
+	@return the new tail */
+	Position advance_tail()
+	{
+		Position	tail = m_tail.load(std::memory_order_relaxed);
+
+		for (;;) {
+			std::atomic<Position>&	link = m_links[slot(tail)];
+
+			const Position	distance = link.load(
+				std::memory_order_acquire);
+
+			if (distance == 0) {
+				break;
+			}
+
+			/* Free the slot for the range which will start
+			capacity positions later. */
+			link.store(0, std::memory_order_relaxed);
+
+			tail += distance;
+		}
+
+		m_tail.store(tail, std::memory_order_release);
+
+		return(tail);
+	}
+
+	/** @return the position up to which all ranges have been reported,
+	as of the last call to advance_tail() */
+	Position tail() const
+	{
+		return(m_tail.load(std::memory_order_acquire));
+	}
+
+	/** Check whether a range starting at the given position may be
+	reported now.
+	@param[in]	from	start of the range
+	@return true if the slot of the range is free */
+	bool has_space(Position from) const
+	{
+		return(from < tail() + m_capacity);
+	}
+
+	/** Move the tail to a new position. Must only be called when no
+	range is being reported concurrently, and no link is pending.
+	@param[in]	position	new tail */
+	void reset(Position position)
+	{
+		for (size_t i = 0; i < m_capacity; ++i) {
+			ut_ad(m_links[i].load(std::memory_order_relaxed) == 0);
+		}
+
+		m_tail.store(position, std::memory_order_release);
+	}
+
+	/** @return number of slots */
+	size_t capacity() const
+	{
+		return(m_capacity);
+	}
+
+private:
+	/** @return slot of the given position */
+	size_t slot(Position position) const
+	{
+		return(static_cast<size_t>(position & (m_capacity - 1)));
+	}
+
+	/** Number of slots; a power of two */
+	const size_t		m_capacity;
+
+	/** Ring of slots */
+	std::atomic<Position>*	m_links;
+
+	/** Position up to which all ranges have been reported */
+	std::atomic<Position>	m_tail;
+
+	/* Disable copying */
+	Link_buf(const Link_buf&);
+	Link_buf& operator=(const Link_buf&);
+};
+
+#endif /* ut0link_buf_h */
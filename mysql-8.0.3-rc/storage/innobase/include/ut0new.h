@@ -166,6 +166,7 @@ extern PSI_memory_key	mem_key_dict_stats_bg_recalc_pool_t;
 extern PSI_memory_key	mem_key_dict_stats_index_map_t;
 extern PSI_memory_key	mem_key_dict_stats_n_diff_on_level;
 extern PSI_memory_key	mem_key_other;
+extern PSI_memory_key	mem_key_page_search_cache;
 extern PSI_memory_key	mem_key_partitioning;
 extern PSI_memory_key	mem_key_row_log_buf;
 extern PSI_memory_key	mem_key_row_merge_sort;
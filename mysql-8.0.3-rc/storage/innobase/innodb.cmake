@@ -36,6 +36,13 @@ IF(UNIX)
     IF(HAVE_LIBAIO_H AND HAVE_LIBAIO)
       ADD_DEFINITIONS(-DLINUX_NATIVE_AIO=1)
       LINK_LIBRARIES(aio)
+
+      # io_uring is used through the system calls directly, only the
+      # kernel header is needed. libaio remains the fallback.
+      CHECK_INCLUDE_FILES (linux/io_uring.h HAVE_LINUX_IO_URING_H)
+      IF(HAVE_LINUX_IO_URING_H)
+        ADD_DEFINITIONS(-DLINUX_IO_URING=1)
+      ENDIF()
     ENDIF()
 
   ELSEIF(CMAKE_SYSTEM_NAME STREQUAL "SunOS")
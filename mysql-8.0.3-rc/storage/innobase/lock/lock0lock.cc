@@ -59,6 +59,9 @@ Created 5/7/1996 Heikki Tuuri
 /* Flag to enable/disable deadlock detector. */
 bool	innobase_deadlock_detect = true;
 
+/** Search for deadlocks in the background deadlock detector thread */
+bool	innobase_deadlock_detect_async = false;
+
 /** Total number of cached record locks */
 static const ulint	REC_LOCK_CACHE = 8;
 
@@ -238,6 +241,9 @@ private:
 	@param lock lock trx wants */
 	static void rollback_print(const trx_t* trx, const lock_t* lock);
 
+	/* The background deadlock detector prints the same report. */
+	friend class WaitForGraph;
+
 private:
 	/** DFS state information, used during deadlock checking. */
 	struct state_t {
@@ -278,6 +284,95 @@ uint64_t	DeadlockChecker::s_lock_mark_counter = 0;
 /** The stack used for deadlock searches. */
 DeadlockChecker::state_t	DeadlockChecker::s_states[MAX_STACK_SIZE];
 
+/** Snapshot of the waits-for graph among the transactions which are suspended
+in a lock wait, used by the background deadlock detector.
+
+The snapshot is taken with lock_sys x-latched, which costs time proportional
+to the number of waiting transactions and the length of their lock queues.
+The cycles are then searched for without holding any latch, and each of them
+is checked again with lock_sys x-latched before a victim is chosen, because
+the waits may have ended in the meantime. Transactions which are not waiting
+cannot be on a cycle, so they are not part of the graph. */
+class WaitForGraph {
+public:
+	/** Take a snapshot of the waits. The caller must hold the lock wait
+	mutex and lock_sys x-latched. */
+	void build();
+
+	/** Find the cycles in the snapshot. Does not access the lock system. */
+	void find_cycles();
+
+	/** Resolve the cycles found by find_cycles() that still exist. The
+	caller must hold lock_sys x-latched.
+	@return number of transactions chosen as deadlock victims */
+	ulint resolve();
+
+	/** @return true if find_cycles() found no cycle */
+	bool no_cycles() const
+	{
+		return(m_cycles.empty());
+	}
+
+private:
+	/** A waiting transaction */
+	struct node_t {
+		/** The waiting transaction */
+		trx_t*		m_trx;
+
+		/** Lock that m_trx was waiting for at the time of the
+		snapshot */
+		const lock_t*	m_wait_lock;
+
+		/** Position of the first outgoing edge in m_edges */
+		size_t		m_first_edge;
+
+		/** Number of outgoing edges */
+		size_t		m_n_edges;
+	};
+
+	/** Cycle, as a range [first, last) of m_cycle_nodes */
+	typedef std::pair<size_t, size_t>	cycle_t;
+
+	/** Invoke a functor for each lock ahead of wait_lock in its queue
+	that wait_lock has to wait for.
+	@param[in]	wait_lock	waiting lock
+	@param[in]	f		functor taking const lock_t*; returns
+					false to stop the iteration */
+	template <typename F>
+	static void for_each_blocker(const lock_t* wait_lock, F&& f);
+
+	/** Check that the waits of a cycle still exist.
+	@param[in]	cycle	cycle to check
+	@return true if every transaction on the cycle still waits for the
+	same lock, and that lock still has to wait for a lock of the next
+	transaction on the cycle */
+	bool is_valid(const cycle_t& cycle) const;
+
+	/** Choose the victim of a cycle. Transactions of low priority are
+	preferred, and among them the one with the smallest weight.
+	@param[in]	cycle	cycle
+	@return the victim */
+	const node_t& select_victim(const cycle_t& cycle) const;
+
+	/** Print a cycle and its victim to the deadlock report.
+	@param[in]	cycle	cycle
+	@param[in]	victim	victim transaction */
+	void print(const cycle_t& cycle, const node_t& victim) const;
+
+	/** Waiting transactions */
+	std::vector<node_t>	m_nodes;
+
+	/** Targets of the edges, as positions in m_nodes */
+	std::vector<size_t>	m_edges;
+
+	/** Nodes of the cycles found, as positions in m_nodes, in the
+	order of the waits */
+	std::vector<size_t>	m_cycle_nodes;
+
+	/** Cycles found */
+	std::vector<cycle_t>	m_cycles;
+};
+
 #ifdef UNIV_DEBUG
 /*********************************************************************//**
 Validates the lock system.
@@ -456,12 +551,31 @@ lock_sys_create(
 
 	lock_sys->last_slot = lock_sys->waiting_threads;
 
-	mutex_create(LATCH_ID_LOCK_SYS, &lock_sys->mutex);
+	lock_sys->latch.create(
+		lock_sys_latch_key, SYNC_LOCK_SYS, LOCK_SYS_N_LATCH_SHARDS);
+
+	lock_sys->page_shards = static_cast<lock_sys_shard_t*>(
+		ut_zalloc_nokey(
+			LOCK_SYS_N_SHARDS * sizeof(*lock_sys->page_shards)));
+
+	lock_sys->table_shards = static_cast<lock_sys_shard_t*>(
+		ut_zalloc_nokey(
+			LOCK_SYS_N_SHARDS * sizeof(*lock_sys->table_shards)));
+
+	for (ulint i = 0; i < LOCK_SYS_N_SHARDS; ++i) {
+		mutex_create(LATCH_ID_LOCK_SYS_PAGE,
+			     &lock_sys->page_shards[i].mutex);
+
+		mutex_create(LATCH_ID_LOCK_SYS_TABLE,
+			     &lock_sys->table_shards[i].mutex);
+	}
 
 	mutex_create(LATCH_ID_LOCK_SYS_WAIT, &lock_sys->wait_mutex);
 
 	lock_sys->timeout_event = os_event_create(0);
 
+	lock_sys->deadlock_event = os_event_create(0);
+
 	lock_sys->rec_hash = hash_create(n_cells);
 	lock_sys->prdt_hash = hash_create(n_cells);
 	lock_sys->prdt_page_hash = hash_create(n_cells);
@@ -557,7 +671,18 @@ lock_sys_close(void)
 
 	os_event_destroy(lock_sys->timeout_event);
 
-	mutex_destroy(&lock_sys->mutex);
+	os_event_destroy(lock_sys->deadlock_event);
+
+	for (ulint i = 0; i < LOCK_SYS_N_SHARDS; ++i) {
+		mutex_destroy(&lock_sys->page_shards[i].mutex);
+		mutex_destroy(&lock_sys->table_shards[i].mutex);
+	}
+
+	ut_free(lock_sys->page_shards);
+	ut_free(lock_sys->table_shards);
+
+	lock_sys->latch.free();
+
 	mutex_destroy(&lock_sys->wait_mutex);
 
 	srv_slot_t*	slot = lock_sys->waiting_threads;
@@ -583,6 +708,26 @@ lock_get_size(void)
 	return((ulint) sizeof(lock_t));
 }
 
+#ifdef UNIV_DEBUG
+/** Check if the calling thread may access the lock queue which a lock
+belongs to: it must either x-latch lock_sys, or s-latch it and own the
+mutex of the shard of the page or the table of the lock.
+@param[in]	lock	record or table lock
+@return true if the queue of the lock may be accessed */
+static
+bool
+lock_queue_own(const lock_t* lock)
+{
+	if (lock_get_type_low(lock) == LOCK_REC) {
+
+		return(lock_sys_page_own(lock->rec_lock.space,
+					 lock->rec_lock.page_no));
+	}
+
+	return(lock_sys_table_own(lock->tab_lock.table));
+}
+#endif /* UNIV_DEBUG */
+
 /*********************************************************************//**
 Sets the wait flag of a lock and the back pointer in trx to lock. */
 UNIV_INLINE
@@ -612,7 +757,7 @@ lock_reset_lock_and_trx_wait(
 {
 	ut_ad(lock->trx->lock.wait_lock == lock);
 	ut_ad(lock_get_wait(lock));
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_queue_own(lock));
 
 	lock->trx->lock.wait_lock = NULL;
 	lock->type_mode &= ~LOCK_WAIT;
@@ -1327,7 +1472,7 @@ RecLock::lock_alloc(
 	const RecID&	rec_id,
 	ulint		size)
 {
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_sys_page_own(rec_id.m_space_id, rec_id.m_page_no));
 
 	lock_t*	lock;
 
@@ -1394,7 +1539,10 @@ static
 bool
 lock_use_fcfs(const trx_t* trx)
 {
-	ut_ad(lock_mutex_own());
+	/* n_waiting is only modified with lock_sys x-latched, therefore
+	the result stays valid for as long as lock_sys is latched in
+	either mode. */
+	ut_ad(lock_sys_own());
 
 	return(thd_is_replication_slave_thread(trx->mysql_thd)
 	       || lock_sys->n_waiting < LOCK_VATS_THRESHOLD);
@@ -1489,7 +1637,7 @@ lock_update_age(
 	ulint		heap_no,
 	bool		wait)
 {
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_queue_own(new_lock));
 
 	if (lock_use_fcfs(new_lock->trx)
 	    || new_lock->trx->state != TRX_STATE_ACTIVE) {
@@ -1497,6 +1645,10 @@ lock_update_age(
 		return;
 	}
 
+	/* The ages are global state, they may only be updated with
+	lock_sys x-latched. */
+	ut_ad(lock_mutex_own());
+
 	using Trxs = std::unordered_set<trx_t*>;
 
 	Trxs	trxs;
@@ -1553,7 +1705,7 @@ lock_update_age(
 void
 RecLock::lock_add(lock_t* lock, bool add_to_hash)
 {
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_sys_page_own(m_rec_id.m_space_id, m_rec_id.m_page_no));
 	ut_ad(trx_mutex_own(lock->trx));
 
 	bool	wait = m_mode & LOCK_WAIT;
@@ -1562,7 +1714,7 @@ RecLock::lock_add(lock_t* lock, bool add_to_hash)
 		ulint		key = m_rec_id.fold();
 		hash_table_t*	lock_hash = lock_hash_get(m_mode);
 
-		++lock->index->table->n_rec_locks;
+		os_atomic_increment_ulint(&lock->index->table->n_rec_locks, 1);
 
 		if (!lock_use_fcfs(lock->trx) && !wait) {
 
@@ -1603,7 +1755,7 @@ RecLock::create(
 	bool	add_to_hash,
 	const	lock_prdt_t* prdt)
 {
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_sys_page_own(m_rec_id.m_space_id, m_rec_id.m_page_no));
 	ut_ad(trx->owns_mutex == trx_mutex_own(trx));
 
 	/* Create the explicit lock instance and initialise it. */
@@ -1967,7 +2119,9 @@ lock_rec_lock_fast(
 	dict_index_t*		index,	/*!< in: index of record */
 	que_thr_t*		thr)	/*!< in: query thread */
 {
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_sys_page_own(block->page.id.space(),
+				block->page.id.page_no()));
+	ut_ad(lock_use_fcfs(thr_get_trx(thr)));
 	ut_ad(!srv_read_only_mode);
 	ut_ad((LOCK_MODE_MASK & mode) != LOCK_S
 	      || lock_table_has(thr_get_trx(thr), index->table, LOCK_IS));
@@ -2139,7 +2293,10 @@ lock_rec_lock_slow(
 possible, enqueues a waiting lock request. This is a low-level function
 which does NOT look at implicit locks! Checks lock compatibility within
 explicit locks. This function sets a normal next-key lock, or in the case
-of a page supremum record, a gap type lock.
+of a page supremum record, a gap type lock. The caller must not hold the
+lock_sys latch: the common cases are handled by lock_rec_lock_fast() with
+lock_sys s-latched and only the shard of the page locked, the others by
+lock_rec_lock_slow() with lock_sys x-latched.
 @param[in]	impl		if true, no lock is set	if no wait is
 				necessary: we assume that the caller will
 				set an implicit lock
@@ -2164,7 +2321,7 @@ lock_rec_lock(
 	dict_index_t*		index,
 	que_thr_t*		thr)
 {
-	ut_ad(lock_mutex_own());
+	ut_ad(!lock_mutex_own());
 	ut_ad(!srv_read_only_mode);
 	ut_ad((LOCK_MODE_MASK & mode) != LOCK_S
 	      || lock_table_has(thr_get_trx(thr), index->table, LOCK_IS));
@@ -2178,19 +2335,46 @@ lock_rec_lock(
 	ut_ad(index->is_clustered() || !dict_index_is_online_ddl(index));
 
 	/* We try a simplified and faster subroutine for the most
-	common cases */
-	switch (lock_rec_lock_fast(impl, mode, block, heap_no, index, thr)) {
+	common cases. It only looks at the lock queue of the page, which
+	is protected by the page shard. With VATS the ages of the other
+	transactions in the queue have to be updated, which requires
+	the x-latch. */
+
+	lock_rec_req_status	status = LOCK_REC_FAIL;
+
+	size_t		shard = lock_sys_s_enter();
+
+	if (lock_use_fcfs(thr_get_trx(thr))) {
+		LockMutex*	page_mutex = lock_sys->page_mutex(
+			block->page.id.space(), block->page.id.page_no());
+
+		mutex_enter(page_mutex);
+
+		status = lock_rec_lock_fast(
+			impl, mode, block, heap_no, index, thr);
+
+		mutex_exit(page_mutex);
+	}
+
+	lock_sys_s_exit(shard);
+
+	switch (status) {
 	case LOCK_REC_SUCCESS:
 		return(DB_SUCCESS);
 	case LOCK_REC_SUCCESS_CREATED:
 		return(DB_SUCCESS_LOCKED_REC);
 	case LOCK_REC_FAIL:
-		return(lock_rec_lock_slow(impl, sel_mode, mode, block,
-					  heap_no, index, thr));
+		break;
 	}
 
-	ut_error;
-	return(DB_ERROR);
+	lock_mutex_enter();
+
+	dberr_t	err = lock_rec_lock_slow(
+		impl, sel_mode, mode, block, heap_no, index, thr);
+
+	lock_mutex_exit();
+
+	return(err);
 }
 
 /*********************************************************************//**
@@ -2210,7 +2394,7 @@ lock_rec_has_to_wait_in_queue(
 	ulint		bit_offset;
 	hash_table_t*	hash;
 
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_queue_own(wait_lock));
 	ut_ad(lock_get_wait(wait_lock));
 	ut_ad(lock_get_type_low(wait_lock) == LOCK_REC);
 
@@ -2249,7 +2433,7 @@ lock_grant(
 /*=======*/
 	lock_t*	lock)	/*!< in/out: waiting lock request */
 {
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_queue_own(lock));
 
 	lock_reset_lock_and_trx_wait(lock);
 
@@ -2439,7 +2623,7 @@ RecLock::lock_add_priority(
 	/* Add the lock to lock hash table. */
 	lock->hash = add_position->hash;
 	add_position->hash = lock;
-	++lock->index->table->n_rec_locks;
+	os_atomic_increment_ulint(&lock->index->table->n_rec_locks, 1);
 
 	return(grant_lock);
 }
@@ -2861,7 +3045,7 @@ static
 void
 lock_rec_dequeue_from_page(lock_t* in_lock, bool use_fcfs)
 {
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_queue_own(in_lock));
 	ut_ad(lock_get_type_low(in_lock) == LOCK_REC);
 
 	/* We may or may not be holding in_lock->trx->mutex here. */
@@ -2871,7 +3055,7 @@ lock_rec_dequeue_from_page(lock_t* in_lock, bool use_fcfs)
 	auto	page_no = in_lock->rec_lock.page_no;
 
 	ut_ad(in_lock->index->table->n_rec_locks > 0);
-	in_lock->index->table->n_rec_locks--;
+	os_atomic_decrement_ulint(&in_lock->index->table->n_rec_locks, 1);
 
 	hash_table_t*	lock_hash = lock_hash_get(in_lock->type_mode);
 
@@ -2936,7 +3120,7 @@ lock_rec_discard(lock_t* in_lock)
 	page_no = in_lock->rec_lock.page_no;
 
 	ut_ad(in_lock->index->table->n_rec_locks > 0);
-	in_lock->index->table->n_rec_locks--;
+	os_atomic_decrement_ulint(&in_lock->index->table->n_rec_locks, 1);
 
 	HASH_DELETE(lock_t, hash, lock_hash_get(in_lock->type_mode),
 			    lock_rec_fold(space, page_no), in_lock);
@@ -4108,7 +4292,7 @@ lock_table_create(
 	lock_t*		lock;
 
 	ut_ad(table && trx);
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_sys_table_own(table));
 	ut_ad(trx_mutex_own(trx));
 
 	check_trx_state(trx);
@@ -4181,7 +4365,7 @@ lock_table_pop_autoinc_locks(
 /*=========================*/
 	trx_t*	trx)	/*!< in/out: transaction that owns the AUTOINC locks */
 {
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_sys_own());
 	ut_ad(!ib_vector_is_empty(trx->autoinc_locks));
 
 	/* Skip any gaps, gaps are NULL lock entries in the
@@ -4209,7 +4393,7 @@ lock_table_remove_autoinc_lock(
 	lock_t*	autoinc_lock;
 	lint	i = ib_vector_size(trx->autoinc_locks) - 1;
 
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_queue_own(lock));
 	ut_ad(lock_get_mode(lock) == LOCK_AUTO_INC);
 	ut_ad(lock_get_type_low(lock) & LOCK_TABLE);
 	ut_ad(!ib_vector_is_empty(trx->autoinc_locks));
@@ -4261,7 +4445,7 @@ lock_table_remove_low(
 	trx_t*		trx;
 	dict_table_t*	table;
 
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_queue_own(lock));
 
 	trx = lock->trx;
 	table = lock->tab_lock.table;
@@ -4402,7 +4586,7 @@ lock_table_other_has_incompatible(
 {
 	const lock_t*	lock;
 
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_sys_table_own(table));
 
 	for (lock = UT_LIST_GET_LAST(table->locks);
 	     lock != NULL;
@@ -4474,11 +4658,40 @@ lock_table(
 		trx_set_rw_mode(trx);
 	}
 
-	lock_mutex_enter();
+	/* First try to grant the lock with lock_sys s-latched and only
+	the shard of the table locked. If we may have to wait, retry
+	with lock_sys x-latched, which is needed for enqueueing a
+	waiting request and for deadlock detection. */
+
+	size_t		shard = lock_sys_s_enter();
+	LockMutex*	table_mutex = lock_sys->table_mutex(table);
+
+	mutex_enter(table_mutex);
 
 	/* We have to check if the new lock is compatible with any locks
 	other transactions have in the table lock queue. */
 
+	wait_for = lock_table_other_has_incompatible(
+		trx, LOCK_WAIT, table, mode);
+
+	if (wait_for == NULL) {
+		trx_mutex_enter(trx);
+
+		lock_table_create(table, mode | flags, trx);
+
+		trx_mutex_exit(trx);
+	}
+
+	mutex_exit(table_mutex);
+
+	lock_sys_s_exit(shard);
+
+	if (wait_for == NULL) {
+		return(DB_SUCCESS);
+	}
+
+	lock_mutex_enter();
+
 	wait_for = lock_table_other_has_incompatible(
 		trx, LOCK_WAIT, table, mode);
 
@@ -4544,7 +4757,7 @@ lock_table_has_to_wait_in_queue(
 	const dict_table_t*	table;
 	const lock_t*		lock;
 
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_queue_own(wait_lock));
 	ut_ad(lock_get_wait(wait_lock));
 
 	table = wait_lock->tab_lock.table;
@@ -4574,7 +4787,7 @@ lock_table_dequeue(
 			behind will get their lock requests granted, if
 			they are now qualified to it */
 {
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_queue_own(in_lock));
 	ut_a(lock_get_type_low(in_lock) == LOCK_TABLE);
 
 	lock_t*	lock = UT_LIST_GET_NEXT(tab_lock.locks, in_lock);
@@ -4783,11 +4996,11 @@ lock_rec_unlock(
 
 /*********************************************************************//**
 Releases transaction locks, and releases possible other transactions waiting
-because of these locks. */
+because of these locks. The caller must x-latch lock_sys. */
 static
 void
-lock_release(
-/*=========*/
+lock_release_low(
+/*=============*/
 	trx_t*	trx)	/*!< in/out: transaction */
 {
 	lock_t*		lock;
@@ -4824,6 +5037,89 @@ lock_release(
 	}
 }
 
+/*********************************************************************//**
+Releases transaction locks, and releases possible other transactions waiting
+because of these locks. The transaction must be committed in memory, so that
+no other thread can add locks to it any more. The caller must s-latch
+lock_sys: each lock is released holding only the mutex of the shard of its
+queue. If VATS is in use, the locks are released with lock_sys x-latched.
+@param[in,out]	trx	transaction
+@param[in,out]	shard	shard of the lock_sys latch that is s-latched;
+			the latch is released and reacquired from time
+			to time so that waiters for the x-latch may proceed */
+static
+void
+lock_release(trx_t* trx, size_t* shard)
+{
+	ulint		count = 0;
+
+	ut_ad(lock_sys_s_own());
+	ut_ad(!trx_mutex_own(trx));
+	ut_ad(!trx->is_dd_trx);
+	ut_ad(trx_state_eq(trx, TRX_STATE_COMMITTED_IN_MEMORY));
+
+	/* Only this thread modifies the list of locks of a committed
+	transaction, and any thread which would modify other lock queues
+	in bulk must x-latch lock_sys. */
+
+	for (lock_t* lock = UT_LIST_GET_LAST(trx->lock.trx_locks);
+	     lock != NULL;
+	     lock = UT_LIST_GET_LAST(trx->lock.trx_locks)) {
+
+		if (!lock_use_fcfs(trx)) {
+
+			/* Granting the locks with VATS updates the ages
+			of the transactions in the queue. */
+
+			lock_sys_s_exit(*shard);
+
+			lock_mutex_enter();
+
+			lock_release_low(trx);
+
+			lock_mutex_exit();
+
+			*shard = lock_sys_s_enter();
+
+			return;
+		}
+
+		LockMutex*	mutex;
+
+		if (lock_get_type_low(lock) == LOCK_REC) {
+
+			mutex = lock_sys->page_mutex(
+				lock->rec_lock.space, lock->rec_lock.page_no);
+
+			mutex_enter(mutex);
+
+			lock_rec_dequeue_from_page(lock, false);
+		} else {
+
+			mutex = lock_sys->table_mutex(lock->tab_lock.table);
+
+			mutex_enter(mutex);
+
+			lock_table_dequeue(lock);
+		}
+
+		mutex_exit(mutex);
+
+		if (count == LOCK_RELEASE_INTERVAL) {
+			/* Release the latch for a while, so that we
+			do not block the threads waiting for the x-latch */
+
+			lock_sys_s_exit(*shard);
+
+			*shard = lock_sys_s_enter();
+
+			count = 0;
+		}
+
+		++count;
+	}
+}
+
 /* True if a lock mode is S or X */
 #define IS_LOCK_S_OR_X(lock) \
 	(lock_get_mode(lock) == LOCK_S \
@@ -6268,7 +6564,6 @@ lock_rec_insert_check_and_lock(
 	const rec_t*	next_rec = page_rec_get_next_const(rec);
 	ulint		heap_no = page_rec_get_heap_no(next_rec);
 
-	lock_mutex_enter();
 	/* Because this code is invoked for a running transaction by
 	the thread that is serving the transaction, it is not necessary
 	to hold trx->mutex here. */
@@ -6278,13 +6573,36 @@ lock_rec_insert_check_and_lock(
 	BTR_NO_LOCKING_FLAG and skip the locking altogether. */
 	ut_ad(lock_table_has(trx, index->table, LOCK_IX));
 
+	/* In the common case there are no locks on the successor record;
+	checking that only requires the shard of the page. */
+
+	size_t		shard = lock_sys_s_enter();
+	LockMutex*	page_mutex = lock_sys->page_mutex(
+		block->page.id.space(), block->page.id.page_no());
+
+	mutex_enter(page_mutex);
+
 	lock = lock_rec_get_first(lock_sys->rec_hash, block, heap_no);
 
+	mutex_exit(page_mutex);
+
+	lock_sys_s_exit(shard);
+
+	if (lock != NULL) {
+		lock_mutex_enter();
+
+		/* The queue may have changed while lock_sys was not
+		latched. */
+		lock = lock_rec_get_first(lock_sys->rec_hash, block, heap_no);
+
+		if (lock == NULL) {
+			lock_mutex_exit();
+		}
+	}
+
 	if (lock == NULL) {
 		/* We optimize CPU time usage in the simplest case */
 
-		lock_mutex_exit();
-
 		if (inherit_in && !index->is_clustered()) {
 			/* Update the page max trx id field */
 			page_update_max_trx_id(block,
@@ -6514,8 +6832,6 @@ lock_clust_rec_modify_check_and_lock(
 
 	lock_rec_convert_impl_to_expl(block, rec, index, offsets);
 
-	lock_mutex_enter();
-
 	ut_ad(lock_table_has(thr_get_trx(thr), index->table, LOCK_IX));
 
 	err = lock_rec_lock(true, SELECT_ORDINARY, LOCK_X | LOCK_REC_NOT_GAP,
@@ -6523,8 +6839,6 @@ lock_clust_rec_modify_check_and_lock(
 
 	MONITOR_INC(MONITOR_NUM_RECLOCK_REQ);
 
-	lock_mutex_exit();
-
 	ut_ad(lock_rec_queue_validate(false, block, rec, index, offsets));
 
 	if (err == DB_SUCCESS_LOCKED_REC) {
@@ -6574,8 +6888,6 @@ lock_sec_rec_modify_check_and_lock(
 	index record, and this would not have been possible if another active
 	transaction had modified this secondary index record. */
 
-	lock_mutex_enter();
-
 	ut_ad(lock_table_has(thr_get_trx(thr), index->table, LOCK_IX));
 
 	err = lock_rec_lock(true, SELECT_ORDINARY, LOCK_X | LOCK_REC_NOT_GAP,
@@ -6583,8 +6895,6 @@ lock_sec_rec_modify_check_and_lock(
 
 	MONITOR_INC(MONITOR_NUM_RECLOCK_REQ);
 
-	lock_mutex_exit();
-
 #ifdef UNIV_DEBUG
 	{
 		mem_heap_t*	heap		= NULL;
@@ -6677,8 +6987,6 @@ lock_sec_rec_read_check_and_lock(
 		lock_rec_convert_impl_to_expl(block, rec, index, offsets);
 	}
 
-	lock_mutex_enter();
-
 	ut_ad(mode != LOCK_X
 	      || lock_table_has(thr_get_trx(thr), index->table, LOCK_IX));
 	ut_ad(mode != LOCK_S
@@ -6689,8 +6997,6 @@ lock_sec_rec_read_check_and_lock(
 
 	MONITOR_INC(MONITOR_NUM_RECLOCK_REQ);
 
-	lock_mutex_exit();
-
 	ut_ad(lock_rec_queue_validate(false, block, rec, index, offsets));
 
 	return(err);
@@ -6753,8 +7059,6 @@ lock_clust_rec_read_check_and_lock(
 		lock_rec_convert_impl_to_expl(block, rec, index, offsets);
 	}
 
-	lock_mutex_enter();
-
 	ut_ad(mode != LOCK_X
 	      || lock_table_has(thr_get_trx(thr), index->table, LOCK_IX));
 	ut_ad(mode != LOCK_S
@@ -6765,8 +7069,6 @@ lock_clust_rec_read_check_and_lock(
 
 	MONITOR_INC(MONITOR_NUM_RECLOCK_REQ);
 
-	lock_mutex_exit();
-
 	ut_ad(lock_rec_queue_validate(false, block, rec, index, offsets));
 
 	DEBUG_SYNC_C("after_lock_clust_rec_read_check_and_lock");
@@ -7237,13 +7539,17 @@ lock_trx_release_locks(
 
 	release_lock = (UT_LIST_GET_LEN(trx->lock.trx_locks) > 0);
 
-	/* Don't take lock_sys mutex if trx didn't acquire any lock. */
+	size_t	shard = 0;
+
+	/* Don't latch lock_sys if trx didn't acquire any lock. */
 	if (release_lock) {
 		DEBUG_SYNC_C("before_lock_trx_release_locks");
 
 		/* The transition of trx->state to TRX_STATE_COMMITTED_IN_MEMORY
-		is protected by both the lock_sys->mutex and the trx->mutex. */
-		lock_mutex_enter();
+		is protected by both the lock_sys latch and the trx->mutex.
+		Threads that check the state with lock_sys x-latched are
+		excluded by the s-latch. */
+		shard = lock_sys_s_enter();
 	}
 
 	trx_mutex_enter(trx);
@@ -7270,7 +7576,7 @@ lock_trx_release_locks(
 
 		ut_a(release_lock);
 
-		lock_mutex_exit();
+		lock_sys_s_exit(shard);
 
 		while (trx_is_referenced(trx)) {
 
@@ -7287,7 +7593,7 @@ lock_trx_release_locks(
 
 		trx_mutex_exit(trx);
 
-		lock_mutex_enter();
+		shard = lock_sys_s_enter();
 
 		trx_mutex_enter(trx);
 	}
@@ -7311,9 +7617,9 @@ lock_trx_release_locks(
 
 	if (release_lock) {
 
-		lock_release(trx);
+		lock_release(trx, &shard);
 
-		lock_mutex_exit();
+		lock_sys_s_exit(shard);
 	}
 
 	trx->lock.n_rec_locks = 0;
@@ -7955,7 +8261,11 @@ DeadlockChecker::check_and_resolve(const lock_t* lock, trx_t* trx)
 	We return current transaction as deadlock victim here. */
 	if (trx->in_innodb & TRX_FORCE_ROLLBACK_ASYNC) {
 		return(trx);
-	} else if (!innobase_deadlock_detect) {
+	} else if (!innobase_deadlock_detect
+		   || innobase_deadlock_detect_async) {
+
+		/* If the search is asynchronous, lock_wait_suspend_thread()
+		wakes up the deadlock detector thread. */
 		return(NULL);
 	}
 
@@ -8018,6 +8328,382 @@ DeadlockChecker::check_and_resolve(const lock_t* lock, trx_t* trx)
 	return(victim_trx);
 }
 
+/** Invoke a functor for each lock ahead of wait_lock in its queue that
+wait_lock has to wait for.
+@param[in]	wait_lock	waiting lock
+@param[in]	f		functor taking const lock_t*; returns false to
+				stop the iteration */
+template <typename F>
+void
+WaitForGraph::for_each_blocker(const lock_t* wait_lock, F&& f)
+{
+	ut_ad(lock_mutex_own());
+	ut_ad(lock_get_wait(wait_lock));
+
+	if (lock_get_type_low(wait_lock) == LOCK_REC) {
+		const ulint	heap_no = lock_rec_find_set_bit(wait_lock);
+
+		for (const lock_t* lock = lock_rec_get_first_on_page_addr(
+			     lock_hash_get(wait_lock->type_mode),
+			     wait_lock->rec_lock.space,
+			     wait_lock->rec_lock.page_no);
+		     lock != wait_lock;
+		     lock = lock_rec_get_next_on_page_const(lock)) {
+
+			if (lock_rec_get_nth_bit(lock, heap_no)
+			    && lock_has_to_wait(wait_lock, lock)
+			    && !f(lock)) {
+
+				return;
+			}
+		}
+	} else {
+		ut_ad(lock_get_type_low(wait_lock) == LOCK_TABLE);
+
+		for (const lock_t* lock = UT_LIST_GET_FIRST(
+			     wait_lock->tab_lock.table->locks);
+		     lock != wait_lock;
+		     lock = UT_LIST_GET_NEXT(tab_lock.locks, lock)) {
+
+			if (lock_has_to_wait(wait_lock, lock) && !f(lock)) {
+				return;
+			}
+		}
+	}
+}
+
+/** Take a snapshot of the waits. The caller must hold the lock wait mutex
+and lock_sys x-latched. */
+void
+WaitForGraph::build()
+{
+	ut_ad(lock_wait_mutex_own());
+	ut_ad(lock_mutex_own());
+
+	m_nodes.clear();
+	m_edges.clear();
+
+	std::unordered_map<const trx_t*, size_t>	positions;
+
+	for (const srv_slot_t* slot = lock_sys->waiting_threads;
+	     slot < lock_sys->last_slot;
+	     ++slot) {
+
+		if (!slot->in_use) {
+			continue;
+		}
+
+		trx_t*		trx = thr_get_trx(slot->thr);
+		const lock_t*	wait_lock = trx->lock.wait_lock;
+
+		/* The wait may have ended before the thread was woken up. */
+		if (wait_lock == NULL) {
+			continue;
+		}
+
+		positions[trx] = m_nodes.size();
+
+		node_t	node;
+
+		node.m_trx = trx;
+		node.m_wait_lock = wait_lock;
+		node.m_first_edge = 0;
+		node.m_n_edges = 0;
+
+		m_nodes.push_back(node);
+	}
+
+	for (node_t& node : m_nodes) {
+
+		node.m_first_edge = m_edges.size();
+
+		for_each_blocker(
+			node.m_wait_lock,
+			[&](const lock_t* lock)
+			{
+				auto	it = positions.find(lock->trx);
+
+				/* A transaction which is not waiting
+				cannot be on a cycle. */
+				if (it != positions.end()) {
+					m_edges.push_back(it->second);
+				}
+
+				return(true);
+			});
+
+		node.m_n_edges = m_edges.size() - node.m_first_edge;
+	}
+}
+
+/** Find the cycles in the snapshot by a depth-first search. Every back edge
+closes a cycle, made of the nodes on the search stack from the target of the
+edge to its source. Not every cycle of the graph is found, but at least one
+in each strongly connected component that has a cycle; the others are found
+by later searches, if they still exist after the victims were rolled back. */
+void
+WaitForGraph::find_cycles()
+{
+	enum colour_t { WHITE, GREY, BLACK };
+
+	const size_t	n_nodes = m_nodes.size();
+
+	std::vector<colour_t>	colour(n_nodes, WHITE);
+
+	/* The search stack: a node and the next of its edges to follow */
+	std::vector<std::pair<size_t, size_t>>	stack;
+
+	m_cycle_nodes.clear();
+	m_cycles.clear();
+
+	for (size_t root = 0; root < n_nodes; ++root) {
+
+		if (colour[root] != WHITE) {
+			continue;
+		}
+
+		colour[root] = GREY;
+		stack.push_back(std::make_pair(root, 0));
+
+		while (!stack.empty()) {
+			const size_t	pos = stack.back().first;
+			const node_t&	node = m_nodes[pos];
+
+			if (stack.back().second == node.m_n_edges) {
+				colour[pos] = BLACK;
+				stack.pop_back();
+				continue;
+			}
+
+			const size_t	next = m_edges[
+				node.m_first_edge + stack.back().second++];
+
+			if (colour[next] == WHITE) {
+
+				colour[next] = GREY;
+				stack.push_back(std::make_pair(next, 0));
+
+			} else if (colour[next] == GREY) {
+
+				const size_t	first = m_cycle_nodes.size();
+
+				auto	it = stack.end();
+
+				do {
+					--it;
+				} while (it->first != next);
+
+				for (; it != stack.end(); ++it) {
+					m_cycle_nodes.push_back(it->first);
+				}
+
+				m_cycles.push_back(
+					cycle_t(first, m_cycle_nodes.size()));
+			}
+		}
+	}
+}
+
+/** Check that the waits of a cycle still exist.
+@param[in]	cycle	cycle to check
+@return true if every transaction on the cycle still waits for the same lock,
+and that lock still has to wait for a lock of the next transaction on the
+cycle */
+bool
+WaitForGraph::is_valid(const cycle_t& cycle) const
+{
+	ut_ad(lock_mutex_own());
+
+	for (size_t i = cycle.first; i < cycle.second; ++i) {
+
+		const node_t&	node = m_nodes[m_cycle_nodes[i]];
+
+		const size_t	j = i + 1 < cycle.second ? i + 1 : cycle.first;
+
+		const trx_t*	next = m_nodes[m_cycle_nodes[j]].m_trx;
+
+		if (node.m_trx->lock.wait_lock != node.m_wait_lock) {
+			return(false);
+		}
+
+		bool	found = false;
+
+		for_each_blocker(
+			node.m_wait_lock,
+			[&](const lock_t* lock)
+			{
+				found = (lock->trx == next);
+
+				return(!found);
+			});
+
+		if (!found) {
+			return(false);
+		}
+	}
+
+	return(true);
+}
+
+/** Choose the victim of a cycle. Transactions of low priority are preferred,
+and among them the one with the smallest weight.
+@param[in]	cycle	cycle
+@return the victim */
+const WaitForGraph::node_t&
+WaitForGraph::select_victim(const cycle_t& cycle) const
+{
+	ut_ad(lock_mutex_own());
+	ut_ad(cycle.second > cycle.first);
+
+	const node_t*	victim = &m_nodes[m_cycle_nodes[cycle.first]];
+
+	for (size_t i = cycle.first + 1; i < cycle.second; ++i) {
+
+		const node_t&	node = m_nodes[m_cycle_nodes[i]];
+
+		const bool	high = trx_is_high_priority(node.m_trx);
+
+		if (high != trx_is_high_priority(victim->m_trx)) {
+
+			if (!high) {
+				victim = &node;
+			}
+
+		} else if (trx_weight_ge(victim->m_trx, node.m_trx)) {
+
+			victim = &node;
+		}
+	}
+
+	return(*victim);
+}
+
+/** Print a cycle and its victim to the deadlock report.
+@param[in]	cycle	cycle
+@param[in]	victim	victim transaction */
+void
+WaitForGraph::print(const cycle_t& cycle, const node_t& victim) const
+{
+	ut_ad(lock_mutex_own());
+
+	char	buf[64];
+	ulint	victim_no = 0;
+
+	DeadlockChecker::start_print();
+
+	for (size_t i = cycle.first; i < cycle.second; ++i) {
+
+		const node_t&	node = m_nodes[m_cycle_nodes[i]];
+		const ulint	no = i - cycle.first + 1;
+
+		snprintf(buf, sizeof(buf),
+			 "\n*** (" ULINTPF ") TRANSACTION:\n", no);
+		DeadlockChecker::print(buf);
+
+		DeadlockChecker::print(node.m_trx, 3000);
+
+		snprintf(buf, sizeof(buf),
+			 "*** (" ULINTPF ") WAITING FOR THIS LOCK TO BE"
+			 " GRANTED:\n", no);
+		DeadlockChecker::print(buf);
+
+		DeadlockChecker::print(node.m_wait_lock);
+
+		if (&node == &victim) {
+			victim_no = no;
+		}
+	}
+
+	snprintf(buf, sizeof(buf),
+		 "*** WE ROLL BACK TRANSACTION (" ULINTPF ")\n", victim_no);
+	DeadlockChecker::print(buf);
+
+	DBUG_PRINT("ib_lock", ("deadlock detected"));
+}
+
+/** Resolve the cycles found by find_cycles() that still exist. The caller
+must hold lock_sys x-latched.
+@return number of transactions chosen as deadlock victims */
+ulint
+WaitForGraph::resolve()
+{
+	ut_ad(lock_mutex_own());
+
+	ulint	n_victims = 0;
+
+	for (const cycle_t& cycle : m_cycles) {
+
+		/* A cycle that shares a transaction with a cycle that
+		was resolved before is no longer valid. */
+		if (!is_valid(cycle)) {
+			continue;
+		}
+
+		const node_t&	victim = select_victim(cycle);
+
+		print(cycle, victim);
+
+		trx_t*	trx = victim.m_trx;
+
+		trx_mutex_enter(trx);
+
+		trx->owns_mutex = true;
+
+		trx->lock.was_chosen_as_deadlock_victim = true;
+
+		lock_cancel_waiting_and_release(trx->lock.wait_lock, false);
+
+		trx->owns_mutex = false;
+
+		trx_mutex_exit(trx);
+
+		lock_deadlock_found = true;
+
+		MONITOR_INC(MONITOR_DEADLOCK);
+
+		++n_victims;
+	}
+
+	return(n_victims);
+}
+
+/** Search the waits-for graph of the transactions which are suspended in a
+lock wait for cycles, and resolve each of them by rolling back the lightest
+transaction on the cycle. The caller must not hold any latches.
+@return number of transactions chosen as deadlock victims */
+ulint
+lock_deadlock_detect_and_resolve()
+{
+	ut_ad(!lock_mutex_own());
+	ut_ad(!srv_read_only_mode);
+
+	WaitForGraph	graph;
+
+	lock_wait_mutex_enter();
+
+	lock_mutex_enter();
+
+	graph.build();
+
+	lock_mutex_exit();
+
+	lock_wait_mutex_exit();
+
+	graph.find_cycles();
+
+	if (graph.no_cycles()) {
+		return(0);
+	}
+
+	lock_mutex_enter();
+
+	const ulint	n_victims = graph.resolve();
+
+	lock_mutex_exit();
+
+	return(n_victims);
+}
+
 /**
 Allocate cached locks for the transaction.
 @param trx		allocate cached record locks for this transaction */
@@ -273,6 +273,12 @@ lock_wait_suspend_thread(
 
 	lock_mutex_exit();
 
+	/* The slot is in use now, so this wait is part of the next search
+	for deadlocks. */
+	if (innobase_deadlock_detect && innobase_deadlock_detect_async) {
+		os_event_set(lock_sys->deadlock_event);
+	}
+
 	ulint	had_dict_lock = trx->dict_operation_lock_mode;
 
 	switch (had_dict_lock) {
@@ -399,13 +405,14 @@ lock_wait_release_thread_if_suspended(
 	que_thr_t*	thr)	/*!< in: query thread associated with the
 				user OS thread	 */
 {
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_sys_own());
 	ut_ad(trx_mutex_own(thr_get_trx(thr)));
 
-	/* We own both the lock mutex and the trx_t::mutex but not the
-	lock wait mutex. This is OK because other threads will see the state
-	of this slot as being in use and no other thread can change the state
-	of the slot to free unless that thread also owns the lock mutex. */
+	/* We own the lock_sys latch, in either mode, and the trx_t::mutex
+	but not the lock wait mutex. This is OK because other threads will
+	see the state of this slot as being in use and no other thread can
+	change the state of the slot to free unless that thread also owns the
+	lock_sys latch in X mode. */
 
 	if (thr->slot != NULL && thr->slot->in_use && thr->slot->thr == thr) {
 		trx_t*	trx = thr_get_trx(thr);
@@ -532,3 +539,39 @@ lock_wait_timeout_thread()
 	lock_sys->timeout_thread_active = false;
 }
 
+/** A thread which searches the waits-for graph of the suspended transactions
+for cycles and resolves them, when innodb_deadlock_detect_async is set. */
+void
+lock_deadlock_detector_thread()
+{
+	int64_t		sig_count = 0;
+	os_event_t	event = lock_sys->deadlock_event;
+
+	ut_ad(!srv_read_only_mode);
+
+	lock_sys->deadlock_thread_active = true;
+
+	do {
+		/* We are woken up whenever a transaction is suspended in a
+		lock wait. Also search once per second while there are waits,
+		in case a wait ended and started again while the previous
+		search was checking its cycles. */
+
+		os_event_wait_time_low(event, 1000000, sig_count);
+		sig_count = os_event_reset(event);
+
+		if (srv_shutdown_state >= SRV_SHUTDOWN_CLEANUP) {
+			break;
+		}
+
+		if (innobase_deadlock_detect
+		    && innobase_deadlock_detect_async
+		    && lock_sys->n_waiting > 0) {
+
+			lock_deadlock_detect_and_resolve();
+		}
+
+	} while (srv_shutdown_state < SRV_SHUTDOWN_CLEANUP);
+
+	lock_sys->deadlock_thread_active = false;
+}
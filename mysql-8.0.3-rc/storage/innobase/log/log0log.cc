@@ -49,6 +49,7 @@ Created 12/9/1995 Heikki Tuuri
 #include "fil0fil.h"
 #include "log0recv.h"
 #include "mem0mem.h"
+#include "os0thread-create.h"
 #include "srv0mon.h"
 #include "srv0srv.h"
 #include "srv0start.h"
@@ -133,23 +134,28 @@ log_io_complete_checkpoint(void);
 /*============================*/
 
 /****************************************************************//**
-Returns the oldest modified block lsn in the pool, or log_sys->lsn if none
-exists.
+Returns the oldest modified block lsn in the pool, or the current lsn if
+none exists.
 @return LSN of oldest modification */
 static
 lsn_t
 log_buf_pool_get_oldest_modification(void)
 /*======================================*/
 {
-	lsn_t	lsn;
-
 	ut_ad(log_mutex_own());
 
-	lsn = buf_pool_get_oldest_modification();
+	/* Read the current lsn before looking at the flush lists. A
+	mini-transaction which reserved its log before this point has
+	either added its dirty pages to the flush lists already, or holds
+	the flush order mutex, which buf_pool_get_oldest_modification()
+	waits for. */
+	const lsn_t	current_lsn = log_get_lsn();
+
+	lsn_t	lsn = buf_pool_get_oldest_modification();
 
 	if (!lsn) {
 
-		lsn = log_sys->lsn;
+		lsn = current_lsn;
 	}
 
 	return(lsn);
@@ -180,32 +186,74 @@ log_downgrade()
 		OS_FILE_LOG_BLOCK_SIZE, buf, group);
 }
 
+/** Allocate the log buffer ring and the write buffer for the current
+log_sys->buf_size. */
+static
+void
+log_buffer_alloc()
+{
+	log_sys->buf_ptr = static_cast<byte*>(
+		ut_zalloc_nokey(log_sys->buf_size + OS_FILE_LOG_BLOCK_SIZE));
+	log_sys->buf = static_cast<byte*>(
+		ut_align(log_sys->buf_ptr, OS_FILE_LOG_BLOCK_SIZE));
+
+	/* Room for a full ring and for the write-ahead padding, which
+	is never more than a page. */
+	log_sys->write_buf_size = log_sys->buf_size + UNIV_PAGE_SIZE;
+
+	log_sys->write_buf_ptr = static_cast<byte*>(
+		ut_zalloc_nokey(log_sys->write_buf_size
+				+ OS_FILE_LOG_BLOCK_SIZE));
+	log_sys->write_buf = static_cast<byte*>(
+		ut_align(log_sys->write_buf_ptr, OS_FILE_LOG_BLOCK_SIZE));
+
+	log_sys->max_buf_free = log_sys->buf_size / LOG_BUF_FLUSH_RATIO
+		- LOG_BUF_FLUSH_MARGIN;
+}
+
+/** Free the log buffer ring and the write buffer. */
+static
+void
+log_buffer_free()
+{
+	ut_free(log_sys->buf_ptr);
+	log_sys->buf_ptr = NULL;
+	log_sys->buf = NULL;
+
+	ut_free(log_sys->write_buf_ptr);
+	log_sys->write_buf_ptr = NULL;
+	log_sys->write_buf = NULL;
+}
+
+/** Get the log block which contains an lsn in the log buffer ring.
+@param[in]	lsn	log sequence number
+@return the log block in log_sys->buf */
+static inline
+byte*
+log_buffer_block(
+	lsn_t	lsn)
+{
+	return(log_sys->buf
+	       + ut_uint64_align_down(lsn, OS_FILE_LOG_BLOCK_SIZE)
+	       % log_sys->buf_size);
+}
+
 /** Extends the log buffer.
 @param[in]	len	requested minimum size in bytes */
 void
 log_buffer_extend(
 	ulint	len)
 {
-	ulint	move_start;
-	ulint	move_end;
 	byte	tmp_buf[OS_FILE_LOG_BLOCK_SIZE];
 
-	log_mutex_enter_all();
-
-	while (log_sys->is_extending) {
-		/* Another thread is trying to extend already.
-		Needs to wait for. */
-		log_mutex_exit_all();
+	/* Wait for the mini-transactions which are filling the log buffer
+	and keep new ones from reserving space in it. */
+	log_buffer_x_lock_enter();
 
-		log_buffer_flush_to_disk();
-
-		log_mutex_enter_all();
-
-		if (srv_log_buffer_size > len / UNIV_PAGE_SIZE) {
-			/* Already extended enough by the others */
-			log_mutex_exit_all();
-			return;
-		}
+	if (len <= log_sys->buf_size) {
+		/* Already extended enough by the others */
+		log_buffer_x_lock_exit();
+		return;
 	}
 
 	if (len >= log_sys->buf_size / 2) {
@@ -218,56 +266,35 @@ log_buffer_extend(
 			<< LOG_BUFFER_SIZE << " / 2). Trying to extend it.";
 	}
 
-	log_sys->is_extending = true;
-
-	while (ut_calc_align_down(log_sys->buf_free,
-				  OS_FILE_LOG_BLOCK_SIZE)
-	       != ut_calc_align_down(log_sys->buf_next_to_write,
-				     OS_FILE_LOG_BLOCK_SIZE)) {
-		/* Buffer might have >1 blocks to write still. */
-		log_mutex_exit_all();
+	/* Write out all the log, so that only the last incomplete block
+	has to be moved to the new buffer. */
+	log_write_up_to(log_get_lsn(), false);
 
-		log_buffer_flush_to_disk();
+	log_mutex_enter_all();
 
-		log_mutex_enter_all();
-	}
+	const lsn_t	lsn = log_get_lsn();
 
-	move_start = ut_calc_align_down(
-		log_sys->buf_free,
-		OS_FILE_LOG_BLOCK_SIZE);
-	move_end = log_sys->buf_free;
+	ut_ad(log_sys->write_lsn == lsn || recv_no_ibuf_operations);
 
 	/* store the last log block in buffer */
-	ut_memcpy(tmp_buf, log_sys->buf + move_start,
-		  move_end - move_start);
-
-	log_sys->buf_free -= move_start;
-	log_sys->buf_next_to_write -= move_start;
+	ut_memcpy(tmp_buf, log_buffer_block(lsn), OS_FILE_LOG_BLOCK_SIZE);
 
 	/* reallocate log buffer */
 	srv_log_buffer_size = static_cast<ulong>(len / UNIV_PAGE_SIZE + 1);
-	ut_free(log_sys->buf_ptr);
 
-	log_sys->buf_size = LOG_BUFFER_SIZE;
+	log_buffer_free();
 
-	log_sys->buf_ptr = static_cast<byte*>(
-		ut_zalloc_nokey(log_sys->buf_size * 2 + OS_FILE_LOG_BLOCK_SIZE));
-	log_sys->buf = static_cast<byte*>(
-		ut_align(log_sys->buf_ptr, OS_FILE_LOG_BLOCK_SIZE));
+	log_sys->buf_size = LOG_BUFFER_SIZE;
 
-	log_sys->first_in_use = true;
-
-	log_sys->max_buf_free = log_sys->buf_size / LOG_BUF_FLUSH_RATIO
-		- LOG_BUF_FLUSH_MARGIN;
+	log_buffer_alloc();
 
 	/* restore the last log block */
-	ut_memcpy(log_sys->buf, tmp_buf, move_end - move_start);
-
-	ut_ad(log_sys->is_extending);
-	log_sys->is_extending = false;
+	ut_memcpy(log_buffer_block(lsn), tmp_buf, OS_FILE_LOG_BLOCK_SIZE);
 
 	log_mutex_exit_all();
 
+	log_buffer_x_lock_exit();
+
 	ib::info() << "innodb_log_buffer_size was extended to "
 		<< LOG_BUFFER_SIZE << ".";
 }
@@ -281,20 +308,15 @@ ulint
 log_calculate_actual_len(
 	ulint len)
 {
-	ut_ad(log_mutex_own());
-
-	/* actual length stored per block */
-	const ulint	len_per_blk = OS_FILE_LOG_BLOCK_SIZE
-		- (LOG_BLOCK_HDR_SIZE + LOG_BLOCK_TRL_SIZE);
-
 	/* actual data length in last block already written */
-	ulint	extra_len = (log_sys->buf_free % OS_FILE_LOG_BLOCK_SIZE);
+	ulint	extra_len = static_cast<ulint>(
+		log_get_lsn() % OS_FILE_LOG_BLOCK_SIZE);
 
 	ut_ad(extra_len >= LOG_BLOCK_HDR_SIZE);
 	extra_len -= LOG_BLOCK_HDR_SIZE;
 
 	/* total extra length for block header and trailer */
-	extra_len = ((len + extra_len) / len_per_blk)
+	extra_len = ((len + extra_len) / LOG_BLOCK_DATA_SIZE)
 		* (LOG_BLOCK_HDR_SIZE + LOG_BLOCK_TRL_SIZE);
 
 	return(len + extra_len);
@@ -311,7 +333,7 @@ log_margin_checkpoint_age(
 {
 	ulint	margin = log_calculate_actual_len(len);
 
-	ut_ad(log_mutex_own());
+	ut_ad(!log_mutex_own());
 
 	if (margin > log_sys->log_group_capacity) {
 		/* return with warning output to avoid deadlock */
@@ -331,17 +353,26 @@ log_margin_checkpoint_age(
 		return;
 	}
 
+	/* Do a dirty read first, so that the common case does not need
+	the log mutex. */
+	if (log_get_lsn() - log_sys->last_checkpoint_lsn + margin
+	    <= log_sys->log_group_capacity) {
+		return;
+	}
+
+	log_mutex_enter();
+
 	/* Our margin check should ensure that we never reach this condition.
 	Try to do checkpoint once. We cannot keep waiting here as it might
 	result in hang in case the current mtr has latch on oldest lsn */
-	if (log_sys->lsn - log_sys->last_checkpoint_lsn + margin
+	if (log_get_lsn() - log_sys->last_checkpoint_lsn + margin
 	    > log_sys->log_group_capacity) {
 		/* The log write of 'len' might overwrite the transaction log
 		after the last checkpoint. Makes checkpoint. */
 
 		bool	flushed_enough = false;
 
-		if (log_sys->lsn - log_buf_pool_get_oldest_modification()
+		if (log_get_lsn() - log_buf_pool_get_oldest_modification()
 		    + margin
 		    <= log_sys->log_group_capacity) {
 			flushed_enough = true;
@@ -361,178 +392,114 @@ log_margin_checkpoint_age(
 		ut_ad(!srv_checkpoint_disabled);
 #endif /* UNIV_DEBUG */
 		log_checkpoint(true, false);
-
-		log_mutex_enter();
+	} else {
+		log_mutex_exit();
 	}
-
-	return;
 }
 
-/** Open the log for log_write_low. The log must be closed with log_close.
-@param[in]	len	length of the data to be written
-@return start lsn of the log record */
-lsn_t
-log_reserve_and_open(
-	ulint	len)
+/** Wait until the log buffer has room for a range reserved by
+log_buffer_reserve(), that is, until the log written to the log files
+is recent enough for the range not to overwrite unwritten log.
+@param[in]	end_lsn		end lsn of the reserved range */
+void
+log_buffer_wait_for_space(
+	lsn_t	end_lsn)
 {
-	ulint	len_upper_limit;
-#ifdef UNIV_DEBUG
-	ulint	count			= 0;
-#endif /* UNIV_DEBUG */
-
-loop:
-	ut_ad(log_mutex_own());
-
-	if (log_sys->is_extending) {
-		log_mutex_exit();
-
-		/* Log buffer size is extending. Writing up to the next block
-		should wait for the extending finished. */
-
-		os_thread_sleep(100000);
-
-		ut_ad(++count < 50);
+	ut_ad(end_lsn % OS_FILE_LOG_BLOCK_SIZE >= LOG_BLOCK_HDR_SIZE);
 
-		log_mutex_enter();
-		goto loop;
+	/* The ring holds the log from the block of write_lsn onwards.
+	The ranges below ours are at most a ring away from end_lsn, so
+	writing them out never depends on this range being filled. */
+	os_rmb;
+	if (end_lsn <= ut_uint64_align_down(log_sys->write_lsn,
+					    OS_FILE_LOG_BLOCK_SIZE)
+	    + log_sys->buf_size) {
+		return;
 	}
 
-	/* Calculate an upper limit for the space the string may take in the
-	log buffer */
-
-	len_upper_limit = LOG_BUF_WRITE_MARGIN + srv_log_write_ahead_size
-			  + (5 * len) / 4;
-
-	if (log_sys->buf_free + len_upper_limit > log_sys->buf_size) {
-		log_mutex_exit();
-
-		DEBUG_SYNC_C("log_buf_size_exceeded");
+	DEBUG_SYNC_C("log_buf_size_exceeded");
 
-		/* Not enough free space, do a write of the log buffer */
+	srv_stats.log_waits.inc();
 
-		log_buffer_sync_in_background(false);
+	for (;;) {
+		const lsn_t	limit_lsn = ut_uint64_align_up(
+			end_lsn - log_sys->buf_size, OS_FILE_LOG_BLOCK_SIZE);
 
-		srv_stats.log_waits.inc();
+		log_write_up_to(limit_lsn, false);
 
-		ut_ad(++count < 50);
+		os_rmb;
+		if (end_lsn <= ut_uint64_align_down(log_sys->write_lsn,
+						    OS_FILE_LOG_BLOCK_SIZE)
+		    + log_sys->buf_size) {
+			return;
+		}
 
-		log_mutex_enter();
-		goto loop;
+		os_thread_yield();
 	}
-
-	return(log_sys->lsn);
 }
 
-/************************************************************//**
-Writes to the log the string given. It is assumed that the caller holds the
-log mutex. */
-void
-log_write_low(
-/*==========*/
-	const byte*	str,		/*!< in: string */
-	ulint		str_len)	/*!< in: string length */
+/** Copy a string to a range of the log buffer which was reserved by
+log_buffer_reserve(), skipping the log block headers and trailers.
+@param[in]	str	string
+@param[in]	len	string length
+@param[in]	lsn	lsn where the string starts
+@return lsn where the string ends */
+lsn_t
+log_buffer_write(
+	const byte*	str,
+	ulint		len,
+	lsn_t		lsn)
 {
-	log_t*	log	= log_sys;
-	ulint	len;
-	ulint	data_len;
-	byte*	log_block;
-
-	ut_ad(log_mutex_own());
-part_loop:
-	/* Calculate a part length */
-
-	data_len = (log->buf_free % OS_FILE_LOG_BLOCK_SIZE) + str_len;
-
-	if (data_len <= OS_FILE_LOG_BLOCK_SIZE - LOG_BLOCK_TRL_SIZE) {
-
-		/* The string fits within the current log block */
-
-		len = str_len;
-	} else {
-		data_len = OS_FILE_LOG_BLOCK_SIZE - LOG_BLOCK_TRL_SIZE;
-
-		len = OS_FILE_LOG_BLOCK_SIZE
-			- (log->buf_free % OS_FILE_LOG_BLOCK_SIZE)
-			- LOG_BLOCK_TRL_SIZE;
-	}
+	while (len > 0) {
+		const ulint	offset = static_cast<ulint>(
+			lsn % OS_FILE_LOG_BLOCK_SIZE);
 
-	ut_memcpy(log->buf + log->buf_free, str, len);
+		ut_ad(offset >= LOG_BLOCK_HDR_SIZE);
+		ut_ad(offset < OS_FILE_LOG_BLOCK_SIZE - LOG_BLOCK_TRL_SIZE);
 
-	str_len -= len;
-	str = str + len;
+		/* Calculate a part length */
+		const ulint	part_len = std::min(
+			len,
+			OS_FILE_LOG_BLOCK_SIZE - LOG_BLOCK_TRL_SIZE - offset);
 
-	log_block = static_cast<byte*>(
-		ut_align_down(
-			log->buf + log->buf_free, OS_FILE_LOG_BLOCK_SIZE));
+		ut_memcpy(log_buffer_block(lsn) + offset, str, part_len);
 
-	log_block_set_data_len(log_block, data_len);
+		str += part_len;
+		len -= part_len;
+		lsn += part_len;
 
-	if (data_len == OS_FILE_LOG_BLOCK_SIZE - LOG_BLOCK_TRL_SIZE) {
-		/* This block became full */
-		log_block_set_data_len(log_block, OS_FILE_LOG_BLOCK_SIZE);
-		log_block_set_checkpoint_no(log_block,
-					    log_sys->next_checkpoint_no);
-		len += LOG_BLOCK_HDR_SIZE + LOG_BLOCK_TRL_SIZE;
-
-		log->lsn += len;
-
-		/* Initialize the next block header */
-		log_block_init(log_block + OS_FILE_LOG_BLOCK_SIZE, log->lsn);
-	} else {
-		log->lsn += len;
-	}
-
-	log->buf_free += len;
-
-	ut_ad(log->buf_free <= log->buf_size);
-
-	if (str_len > 0) {
-		goto part_loop;
+		if (offset + part_len
+		    == OS_FILE_LOG_BLOCK_SIZE - LOG_BLOCK_TRL_SIZE) {
+			/* This block became full: continue after the
+			header of the next one */
+			lsn += LOG_BLOCK_TRL_SIZE + LOG_BLOCK_HDR_SIZE;
+		}
 	}
 
-	srv_stats.log_write_requests.inc();
+	return(lsn);
 }
 
-/************************************************************//**
-Closes the log.
-@return lsn */
-lsn_t
-log_close(void)
-/*===========*/
+/** Check whether a log flush or a checkpoint is needed after the log has
+grown to a given lsn, and set log_sys->check_flush_or_checkpoint if so.
+@param[in]	lsn	end lsn of the log records just added */
+static
+void
+log_buffer_check_margins(
+	lsn_t	lsn)
 {
-	byte*		log_block;
-	ulint		first_rec_group;
-	lsn_t		oldest_lsn;
-	lsn_t		lsn;
 	log_t*		log	= log_sys;
+	lsn_t		oldest_lsn;
 	lsn_t		checkpoint_age;
 
-	ut_ad(log_mutex_own());
-
-	lsn = log->lsn;
-
-	log_block = static_cast<byte*>(
-		ut_align_down(
-			log->buf + log->buf_free, OS_FILE_LOG_BLOCK_SIZE));
-
-	first_rec_group = log_block_get_first_rec_group(log_block);
-
-	if (first_rec_group == 0) {
-		/* We initialized a new log block which was not written
-		full by the current mtr: the next mtr log record group
-		will start within this block at the offset data_len */
-
-		log_block_set_first_rec_group(
-			log_block, log_block_get_data_len(log_block));
-	}
-
-	if (log->buf_free > log->max_buf_free) {
+	if (lsn - log->write_lsn > log->max_buf_free) {
 
 		log->check_flush_or_checkpoint = true;
 	}
 
 	checkpoint_age = lsn - log->last_checkpoint_lsn;
 
+	MONITOR_SET(MONITOR_LSN_CHECKPOINT_AGE, checkpoint_age);
+
 	if (checkpoint_age >= log->log_group_capacity) {
 		DBUG_EXECUTE_IF(
 			"print_all_chkp_warnings",
@@ -553,7 +520,7 @@ log_close(void)
 
 	if (checkpoint_age <= log->max_modified_age_sync) {
 
-		goto function_exit;
+		return;
 	}
 
 	oldest_lsn = buf_pool_get_oldest_modification();
@@ -564,9 +531,110 @@ log_close(void)
 
 		log->check_flush_or_checkpoint = true;
 	}
-function_exit:
+}
 
-	return(lsn);
+/** Close a range of the log buffer which was reserved by
+log_buffer_reserve() and filled with log_buffer_write(). Sets the first
+record group offsets of the log blocks that were started in the range,
+reports the range as complete to the log writer, and checks whether a log
+flush or a checkpoint is needed.
+@param[in]	start_lsn	start lsn of the range
+@param[in]	end_lsn		end lsn of the range */
+void
+log_buffer_close(
+	lsn_t	start_lsn,
+	lsn_t	end_lsn)
+{
+	ut_ad(end_lsn > start_lsn);
+
+	const lsn_t	start_block = ut_uint64_align_down(
+		start_lsn, OS_FILE_LOG_BLOCK_SIZE);
+	const lsn_t	end_block = ut_uint64_align_down(
+		end_lsn, OS_FILE_LOG_BLOCK_SIZE);
+
+	/* Only the mini-transaction whose range crosses the start of a
+	block may touch its header. The blocks which are completely
+	covered by the range contain no start of a log record group, and
+	the next log record group starts in the last block at end_lsn. */
+	if (start_block != end_block) {
+
+		for (lsn_t block = start_block + OS_FILE_LOG_BLOCK_SIZE;
+		     block < end_block;
+		     block += OS_FILE_LOG_BLOCK_SIZE) {
+
+			log_block_set_first_rec_group(
+				log_buffer_block(block), 0);
+		}
+
+		log_block_set_first_rec_group(
+			log_buffer_block(end_block),
+			static_cast<ulint>(end_lsn % OS_FILE_LOG_BLOCK_SIZE));
+	}
+
+	Link_buf<lsn_t>*	recent_written = log_sys->recent_written;
+
+	if (!recent_written->has_space(start_lsn)) {
+		/* Too many mini-transactions are ahead of the oldest one
+		which is still copying its log records. Wait for it. */
+		srv_stats.log_waits.inc();
+
+		do {
+			os_thread_yield();
+
+			log_write_mutex_enter();
+			recent_written->advance_tail();
+			log_write_mutex_exit();
+
+		} while (!recent_written->has_space(start_lsn));
+	}
+
+	recent_written->add_link(start_lsn, end_lsn);
+
+	srv_stats.log_write_requests.inc();
+
+	log_buffer_check_margins(end_lsn);
+}
+
+/** Make the log buffer continue the log from a given lsn, e.g. after the
+recovery or when the log files have been recreated.
+@param[in]	lsn		the new current lsn
+@param[in]	last_block	the log block which contains lsn, as
+read from the log files, or NULL if lsn starts a new block */
+void
+log_buffer_reset(
+	lsn_t		lsn,
+	const byte*	last_block)
+{
+	byte*	block;
+
+	log_sys->sn.store(log_translate_lsn_to_sn(lsn));
+	log_sys->recent_written->reset(lsn);
+
+	block = log_buffer_block(lsn);
+
+	if (last_block == NULL) {
+		ut_ad(lsn % OS_FILE_LOG_BLOCK_SIZE == LOG_BLOCK_HDR_SIZE);
+
+		/* Nothing of the new block has been written yet: the
+		next write will start with it, and with the log file
+		header if the block starts a log file. */
+		log_sys->write_lsn = lsn - LOG_BLOCK_HDR_SIZE;
+
+		log_block_init(block, lsn);
+		log_block_set_first_rec_group(block, LOG_BLOCK_HDR_SIZE);
+	} else {
+		log_sys->write_lsn = lsn;
+
+		ut_memcpy(block, last_block, OS_FILE_LOG_BLOCK_SIZE);
+
+		if (log_block_get_first_rec_group(block) == 0) {
+			/* The next log record group will start at lsn */
+			log_block_set_first_rec_group(
+				block,
+				static_cast<ulint>(
+					lsn % OS_FILE_LOG_BLOCK_SIZE));
+		}
+	}
 }
 
 /******************************************************//**
@@ -793,25 +861,19 @@ log_init(void)
 
 	mutex_create(LATCH_ID_LOG_FLUSH_ORDER, &log_sys->log_flush_order_mutex);
 
-	/* Start the lsn from one log block from zero: this way every
-	log record has a start lsn != zero, a fact which we will use */
+	log_sys->sn_lock.create(
+		log_sn_lock_key, SYNC_NO_ORDER_CHECK, LOG_SN_LOCK_SHARDS);
 
-	log_sys->lsn = LOG_START_LSN;
+	log_sys->recent_written = UT_NEW_NOKEY(
+		Link_buf<lsn_t>(LOG_RECENT_WRITTEN_SIZE));
 
 	ut_a(LOG_BUFFER_SIZE >= 16 * OS_FILE_LOG_BLOCK_SIZE);
 	ut_a(LOG_BUFFER_SIZE >= 4 * UNIV_PAGE_SIZE);
 
 	log_sys->buf_size = LOG_BUFFER_SIZE;
 
-	log_sys->buf_ptr = static_cast<byte*>(
-		ut_zalloc_nokey(log_sys->buf_size * 2 + OS_FILE_LOG_BLOCK_SIZE));
-	log_sys->buf = static_cast<byte*>(
-		ut_align(log_sys->buf_ptr, OS_FILE_LOG_BLOCK_SIZE));
+	log_buffer_alloc();
 
-	log_sys->first_in_use = true;
-
-	log_sys->max_buf_free = log_sys->buf_size / LOG_BUF_FLUSH_RATIO
-		- LOG_BUF_FLUSH_MARGIN;
 	log_sys->check_flush_or_checkpoint = true;
 	UT_LIST_INIT(log_sys->log_groups, &log_group_t::log_groups);
 
@@ -819,15 +881,33 @@ log_init(void)
 	log_sys->last_printout_time = time(NULL);
 	/*----------------------------*/
 
-	log_sys->write_lsn = log_sys->lsn;
-
 	log_sys->flush_event = os_event_create(0);
 
 	os_event_set(log_sys->flush_event);
 
+	log_sys->threads_enabled.store(false);
+	log_sys->flush_requested_lsn.store(0);
+
+	log_sys->writer_event = os_event_create(0);
+	log_sys->flusher_event = os_event_create(0);
+	log_sys->threads_exit_event = os_event_create(0);
+
+	log_sys->write_events = static_cast<os_event_t*>(
+		ut_zalloc_nokey(LOG_WAIT_EVENTS * sizeof(os_event_t)));
+	log_sys->flush_events = static_cast<os_event_t*>(
+		ut_zalloc_nokey(LOG_WAIT_EVENTS * sizeof(os_event_t)));
+
+	for (ulint i = 0; i < LOG_WAIT_EVENTS; ++i) {
+		log_sys->write_events[i] = os_event_create(0);
+		log_sys->flush_events[i] = os_event_create(0);
+	}
+
 	/*----------------------------*/
 
-	log_sys->last_checkpoint_lsn = log_sys->lsn;
+	/* Start the lsn from one log block from zero: this way every
+	log record has a start lsn != zero, a fact which we will use */
+
+	log_sys->last_checkpoint_lsn = LOG_START_LSN;
 
 	rw_lock_create(
 		checkpoint_lock_key, &log_sys->checkpoint_lock,
@@ -841,14 +921,10 @@ log_init(void)
 
 	/*----------------------------*/
 
-	log_block_init(log_sys->buf, log_sys->lsn);
-	log_block_set_first_rec_group(log_sys->buf, LOG_BLOCK_HDR_SIZE);
-
-	log_sys->buf_free = LOG_BLOCK_HDR_SIZE;
-	log_sys->lsn = LOG_START_LSN + LOG_BLOCK_HDR_SIZE;
+	log_buffer_reset(LOG_START_LSN + LOG_BLOCK_HDR_SIZE, NULL);
 
 	MONITOR_SET(MONITOR_LSN_CHECKPOINT_AGE,
-		    log_sys->lsn - log_sys->last_checkpoint_lsn);
+		    log_get_lsn() - log_sys->last_checkpoint_lsn);
 }
 
 /******************************************************************//**
@@ -1398,6 +1474,38 @@ loop:
 	}
 }
 
+/** Wake up the threads waiting for the log to be written or flushed up to
+an lsn in [old_lsn, new_lsn].
+@param[in]	events		log_sys->write_events or log_sys->flush_events
+@param[in]	old_lsn		previous value of the lsn that was advanced
+@param[in]	new_lsn		new value of the lsn that was advanced */
+static
+void
+log_wake_waiters(
+	os_event_t*	events,
+	lsn_t		old_lsn,
+	lsn_t		new_lsn)
+{
+	if (new_lsn <= old_lsn) {
+		return;
+	}
+
+	const lsn_t	first = old_lsn / OS_FILE_LOG_BLOCK_SIZE;
+	const lsn_t	last = new_lsn / OS_FILE_LOG_BLOCK_SIZE;
+
+	if (last - first >= LOG_WAIT_EVENTS) {
+		for (ulint i = 0; i < LOG_WAIT_EVENTS; ++i) {
+			os_event_set(events[i]);
+		}
+
+		return;
+	}
+
+	for (lsn_t block_no = first; block_no <= last; ++block_no) {
+		os_event_set(events[block_no % LOG_WAIT_EVENTS]);
+	}
+}
+
 /** Flush the log has been written to the log file. */
 static
 void
@@ -1413,7 +1521,14 @@ log_write_flush_to_disk_low()
 	if (do_flush) {
 		log_group_t*	group = UT_LIST_GET_FIRST(log_sys->log_groups);
 		fil_flush(group->space_id);
+
+		const lsn_t	old_lsn = log_sys->flushed_to_disk_lsn;
+
 		log_sys->flushed_to_disk_lsn = log_sys->current_flush_lsn;
+
+		log_wake_waiters(
+			log_sys->flush_events, old_lsn,
+			log_sys->flushed_to_disk_lsn);
 	}
 
 	log_sys->n_pending_flushes--;
@@ -1422,71 +1537,81 @@ log_write_flush_to_disk_low()
 	os_event_set(log_sys->flush_event);
 }
 
-/** Switch the log buffer in use, and copy the content of last block
-from old log buffer to the head of the to be used one. Thus, buf_free and
-buf_next_to_write would be changed accordingly */
-static inline
+/** Copy the log blocks in [area_start, area_end) from the log buffer ring
+to the write buffer and fill in their headers.
+@param[in]	area_start	start of the first block
+@param[in]	area_end	end of the last block
+@param[in]	ready_lsn	the log is complete up to this lsn, which is
+within the last block
+@param[in]	checkpoint_no	value for LOG_BLOCK_CHECKPOINT_NO */
+static
 void
-log_buffer_switch()
+log_buffer_copy_to_write_buf(
+	lsn_t		area_start,
+	lsn_t		area_end,
+	lsn_t		ready_lsn,
+	ib_uint64_t	checkpoint_no)
 {
-	ut_ad(log_mutex_own());
-	ut_ad(log_write_mutex_own());
+	const ulint	len = static_cast<ulint>(area_end - area_start);
+	const ulint	offset = static_cast<ulint>(
+		area_start % log_sys->buf_size);
 
-	const byte*	old_buf = log_sys->buf;
-	ulint		area_end = ut_calc_align(log_sys->buf_free,
-						 OS_FILE_LOG_BLOCK_SIZE);
+	ut_ad(len > 0);
+	ut_ad(len <= log_sys->buf_size);
+	ut_ad(ready_lsn > area_end - OS_FILE_LOG_BLOCK_SIZE);
+	ut_ad(ready_lsn < area_end);
 
-	if (log_sys->first_in_use) {
-		ut_ad(log_sys->buf == ut_align(log_sys->buf_ptr,
-					       OS_FILE_LOG_BLOCK_SIZE));
-		log_sys->buf += log_sys->buf_size;
+	if (offset + len <= log_sys->buf_size) {
+		ut_memcpy(log_sys->write_buf, log_sys->buf + offset, len);
 	} else {
-		log_sys->buf -= log_sys->buf_size;
-		ut_ad(log_sys->buf == ut_align(log_sys->buf_ptr,
-					       OS_FILE_LOG_BLOCK_SIZE));
+		/* The area wraps around the end of the ring */
+		const ulint	first_len = log_sys->buf_size - offset;
+
+		ut_memcpy(log_sys->write_buf, log_sys->buf + offset,
+			  first_len);
+		ut_memcpy(log_sys->write_buf + first_len, log_sys->buf,
+			  len - first_len);
 	}
 
-	log_sys->first_in_use = !log_sys->first_in_use;
+	byte*	block = log_sys->write_buf;
 
-	/* Copy the last block to new buf */
-	ut_memcpy(log_sys->buf,
-		  old_buf + area_end - OS_FILE_LOG_BLOCK_SIZE,
-		  OS_FILE_LOG_BLOCK_SIZE);
+	for (lsn_t block_lsn = area_start;
+	     block_lsn < area_end;
+	     block_lsn += OS_FILE_LOG_BLOCK_SIZE,
+	     block += OS_FILE_LOG_BLOCK_SIZE) {
+
+		log_block_set_hdr_no(
+			block, log_block_convert_lsn_to_no(block_lsn));
+
+		if (block_lsn + OS_FILE_LOG_BLOCK_SIZE < area_end) {
+			log_block_set_data_len(block, OS_FILE_LOG_BLOCK_SIZE);
+		} else {
+			log_block_set_data_len(
+				block,
+				static_cast<ulint>(
+					ready_lsn % OS_FILE_LOG_BLOCK_SIZE));
+		}
+
+		log_block_set_checkpoint_no(block, checkpoint_no);
+	}
 
-	log_sys->buf_free %= OS_FILE_LOG_BLOCK_SIZE;
-	log_sys->buf_next_to_write = log_sys->buf_free;
+	log_block_set_flush_bit(log_sys->write_buf, TRUE);
 }
 
-/** Ensure that the log has been written to the log file up to a given
-log entry (such as that of a transaction commit). Start a new write, or
-wait and check if an already running write is covering the request.
+/** Write the log to the log file up to a given lsn in the calling thread.
+Start a new write, or wait and check if an already running write is
+covering the request.
 @param[in]	lsn		log sequence number that should be
 included in the redo log file write
 @param[in]	flush_to_disk	whether the written log should also
 be flushed to the file system */
+static
 void
-log_write_up_to(
+log_write_up_to_low(
 	lsn_t	lsn,
 	bool	flush_to_disk)
 {
-#ifdef UNIV_DEBUG
-	ulint		loop_count	= 0;
-#endif /* UNIV_DEBUG */
-	byte*	write_buf;
-	lsn_t	write_lsn;
-
-	ut_ad(!srv_read_only_mode);
-
-	if (recv_no_ibuf_operations) {
-		/* Recovery is running and no operations on the log files are
-		allowed yet (the variable name .._no_ibuf_.. is misleading) */
-
-		return;
-	}
-
 loop:
-	ut_ad(++loop_count < 128);
-
 #if UNIV_WORD_SIZE > 7
 	/* We can do a dirty read of LSN. */
 	/* NOTE: Currently doesn't do dirty read for
@@ -1543,14 +1668,22 @@ loop:
 		}
 	}
 
-	log_mutex_enter();
-	if (!flush_to_disk
-	    && log_sys->buf_free == log_sys->buf_next_to_write) {
-		/* Nothing to write and no flush to disk requested */
-		log_mutex_exit_all();
-		return;
+	/* Find out up to which lsn the log buffer has been filled
+	without holes. */
+	const lsn_t	ready_lsn = log_sys->recent_written->advance_tail();
+
+	if (ready_lsn < lsn) {
+		/* Some mini-transactions below lsn are still copying
+		their log records to the log buffer. */
+		log_write_mutex_exit();
+
+		os_thread_yield();
+
+		goto loop;
 	}
 
+	log_mutex_enter();
+
 	log_group_t*	group;
 	group = UT_LIST_GET_FIRST(log_sys->log_groups);
 
@@ -1560,7 +1693,7 @@ loop:
 		lsn_t	lsn_diff;
 		uint	count = 0;
 
-		lsn_diff = log_sys->lsn - arch_log_sys->get_archived_lsn();
+		lsn_diff = ready_lsn - arch_log_sys->get_archived_lsn();
 
 		while (lsn_diff > log_group_get_capacity(group)) {
 
@@ -1571,7 +1704,7 @@ loop:
 			os_thread_sleep(10000);
 
 			log_mutex_enter_all();
-			lsn_diff = log_sys->lsn
+			lsn_diff = ready_lsn
 				- arch_log_sys->get_archived_lsn();
 
 			ib::info() << "Flush Waiting for archiver to"
@@ -1594,24 +1727,23 @@ loop:
 		}
 	}
 
-	ulint		start_offset;
-	ulint		end_offset;
-	ulint		area_start;
-	ulint		area_end;
+	lsn_t		area_start;
+	lsn_t		area_end;
+	ulint		area_len;
 	ulong		write_ahead_size = srv_log_write_ahead_size;
 	ulint		pad_size;
 
 	DBUG_PRINT("ib_log", ("write " LSN_PF " to " LSN_PF,
 			      log_sys->write_lsn,
-			      log_sys->lsn));
+			      ready_lsn));
 
 	if (flush_to_disk) {
 		log_sys->n_pending_flushes++;
-		log_sys->current_flush_lsn = log_sys->lsn;
+		log_sys->current_flush_lsn = ready_lsn;
 		MONITOR_INC(MONITOR_PENDING_LOG_FLUSH);
 		os_event_reset(log_sys->flush_event);
 
-		if (log_sys->buf_free == log_sys->buf_next_to_write) {
+		if (ready_lsn == log_sys->write_lsn) {
 			/* Nothing to write, flush only */
 			log_mutex_exit_all();
 			log_write_flush_to_disk_low();
@@ -1619,77 +1751,89 @@ loop:
 		}
 	}
 
-	start_offset = log_sys->buf_next_to_write;
-	end_offset = log_sys->buf_free;
+	ut_ad(ready_lsn > log_sys->write_lsn);
 
-	area_start = ut_calc_align_down(start_offset, OS_FILE_LOG_BLOCK_SIZE);
-	area_end = ut_calc_align(end_offset, OS_FILE_LOG_BLOCK_SIZE);
+	area_start = ut_uint64_align_down(log_sys->write_lsn,
+					  OS_FILE_LOG_BLOCK_SIZE);
+	area_end = ut_uint64_align_up(ready_lsn, OS_FILE_LOG_BLOCK_SIZE);
+	area_len = static_cast<ulint>(area_end - area_start);
 
-	ut_ad(area_end - area_start > 0);
-
-	log_block_set_flush_bit(log_sys->buf + area_start, TRUE);
-	log_block_set_checkpoint_no(
-		log_sys->buf + area_end - OS_FILE_LOG_BLOCK_SIZE,
-		log_sys->next_checkpoint_no);
-
-	write_lsn = log_sys->lsn;
-	write_buf = log_sys->buf;
-
-	log_buffer_switch();
+	const ib_uint64_t	checkpoint_no = log_sys->next_checkpoint_no;
 
 	log_group_set_fields(group, log_sys->write_lsn);
 
 	log_mutex_exit();
 
+	/* Only the log writer, which holds write_mutex, reads from the
+	blocks between write_lsn and ready_lsn. The mini-transactions
+	may still be filling the last block beyond ready_lsn. */
+	log_buffer_copy_to_write_buf(
+		area_start, area_end, ready_lsn, checkpoint_no);
+
 	/* Calculate pad_size if needed. */
 	pad_size = 0;
 	if (write_ahead_size > OS_FILE_LOG_BLOCK_SIZE) {
 		lsn_t	end_offset;
 		ulint	end_offset_in_unit;
 
-		end_offset = log_group_calc_lsn_offset(
-			ut_uint64_align_up(write_lsn,
-					   OS_FILE_LOG_BLOCK_SIZE),
-			group);
+		end_offset = log_group_calc_lsn_offset(area_end, group);
 		end_offset_in_unit = (ulint) (end_offset % write_ahead_size);
 
 		if (end_offset_in_unit > 0
-		    && (area_end - area_start) > end_offset_in_unit) {
+		    && area_len > end_offset_in_unit) {
 			/* The first block in the unit was initialized
 			after the last writing.
 			Needs to be written padded data once. */
 			pad_size = write_ahead_size - end_offset_in_unit;
 
-			if (area_end + pad_size > log_sys->buf_size) {
-				pad_size = log_sys->buf_size - area_end;
+			if (area_len + pad_size > log_sys->write_buf_size) {
+				pad_size = log_sys->write_buf_size - area_len;
 			}
 
-			::memset(write_buf + area_end, 0, pad_size);
+			::memset(log_sys->write_buf + area_len, 0, pad_size);
 		}
 	}
 
 	/* Do the write to the log files */
 	log_group_write_buf(
-		group, write_buf + area_start,
-		area_end - area_start + pad_size,
+		group, log_sys->write_buf, area_len + pad_size,
 #ifdef UNIV_DEBUG
 		pad_size,
 #endif /* UNIV_DEBUG */
-		ut_uint64_align_down(log_sys->write_lsn,
-				     OS_FILE_LOG_BLOCK_SIZE),
-		start_offset - area_start);
+		area_start,
+		static_cast<ulint>(log_sys->write_lsn - area_start));
 
 	srv_stats.log_padded.add(pad_size);
 
-	log_sys->write_lsn = write_lsn;
+	const lsn_t	old_write_lsn = log_sys->write_lsn;
+
+	log_sys->write_lsn = ready_lsn;
+
+	log_wake_waiters(log_sys->write_events, old_write_lsn, ready_lsn);
 
 #ifndef _WIN32
 	if (srv_unix_file_flush_method == SRV_UNIX_O_DSYNC) {
 		/* O_SYNC means the OS did not buffer the log file at all:
 		so we have also flushed to disk what we have written */
+		const lsn_t	old_flushed_lsn = log_sys->flushed_to_disk_lsn;
+
 		log_sys->flushed_to_disk_lsn = log_sys->write_lsn;
+
+		log_wake_waiters(
+			log_sys->flush_events, old_flushed_lsn,
+			log_sys->flushed_to_disk_lsn);
 	}
 #endif /* !_WIN32 */
+
+	/* Pairs with the fence in log_wait_for_threads(): either the
+	waiter sees the new write_lsn, or we see its flush request. */
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+
+	if (log_sys->flush_requested_lsn.load()
+	    > log_sys->flushed_to_disk_lsn) {
+
+		os_event_set(log_sys->flusher_event);
+	}
 	if (arch_log_sys && arch_log_sys->is_active()) {
 
 		os_event_set(archiver_thread_event);
@@ -1702,6 +1846,302 @@ loop:
 	}
 }
 
+/** Check whether the log has been written, or flushed, up to a given lsn.
+@param[in]	lsn		log sequence number
+@param[in]	flush_to_disk	whether the log must also be flushed
+@return true if the log has been written (and flushed) up to lsn */
+static
+bool
+log_write_is_done(
+	lsn_t	lsn,
+	bool	flush_to_disk)
+{
+	os_rmb;
+
+	return(flush_to_disk
+	       ? log_sys->flushed_to_disk_lsn >= lsn
+	       : log_sys->write_lsn >= lsn);
+}
+
+/** Wait until the log writer thread has written the log up to a given lsn
+and, if requested, the log flusher thread has flushed it. The waiting thread
+first spins for innodb_log_wait_spin_rounds rounds and then sleeps on the
+event of the log block containing lsn.
+@param[in]	lsn		log sequence number
+@param[in]	flush_to_disk	whether the log must also be flushed
+@return false if the threads were stopped before the log was written up
+to lsn; the caller must then write the log itself */
+static
+bool
+log_wait_for_threads(
+	lsn_t	lsn,
+	bool	flush_to_disk)
+{
+	if (flush_to_disk) {
+		lsn_t	requested = log_sys->flush_requested_lsn.load();
+
+		while (requested < lsn
+		       && !log_sys->flush_requested_lsn.compare_exchange_weak(
+			       requested, lsn)) {
+		}
+
+		/* Pairs with the fence in log_write_up_to_low(). */
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+	}
+
+	os_rmb;
+
+	if (log_sys->write_lsn < lsn) {
+		if (!os_event_is_set(log_sys->writer_event)) {
+			os_event_set(log_sys->writer_event);
+		}
+	} else if (flush_to_disk) {
+		if (!os_event_is_set(log_sys->flusher_event)) {
+			os_event_set(log_sys->flusher_event);
+		}
+	}
+
+	const ulong	spin_rounds = srv_log_wait_spin_rounds;
+
+	for (ulong i = 0; i < spin_rounds; ++i) {
+		if (log_write_is_done(lsn, flush_to_disk)) {
+			MONITOR_INC(MONITOR_LOG_WAIT_SPIN_HITS);
+			return(true);
+		}
+
+		UT_RELAX_CPU();
+	}
+
+	os_event_t*	events = flush_to_disk
+		? log_sys->flush_events
+		: log_sys->write_events;
+
+	os_event_t	event = events[
+		(lsn / OS_FILE_LOG_BLOCK_SIZE) % LOG_WAIT_EVENTS];
+
+	for (;;) {
+		const int64_t	sig_count = os_event_reset(event);
+
+		if (log_write_is_done(lsn, flush_to_disk)) {
+			break;
+		}
+
+		if (!log_sys->threads_enabled.load()) {
+			return(false);
+		}
+
+		MONITOR_INC(MONITOR_LOG_WAIT_EVENT_WAITS);
+
+		os_event_wait_low(event, sig_count);
+	}
+
+	return(true);
+}
+
+/** Ensure that the log has been written to the log file up to a given
+log entry (such as that of a transaction commit). While the log writer and
+the log flusher threads are running, wait for them to do the write (and the
+flush); otherwise start a new write, or wait and check if an already running
+write is covering the request.
+@param[in]	lsn		log sequence number that should be
+included in the redo log file write
+@param[in]	flush_to_disk	whether the written log should also
+be flushed to the file system */
+void
+log_write_up_to(
+	lsn_t	lsn,
+	bool	flush_to_disk)
+{
+	ut_ad(!srv_read_only_mode);
+
+	if (recv_no_ibuf_operations) {
+		/* Recovery is running and no operations on the log files are
+		allowed yet (the variable name .._no_ibuf_.. is misleading) */
+
+		return;
+	}
+
+	lsn = std::min(lsn, log_get_lsn());
+
+	if (log_write_is_done(lsn, flush_to_disk)) {
+		return;
+	}
+
+	if (log_sys->threads_enabled.load()
+	    && log_wait_for_threads(lsn, flush_to_disk)) {
+
+		return;
+	}
+
+	log_write_up_to_low(lsn, flush_to_disk);
+}
+
+/** How long the log writer and the log flusher threads sleep at most when
+there is nothing to do, in microseconds */
+static const ulint	LOG_THREADS_IDLE_WAIT = 1000000;
+
+/** How many times the log writer yields while mini-transactions are still
+copying their log records, before it sleeps on log_sys->writer_event */
+static const ulint	LOG_WRITER_SPIN_ROUNDS = 100;
+
+/** How long the log writer sleeps at most while mini-transactions are still
+copying their log records, in microseconds */
+static const ulint	LOG_WRITER_COPY_WAIT = 100;
+
+/** The log writer thread. It writes the log buffer to the log files as soon
+as there is a hole-free range of log in it, so that the writes of concurrently
+committing transactions are batched together. */
+static
+void
+log_writer_thread()
+{
+	ut_ad(!srv_read_only_mode);
+
+	ulint	n_spins = 0;
+
+	while (log_sys->threads_enabled.load()) {
+
+		const int64_t	sig_count = os_event_reset(
+			log_sys->writer_event);
+
+		/* log_stop_background_threads() sets the event after
+		clearing threads_enabled; check again after the reset so
+		that the wake-up cannot be lost. */
+		if (!log_sys->threads_enabled.load()) {
+			break;
+		}
+
+		os_rmb;
+
+		const lsn_t	write_lsn = log_sys->write_lsn;
+
+		if (write_lsn >= log_get_lsn()) {
+			/* Nothing to write; log_wait_for_threads() wakes
+			us up. */
+			os_event_wait_time_low(
+				log_sys->writer_event, LOG_THREADS_IDLE_WAIT,
+				sig_count);
+			continue;
+		}
+
+		log_write_mutex_enter();
+
+		const lsn_t	ready_lsn = log_sys->recent_written->advance_tail();
+
+		log_write_mutex_exit();
+
+		if (ready_lsn > write_lsn) {
+			n_spins = 0;
+			log_write_up_to_low(ready_lsn, false);
+		} else if (++n_spins < LOG_WRITER_SPIN_ROUNDS) {
+			/* The mini-transactions are still copying their log
+			records to the log buffer; this takes very little
+			time. */
+			os_thread_yield();
+		} else {
+			/* A copy is taking long, for example because the
+			thread was scheduled out. Sleep until a thread
+			waits for the write, or a little while. */
+			n_spins = 0;
+			os_event_wait_time_low(
+				log_sys->writer_event, LOG_WRITER_COPY_WAIT,
+				sig_count);
+		}
+	}
+
+	log_sys->writer_is_active = false;
+	os_event_set(log_sys->threads_exit_event);
+}
+
+/** The log flusher thread. It flushes the written log to disk whenever a
+thread has asked for it in log_write_up_to(), so that one fsync covers the
+commits of all the transactions that were waiting for it. */
+static
+void
+log_flusher_thread()
+{
+	ut_ad(!srv_read_only_mode);
+
+	while (log_sys->threads_enabled.load()) {
+
+		const int64_t	sig_count = os_event_reset(
+			log_sys->flusher_event);
+
+		if (!log_sys->threads_enabled.load()) {
+			break;
+		}
+
+		os_rmb;
+
+		const lsn_t	flush_lsn = std::min(
+			log_sys->flush_requested_lsn.load(),
+			log_sys->write_lsn);
+
+		if (flush_lsn <= log_sys->flushed_to_disk_lsn) {
+			os_event_wait_time_low(
+				log_sys->flusher_event, LOG_THREADS_IDLE_WAIT,
+				sig_count);
+			continue;
+		}
+
+		log_write_up_to_low(flush_lsn, true);
+	}
+
+	log_sys->flusher_is_active = false;
+	os_event_set(log_sys->threads_exit_event);
+}
+
+/** Start the log writer and the log flusher threads. From then on,
+log_write_up_to() waits for them instead of writing the log itself. */
+void
+log_start_background_threads()
+{
+	ut_ad(!srv_read_only_mode);
+	ut_ad(!log_sys->threads_enabled.load());
+
+	log_sys->writer_is_active = true;
+	log_sys->flusher_is_active = true;
+
+	log_sys->threads_enabled.store(true);
+
+	os_thread_create(log_writer_thread_key, log_writer_thread);
+	os_thread_create(log_flusher_thread_key, log_flusher_thread);
+}
+
+/** Stop the log writer and the log flusher threads and wait until they
+have exited. log_write_up_to() writes the log itself afterwards. */
+void
+log_stop_background_threads()
+{
+	if (!log_sys->threads_enabled.load()) {
+		return;
+	}
+
+	log_sys->threads_enabled.store(false);
+
+	os_event_set(log_sys->writer_event);
+	os_event_set(log_sys->flusher_event);
+
+	for (;;) {
+		const int64_t	sig_count = os_event_reset(
+			log_sys->threads_exit_event);
+
+		if (!log_sys->writer_is_active
+		    && !log_sys->flusher_is_active) {
+			break;
+		}
+
+		os_event_wait_low(log_sys->threads_exit_event, sig_count);
+	}
+
+	/* Let the threads which are still waiting for the log writer or
+	the log flusher do the write themselves. */
+	for (ulint i = 0; i < LOG_WAIT_EVENTS; ++i) {
+		os_event_set(log_sys->write_events[i]);
+		os_event_set(log_sys->flush_events[i]);
+	}
+}
+
 /** write to the log file up to the last log entry.
 @param[in]	sync	whether we want the written log
 also to be flushed to disk. */
@@ -1727,7 +2167,7 @@ log_buffer_sync_in_background(
 
 	log_mutex_enter();
 
-	lsn = log_sys->lsn;
+	lsn = log_get_lsn();
 
 	if (flush
 	    && log_sys->n_pending_flushes > 0
@@ -1754,15 +2194,13 @@ log_flush_margin(void)
 	log_t*	log	= log_sys;
 	lsn_t	lsn	= 0;
 
-	log_mutex_enter();
+	const lsn_t	current_lsn = log_get_lsn();
 
-	if (log->buf_free > log->max_buf_free) {
+	if (current_lsn - log->write_lsn > log->max_buf_free) {
 		/* We can write during flush */
-		lsn = log->lsn;
+		lsn = current_lsn;
 	}
 
-	log_mutex_exit();
-
 	if (lsn) {
 		log_write_up_to(lsn, false);
 	}
@@ -1843,7 +2281,7 @@ log_complete_checkpoint()
 
 	log_sys->last_checkpoint_lsn = log_sys->next_checkpoint_lsn;
 	MONITOR_SET(MONITOR_LSN_CHECKPOINT_AGE,
-		    log_sys->lsn - log_sys->last_checkpoint_lsn);
+		    log_get_lsn() - log_sys->last_checkpoint_lsn);
 
 	DBUG_PRINT("ib_log", ("checkpoint ended at " LSN_PF
 			      ", flushed to " LSN_PF,
@@ -2076,9 +2514,7 @@ log_checkpoint(
 	lsn_t	persist_lsn = 0;
 
 	if (has_persisted) {
-		log_mutex_enter();
-		persist_lsn = log_sys->lsn;
-		log_mutex_exit();
+		persist_lsn = log_get_lsn();
 	}
 
 #ifndef _WIN32
@@ -2103,7 +2539,7 @@ log_checkpoint(
 	lsn_t	flush_lsn = std::max(persist_lsn, oldest_lsn);
 
 	/* Because log also contains headers and dummy log records,
-	log_buf_pool_get_oldest_modification() will return log_sys->lsn
+	log_buf_pool_get_oldest_modification() will return the current lsn
 	if the buffer pool contains no dirty buffers.
 	We must make sure that the log is flushed up to that lsn.
 	If there are dirty buffers in the buffer pool, then our
@@ -2210,7 +2646,9 @@ loop:
 
 	oldest_lsn = log_buf_pool_get_oldest_modification();
 
-	age = log->lsn - oldest_lsn;
+	const lsn_t	current_lsn = log_get_lsn();
+
+	age = current_lsn - oldest_lsn;
 
 	if (age > log->max_modified_age_sync) {
 
@@ -2218,7 +2656,7 @@ loop:
 		advance = age - log->max_modified_age_sync;
 	}
 
-	checkpoint_age = log->lsn - log->last_checkpoint_lsn;
+	checkpoint_age = current_lsn - log->last_checkpoint_lsn;
 
 	bool	checkpoint_sync;
 	bool	do_checkpoint;
@@ -2380,6 +2818,12 @@ loop:
 		}
 	}
 
+	/* The remaining log writes and flushes of the shutdown are done
+	by this thread. */
+	if (!srv_read_only_mode) {
+		log_stop_background_threads();
+	}
+
 	log_mutex_enter();
 	const ulint	n_write	= log_sys->n_pending_checkpoint_writes;
 	const ulint	n_flush	= log_sys->n_pending_flushes;
@@ -2475,7 +2919,7 @@ loop:
 
 	log_mutex_enter();
 
-	lsn = log_sys->lsn;
+	lsn = log_get_lsn();
 
 	ut_ad(lsn >= log_sys->last_checkpoint_lsn);
 
@@ -2531,7 +2975,7 @@ loop:
 	bool	freed = buf_all_freed();
 	ut_a(freed);
 
-	ut_a(lsn == log_sys->lsn);
+	ut_a(lsn == log_get_lsn());
 
 	if (lsn < srv_start_lsn) {
 		ib::error() << "Log sequence number at shutdown " << lsn
@@ -2577,26 +3021,20 @@ loop:
 	freed = buf_all_freed();
 	ut_a(freed);
 
-	ut_a(lsn == log_sys->lsn);
+	ut_a(lsn == log_get_lsn());
 }
 
 /******************************************************//**
 Peeks the current lsn.
-@return TRUE if success, FALSE if could not get the log system mutex */
+@return TRUE always; the lsn can be read without any latch */
 ibool
 log_peek_lsn(
 /*=========*/
-	lsn_t*	lsn)	/*!< out: if returns TRUE, current lsn is here */
+	lsn_t*	lsn)	/*!< out: current lsn */
 {
-	if (0 == mutex_enter_nowait(&(log_sys->mutex))) {
-		*lsn = log_sys->lsn;
-
-		log_mutex_exit();
-
-		return(TRUE);
-	}
+	*lsn = log_get_lsn();
 
-	return(FALSE);
+	return(TRUE);
 }
 
 /******************************************************//**
@@ -2616,7 +3054,7 @@ log_print(
 		"Log flushed up to   " LSN_PF "\n"
 		"Pages flushed up to " LSN_PF "\n"
 		"Last checkpoint at  " LSN_PF "\n",
-		log_sys->lsn,
+		log_get_lsn(),
 		log_sys->flushed_to_disk_lsn,
 		log_buf_pool_get_oldest_modification(),
 		log_sys->last_checkpoint_lsn);
@@ -2704,17 +3142,34 @@ log_shutdown()
 {
 	log_group_close_all();
 
-	ut_free(log_sys->buf_ptr);
-	log_sys->buf_ptr = NULL;
-	log_sys->buf = NULL;
+	log_buffer_free();
 	ut_free(log_sys->checkpoint_buf_ptr);
 	log_sys->checkpoint_buf_ptr = NULL;
 	log_sys->checkpoint_buf = NULL;
 
 	os_event_destroy(log_sys->flush_event);
 
+	ut_ad(!log_sys->threads_enabled.load());
+
+	os_event_destroy(log_sys->writer_event);
+	os_event_destroy(log_sys->flusher_event);
+	os_event_destroy(log_sys->threads_exit_event);
+
+	for (ulint i = 0; i < LOG_WAIT_EVENTS; ++i) {
+		os_event_destroy(log_sys->write_events[i]);
+		os_event_destroy(log_sys->flush_events[i]);
+	}
+
+	ut_free(log_sys->write_events);
+	ut_free(log_sys->flush_events);
+
 	rw_lock_free(&log_sys->checkpoint_lock);
 
+	UT_DELETE(log_sys->recent_written);
+	log_sys->recent_written = NULL;
+
+	log_sys->sn_lock.free();
+
 	mutex_free(&log_sys->mutex);
 	mutex_free(&log_sys->write_mutex);
 	mutex_free(&log_sys->log_flush_order_mutex);
@@ -2734,27 +3189,38 @@ log_get_last_block(
 	lsn_t&		last_lsn,
 	byte*		last_block)
 {
-	byte*		src_block;
-
-	log_mutex_enter();
-	last_lsn = log_sys->lsn;
-
 	if (last_block == nullptr) {
 
-		log_mutex_exit();
+		last_lsn = log_get_lsn();
 		return;
 	}
 
+	/* Freeze the lsn, so that all the log up to it is in the
+	log buffer. */
+	log_buffer_x_lock_enter();
+
+	last_lsn = log_get_lsn();
+
 	/* Copy last block from current buffer. */
-	src_block = log_sys->buf + ut_calc_align_down(log_sys->buf_free,
-		OS_FILE_LOG_BLOCK_SIZE);
+	ut_memcpy(last_block, log_buffer_block(last_lsn),
+		  OS_FILE_LOG_BLOCK_SIZE);
 
-	ut_ad(src_block != nullptr);
+	log_buffer_x_lock_exit();
 
-	ut_memcpy(last_block, src_block, OS_FILE_LOG_BLOCK_SIZE);
+	/* Only the log writer fills in the block header in the log
+	buffer; do it here for the copy. */
+	log_mutex_enter();
+
+	log_block_set_checkpoint_no(last_block, log_sys->next_checkpoint_no);
 
 	log_mutex_exit();
 
+	log_block_set_hdr_no(last_block,
+			     log_block_convert_lsn_to_no(last_lsn));
+	log_block_set_data_len(
+		last_block,
+		static_cast<ulint>(last_lsn % OS_FILE_LOG_BLOCK_SIZE));
+
 	log_block_store_checksum(last_block);
 }
 
@@ -29,7 +29,9 @@ Created 9/20/1997 Heikki Tuuri
 #include <my_aes.h>
 #include <sys/types.h>
 
+#include <algorithm>
 #include <array>
+#include <atomic>
 #include <map>
 #include <new>
 #include <string>
@@ -80,6 +82,17 @@ this must be less than UNIV_PAGE_SIZE as it is stored in the buffer pool */
 /** Read-ahead area in applying log records to file pages */
 static const size_t RECV_READ_AHEAD_AREA = 32;
 
+#ifndef UNIV_HOTBACKUP
+/** Minimum number of pages in an apply batch for each apply thread */
+static const size_t RECV_APPLY_PAGES_PER_THREAD = 256;
+
+# ifdef UNIV_DEBUG
+/** Minimum number of pages in an apply batch for each apply thread, or 0
+for RECV_APPLY_PAGES_PER_THREAD */
+uint	recv_apply_pages_per_thread_debug = 0;
+# endif /* UNIV_DEBUG */
+#endif /* !UNIV_HOTBACKUP */
+
 /** The recovery system */
 recv_sys_t*	recv_sys = nullptr;
 
@@ -161,6 +174,7 @@ static lsn_t	recv_max_page_lsn;
 #ifndef UNIV_HOTBACKUP
 # ifdef UNIV_PFS_THREAD
 mysql_pfs_key_t	recv_writer_thread_key;
+mysql_pfs_key_t	recv_apply_thread_key;
 # endif /* UNIV_PFS_THREAD */
 
 /** Flag indicating if recv_writer thread is active. */
@@ -930,8 +944,16 @@ recv_log_recover_5_7(lsn_t lsn)
 	recv_sys->parse_start_lsn = recv_sys->recovered_lsn
 		= recv_sys->scanned_lsn = lsn;
 
+	/* The block was read to the log buffer, which is about to be
+	reset to continue from it. */
+	byte	last_block[OS_FILE_LOG_BLOCK_SIZE];
+
+	ut_memcpy(last_block, buf, OS_FILE_LOG_BLOCK_SIZE);
+
+	log_buffer_reset(lsn, last_block);
+
 	log_sys->last_checkpoint_lsn = log_sys->next_checkpoint_lsn
-		= log_sys->lsn = log_sys->write_lsn
+		= log_sys->write_lsn
 		= log_sys->current_flush_lsn = log_sys->flushed_to_disk_lsn
 		= lsn;
 
@@ -2400,7 +2422,10 @@ recv_read_in_area(const page_id_t& page_id)
 		}
 	}
 
-	buf_read_recv_pages(false, page_id.space(), &page_nos[0], n);
+	/* Another thread may have read in the page meanwhile. */
+	if (n > 0) {
+		buf_read_recv_pages(false, page_id.space(), &page_nos[0], n);
+	}
 
 	return(n);
 }
@@ -2475,6 +2500,74 @@ recv_apply_log_rec(recv_addr_t* recv_addr)
 	}
 }
 
+/** Pages of an apply batch that are assigned to one apply thread */
+using Recv_addrs = std::vector<recv_addr_t*, ut_allocator<recv_addr_t*>>;
+
+/** Progress reporting of an apply batch, shared by the apply threads */
+struct recv_apply_progress_t {
+
+	/** Constructor
+	@param[in]	batch_size	number of pages in the batch */
+	explicit recv_apply_progress_t(size_t batch_size)
+		:
+		m_n_applied(),
+		m_unit(batch_size / PCT),
+		m_pct(PCT)
+	{
+		if (m_unit <= PCT) {
+			m_pct = 100;
+			m_unit = batch_size;
+		}
+	}
+
+	/** Note that a page of the batch has been processed and report
+	the progress at every m_pct percent. */
+	void applied()
+	{
+		const size_t	n = m_n_applied.fetch_add(1) + 1;
+
+		if (m_unit == 0 || (n % m_unit) == 0) {
+			ib::info() << (m_unit == 0 ? 1 : n / m_unit) * m_pct
+				<< "%";
+		}
+	}
+
+	/** Report the progress every 10 percent */
+	static const size_t	PCT = 10;
+
+	/** Number of pages processed so far */
+	std::atomic<size_t>	m_n_applied;
+
+	/** Report the progress after every m_unit pages */
+	size_t			m_unit;
+
+	/** Percentage of the batch that m_unit pages represent */
+	size_t			m_pct;
+};
+
+/** Apply the log records to the pages of one partition of an apply batch.
+The pages that are not in the buffer pool are read in, the log records
+are applied to them by the I/O handler threads.
+@param[in]	recv_addrs	pages to recover, sorted by page number
+@param[in,out]	progress	progress of the batch */
+static
+void
+recv_apply_log_recs_low(
+	const Recv_addrs*	recv_addrs,
+	recv_apply_progress_t*	progress)
+{
+	mutex_enter(&recv_sys->mutex);
+
+	for (auto recv_addr : *recv_addrs) {
+
+		recv_apply_log_rec(recv_addr);
+
+		progress->applied();
+	}
+
+	mutex_exit(&recv_sys->mutex);
+}
+
 /** Empties the hash table of stored log records, applying them to appropriate
 pages.
 @param[in]	allow_ibuf	if true, ibuf operations are allowed during
@@ -2518,36 +2611,74 @@ recv_apply_hashed_log_recs(bool allow_ibuf)
 		<< batch_size
 		<< " redo log records ...";
 
-	static const size_t	PCT = 10;
+	/* The pages are partitioned between the apply threads by
+	read-ahead area, so that the threads recover disjoint pages and
+	each area is read in by one thread only. */
+	size_t	pages_per_thread = RECV_APPLY_PAGES_PER_THREAD;
 
-	size_t	pct = PCT;
-	size_t	applied = 0;
-	auto	unit = batch_size / PCT;
+	ut_d(if (recv_apply_pages_per_thread_debug > 0) {
+		pages_per_thread = recv_apply_pages_per_thread_debug;
+	});
 
-	if (unit <= PCT) {
-		pct = 100;
-		unit = batch_size;
-	}
+	const size_t	n_threads = std::max(
+		std::min(
+			static_cast<size_t>(srv_n_recv_apply_threads),
+			batch_size / pages_per_thread),
+		static_cast<size_t>(1));
+
+	std::vector<Recv_addrs, ut_allocator<Recv_addrs>> partitions(
+		n_threads);
 
 	for (const auto& space : *recv_sys->spaces) {
 
 		fil_tablespace_open_for_recovery(space.first);
 
-		for (auto pages : space.second.m_pages) {
+		for (const auto& pages : space.second.m_pages) {
 
-			ut_ad(pages.second->space == space.first);
+			recv_addr_t*	recv_addr = pages.second;
 
-			recv_apply_log_rec(pages.second);
+			ut_ad(recv_addr->space == space.first);
 
-			++applied;
+			ulint	fold = ut_fold_ulint_pair(
+				recv_addr->space,
+				recv_addr->page_no / RECV_READ_AHEAD_AREA);
 
-			if (unit == 0 || (applied % unit) == 0) {
-				ib::info() << pct << "%";
-				pct += PCT;
-			}
+			partitions[fold % n_threads].push_back(recv_addr);
 		}
 	}
 
+	/* Read the pages in ascending order within each tablespace. */
+	for (auto& recv_addrs : partitions) {
+
+		std::sort(
+			recv_addrs.begin(), recv_addrs.end(),
+			[](const recv_addr_t* lhs, const recv_addr_t* rhs)
+			{
+				return(lhs->space < rhs->space
+				       || (lhs->space == rhs->space
+					   && lhs->page_no < rhs->page_no));
+			});
+	}
+
+	mutex_exit(&recv_sys->mutex);
+
+	recv_apply_progress_t	progress(batch_size);
+	Helper_threads		helpers;
+
+	/* The calling thread applies the first partition itself. */
+	for (size_t i = 1; i < n_threads; ++i) {
+
+		helpers.start(
+			recv_apply_thread_key, recv_apply_log_recs_low,
+			&partitions[i], &progress);
+	}
+
+	recv_apply_log_recs_low(&partitions[0], &progress);
+
+	helpers.join();
+
+	mutex_enter(&recv_sys->mutex);
+
 	/* Wait until all the pages have been processed */
 
 	while (recv_sys->n_addrs != 0) {
@@ -3843,8 +3974,6 @@ recv_recovery_from_checkpoint_start(lsn_t flush_lsn)
 
 	recv_recovery_begin(group, &contiguous_lsn);
 
-	log_sys->lsn = recv_sys->recovered_lsn;
-
 	/* We currently have only one log group */
 
 	if (group->scanned_lsn < checkpoint_lsn
@@ -3892,16 +4021,12 @@ recv_recovery_from_checkpoint_start(lsn_t flush_lsn)
 		srv_start_lsn = recv_sys->recovered_lsn;
 	}
 
-	ut_memcpy(log_sys->buf, recv_sys->last_block, OS_FILE_LOG_BLOCK_SIZE);
-
-	log_sys->buf_free = (ulint) log_sys->lsn % OS_FILE_LOG_BLOCK_SIZE;
-	log_sys->buf_next_to_write = log_sys->buf_free;
-	log_sys->write_lsn = log_sys->lsn;
+	log_buffer_reset(recv_sys->recovered_lsn, recv_sys->last_block);
 
 	log_sys->last_checkpoint_lsn = checkpoint_lsn;
 
 	MONITOR_SET(MONITOR_LSN_CHECKPOINT_AGE,
-		    log_sys->lsn - log_sys->last_checkpoint_lsn);
+		    log_get_lsn() - log_sys->last_checkpoint_lsn);
 
 	log_sys->next_checkpoint_no = checkpoint_no + 1;
 
@@ -4031,30 +4156,25 @@ recv_reset_logs(lsn_t lsn)
 {
 	ut_ad(log_mutex_own());
 
-	log_sys->lsn = ut_uint64_align_up(lsn, OS_FILE_LOG_BLOCK_SIZE);
+	lsn = ut_uint64_align_up(lsn, OS_FILE_LOG_BLOCK_SIZE);
 
 	for (auto group = UT_LIST_GET_FIRST(log_sys->log_groups);
 	     group != nullptr;
 	     group = UT_LIST_GET_NEXT(log_groups, group)) {
 
-		group->lsn = log_sys->lsn;
+		group->lsn = lsn;
 		group->lsn_offset = LOG_FILE_HDR_SIZE;
 	}
 
-	log_sys->buf_next_to_write = 0;
-	log_sys->write_lsn = log_sys->lsn;
-
 	log_sys->next_checkpoint_no = 0;
 	log_sys->last_checkpoint_lsn = 0;
 
-	log_block_init(log_sys->buf, log_sys->lsn);
-	log_block_set_first_rec_group(log_sys->buf, LOG_BLOCK_HDR_SIZE);
-
-	log_sys->buf_free = LOG_BLOCK_HDR_SIZE;
-	log_sys->lsn += LOG_BLOCK_HDR_SIZE;
+	/* Start a new block at lsn. The next write will also write the
+	log file header. */
+	log_buffer_reset(lsn + LOG_BLOCK_HDR_SIZE, NULL);
 
 	MONITOR_SET(MONITOR_LSN_CHECKPOINT_AGE,
-		    (log_sys->lsn - log_sys->last_checkpoint_lsn));
+		    (log_get_lsn() - log_sys->last_checkpoint_lsn));
 
 	log_mutex_exit();
 
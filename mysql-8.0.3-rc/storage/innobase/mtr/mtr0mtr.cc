@@ -349,7 +349,8 @@ public:
 	/** Release the resources */
 	void release_resources();
 
-	/** Append the redo log records to the redo log buffer.
+	/** Copy the redo log records to the range of the redo log buffer
+	which was reserved for them.
 	@param[in]	len	number of bytes to write */
 	void finish_write(ulint len);
 
@@ -391,13 +392,25 @@ mtr_t::is_block_dirtied(const buf_block_t* block)
 
 /** Write the block contents to the REDO log */
 struct mtr_write_log_t {
+	/** Constructor.
+	@param[in]	start_lsn	start of the reserved log buffer range */
+	explicit mtr_write_log_t(lsn_t start_lsn)
+		:
+		m_lsn(start_lsn)
+	{
+		/* Do nothing */
+	}
+
 	/** Append a block to the redo log buffer.
 	@return whether the appending should continue */
-	bool operator()(const mtr_buf_t::block_t* block) const
+	bool operator()(const mtr_buf_t::block_t* block)
 	{
-		log_write_low(block->begin(), block->used());
+		m_lsn = log_buffer_write(block->begin(), block->used(), m_lsn);
 		return(true);
 	}
+
+	/** LSN where the next block will be copied to */
+	lsn_t		m_lsn;
 };
 
 /** Start a mini-transaction.
@@ -549,8 +562,6 @@ mtr_t::Command::prepare_write()
 	case MTR_LOG_NO_REDO:
 	case MTR_LOG_NONE:
 		ut_ad(m_impl->m_log.size() == 0);
-		log_mutex_enter();
-		m_end_lsn = m_start_lsn = log_sys->lsn;
 		return(0);
 	case MTR_LOG_ALL:
 		break;
@@ -566,10 +577,6 @@ mtr_t::Command::prepare_write()
 		log_buffer_extend((len + 1) * 2);
 	}
 
-	ut_ad(m_impl->m_n_log_recs == n_recs);
-
-	log_mutex_enter();
-
 	/* This was not the first time of dirtying a
 	tablespace since the latest checkpoint. */
 
@@ -601,36 +608,25 @@ mtr_t::Command::prepare_write()
 	return(len);
 }
 
-/** Append the redo log records to the redo log buffer
+/** Copy the redo log records to the range of the redo log buffer which
+was reserved for them.
 @param[in] len	number of bytes to write */
 void
 mtr_t::Command::finish_write(
 	ulint	len)
 {
 	ut_ad(m_impl->m_log_mode == MTR_LOG_ALL);
-	ut_ad(log_mutex_own());
 	ut_ad(m_impl->m_log.size() == len);
 	ut_ad(len > 0);
 
-	if (m_impl->m_log.is_small()) {
-		const mtr_buf_t::block_t*	front = m_impl->m_log.front();
-		ut_ad(len <= front->used());
-
-		m_end_lsn = log_reserve_and_write_fast(
-			front->begin(), len, &m_start_lsn);
+	log_buffer_wait_for_space(m_end_lsn);
 
-		if (m_end_lsn > 0) {
-			return;
-		}
-	}
-
-	/* Open the database log for log_write_low */
-	m_start_lsn = log_reserve_and_open(len);
-
-	mtr_write_log_t	write_log;
+	mtr_write_log_t	write_log(m_start_lsn);
 	m_impl->m_log.for_each_block(write_log);
 
-	m_end_lsn = log_close();
+	ut_ad(write_log.m_lsn == m_end_lsn);
+
+	log_buffer_close(m_start_lsn, m_end_lsn);
 }
 
 /** Release the latches and blocks acquired by this mini-transaction */
@@ -664,27 +660,43 @@ mtr_t::Command::execute()
 {
 	ut_ad(m_impl->m_log_mode != MTR_LOG_NONE);
 
-	if (const ulint len = prepare_write()) {
-		finish_write(len);
-	}
+	const ulint	len = prepare_write();
+
+	const size_t	shard = log_buffer_s_lock_enter();
 
 	if (m_impl->m_made_dirty) {
 		log_flush_order_mutex_enter();
 	}
 
-	/* It is now safe to release the log mutex because the
-	flush_order mutex will ensure that we are the first one
-	to insert into the flush list. */
-	log_mutex_exit();
+	/* Reserving the log inside the flush_order mutex ensures that
+	we insert into the flush list in the LSN order. */
+	if (len > 0) {
+		log_buffer_reserve(len, &m_start_lsn, &m_end_lsn);
+	} else {
+		m_end_lsn = m_start_lsn = log_get_lsn();
+	}
 
 	m_impl->m_mtr->m_commit_lsn = m_end_lsn;
 
-	add_dirty_blocks_to_flush_list();
-
 	if (m_impl->m_made_dirty) {
+
+		add_dirty_blocks_to_flush_list();
+
 		log_flush_order_mutex_exit();
 	}
 
+	/* The page latches are still held, so the pages cannot be
+	flushed before their log records are in the log buffer. */
+	if (len > 0) {
+		finish_write(len);
+	}
+
+	log_buffer_s_lock_exit(shard);
+
+	if (!m_impl->m_made_dirty) {
+		add_dirty_blocks_to_flush_list();
+	}
+
 	release_all();
 	release_resources();
 }
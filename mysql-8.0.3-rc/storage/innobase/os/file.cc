@@ -45,6 +45,57 @@ external tools. */
 #include <lz4.h>
 #include <zlib.h>
 
+#ifdef HAVE_LIBZSTD
+# include <zdict.h>
+# include <zstd.h>
+
+/** Zstandard dictionary of a tablespace */
+struct Compression::Dictionary {
+
+	/** Dictionary digested for compression at m_level */
+	ZSTD_CDict*	m_cdict;
+
+	/** Dictionary digested for decompression */
+	ZSTD_DDict*	m_ddict;
+
+	/** Compression level m_cdict was prepared for */
+	ulint		m_level;
+
+	/** Dictionary id, stored in every frame compressed with it */
+	unsigned	m_id;
+
+	/** Raw dictionary contents, for compressing at other levels */
+	byte*		m_data;
+
+	/** Length of m_data in bytes */
+	ulint		m_len;
+};
+
+/** Zstandard contexts of a thread. Creating a context allocates a few
+hundred kilobytes, so each thread keeps its own for all page I/O. */
+struct zstd_thread_ctx_t {
+
+	/** Constructor */
+	zstd_thread_ctx_t() : m_cctx(), m_dctx() { }
+
+	/** Destructor */
+	~zstd_thread_ctx_t()
+	{
+		ZSTD_freeCCtx(m_cctx);
+		ZSTD_freeDCtx(m_dctx);
+	}
+
+	/** Compression context, created on first use */
+	ZSTD_CCtx*	m_cctx;
+
+	/** Decompression context, created on first use */
+	ZSTD_DCtx*	m_dctx;
+};
+
+/** Zstandard contexts of the current thread */
+static thread_local zstd_thread_ctx_t	zstd_thread_ctx;
+#endif /* HAVE_LIBZSTD */
+
 /**
 @param[in]      type            The compression type
 @return the string representation */
@@ -58,6 +109,8 @@ Compression::to_string(Type type)
                 return("Zlib");
         case LZ4:
                 return("LZ4");
+        case ZSTD:
+                return("Zstd");
         }
 
         ut_ad(0);
@@ -122,13 +175,15 @@ not then the source contents are left unchanged and DB_SUCCESS is returned.
 				copied to this page
 @param[in,out]	dst		Scratch area to use for decompression
 @param[in]	dst_len		Size of the scratch area in bytes
+@param[in]	dict		Zstandard dictionary of the tablespace, or NULL
 @return DB_SUCCESS or error code */
 dberr_t
 Compression::deserialize(
-	bool		dblwr_recover,
-	byte*		src,
-	byte*		dst,
-	ulint		dst_len)
+	bool			dblwr_recover,
+	byte*			src,
+	byte*			dst,
+	ulint			dst_len,
+	const Dictionary*	dict)
 {
 	if (!is_compressed_page(src)) {
 		/* There is nothing we can do. */
@@ -238,6 +293,65 @@ Compression::deserialize(
 
 		break;
 
+#ifdef HAVE_LIBZSTD
+	case Compression::ZSTD: {
+
+		ZSTD_DCtx*&	dctx = zstd_thread_ctx.m_dctx;
+
+		if (dctx == NULL) {
+			dctx = ZSTD_createDCtx();
+		}
+
+		/* A frame that was compressed with a dictionary records
+		its id; it can only be decoded with that dictionary. */
+		unsigned	dict_id = ZSTD_getDictID_fromFrame(
+			ptr, header.m_compressed_size);
+		size_t		zret = 0;
+		bool		success = false;
+
+		if (dctx == NULL) {
+
+			/* Fall through to the error below. */
+
+		} else if (dict_id == 0) {
+
+			zret = ZSTD_decompressDCtx(
+				dctx, dst, header.m_original_size,
+				ptr, header.m_compressed_size);
+
+			success = !ZSTD_isError(zret);
+
+		} else if (dict != NULL && dict->m_id == dict_id) {
+
+			zret = ZSTD_decompress_usingDDict(
+				dctx, dst, header.m_original_size,
+				ptr, header.m_compressed_size, dict->m_ddict);
+
+			success = !ZSTD_isError(zret);
+		} else {
+
+			ib::error()
+				<< "Page is compressed with Zstandard"
+				" dictionary " << dict_id << " but the"
+				" tablespace has "
+				<< (dict == NULL ? 0 : dict->m_id);
+		}
+
+		if (!success) {
+
+			if (allocated) {
+				ut_free(dst);
+			}
+
+			return(DB_IO_DECOMPRESS_FAIL);
+		}
+
+		len = static_cast<ulint>(zret);
+
+		break;
+	}
+#endif /* HAVE_LIBZSTD */
+
 	default:
 		ib::error()
 			<< "Compression algorithm support missing: "
@@ -274,13 +388,167 @@ not then the source contents are left unchanged and DB_SUCCESS is returned.
 				copied to this page
 @param[in,out]	dst		Scratch area to use for decompression
 @param[in]	dst_len		Size of the scratch area in bytes
+@param[in]	dict		Zstandard dictionary of the tablespace, or NULL
 @return DB_SUCCESS or error code */
 dberr_t
 os_file_decompress_page(
-	bool		dblwr_recover,
-	byte*		src,
-	byte*		dst,
-	ulint		dst_len)
+	bool				dblwr_recover,
+	byte*				src,
+	byte*				dst,
+	ulint				dst_len,
+	const Compression::Dictionary*	dict)
 {
-	return(Compression::deserialize(dblwr_recover, src, dst, dst_len));
+	return(Compression::deserialize(
+		dblwr_recover, src, dst, dst_len, dict));
+}
+
+/** Compress a page image with Zstandard.
+@param[in]	dict		dictionary to use, or NULL
+@param[in]	level		compression level
+@param[in]	src		data to compress
+@param[in]	src_len		length of src in bytes
+@param[out]	dst		compressed data
+@param[in]	dst_len		capacity of dst in bytes
+@return compressed length, or 0 if the data did not fit or Zstandard is
+not available */
+ulint
+Compression::zstd_compress(
+	const Dictionary*	dict,
+	ulint			level,
+	const byte*		src,
+	ulint			src_len,
+	byte*			dst,
+	ulint			dst_len)
+{
+#ifdef HAVE_LIBZSTD
+	ZSTD_CCtx*&	cctx = zstd_thread_ctx.m_cctx;
+
+	if (cctx == NULL) {
+
+		cctx = ZSTD_createCCtx();
+
+		if (cctx == NULL) {
+			return(0);
+		}
+	}
+
+	size_t	ret;
+
+	if (dict == NULL) {
+
+		ret = ZSTD_compressCCtx(
+			cctx, dst, dst_len, src, src_len,
+			static_cast<int>(level));
+
+	} else if (dict->m_level == level) {
+
+		ret = ZSTD_compress_usingCDict(
+			cctx, dst, dst_len, src, src_len, dict->m_cdict);
+	} else {
+
+		/* The level was changed after the dictionary was
+		digested: slower, but honours the new setting. */
+		ret = ZSTD_compress_usingDict(
+			cctx, dst, dst_len, src, src_len,
+			dict->m_data, dict->m_len, static_cast<int>(level));
+	}
+
+	return(ZSTD_isError(ret) ? 0 : static_cast<ulint>(ret));
+#else
+	return(0);
+#endif /* HAVE_LIBZSTD */
+}
+
+/** Train a Zstandard dictionary from sample pages.
+@param[in]	samples		sample contents, back to back
+@param[in]	sizes		length of each sample in bytes
+@param[in]	n_samples	number of samples
+@param[out]	dict		trained dictionary
+@param[in]	capacity	capacity of dict in bytes
+@return length of the dictionary, or 0 on failure */
+ulint
+Compression::train_dictionary(
+	const byte*	samples,
+	const size_t*	sizes,
+	ulint		n_samples,
+	byte*		dict,
+	ulint		capacity)
+{
+#ifdef HAVE_LIBZSTD
+	size_t	ret = ZDICT_trainFromBuffer(
+		dict, capacity, samples, sizes,
+		static_cast<unsigned>(n_samples));
+
+	if (ZDICT_isError(ret) || ZDICT_getDictID(dict, ret) == 0) {
+		return(0);
+	}
+
+	return(static_cast<ulint>(ret));
+#else
+	return(0);
+#endif /* HAVE_LIBZSTD */
+}
+
+/** Create a dictionary object from a trained dictionary.
+@param[in]	data		dictionary contents
+@param[in]	len		length of data in bytes
+@param[in]	level		level to prepare for compression with
+@return dictionary to free with free_dictionary(), or NULL */
+Compression::Dictionary*
+Compression::create_dictionary(
+	const byte*	data,
+	ulint		len,
+	ulint		level)
+{
+#ifdef HAVE_LIBZSTD
+	unsigned	id = ZDICT_getDictID(data, len);
+
+	if (id == 0) {
+		return(NULL);
+	}
+
+	Dictionary*	dict = static_cast<Dictionary*>(
+		ut_zalloc_nokey(sizeof(*dict) + len));
+
+	if (dict == NULL) {
+		return(NULL);
+	}
+
+	dict->m_id = id;
+	dict->m_level = level;
+	dict->m_len = len;
+	dict->m_data = reinterpret_cast<byte*>(dict + 1);
+
+	memcpy(dict->m_data, data, len);
+
+	dict->m_cdict = ZSTD_createCDict(
+		dict->m_data, len, static_cast<int>(level));
+
+	dict->m_ddict = ZSTD_createDDict(dict->m_data, len);
+
+	if (dict->m_cdict == NULL || dict->m_ddict == NULL) {
+		free_dictionary(dict);
+		return(NULL);
+	}
+
+	return(dict);
+#else
+	return(NULL);
+#endif /* HAVE_LIBZSTD */
+}
+
+/** Free a dictionary created by create_dictionary().
+@param[in,out]	dict		dictionary to free, or NULL */
+void
+Compression::free_dictionary(Dictionary* dict)
+{
+#ifdef HAVE_LIBZSTD
+	if (dict != NULL) {
+		ZSTD_freeCDict(dict->m_cdict);
+		ZSTD_freeDDict(dict->m_ddict);
+		ut_free(dict);
+	}
+#else
+	ut_a(dict == NULL);
+#endif /* HAVE_LIBZSTD */
 }
@@ -58,9 +58,16 @@ struct Compression {
 		ZLIB = 1,
 
 		/** Use LZ4 faster variant, usually lower compression. */
-		LZ4 = 2
+		LZ4 = 2,
+
+		/** Use Zstandard. The value 3 is taken by the "lz4hc" debug
+		setting of innodb_compress_debug. */
+		ZSTD = 4
 	};
 
+	/** Zstandard dictionary of a tablespace, opaque outside file.cc */
+	struct Dictionary;
+
 	/** Compressed page meta-data */
 	struct meta_t {
 
@@ -81,19 +88,21 @@ struct Compression {
 	};
 
 	/** Default constructor */
-	Compression() : m_type(NONE) { };
+	Compression() : m_type(NONE), m_dict() { };
 
 	/** Specific constructor
 	@param[in]	type		Algorithm type */
 	explicit Compression(Type type)
 		:
-		m_type(type)
+		m_type(type),
+		m_dict()
 	{
 #ifdef UNIV_DEBUG
 		switch (m_type) {
 		case NONE:
 		case ZLIB:
 		case LZ4:
+		case ZSTD:
 
 		default:
 			ut_error;
@@ -154,15 +163,69 @@ struct Compression {
 					data will be copied to this page
 	@param[in,out]	dst		Scratch area to use for decompression
 	@param[in]	dst_len		Size of the scratch area in bytes
+	@param[in]	dict		Zstandard dictionary of the tablespace,
+					or NULL if it has none
 	@return DB_SUCCESS or error code */
 	static dberr_t deserialize(
-		bool		dblwr_recover,
-		byte*		src,
-		byte*		dst,
-		ulint		dst_len)
+		bool			dblwr_recover,
+		byte*			src,
+		byte*			dst,
+		ulint			dst_len,
+		const Dictionary*	dict)
+		MY_ATTRIBUTE((warn_unused_result));
+
+	/** Compress a page image with Zstandard.
+	@param[in]	dict		dictionary to use, or NULL
+	@param[in]	level		compression level
+	@param[in]	src		data to compress
+	@param[in]	src_len		length of src in bytes
+	@param[out]	dst		compressed data
+	@param[in]	dst_len		capacity of dst in bytes
+	@return compressed length, or 0 if the data did not fit or
+	Zstandard is not available */
+	static ulint zstd_compress(
+		const Dictionary*	dict,
+		ulint			level,
+		const byte*		src,
+		ulint			src_len,
+		byte*			dst,
+		ulint			dst_len)
+		MY_ATTRIBUTE((warn_unused_result));
+
+	/** Train a Zstandard dictionary from sample pages.
+	@param[in]	samples		sample contents, back to back
+	@param[in]	sizes		length of each sample in bytes
+	@param[in]	n_samples	number of samples
+	@param[out]	dict		trained dictionary
+	@param[in]	capacity	capacity of dict in bytes
+	@return length of the dictionary, or 0 on failure */
+	static ulint train_dictionary(
+		const byte*	samples,
+		const size_t*	sizes,
+		ulint		n_samples,
+		byte*		dict,
+		ulint		capacity)
+		MY_ATTRIBUTE((warn_unused_result));
+
+	/** Create a dictionary object from a trained dictionary.
+	@param[in]	data		dictionary contents
+	@param[in]	len		length of data in bytes
+	@param[in]	level		level to prepare for compression with
+	@return dictionary to free with free_dictionary(), or NULL */
+	static Dictionary* create_dictionary(
+		const byte*	data,
+		ulint		len,
+		ulint		level)
 		MY_ATTRIBUTE((warn_unused_result));
 
+	/** Free a dictionary created by create_dictionary().
+	@param[in,out]	dict		dictionary to free, or NULL */
+	static void free_dictionary(Dictionary* dict);
+
 	/** Compression type */
-	Type		m_type;
+	Type			m_type;
+
+	/** Zstandard dictionary of the tablespace, or NULL */
+	const Dictionary*	m_dict;
 };
 #endif
@@ -73,6 +73,14 @@ Created 10/21/1995 Heikki Tuuri
 #include <libaio.h>
 #endif /* LINUX_NATIVE_AIO */
 
+#ifdef LINUX_IO_URING
+#include <linux/io_uring.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#endif /* LINUX_IO_URING */
+
 #ifdef HAVE_FALLOC_PUNCH_HOLE_AND_KEEP_SIZE
 # include <fcntl.h>
 # include <linux/falloc.h>
@@ -270,6 +278,19 @@ If an AIO request is made the calling thread not only queues it in the
 array but also submits the requests. The helper thread then collects
 the completed IO request and calls completion routine on it.
 
+Linux io_uring:
+===============
+
+If innodb_use_io_uring is also set and the kernel supports io_uring, the
+requests are passed to the kernel through an io_uring instance per segment
+instead of a libaio context. The calling thread queues the request in the
+submission ring while holding the array mutex. Requests that are flagged
+IORequest::DO_NOT_WAKE, such as read-ahead and flush batches, are left in
+the ring and submitted together by os_aio_simulated_wake_handler_threads().
+The helper thread of the segment reaps the completion ring without taking
+the array mutex; the completion entry points directly to the slot.
+Pages of the buffer pool are read and written through registered buffers.
+
 **********************************************************************/
 
 
@@ -344,6 +365,12 @@ struct Slot {
 	/** Linux control block for aio */
 	struct iocb		control;
 
+# ifdef LINUX_IO_URING
+	/** Buffer of an io_uring request that does not use a
+	registered buffer */
+	struct iovec		iov;
+# endif /* LINUX_IO_URING */
+
 	/** AIO return code */
 	int			ret;
 
@@ -373,6 +400,171 @@ struct Slot {
 	void*			encrypt_log_buf;
 };
 
+#ifdef LINUX_IO_URING
+/** An io_uring instance: a submission ring and a completion ring that are
+shared with the kernel. The C library has no wrappers for the io_uring
+system calls, therefore they are invoked directly. The submission ring has
+a single producer at a time, callers of get_sqe() and commit() must hold the
+mutex of the AIO array. The completion ring is only consumed by the I/O
+handler thread of the segment. */
+class IOUring {
+public:
+	/** Constructor */
+	IOUring()
+		:
+		m_fd(-1),
+		m_sq_ptr(MAP_FAILED),
+		m_sq_size(),
+		m_cq_ptr(MAP_FAILED),
+		m_cq_size(),
+		m_sqes(static_cast<io_uring_sqe*>(MAP_FAILED)),
+		m_sqes_size(),
+		m_sq_head(),
+		m_sq_tail(),
+		m_sq_mask(),
+		m_sq_entries(),
+		m_sq_local_tail(),
+		m_cq_head(),
+		m_cq_tail(),
+		m_cq_mask(),
+		m_cqes()
+	{
+	}
+
+	/** Destructor */
+	~IOUring()
+	{
+		destroy();
+	}
+
+	/** Create the rings and map them into our address space.
+	@param[in]	entries		minimum number of submission entries
+	@return 0 on success or -errno */
+	int create(ulint entries);
+
+	/** Unmap the rings and close the file descriptor. This also drops
+	the registered buffers. */
+	void destroy();
+
+	/** Get the next free submission entry. It is not visible to the
+	kernel before commit() is called.
+	@return submission entry, or nullptr if the ring is full */
+	io_uring_sqe* get_sqe()
+	{
+		const unsigned	head = __atomic_load_n(
+			m_sq_head, __ATOMIC_ACQUIRE);
+
+		if (m_sq_local_tail - head >= m_sq_entries) {
+			return(nullptr);
+		}
+
+		return(&m_sqes[m_sq_local_tail & *m_sq_mask]);
+	}
+
+	/** Publish the entry returned by get_sqe() to the kernel. */
+	void commit()
+	{
+		++m_sq_local_tail;
+
+		__atomic_store_n(m_sq_tail, m_sq_local_tail, __ATOMIC_RELEASE);
+	}
+
+	/** Submit all the published entries that the kernel has not
+	consumed yet. This can be called without holding the array mutex.
+	@return number of submitted entries or -errno */
+	int submit();
+
+	/** Get the oldest completion entry. Must only be called by the
+	I/O handler thread of the segment.
+	@return completion entry, or nullptr if there is none */
+	io_uring_cqe* peek() const
+	{
+		const unsigned	head = *m_cq_head;
+
+		if (head == __atomic_load_n(m_cq_tail, __ATOMIC_ACQUIRE)) {
+			return(nullptr);
+		}
+
+		return(&m_cqes[head & *m_cq_mask]);
+	}
+
+	/** Release the completion entry returned by peek() to the kernel. */
+	void advance()
+	{
+		__atomic_store_n(m_cq_head, *m_cq_head + 1, __ATOMIC_RELEASE);
+	}
+
+	/** Wait until there is a completion entry or the timeout expires.
+	@param[in]	timeout_ms	timeout in milliseconds
+	@return true if there is a completion entry */
+	bool wait(int timeout_ms) const;
+
+	/** Register buffers for IORING_OP_READ_FIXED and
+	IORING_OP_WRITE_FIXED.
+	@param[in]	iov		buffers
+	@param[in]	n		number of buffers
+	@return 0 on success or -errno */
+	int register_buffers(const iovec* iov, ulint n);
+
+	/** Unregister the buffers that were registered with
+	register_buffers(). */
+	void unregister_buffers();
+
+private:
+	/** The file descriptor of the io_uring instance */
+	int			m_fd;
+
+	/** The submission ring mapping */
+	void*			m_sq_ptr;
+
+	/** Size of the submission ring mapping */
+	size_t			m_sq_size;
+
+	/** The completion ring mapping, can be the same as m_sq_ptr */
+	void*			m_cq_ptr;
+
+	/** Size of the completion ring mapping */
+	size_t			m_cq_size;
+
+	/** The submission entries */
+	io_uring_sqe*		m_sqes;
+
+	/** Size of the submission entries mapping */
+	size_t			m_sqes_size;
+
+	/** Submission ring head, advanced by the kernel */
+	unsigned*		m_sq_head;
+
+	/** Submission ring tail, advanced by us */
+	unsigned*		m_sq_tail;
+
+	/** Submission ring index mask */
+	const unsigned*		m_sq_mask;
+
+	/** Number of submission ring entries */
+	unsigned		m_sq_entries;
+
+	/** Our copy of the submission ring tail */
+	unsigned		m_sq_local_tail;
+
+	/** Completion ring head, advanced by us */
+	unsigned*		m_cq_head;
+
+	/** Completion ring tail, advanced by the kernel */
+	unsigned*		m_cq_tail;
+
+	/** Completion ring index mask */
+	const unsigned*		m_cq_mask;
+
+	/** The completion entries */
+	io_uring_cqe*		m_cqes;
+};
+
+/** Registered buffers, sorted by address. The index of a buffer in the
+vector is the buffer index of the fixed requests that use it. */
+typedef std::vector<iovec, ut_allocator<iovec> > IORegions;
+#endif /* LINUX_IO_URING */
+
 /** The asynchronous i/o array structure */
 class AIO {
 public:
@@ -492,8 +684,11 @@ public:
 #ifdef LINUX_NATIVE_AIO
 	/** Dispatch an AIO request to the kernel.
 	@param[in,out]	slot	an already reserved slot
+	@param[in]	submit	false if the request can be left queued
+				until os_aio_simulated_wake_handler_threads()
+				is called; only used with io_uring
 	@return true on success. */
-	bool linux_dispatch(Slot* slot)
+	bool linux_dispatch(Slot* slot, bool submit)
 		MY_ATTRIBUTE((warn_unused_result));
 
 	/** Accessor for an AIO event
@@ -534,6 +729,44 @@ public:
 		MY_ATTRIBUTE((warn_unused_result));
 #endif /* LINUX_NATIVE_AIO */
 
+#ifdef LINUX_IO_URING
+	/** Accessor for the io_uring instance of a segment
+	@param[in]	segment	Segment for which to get the instance
+	@return the io_uring instance of the segment */
+	IOUring* uring(ulint segment)
+		MY_ATTRIBUTE((warn_unused_result))
+	{
+		ut_ad(segment < get_n_segments());
+
+		return(&m_rings[segment]);
+	}
+
+	/** Queue a request in the submission ring of the segment of the
+	slot. The caller must own the mutex.
+	@param[in,out]	slot	an already reserved slot */
+	void uring_queue(Slot* slot);
+
+	/** Submit the queued requests of a segment.
+	@param[in]	segment	local segment */
+	void uring_submit(ulint segment);
+
+	/** Submit the queued requests of all the segments. */
+	void uring_submit();
+
+	/** Submit the queued requests of all the AIO arrays. */
+	static void uring_submit_all();
+
+	/** Register buffers with all the io_uring instances of all the AIO
+	arrays.
+	@param[in]	regions	buffers, sorted by address */
+	static void uring_register_buffers_all(const IORegions& regions);
+
+	/** Checks if the kernel supports io_uring.
+	@return true if supported, false otherwise. */
+	static bool is_io_uring_supported()
+		MY_ATTRIBUTE((warn_unused_result));
+#endif /* LINUX_IO_URING */
+
 #ifdef WIN_ASYNC_IO
 	/** Wakes up all async i/o threads in the array in Windows async I/O at
 	shutdown. */
@@ -727,6 +960,25 @@ private:
 		MY_ATTRIBUTE((warn_unused_result));
 #endif /* LINUX_NATIVE_AIO */
 
+#ifdef LINUX_IO_URING
+	/** Initialise one io_uring instance per segment
+	@return DB_SUCCESS or error code */
+	dberr_t init_io_uring()
+		MY_ATTRIBUTE((warn_unused_result));
+
+	/** Register buffers with the io_uring instances of this array.
+	@param[in]	regions	buffers, sorted by address */
+	void uring_register_buffers(const IORegions& regions);
+
+	/** Find the registered buffer that contains a memory range.
+	The caller must own the mutex.
+	@param[in]	ptr	start of the range
+	@param[in]	len	length of the range
+	@return index of the registered buffer, or ULINT_UNDEFINED */
+	ulint uring_buffer_index(const byte* ptr, ulint len) const
+		MY_ATTRIBUTE((warn_unused_result));
+#endif /* LINUX_IO_URING */
+
 private:
 	typedef std::vector<Slot> Slots;
 
@@ -775,6 +1027,16 @@ private:
 	IOEvents		m_events;
 #endif /* LINUX_NATIV_AIO */
 
+#ifdef LINUX_IO_URING
+	/** io_uring instances if srv_use_io_uring, one per segment.
+	Each thread will work on one instance exclusively. */
+	IOUring*		m_rings;
+
+	/** The buffers registered with every instance in m_rings,
+	protected by m_mutex */
+	IORegions		m_uring_regions;
+#endif /* LINUX_IO_URING */
+
 	/** The aio arrays for non-ibuf i/o and ibuf i/o, as well as
 	sync AIO. These are NULL when the module has not yet been
 	initialized. */
@@ -806,6 +1068,14 @@ AIO*	AIO::s_sync;
 /** timeout for each io_getevents() call = 500ms. */
 static const ulint	OS_AIO_REAP_TIMEOUT = 500000000UL;
 
+# ifdef LINUX_IO_URING
+/** timeout for each wait for io_uring completions, in milliseconds */
+static const int	OS_AIO_URING_REAP_TIMEOUT_MS = 500;
+
+/** largest buffer that can be registered with io_uring */
+static const ulint	OS_AIO_URING_MAX_BUFFER_SIZE = 1UL << 30;
+# endif /* LINUX_IO_URING */
+
 /** time to sleep, in microseconds if io_setup() returns EAGAIN. */
 static const ulint	OS_AIO_IO_SETUP_RETRY_SLEEP = 500000UL;
 
@@ -1492,6 +1762,22 @@ os_file_compress_page(
 
 		break;
 
+	case Compression::ZSTD:
+
+		len = Compression::zstd_compress(
+			compression.m_dict, srv_compression_zstd_level,
+			src + FIL_PAGE_DATA, content_len,
+			dst + FIL_PAGE_DATA, out_len);
+
+		if (len == 0) {
+
+			*dst_len = src_len;
+
+			return(src);
+		}
+
+		break;
+
 	default:
 		*dst_len = src_len;
 		return(src);
@@ -1808,7 +2094,8 @@ os_file_io_complete(
 		if (ret == DB_SUCCESS) {
 			return(os_file_decompress_page(
 					type.is_dblwr_recover(),
-					buf, scratch, len));
+					buf, scratch, len,
+					type.compression_algorithm().m_dict));
 		} else {
 			return(ret);
 		}
@@ -2691,44 +2978,567 @@ LinuxAIOHandler::collect()
 			m_array->release();
 		}
 
-		if (srv_shutdown_state == SRV_SHUTDOWN_EXIT_THREADS
-		    || !buf_page_cleaner_is_active
-		    || ret > 0) {
+		if (srv_shutdown_state == SRV_SHUTDOWN_EXIT_THREADS
+		    || !buf_page_cleaner_is_active
+		    || ret > 0) {
+
+			break;
+		}
+
+		/* This error handling is for any error in collecting the
+		IO requests. The errors, if any, for any particular IO
+		request are simply passed on to the calling routine. */
+
+		switch (ret) {
+		case -EAGAIN:
+			/* Not enough resources! Try again. */
+
+		case -EINTR:
+			/* Interrupted! The behaviour in case of an interrupt.
+			If we have some completed IOs available then the
+			return code will be the number of IOs. We get EINTR
+			only if there are no completed IOs and we have been
+			interrupted. */
+
+		case 0:
+			/* No pending request! Go back and check again. */
+
+			continue;
+		}
+
+		/* All other errors should cause a trap for now. */
+		ib::fatal()
+			<< "Unexpected ret_code[" << ret
+			<< "] from io_getevents()!";
+
+		break;
+	}
+}
+
+/** Process a Linux AIO request
+@param[out]	m1		the messages passed with the
+@param[out]	m2		AIO request; note that in case the
+				AIO operation failed, these output
+				parameters are valid and can be used to
+				restart the operation.
+@param[out]	request		IO context
+@return DB_SUCCESS or error code */
+dberr_t
+LinuxAIOHandler::poll(fil_node_t** m1, void** m2, IORequest* request)
+{
+	dberr_t		err;
+	Slot*		slot;
+
+	/* Loop until we have found a completed request. */
+	for (;;) {
+
+		ulint	n_pending;
+
+		slot = find_completed_slot(&n_pending);
+
+		if (slot != NULL) {
+
+			ut_ad(m_array->is_mutex_owned());
+
+			err = check_state(slot);
+
+			/* DB_FAIL is not a hard error, we should retry */
+			if (err != DB_FAIL) {
+				break;
+			}
+
+			/* Partial IO, resubmit request for
+			remaining bytes to read/write */
+			err = resubmit(slot);
+
+			if (err != DB_SUCCESS) {
+				break;
+			}
+
+			m_array->release();
+
+		} else if (is_shutdown() && n_pending == 0) {
+
+			/* There is no completed request. If there is
+			no pending request at all, and the system is
+			being shut down, exit. */
+
+			*m1 = NULL;
+			*m2 = NULL;
+
+			return(DB_SUCCESS);
+
+		} else {
+
+			/* Wait for some request. Note that we return
+			from wait if we have found a request. */
+
+			srv_set_io_thread_op_info(
+				m_global_segment,
+				"waiting for completed aio requests");
+
+			collect();
+		}
+	}
+
+	if (err == DB_IO_PARTIAL_FAILED) {
+		/* Aborting in case of submit failure */
+		ib::fatal()
+			<< "Native Linux AIO interface. "
+			"io_submit() call failed when "
+			"resubmitting a partial I/O "
+			"request on the file " << slot->name
+			<< ".";
+	}
+
+	*m1 = slot->m1;
+	*m2 = slot->m2;
+
+	*request = slot->type;
+
+	m_array->release(slot);
+
+	m_array->release();
+
+	return(err);
+}
+
+#ifdef LINUX_IO_URING
+/** Create an io_uring instance.
+@param[in]	entries		number of submission entries
+@param[in,out]	params		parameters of the instance
+@return file descriptor or -1 with errno set */
+static
+int
+os_io_uring_setup(unsigned entries, io_uring_params* params)
+{
+	return(static_cast<int>(syscall(__NR_io_uring_setup, entries, params)));
+}
+
+/** Submit requests to an io_uring instance and/or wait for completions.
+@param[in]	fd		file descriptor of the instance
+@param[in]	to_submit	number of entries to submit
+@param[in]	min_complete	number of completions to wait for
+@param[in]	flags		IORING_ENTER_ flags
+@return number of submitted entries or -1 with errno set */
+static
+int
+os_io_uring_enter(
+	int		fd,
+	unsigned	to_submit,
+	unsigned	min_complete,
+	unsigned	flags)
+{
+	return(static_cast<int>(syscall(
+		__NR_io_uring_enter, fd, to_submit, min_complete, flags,
+		NULL, 0)));
+}
+
+/** Register resources with an io_uring instance.
+@param[in]	fd		file descriptor of the instance
+@param[in]	opcode		IORING_REGISTER_ opcode
+@param[in]	arg		resources to register
+@param[in]	n_args		number of resources
+@return 0 or -1 with errno set */
+static
+int
+os_io_uring_register(int fd, unsigned opcode, const void* arg, unsigned n_args)
+{
+	return(static_cast<int>(syscall(
+		__NR_io_uring_register, fd, opcode, arg, n_args)));
+}
+
+/** Create the rings and map them into our address space.
+@param[in]	entries		minimum number of submission entries
+@return 0 on success or -errno */
+int
+IOUring::create(ulint entries)
+{
+	ut_a(m_fd == -1);
+
+	io_uring_params	params;
+
+	memset(&params, 0x0, sizeof(params));
+
+	m_fd = os_io_uring_setup(static_cast<unsigned>(entries), &params);
+
+	if (m_fd == -1) {
+		return(-errno);
+	}
+
+	m_sq_size = params.sq_off.array
+		+ params.sq_entries * sizeof(unsigned);
+
+	m_cq_size = params.cq_off.cqes
+		+ params.cq_entries * sizeof(io_uring_cqe);
+
+	bool	single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP);
+
+	if (single_mmap) {
+		m_sq_size = m_cq_size = std::max(m_sq_size, m_cq_size);
+	}
+
+	m_sq_ptr = mmap(
+		NULL, m_sq_size, PROT_READ | PROT_WRITE,
+		MAP_SHARED | MAP_POPULATE, m_fd, IORING_OFF_SQ_RING);
+
+	if (m_sq_ptr == MAP_FAILED) {
+		int	err = errno;
+
+		destroy();
+
+		return(-err);
+	}
+
+	if (single_mmap) {
+		m_cq_ptr = m_sq_ptr;
+	} else {
+		m_cq_ptr = mmap(
+			NULL, m_cq_size, PROT_READ | PROT_WRITE,
+			MAP_SHARED | MAP_POPULATE, m_fd, IORING_OFF_CQ_RING);
+
+		if (m_cq_ptr == MAP_FAILED) {
+			int	err = errno;
+
+			destroy();
+
+			return(-err);
+		}
+	}
+
+	m_sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+
+	m_sqes = static_cast<io_uring_sqe*>(mmap(
+		NULL, m_sqes_size, PROT_READ | PROT_WRITE,
+		MAP_SHARED | MAP_POPULATE, m_fd, IORING_OFF_SQES));
+
+	if (m_sqes == MAP_FAILED) {
+		int	err = errno;
+
+		destroy();
+
+		return(-err);
+	}
+
+	byte*	sq = static_cast<byte*>(m_sq_ptr);
+
+	m_sq_head = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+	m_sq_tail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+	m_sq_mask = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+	m_sq_entries = params.sq_entries;
+	m_sq_local_tail = *m_sq_tail;
+
+	/* Submission entry i is always at position i of the indirection
+	array, get_sqe() hands out the entries in ring order. */
+	unsigned*	array = reinterpret_cast<unsigned*>(
+		sq + params.sq_off.array);
+
+	for (unsigned i = 0; i < m_sq_entries; ++i) {
+		array[i] = i;
+	}
+
+	byte*	cq = static_cast<byte*>(m_cq_ptr);
+
+	m_cq_head = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+	m_cq_tail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+	m_cq_mask = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+	m_cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+	return(0);
+}
+
+/** Unmap the rings and close the file descriptor. This also drops
+the registered buffers. */
+void
+IOUring::destroy()
+{
+	if (m_sqes != MAP_FAILED) {
+		munmap(m_sqes, m_sqes_size);
+		m_sqes = static_cast<io_uring_sqe*>(MAP_FAILED);
+	}
+
+	if (m_cq_ptr != MAP_FAILED && m_cq_ptr != m_sq_ptr) {
+		munmap(m_cq_ptr, m_cq_size);
+	}
+
+	m_cq_ptr = MAP_FAILED;
+
+	if (m_sq_ptr != MAP_FAILED) {
+		munmap(m_sq_ptr, m_sq_size);
+		m_sq_ptr = MAP_FAILED;
+	}
+
+	if (m_fd != -1) {
+		close(m_fd);
+		m_fd = -1;
+	}
+}
+
+/** Submit all the published entries that the kernel has not
+consumed yet. This can be called without holding the array mutex.
+@return number of submitted entries or -errno */
+int
+IOUring::submit()
+{
+	for (;;) {
+		unsigned	to_submit
+			= __atomic_load_n(m_sq_tail, __ATOMIC_ACQUIRE)
+			- __atomic_load_n(m_sq_head, __ATOMIC_ACQUIRE);
+
+		if (to_submit == 0) {
+			return(0);
+		}
+
+		/* If another thread submits concurrently, the kernel
+		only consumes the entries that are still pending. */
+		int	ret = os_io_uring_enter(m_fd, to_submit, 0, 0);
+
+		if (ret >= 0) {
+			return(ret);
+		} else if (errno != EINTR) {
+			return(-errno);
+		}
+	}
+}
+
+/** Wait until there is a completion entry or the timeout expires.
+@param[in]	timeout_ms	timeout in milliseconds
+@return true if there is a completion entry */
+bool
+IOUring::wait(int timeout_ms) const
+{
+	if (peek() != nullptr) {
+		return(true);
+	}
+
+	struct pollfd	pfd;
+
+	pfd.fd = m_fd;
+	pfd.events = POLLIN;
+	pfd.revents = 0;
+
+	return(::poll(&pfd, 1, timeout_ms) > 0);
+}
+
+/** Register buffers for IORING_OP_READ_FIXED and IORING_OP_WRITE_FIXED.
+@param[in]	iov		buffers
+@param[in]	n		number of buffers
+@return 0 on success or -errno */
+int
+IOUring::register_buffers(const iovec* iov, ulint n)
+{
+	int	ret = os_io_uring_register(
+		m_fd, IORING_REGISTER_BUFFERS, iov, static_cast<unsigned>(n));
+
+	return(ret == -1 ? -errno : 0);
+}
+
+/** Unregister the buffers that were registered with register_buffers(). */
+void
+IOUring::unregister_buffers()
+{
+	os_io_uring_register(m_fd, IORING_UNREGISTER_BUFFERS, NULL, 0);
+}
+
+/** Linux io_uring handler */
+class UringAIOHandler {
+public:
+	/**
+	@param[in] global_segment	The global segment*/
+	UringAIOHandler(ulint global_segment)
+		:
+		m_global_segment(global_segment)
+	{
+		/* Should never be doing Sync IO here. */
+		ut_a(m_global_segment != ULINT_UNDEFINED);
+
+		/* Find the array and the local segment. */
+
+		m_segment = AIO::get_array_and_local_segment(
+			&m_array, m_global_segment);
+
+		m_n_slots = m_array->slots_per_segment();
+
+		m_ring = m_array->uring(m_segment);
+	}
+
+	/**
+	Process an io_uring request
+	@param[out]	m1		the messages passed with the
+	@param[out]	m2		AIO request; note that in case the
+					AIO operation failed, these output
+					parameters are valid and can be used to
+					restart the operation.
+	@param[out]	request		IO context
+	@return DB_SUCCESS or error code */
+	dberr_t poll(fil_node_t** m1, void** m2, IORequest* request);
+
+private:
+	/** Take the oldest completion entry from the completion ring and
+	mark its slot as done. The completion ring is only consumed by this
+	thread, therefore the array mutex is not needed for that.
+	@return NULL or a slot that has completed IO, if a slot is returned
+	then the m_array->m_mutex is owned by the caller */
+	Slot* reap();
+
+	/** Check if the IO succeeded
+	@param[in,out]	slot		The slot to check
+	@return DB_SUCCESS, DB_FAIL if the operation should be retried or
+		DB_IO_ERROR on all other errors */
+	dberr_t	check_state(Slot* slot);
+
+	/** Queue the remainder of an IO request that was only partially
+	successful. The caller must own the mutex.
+	@param[in,out]	slot		Request to resubmit */
+	void resubmit(Slot* slot);
+
+	/** @return the number of pending IO requests in the segment */
+	ulint pending() const;
+
+	/** @return true if a shutdown was detected */
+	bool is_shutdown() const
+	{
+		return(srv_shutdown_state == SRV_SHUTDOWN_EXIT_THREADS
+		       && !buf_page_cleaner_is_active);
+	}
+
+private:
+	/** Slot array */
+	AIO*			m_array;
+
+	/** io_uring instance of the local segment */
+	IOUring*		m_ring;
+
+	/** Number of slots in the local segment */
+	ulint			m_n_slots;
+
+	/** The local segment to check */
+	ulint			m_segment;
+
+	/** The global segment */
+	ulint			m_global_segment;
+};
+
+/** Take the oldest completion entry from the completion ring and mark its
+slot as done.
+@return NULL or a slot that has completed IO, if a slot is returned then
+the m_array->m_mutex is owned by the caller */
+Slot*
+UringAIOHandler::reap()
+{
+	io_uring_cqe*	cqe = m_ring->peek();
+
+	if (cqe == nullptr) {
+		return(NULL);
+	}
+
+	Slot*	slot = reinterpret_cast<Slot*>(cqe->user_data);
+	int	res = cqe->res;
+
+	m_ring->advance();
+
+	/* Some sanity checks. */
+	ut_a(slot != NULL);
+	ut_a(slot->is_reserved);
+	ut_a(slot->pos >= m_segment * m_n_slots);
+	ut_a(slot->pos < (m_segment + 1) * m_n_slots);
+
+	/* We never compress/decompress the first page */
+
+	if (res >= 0
+	    && slot->offset > 0
+	    && !slot->skip_punch_hole
+	    && slot->type.is_compression_enabled()
+	    && !slot->type.is_log()
+	    && slot->type.is_write()
+	    && slot->type.is_compressed()
+	    && slot->type.punch_hole()) {
+
+		slot->err = AIOHandler::io_complete(slot);
+	} else {
+		slot->err = DB_SUCCESS;
+	}
+
+	/* Mark this request as completed. The error handling
+	will be done in the calling function. */
+	m_array->acquire();
+
+	slot->ret = res < 0 ? res : 0;
+	slot->n_bytes = res < 0 ? 0 : res;
+	slot->io_already_done = true;
+
+	return(slot);
+}
+
+/** Check if the IO succeeded
+@param[in,out]	slot		The slot to check
+@return DB_SUCCESS, DB_FAIL if the operation should be retried or
+	DB_IO_ERROR on all other errors */
+dberr_t
+UringAIOHandler::check_state(Slot* slot)
+{
+	ut_ad(m_array->is_mutex_owned());
+	ut_ad(slot->io_already_done);
+
+	srv_set_io_thread_op_info(
+		m_global_segment, "processing completed aio requests");
+
+	if (slot->ret == 0) {
+		return(AIOHandler::post_io_processing(slot));
+	}
+
+	errno = -slot->ret;
+
+	/* As with libaio, requests are not retried when reaped by a
+	thread other than the dispatcher. */
+	os_file_handle_error(slot->name, "io_uring");
+
+	return(DB_IO_ERROR);
+}
+
+/** Queue the remainder of an IO request that was only partially
+successful. The caller must own the mutex.
+@param[in,out]	slot		Request to resubmit */
+void
+UringAIOHandler::resubmit(Slot* slot)
+{
+	ut_ad(m_array->is_mutex_owned());
+	ut_ad(static_cast<ulint>(slot->n_bytes) < slot->len);
+
+	slot->len -= slot->n_bytes;
+	slot->ptr += slot->n_bytes;
+	slot->offset += slot->n_bytes;
+
+	/* Resetting the bytes read/written */
+	slot->n_bytes = 0;
+	slot->io_already_done = false;
 
-			break;
-		}
+	m_array->uring_queue(slot);
+}
 
-		/* This error handling is for any error in collecting the
-		IO requests. The errors, if any, for any particular IO
-		request are simply passed on to the calling routine. */
+/** @return the number of pending IO requests in the segment */
+ulint
+UringAIOHandler::pending() const
+{
+	ulint	n_pending = 0;
 
-		switch (ret) {
-		case -EAGAIN:
-			/* Not enough resources! Try again. */
+	m_array->acquire();
 
-		case -EINTR:
-			/* Interrupted! The behaviour in case of an interrupt.
-			If we have some completed IOs available then the
-			return code will be the number of IOs. We get EINTR
-			only if there are no completed IOs and we have been
-			interrupted. */
+	const Slot*	slot = m_array->at(m_segment * m_n_slots);
 
-		case 0:
-			/* No pending request! Go back and check again. */
+	for (ulint i = 0; i < m_n_slots; ++i, ++slot) {
 
-			continue;
+		if (slot->is_reserved) {
+			++n_pending;
 		}
+	}
 
-		/* All other errors should cause a trap for now. */
-		ib::fatal()
-			<< "Unexpected ret_code[" << ret
-			<< "] from io_getevents()!";
+	m_array->release();
 
-		break;
-	}
+	return(n_pending);
 }
 
-/** Process a Linux AIO request
+/** Process an io_uring request
 @param[out]	m1		the messages passed with the
 @param[out]	m2		AIO request; note that in case the
 				AIO operation failed, these output
@@ -2737,7 +3547,7 @@ LinuxAIOHandler::collect()
 @param[out]	request		IO context
 @return DB_SUCCESS or error code */
 dberr_t
-LinuxAIOHandler::poll(fil_node_t** m1, void** m2, IORequest* request)
+UringAIOHandler::poll(fil_node_t** m1, void** m2, IORequest* request)
 {
 	dberr_t		err;
 	Slot*		slot;
@@ -2745,9 +3555,7 @@ LinuxAIOHandler::poll(fil_node_t** m1, void** m2, IORequest* request)
 	/* Loop until we have found a completed request. */
 	for (;;) {
 
-		ulint	n_pending;
-
-		slot = find_completed_slot(&n_pending);
+		slot = reap();
 
 		if (slot != NULL) {
 
@@ -2762,15 +3570,13 @@ LinuxAIOHandler::poll(fil_node_t** m1, void** m2, IORequest* request)
 
 			/* Partial IO, resubmit request for
 			remaining bytes to read/write */
-			err = resubmit(slot);
-
-			if (err != DB_SUCCESS) {
-				break;
-			}
+			resubmit(slot);
 
 			m_array->release();
 
-		} else if (is_shutdown() && n_pending == 0) {
+			m_array->uring_submit(m_segment);
+
+		} else if (is_shutdown() && pending() == 0) {
 
 			/* There is no completed request. If there is
 			no pending request at all, and the system is
@@ -2783,25 +3589,16 @@ LinuxAIOHandler::poll(fil_node_t** m1, void** m2, IORequest* request)
 
 		} else {
 
-			/* Wait for some request. Note that we return
-			from wait if we have found a request. */
-
 			srv_set_io_thread_op_info(
 				m_global_segment,
 				"waiting for completed aio requests");
 
-			collect();
-		}
-	}
+			/* Submit requests that were queued without a
+			wake up, in case nobody else does it. */
+			m_array->uring_submit(m_segment);
 
-	if (err == DB_IO_PARTIAL_FAILED) {
-		/* Aborting in case of submit failure */
-		ib::fatal()
-			<< "Native Linux AIO interface. "
-			"io_submit() call failed when "
-			"resubmitting a partial I/O "
-			"request on the file " << slot->name
-			<< ".";
+			m_ring->wait(OS_AIO_URING_REAP_TIMEOUT_MS);
+		}
 	}
 
 	*m1 = slot->m1;
@@ -2815,6 +3612,7 @@ LinuxAIOHandler::poll(fil_node_t** m1, void** m2, IORequest* request)
 
 	return(err);
 }
+#endif /* LINUX_IO_URING */
 
 /** This function is only used in Linux native asynchronous i/o.
 Waits for an aio operation to complete. This function is used to wait for
@@ -2844,9 +3642,20 @@ os_aio_linux_handler(
 	void**		m2,
 	IORequest*	request)
 {
-	LinuxAIOHandler	handler(global_segment);
+	dberr_t	err;
+
+#ifdef LINUX_IO_URING
+	if (srv_use_io_uring) {
+		UringAIOHandler	handler(global_segment);
 
-	dberr_t	err = handler.poll(m1, m2, request);
+		err = handler.poll(m1, m2, request);
+	} else
+#endif /* LINUX_IO_URING */
+	{
+		LinuxAIOHandler	handler(global_segment);
+
+		err = handler.poll(m1, m2, request);
+	}
 
 	if (err == DB_IO_NO_PUNCH_HOLE) {
 		fil_no_punch_hole(*m1);
@@ -2858,13 +3667,39 @@ os_aio_linux_handler(
 
 /** Dispatch an AIO request to the kernel.
 @param[in,out]	slot		an already reserved slot
+@param[in]	submit		false if the request can be left queued
+				until os_aio_simulated_wake_handler_threads()
+				is called; only used with io_uring
 @return true on success. */
 bool
-AIO::linux_dispatch(Slot* slot)
+AIO::linux_dispatch(Slot* slot, bool submit)
 {
 	ut_a(slot->is_reserved);
 	ut_ad(slot->type.validate());
 
+#ifdef LINUX_IO_URING
+	if (srv_use_io_uring) {
+		ulint	segment = (slot->pos * m_n_segments) / m_slots.size();
+
+		acquire();
+
+		uring_queue(slot);
+
+		release();
+
+		/* Errors are not reported to the caller because the request
+		is queued already, the I/O handler thread retries the
+		submission. */
+		if (submit) {
+			uring_submit(segment);
+		}
+
+		return(true);
+	}
+#else
+	UT_NOT_USED(submit);
+#endif /* LINUX_IO_URING */
+
 	/* Find out what we are going to work with.
 	The iocb struct is directly in the slot.
 	The io_context is one per segment. */
@@ -3091,6 +3926,274 @@ AIO::is_linux_native_aio_supported()
 	return(false);
 }
 
+#ifdef LINUX_IO_URING
+/** Find the registered buffer that contains a memory range. The caller
+must own the mutex.
+@param[in]	ptr	start of the range
+@param[in]	len	length of the range
+@return index of the registered buffer, or ULINT_UNDEFINED */
+ulint
+AIO::uring_buffer_index(const byte* ptr, ulint len) const
+{
+	ut_ad(is_mutex_owned());
+
+	/* Find the last region that starts at or before ptr. */
+	ulint	lo = 0;
+	ulint	hi = m_uring_regions.size();
+
+	while (lo < hi) {
+		ulint	mid = lo + (hi - lo) / 2;
+
+		if (static_cast<const byte*>(m_uring_regions[mid].iov_base)
+		    <= ptr) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+
+	if (lo == 0) {
+		return(ULINT_UNDEFINED);
+	}
+
+	const iovec&	region = m_uring_regions[lo - 1];
+	const byte*	start = static_cast<const byte*>(region.iov_base);
+
+	if (ptr + len > start + region.iov_len) {
+		return(ULINT_UNDEFINED);
+	}
+
+	return(lo - 1);
+}
+
+/** Queue a request in the submission ring of the segment of the slot.
+The caller must own the mutex.
+@param[in,out]	slot	an already reserved slot */
+void
+AIO::uring_queue(Slot* slot)
+{
+	ut_ad(is_mutex_owned());
+	ut_a(slot->is_reserved);
+
+	IOUring*	ring = uring((slot->pos * m_n_segments) / m_slots.size());
+
+	/* A slot has at most one request in the ring and the ring has at
+	least as many entries as there are slots in a segment. */
+	io_uring_sqe*	sqe = ring->get_sqe();
+
+	ut_a(sqe != nullptr);
+
+	memset(sqe, 0x0, sizeof(*sqe));
+
+	ulint	index = uring_buffer_index(slot->ptr, slot->len);
+
+	if (index != ULINT_UNDEFINED) {
+		sqe->opcode = slot->type.is_read()
+			? IORING_OP_READ_FIXED : IORING_OP_WRITE_FIXED;
+		sqe->addr = reinterpret_cast<uintptr_t>(slot->ptr);
+		sqe->len = static_cast<uint32_t>(slot->len);
+		sqe->buf_index = static_cast<uint16_t>(index);
+	} else {
+		slot->iov.iov_base = slot->ptr;
+		slot->iov.iov_len = slot->len;
+
+		sqe->opcode = slot->type.is_read()
+			? IORING_OP_READV : IORING_OP_WRITEV;
+		sqe->addr = reinterpret_cast<uintptr_t>(&slot->iov);
+		sqe->len = 1;
+	}
+
+	sqe->fd = slot->file.m_file;
+	sqe->off = slot->offset;
+	sqe->user_data = reinterpret_cast<uintptr_t>(slot);
+
+	ring->commit();
+}
+
+/** Submit the queued requests of a segment.
+@param[in]	segment	local segment */
+void
+AIO::uring_submit(ulint segment)
+{
+	int	ret = uring(segment)->submit();
+
+	switch (ret) {
+	case -EAGAIN:
+	case -EBUSY:
+		/* Not enough resources! The requests stay queued and the
+		I/O handler thread submits them on its next wake up. */
+		return;
+	}
+
+	if (ret < 0) {
+		ib::fatal()
+			<< "Unexpected ret_code[" << -ret
+			<< "] from io_uring_enter()!";
+	}
+}
+
+/** Submit the queued requests of all the segments. */
+void
+AIO::uring_submit()
+{
+	for (ulint i = 0; i < m_n_segments; ++i) {
+		uring_submit(i);
+	}
+}
+
+/** Submit the queued requests of all the AIO arrays. */
+void
+AIO::uring_submit_all()
+{
+	AIO*	arrays[] = { s_reads, s_writes, s_ibuf, s_log, s_sync };
+
+	for (ulint i = 0; i < UT_ARR_SIZE(arrays); ++i) {
+
+		if (arrays[i] != NULL) {
+			arrays[i]->uring_submit();
+		}
+	}
+}
+
+/** Register buffers with the io_uring instances of this array.
+@param[in]	regions	buffers, sorted by address */
+void
+AIO::uring_register_buffers(const IORegions& regions)
+{
+	acquire();
+
+	/* Queued requests may refer to the current registration. */
+	uring_submit();
+
+	if (!m_uring_regions.empty()) {
+
+		for (ulint i = 0; i < m_n_segments; ++i) {
+			m_rings[i].unregister_buffers();
+		}
+
+		m_uring_regions.clear();
+	}
+
+	if (!regions.empty()) {
+		int	ret = 0;
+		ulint	n_registered = 0;
+
+		while (n_registered < m_n_segments) {
+
+			ret = m_rings[n_registered].register_buffers(
+				&regions[0], regions.size());
+
+			if (ret != 0) {
+				break;
+			}
+
+			++n_registered;
+		}
+
+		if (ret == 0) {
+			m_uring_regions = regions;
+		} else {
+			/* Usually RLIMIT_MEMLOCK is too small. The
+			requests fall back to unregistered buffers. */
+			ib::warn()
+				<< "io_uring buffer registration failed"
+				" with error[" << -ret << "]. Buffer pool"
+				" pages will be read and written without"
+				" registered buffers.";
+
+			for (ulint i = 0; i < n_registered; ++i) {
+				m_rings[i].unregister_buffers();
+			}
+		}
+	}
+
+	release();
+}
+
+/** Register buffers with all the io_uring instances of the arrays that
+do buffer pool page I/O.
+@param[in]	regions	buffers, sorted by address */
+void
+AIO::uring_register_buffers_all(const IORegions& regions)
+{
+	AIO*	arrays[] = { s_reads, s_writes, s_ibuf };
+
+	for (ulint i = 0; i < UT_ARR_SIZE(arrays); ++i) {
+
+		if (arrays[i] != NULL) {
+			arrays[i]->uring_register_buffers(regions);
+		}
+	}
+}
+
+/** Initialise one io_uring instance per segment
+@return DB_SUCCESS or error code */
+dberr_t
+AIO::init_io_uring()
+{
+	ut_a(m_rings == NULL);
+
+	m_rings = UT_NEW_ARRAY_NOKEY(IOUring, m_n_segments);
+
+	if (m_rings == NULL) {
+		return(DB_OUT_OF_MEMORY);
+	}
+
+	for (ulint i = 0; i < m_n_segments; ++i) {
+
+		int	ret = m_rings[i].create(slots_per_segment());
+
+		if (ret != 0) {
+			ib::error()
+				<< "io_uring_setup() returned following"
+				" error[" << -ret << "]";
+
+			return(DB_IO_ERROR);
+		}
+	}
+
+	return(DB_SUCCESS);
+}
+
+/** Checks if the kernel supports io_uring. This is called after
+is_linux_native_aio_supported() has checked the file system.
+@return true if supported, false otherwise. */
+bool
+AIO::is_io_uring_supported()
+{
+	IOUring	ring;
+
+	int	ret = ring.create(1);
+
+	if (ret == 0) {
+		io_uring_sqe*	sqe = ring.get_sqe();
+
+		memset(sqe, 0x0, sizeof(*sqe));
+
+		sqe->opcode = IORING_OP_NOP;
+
+		ring.commit();
+
+		ret = ring.submit();
+
+		if (ret == 1) {
+			ring.wait(-1);
+
+			ret = ring.peek()->res;
+		} else if (ret >= 0) {
+			ret = -EIO;
+		}
+	}
+
+	if (ret != 0) {
+		ib::warn()
+			<< "io_uring check returned error[" << -ret << "]";
+	}
+
+	return(ret == 0);
+}
+#endif /* LINUX_IO_URING */
+
 #endif /* LINUX_NATIVE_AIO */
 
 /** Retrieves the last error number if an error occurs in a file io function.
@@ -6686,6 +7789,9 @@ AIO::AIO(
 # ifdef LINUX_NATIVE_AIO
 	,m_aio_ctx(),
 	m_events(m_slots.size())
+#  ifdef LINUX_IO_URING
+	,m_rings()
+#  endif /* LINUX_IO_URING */
 # elif defined(_WIN32)
 	,m_handles()
 # endif /* LINUX_NATIVE_AIO */
@@ -6792,7 +7898,16 @@ AIO::init()
 
 	if (srv_use_native_aio) {
 #ifdef LINUX_NATIVE_AIO
-		dberr_t	err = init_linux_native_aio();
+		dberr_t	err;
+
+# ifdef LINUX_IO_URING
+		if (srv_use_io_uring) {
+			err = init_io_uring();
+		} else
+# endif /* LINUX_IO_URING */
+		{
+			err = init_linux_native_aio();
+		}
 
 		if (err != DB_SUCCESS) {
 			return(err);
@@ -6864,6 +7979,12 @@ AIO::~AIO()
 	}
 #endif /* LINUX_NATIVE_AIO */
 
+#ifdef LINUX_IO_URING
+	if (m_rings != NULL) {
+		UT_DELETE_ARRAY(m_rings);
+	}
+#endif /* LINUX_IO_URING */
+
 	m_slots.clear();
 }
 
@@ -6896,6 +8017,21 @@ AIO::start(
 	}
 #endif /* LINUX_NATIVE_AIO */
 
+#ifdef LINUX_IO_URING
+	if (srv_use_io_uring
+	    && (!srv_use_native_aio || !is_io_uring_supported())) {
+
+		ib::warn() << "io_uring disabled, falling back to"
+			" Linux Native AIO.";
+
+		srv_use_io_uring = FALSE;
+	}
+
+	if (srv_use_io_uring) {
+		ib::info() << "Using io_uring for Linux Native AIO";
+	}
+#endif /* LINUX_IO_URING */
+
 	srv_reset_io_thread_op_info();
 
 	s_reads = create(
@@ -7179,6 +8315,62 @@ os_aio_free()
 	block_cache = NULL;
 }
 
+#ifdef LINUX_IO_URING
+/** Compare two memory regions by address.
+@param[in]	lhs	first region
+@param[in]	rhs	second region
+@return true if lhs starts before rhs */
+static
+bool
+os_aio_region_less(const iovec& lhs, const iovec& rhs)
+{
+	return(lhs.iov_base < rhs.iov_base);
+}
+#endif /* LINUX_IO_URING */
+
+/** Register the memory regions that are used as I/O buffers with the
+native AIO backend. Any previously registered regions are unregistered.
+@param[in]	regions		memory regions, or nullptr
+@param[in]	n_regions	number of regions, 0 to only unregister */
+void
+os_aio_register_buffers(const os_aio_region_t* regions, ulint n_regions)
+{
+#ifdef LINUX_IO_URING
+	if (!srv_use_native_aio || !srv_use_io_uring) {
+		return;
+	}
+
+	IORegions	iov;
+
+	for (ulint i = 0; i < n_regions; ++i) {
+
+		/* The kernel limits the size of a registered buffer. */
+		if (regions[i].len > OS_AIO_URING_MAX_BUFFER_SIZE) {
+			continue;
+		}
+
+		iovec	region;
+
+		region.iov_base = regions[i].ptr;
+		region.iov_len = regions[i].len;
+
+		iov.push_back(region);
+	}
+
+	/* The buffer index of a request is 16 bits. */
+	if (iov.size() > UINT16_MAX) {
+		iov.clear();
+	}
+
+	std::sort(iov.begin(), iov.end(), os_aio_region_less);
+
+	AIO::uring_register_buffers_all(iov);
+#else
+	UT_NOT_USED(regions);
+	UT_NOT_USED(n_regions);
+#endif /* LINUX_IO_URING */
+}
+
 /** Wakes up all async i/o threads so that they know to exit themselves in
 shutdown. */
 void
@@ -7319,6 +8511,14 @@ AIO::reserve_slot(
 
 			os_aio_simulated_wake_handler_threads();
 		}
+#ifdef LINUX_IO_URING
+		else if (srv_use_io_uring) {
+			/* Submit the queued requests so that
+			we get more slots */
+
+			uring_submit();
+		}
+#endif /* LINUX_IO_URING */
 
 		os_event_wait(m_not_full);
 	}
@@ -7571,6 +8771,14 @@ void
 os_aio_simulated_wake_handler_threads()
 {
 	if (srv_use_native_aio) {
+#ifdef LINUX_IO_URING
+		if (srv_use_io_uring) {
+			/* Submit the requests that were queued with
+			IORequest::DO_NOT_WAKE. */
+			AIO::uring_submit_all();
+		}
+#endif /* LINUX_IO_URING */
+
 		/* We do not use simulated aio: do nothing */
 
 		return;
@@ -7895,7 +9103,7 @@ try_again:
 				file.m_file, slot->ptr, slot->len,
 				&slot->n_bytes, &slot->control);
 #elif defined(LINUX_NATIVE_AIO)
-			if (!array->linux_dispatch(slot)) {
+			if (!array->linux_dispatch(slot, type.is_wake())) {
 				goto err_exit;
 			}
 #endif /* WIN_ASYNC_IO */
@@ -7913,7 +9121,7 @@ try_again:
 				file.m_file, slot->ptr, slot->len,
 				&slot->n_bytes, &slot->control);
 #elif defined(LINUX_NATIVE_AIO)
-			if (!array->linux_dispatch(slot)) {
+			if (!array->linux_dispatch(slot, type.is_wake())) {
 				goto err_exit;
 			}
 #endif /* WIN_ASYNC_IO */
@@ -8710,7 +9918,7 @@ os_aio_print(FILE*	file)
 		ULINTPF " OS file writes, "
 		ULINTPF " OS fsyncs\n",
 		fil_n_pending_log_flushes,
-		fil_n_pending_tablespace_flushes,
+		fil_n_pending_tablespace_flushes.load(),
 		os_n_file_reads,
 		os_n_file_writes,
 		os_n_fsyncs);
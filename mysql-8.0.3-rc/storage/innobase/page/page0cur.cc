@@ -34,6 +34,7 @@ Created 10/4/1994 Heikki Tuuri
 #include "page0zip.h"
 #ifndef UNIV_HOTBACKUP
 #include <algorithm>
+#include <atomic>
 
 #include "gis0rtree.h"
 #include "rem0cmp.h"
@@ -393,6 +394,399 @@ populate_offsets(
 	return(index->rec_cache.offsets);
 }
 
+/** Maximum number of page directory slots whose key prefix is kept in the
+search cache of a page */
+static const ulint	PAGE_SEARCH_CACHE_N_SLOTS = 32;
+
+/** Number of searches of a page without a current search cache after which
+the cache is (re)built */
+static const ulint	PAGE_SEARCH_CACHE_HOT = 32;
+
+/** Pages with fewer directory slots than this are not worth caching */
+static const ulint	PAGE_SEARCH_CACHE_MIN_SLOTS = 8;
+
+/** At most one in this many buffer pool pages can have a search cache */
+static const ulint	PAGE_SEARCH_CACHE_POOL_SHARE = 64;
+
+/** Number of allocated page search caches */
+static std::atomic<ulint>	page_search_cache_n_alloc;
+
+/** Sparse cache of the page directory of a frequently searched index page.
+It holds the first eight bytes of the first field of the records owned by
+evenly spaced directory slots, in an array that fits in a few cache lines.
+page_cur_search_with_match() narrows the slot range with it before the
+binary search, so that fewer records have to be decoded on a hot page.
+
+The cache is only kept for indexes whose first field is compared with
+memcmp(), so that the order of the prefixes agrees with the order of the
+records. It describes the page as of modify_clock and n_slots; a record
+insert that splits a directory slot changes n_slots, and every other
+change that could move a record increments the modify clock.
+
+A thread holding a latch on the block rebuilds a stale cache. Other
+threads that hold a shared latch on the same block can read the cache
+meanwhile, so the contents are guarded by a sequence number that is odd
+while the cache is being written. */
+struct page_search_cache_t {
+	/** sequence number, odd while the cache is being written */
+	volatile ulint	seq;
+	/** id of the index that the page belonged to */
+	space_index_t	index_id;
+	/** buf_block_t::modify_clock when the cache was built */
+	ib_uint64_t	modify_clock;
+	/** number of directory slots on the page when the cache was built */
+	ulint		n_slots;
+	/** number of cached slots */
+	ulint		n;
+	/** key prefixes of the owner records of the cached slots,
+	in ascending order */
+	ib_uint64_t	prefix[PAGE_SEARCH_CACHE_N_SLOTS];
+	/** numbers of the cached directory slots */
+	uint16_t	slot_no[PAGE_SEARCH_CACHE_N_SLOTS];
+	/** page offsets of the owner records of the cached slots */
+	uint16_t	rec_offs[PAGE_SEARCH_CACHE_N_SLOTS];
+};
+
+/** Normalize a key prefix for the page search cache. The first eight bytes
+are read most significant byte first and a shorter value is padded with
+zero bytes, so that a < b for two prefixes implies that the fields compare
+in the same way.
+@param[in]	data	field data
+@param[in]	len	field length
+@return normalized prefix */
+static inline
+ib_uint64_t
+page_cur_search_cache_prefix(
+	const byte*	data,
+	ulint		len)
+{
+	byte	buf[8];
+
+	memset(buf, 0, sizeof buf);
+	memcpy(buf, data, std::min(len, ulint(sizeof buf)));
+
+	return(mach_read_from_8(buf));
+}
+
+/** Check if the pages of an index can use the page search cache.
+@param[in]	index	index tree
+@return true if the first field of the index is compared with memcmp() */
+static
+bool
+page_cur_search_cache_is_usable(
+	const dict_index_t*	index)
+{
+	if (dict_index_is_spatial(index) || dict_index_is_ibuf(index)) {
+		return(false);
+	}
+
+	const dict_field_t*	field = index->get_field(0);
+
+	if (!field->is_ascending) {
+		return(false);
+	}
+
+	switch (field->col->mtype) {
+	case DATA_FIXBINARY:
+	case DATA_BINARY:
+		return(dtype_get_charset_coll(field->col->prtype)
+		       == DATA_MYSQL_BINARY_CHARSET_COLL);
+	case DATA_INT:
+	case DATA_SYS:
+		return(true);
+	}
+
+	return(false);
+}
+
+/** Check if the search cache of a page describes the current page.
+@param[in]	cache	search cache
+@param[in]	block	index page
+@param[in]	index	index tree
+@param[in]	n_slots	number of directory slots on the page
+@return true if the cache is current */
+static inline
+bool
+page_cur_search_cache_is_current(
+	const page_search_cache_t*	cache,
+	const buf_block_t*		block,
+	const dict_index_t*		index,
+	ulint				n_slots)
+{
+	return(cache->modify_clock == block->modify_clock
+	       && cache->n_slots == n_slots
+	       && cache->index_id == index->id);
+}
+
+/** Check if one more page search cache may be allocated.
+@return true if the caches have not used up their share of the buffer pool */
+static inline
+bool
+page_cur_search_cache_can_alloc()
+{
+	return(page_search_cache_n_alloc.load(std::memory_order_relaxed)
+	       < buf_pool_get_n_pages() / PAGE_SEARCH_CACHE_POOL_SHARE);
+}
+
+/** Build the search cache of a page. Nothing is done if another thread is
+building the cache at the same time, or if no more caches may be allocated.
+@param[in,out]	block	index page, latched
+@param[in]	index	index tree
+@param[in]	n_slots	number of directory slots on the page
+@param[out]	seq	sequence number of the built cache
+@return the search cache, or NULL if it was not built */
+static
+page_search_cache_t*
+page_cur_search_cache_build(
+	buf_block_t*		block,
+	const dict_index_t*	index,
+	ulint			n_slots,
+	ulint*			seq)
+{
+	page_search_cache_t*	cache = block->search_cache;
+
+	if (cache == NULL) {
+		if (!page_cur_search_cache_can_alloc()) {
+			return(NULL);
+		}
+
+		cache = static_cast<page_search_cache_t*>(
+			ut_zalloc(sizeof *cache, mem_key_page_search_cache));
+
+		os_wmb;
+
+		buf_page_mutex_enter(block);
+
+		if (block->search_cache == NULL) {
+			block->search_cache = cache;
+			cache = NULL;
+			page_search_cache_n_alloc.fetch_add(
+				1, std::memory_order_relaxed);
+		}
+
+		buf_page_mutex_exit(block);
+
+		ut_free(cache);
+
+		cache = block->search_cache;
+	}
+
+	ulint	old_seq = cache->seq;
+
+	if ((old_seq & 1)
+	    || !os_compare_and_swap_ulint(&cache->seq, old_seq, old_seq + 1)) {
+		return(NULL);
+	}
+
+	const page_t*	page = buf_block_get_frame(block);
+	const ulint	n_user_slots = n_slots - 2;
+	const ulint	n_samples = std::min(n_user_slots,
+					     PAGE_SEARCH_CACHE_N_SLOTS);
+	mem_heap_t*	heap = NULL;
+	ulint		offsets_[REC_OFFS_NORMAL_SIZE];
+	ulint*		offsets = offsets_;
+	ulint		n = 0;
+
+	rec_offs_init(offsets_);
+
+	for (ulint i = 0; i < n_samples; i++) {
+		/* Skip the infimum and supremum slots. */
+		ulint		slot_no = 1 + i * n_user_slots / n_samples;
+		const rec_t*	rec = page_dir_slot_get_rec(
+			page_dir_get_nth_slot(page, slot_no));
+
+		/* The minimum record of a non-leaf level compares less
+		than any key; it cannot be described by its prefix. */
+		if (rec_get_info_bits(rec, page_is_comp(page))
+		    & REC_INFO_MIN_REC_FLAG) {
+			continue;
+		}
+
+		offsets = rec_get_offsets(rec, index, offsets, 1, &heap);
+
+		ulint		len;
+		const byte*	data = rec_get_nth_field(rec, offsets, 0, &len);
+
+		if (len == UNIV_SQL_NULL) {
+			continue;
+		}
+
+		ut_ad(!rec_offs_nth_extern(offsets, 0));
+
+		cache->prefix[n] = page_cur_search_cache_prefix(data, len);
+		cache->slot_no[n] = static_cast<uint16_t>(slot_no);
+		cache->rec_offs[n] = static_cast<uint16_t>(page_offset(rec));
+		ut_ad(n == 0 || cache->prefix[n - 1] <= cache->prefix[n]);
+		n++;
+	}
+
+	if (UNIV_LIKELY_NULL(heap)) {
+		mem_heap_free(heap);
+	}
+
+	cache->n = n;
+	cache->n_slots = n_slots;
+	cache->modify_clock = block->modify_clock;
+	cache->index_id = index->id;
+
+	os_wmb;
+
+	*seq = old_seq + 2;
+	cache->seq = *seq;
+
+	return(cache);
+}
+
+/** Narrow the range of page directory slots for a binary search with the
+search cache of the page, building the cache if the page is searched often.
+A cached slot is only used as a limit if the key prefix alone shows that the
+search key is less or greater than its owner record, so the result does
+not depend on the search mode.
+@param[in]	block			index page
+@param[in]	index			index tree
+@param[in]	tuple			search key
+@param[in,out]	low			lower limit directory slot
+@param[in,out]	up			upper limit directory slot
+@param[in,out]	low_matched_fields	matched fields in the lower limit
+@param[in,out]	up_matched_fields	matched fields in the upper limit */
+static
+void
+page_cur_search_cache_narrow(
+	const buf_block_t*	block,
+	const dict_index_t*	index,
+	const dtuple_t*		tuple,
+	ulint*			low,
+	ulint*			up,
+	ulint*			low_matched_fields,
+	ulint*			up_matched_fields)
+{
+	const ulint	n_slots = *up + 1;
+
+	ut_ad(*low == 0);
+
+	if (!srv_page_search_cache
+	    || n_slots < PAGE_SEARCH_CACHE_MIN_SLOTS
+	    || buf_block_get_state(block) != BUF_BLOCK_FILE_PAGE
+	    || dtuple_get_n_fields_cmp(tuple) == 0
+	    || !page_cur_search_cache_is_usable(index)) {
+		return;
+	}
+
+	const dfield_t*	dfield = dtuple_get_nth_field(tuple, 0);
+
+	if (dfield_is_null(dfield)) {
+		return;
+	}
+
+	page_search_cache_t*	cache = block->search_cache;
+	ulint			seq = 0;
+
+	if (cache != NULL) {
+		seq = cache->seq;
+		os_rmb;
+	}
+
+	if (cache == NULL
+	    || (seq & 1)
+	    || !page_cur_search_cache_is_current(cache, block, index, n_slots)) {
+
+		buf_block_t*	b = const_cast<buf_block_t*>(block);
+
+		/* Do not count the searches of a page that cannot get
+		a cache, so that its block is not written to. */
+		if (cache == NULL && !page_cur_search_cache_can_alloc()) {
+			return;
+		}
+
+		/* A lost update only delays the build. */
+		ulint	n = b->n_cur_searches.load(
+			std::memory_order_relaxed) + 1;
+
+		if (n < PAGE_SEARCH_CACHE_HOT) {
+			b->n_cur_searches.store(
+				n, std::memory_order_relaxed);
+			return;
+		}
+
+		b->n_cur_searches.store(0, std::memory_order_relaxed);
+
+		cache = page_cur_search_cache_build(b, index, n_slots, &seq);
+
+		if (cache == NULL) {
+			return;
+		}
+	}
+
+	const ib_uint64_t	key = page_cur_search_cache_prefix(
+		static_cast<const byte*>(dfield_get_data(dfield)),
+		dfield_get_len(dfield));
+	const ib_uint64_t*	begin = cache->prefix;
+	const ib_uint64_t*	end = cache->prefix + cache->n;
+
+	/* The cached slots before lo have a smaller prefix than the key,
+	and the slots from hi on a greater one. */
+	ulint	lo = std::lower_bound(begin, end, key) - begin;
+	ulint	hi = std::upper_bound(begin + lo, end, key) - begin;
+	ulint	new_low = *low;
+	ulint	new_up = *up;
+	const page_t*	page = buf_block_get_frame(block);
+
+	if (lo > 0) {
+		new_low = cache->slot_no[lo - 1];
+
+		if (page_offset(page_dir_slot_get_rec(
+			page_dir_get_nth_slot(page, new_low)))
+		    != cache->rec_offs[lo - 1]) {
+			return;
+		}
+	}
+
+	if (hi < cache->n) {
+		new_up = cache->slot_no[hi];
+
+		if (page_offset(page_dir_slot_get_rec(
+			page_dir_get_nth_slot(page, new_up)))
+		    != cache->rec_offs[hi]) {
+			return;
+		}
+	}
+
+	/* Discard the result if the cache was rebuilt while we read it. */
+	os_rmb;
+
+	if (cache->seq != seq) {
+		return;
+	}
+
+	/* The first field differs from the limit records. */
+	if (new_low != *low) {
+		*low = new_low;
+		*low_matched_fields = 0;
+	}
+
+	if (new_up != *up) {
+		*up = new_up;
+		*up_matched_fields = 0;
+	}
+}
+
+/** Free the search cache of a buffer block, if it has one. The block must
+not be accessible to other threads.
+@param[in,out]	block	buffer block */
+void
+page_cur_search_cache_free(
+	buf_block_t*	block)
+{
+	if (block->search_cache != NULL) {
+		ut_free(block->search_cache);
+		block->search_cache = NULL;
+		page_search_cache_n_alloc.fetch_sub(
+			1, std::memory_order_relaxed);
+	}
+
+	block->n_cur_searches.store(0, std::memory_order_relaxed);
+}
+
 /****************************************************************//**
 Searches the right position for a page cursor. */
 void
@@ -512,6 +906,9 @@ page_cur_search_with_match(
 	low = 0;
 	up = page_dir_get_n_slots(page) - 1;
 
+	page_cur_search_cache_narrow(block, index, tuple, &low, &up,
+				     &low_matched_fields, &up_matched_fields);
+
 	/* Perform binary search until the lower and upper limit directory
 	slots come to the distance 1 of each other */
 
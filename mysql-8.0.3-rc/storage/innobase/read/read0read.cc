@@ -27,6 +27,7 @@ Created 2/16/1997 Heikki Tuuri
 
 #include "srv0srv.h"
 #include "trx0sys.h"
+#include "ut0counter.h"
 
 /*
 -------------------------------------------------------------------------------
@@ -130,11 +131,14 @@ FACT C: Purge does not remove any delete-marked row that is visible
 in any cursor read view.
 
 PROOF: We know that:
- 1: Currently active read views in trx_sys_t::view_list are ordered by
+ 1: Currently active read views in each shard of MVCC are ordered by
     ReadView::low_limit_no in descending order, that is,
-    newest read view first.
+    newest read view first. The views are created from published
+    snapshots of the active transactions, and a view that is created
+    later is created from the same or a later snapshot.
 
- 2: Purge clones the oldest read view and uses that to determine whether there
+ 2: Purge clones the oldest read view of all the shards, while holding
+    the mutexes of all the shards, and uses that to determine whether there
     are any active transactions that can see the to be purged records.
 
 Therefore any joining or active transaction will not have a view older
@@ -162,13 +166,17 @@ For details see: row_vers_old_has_index_entry() and row_purge_poss_sec()
 
 Some additional issues:
 
-What if trx_sys->view_list == NULL and some transaction T1 and Purge both
-try to open read_view at same time. Only one can acquire trx_sys->mutex.
-In which order will the views be opened? Should it matter? If no, why?
-
-The order does not matter. No new transactions can be created and no running
-RW transaction can commit or rollback (or free views). AC-NL-RO transactions
-will mark their views as closed but not actually free their views.
+What if there are no views and some transaction T1 and Purge both try to
+open read_view at same time. In which order will the views be opened? Should
+it matter? If no, why?
+
+The order does not matter. T1 reads the snapshot while holding the mutex of
+its shard, and purge holds the mutexes of all the shards. If T1 goes first,
+purge will clone its view. Otherwise T1 reads the snapshot that purge used or
+a later one. Snapshots are published under trx_sys->mutex whenever
+trx_sys->rw_trx_ids changes, and a snapshot is never taken directly from
+trx_sys->rw_trx_ids without publishing it first, so a later snapshot never
+sees less than an earlier one.
 */
 
 /** Minimum number of elements to reserve in ReadView::ids_t */
@@ -193,16 +201,17 @@ struct	ViewCheck {
 };
 
 /**
-Validates a read view list. */
+Validates a read view list.
+@param shard		shard whose list to validate */
 
 bool
-MVCC::validate() const
+MVCC::validate(const shard_t& shard) const
 {
 	ViewCheck	check;
 
-	ut_ad(mutex_own(&trx_sys->mutex));
+	ut_ad(mutex_own(&shard.mutex));
 
-	ut_list_map(m_views, check);
+	ut_list_map(shard.m_views, check);
 
 	return(true);
 }
@@ -325,7 +334,9 @@ ReadView::ReadView()
 	m_up_limit_id(),
 	m_creator_trx_id(),
 	m_ids(),
-	m_low_limit_no()
+	m_low_limit_no(),
+	m_snapshot_no(),
+	m_shard()
 {
 	ut_d(::memset(&m_view_list, 0x0, sizeof(m_view_list)));
 }
@@ -340,29 +351,58 @@ ReadView::~ReadView()
 /** Constructor
 @param size		Number of views to pre-allocate */
 MVCC::MVCC(ulint size)
+	:
+	m_snapshot_no(0)
 {
-	UT_LIST_INIT(m_free, &ReadView::m_view_list);
-	UT_LIST_INIT(m_views, &ReadView::m_view_list);
+	m_shards = UT_NEW_ARRAY_NOKEY(shard_t, MVCC_N_SHARDS);
+
+	for (ulint i = 0; i < MVCC_N_SHARDS; ++i) {
+		shard_t&	shard = m_shards[i];
+
+		mutex_create(LATCH_ID_MVCC_VIEW, &shard.mutex);
+
+		UT_LIST_INIT(shard.m_free, &ReadView::m_view_list);
+		UT_LIST_INIT(shard.m_views, &ReadView::m_view_list);
+	}
 
 	for (ulint i = 0; i < size; ++i) {
 		ReadView*	view = UT_NEW_NOKEY(ReadView());
 
-		UT_LIST_ADD_FIRST(m_free, view);
+		view->m_shard = i % MVCC_N_SHARDS;
+
+		UT_LIST_ADD_FIRST(m_shards[view->m_shard].m_free, view);
 	}
+
+	m_snapshots = static_cast<trx_ids_snapshot_t*>(
+		ut_zalloc_nokey(MVCC_N_SNAPSHOTS * sizeof(*m_snapshots)));
+
+	/* Until the first snapshot is published, views are created under
+	trx_sys->mutex. */
+	m_snapshots[0].m_n_ids = ULINT_UNDEFINED;
 }
 
 MVCC::~MVCC()
 {
-	for (ReadView* view = UT_LIST_GET_FIRST(m_free);
-	     view != NULL;
-	     view = UT_LIST_GET_FIRST(m_free)) {
+	for (ulint i = 0; i < MVCC_N_SHARDS; ++i) {
+		shard_t&	shard = m_shards[i];
+
+		for (ReadView* view = UT_LIST_GET_FIRST(shard.m_free);
+		     view != NULL;
+		     view = UT_LIST_GET_FIRST(shard.m_free)) {
+
+			UT_LIST_REMOVE(shard.m_free, view);
+
+			UT_DELETE(view);
+		}
 
-		UT_LIST_REMOVE(m_free, view);
+		ut_a(UT_LIST_GET_LEN(shard.m_views) == 0);
 
-		UT_DELETE(view);
+		mutex_free(&shard.mutex);
 	}
 
-	ut_a(UT_LIST_GET_LEN(m_views) == 0);
+	UT_DELETE_ARRAY(m_shards);
+
+	ut_free(m_snapshots);
 }
 
 /**
@@ -467,6 +507,71 @@ ReadView::prepare(trx_id_t id)
 	}
 }
 
+/** Opens a read view from a published snapshot of the active transactions,
+without acquiring trx_sys_t::mutex.
+@param[in]	id		creator transaction id
+@param[in]	snapshot	published snapshot
+@return false if the snapshot was being modified while it was read, or if it
+does not contain the transaction ids */
+
+bool
+ReadView::prepare(trx_id_t id, const trx_ids_snapshot_t& snapshot)
+{
+	ut_ad(!trx_sys_mutex_own());
+
+	const uint64_t	version = snapshot.m_version.load(
+		std::memory_order_acquire);
+
+	if (version & 1) {
+		return(false);
+	}
+
+	/* The fields can be modified while we read them. They are only
+	used if m_version has not changed by the time we are done. */
+
+	const ulint	n_ids = snapshot.m_n_ids;
+
+	if (n_ids > TRX_IDS_SNAPSHOT_SIZE) {
+		return(false);
+	}
+
+	m_low_limit_id = snapshot.m_low_limit_id;
+
+	m_low_limit_no = snapshot.m_low_limit_no;
+
+	m_ids.reserve(n_ids);
+	m_ids.resize(n_ids);
+
+	::memcpy(m_ids.data(), snapshot.m_ids, n_ids * sizeof(trx_id_t));
+
+	std::atomic_thread_fence(std::memory_order_acquire);
+
+	if (snapshot.m_version.load(std::memory_order_relaxed) != version) {
+		return(false);
+	}
+
+	m_creator_trx_id = id;
+
+	if (id > 0) {
+		/* The snapshot was published after the creator was
+		assigned its id. Remove the id, as copy_trx_ids() does. */
+
+		ids_t::value_type*	begin = m_ids.data();
+		ids_t::value_type*	end = begin + m_ids.size();
+		ids_t::value_type*	it = std::lower_bound(begin, end, id);
+
+		ut_ad(it != end && *it == id);
+
+		if (it != end && *it == id) {
+			::memmove(it, it + 1, (end - it - 1) * sizeof(*it));
+
+			m_ids.resize(m_ids.size() - 1);
+		}
+	}
+
+	return(true);
+}
+
 /**
 Complete the read view creation */
 
@@ -487,35 +592,38 @@ a new view.
 @return a view to use */
 
 ReadView*
-MVCC::get_view()
+MVCC::get_view(ulint shard)
 {
-	ut_ad(mutex_own(&trx_sys->mutex));
+	ut_ad(mutex_own(&m_shards[shard].mutex));
 
+	view_list_t&	free_list = m_shards[shard].m_free;
 	ReadView*	view;
 
-	if (UT_LIST_GET_LEN(m_free) > 0) {
-		view = UT_LIST_GET_FIRST(m_free);
-		UT_LIST_REMOVE(m_free, view);
+	if (UT_LIST_GET_LEN(free_list) > 0) {
+		view = UT_LIST_GET_FIRST(free_list);
+		UT_LIST_REMOVE(free_list, view);
 	} else {
 		view = UT_NEW_NOKEY(ReadView());
 
 		if (view == NULL) {
 			ib::error() << "Failed to allocate MVCC view";
+		} else {
+			view->m_shard = shard;
 		}
 	}
 
+	ut_ad(view == NULL || view->m_shard == shard);
+
 	return(view);
 }
 
 /**
-Release a view that is inactive but not closed. Caller must own
-the trx_sys_t::mutex.
+Release a view that is inactive but not closed.
 @param view		View to release */
 void
 MVCC::view_release(ReadView*& view)
 {
 	ut_ad(!srv_read_only_mode);
-	ut_ad(trx_sys_mutex_own());
 
 	uintptr_t	p = reinterpret_cast<uintptr_t>(view);
 
@@ -530,13 +638,123 @@ MVCC::view_release(ReadView*& view)
 
 	ut_ad(view->m_creator_trx_id == 0);
 
-	UT_LIST_REMOVE(m_views, view);
+	shard_t&	shard = m_shards[view->m_shard];
+
+	mutex_enter(&shard.mutex);
 
-	UT_LIST_ADD_LAST(m_free, view);
+	UT_LIST_REMOVE(shard.m_views, view);
+
+	UT_LIST_ADD_LAST(shard.m_free, view);
+
+	mutex_exit(&shard.mutex);
 
 	view = NULL;
 }
 
+/** Publish a copy of trx_sys->rw_trx_ids for the views created later. Must
+be called with trx_sys->mutex held, after every modification of
+trx_sys->rw_trx_ids.
+@return number of the published snapshot */
+uint64_t
+MVCC::publish_snapshot()
+{
+	ut_ad(trx_sys_mutex_own());
+
+	const uint64_t	no = m_snapshot_no.load(std::memory_order_relaxed) + 1;
+
+	trx_ids_snapshot_t&	snapshot = m_snapshots[no % MVCC_N_SNAPSHOTS];
+
+	const uint64_t	version = snapshot.m_version.load(
+		std::memory_order_relaxed);
+
+	ut_ad(!(version & 1));
+
+	snapshot.m_version.store(version + 1, std::memory_order_relaxed);
+
+	std::atomic_thread_fence(std::memory_order_release);
+
+	snapshot.m_low_limit_id = trx_sys->max_trx_id;
+
+	snapshot.m_low_limit_no = snapshot.m_low_limit_id;
+
+	if (UT_LIST_GET_LEN(trx_sys->serialisation_list) > 0) {
+		const trx_t*	trx;
+
+		trx = UT_LIST_GET_FIRST(trx_sys->serialisation_list);
+
+		if (trx->no < snapshot.m_low_limit_no) {
+			snapshot.m_low_limit_no = trx->no;
+		}
+	}
+
+	const trx_ids_t&	ids = trx_sys->rw_trx_ids;
+
+	if (ids.size() > TRX_IDS_SNAPSHOT_SIZE) {
+
+		snapshot.m_n_ids = ULINT_UNDEFINED;
+
+	} else {
+		if (!ids.empty()) {
+			::memcpy(snapshot.m_ids, &ids[0],
+				 ids.size() * sizeof(trx_id_t));
+		}
+
+		snapshot.m_n_ids = ids.size();
+	}
+
+	snapshot.m_version.store(version + 2, std::memory_order_release);
+
+	m_snapshot_no.store(no, std::memory_order_release);
+
+	return(no);
+}
+
+/** Take the snapshot of the active transactions for a view, from the latest
+published snapshot if possible, else from trx_sys->rw_trx_ids under
+trx_sys->mutex. The caller must hold the mutex of the shard that the view will
+be added to, or the mutexes of all the shards.
+@param view		view to prepare
+@param id		creator transaction id */
+void
+MVCC::view_prepare(ReadView* view, trx_id_t id)
+{
+	ut_ad(!trx_sys_mutex_own());
+
+	/* A snapshot is overwritten after MVCC_N_SNAPSHOTS newer ones have
+	been published. Retry a few times if that happened while we were
+	copying it. */
+
+	for (ulint i = 0; i < MVCC_N_SNAPSHOTS; ++i) {
+
+		const uint64_t	no = m_snapshot_no.load(
+			std::memory_order_acquire);
+
+		if (view->prepare(id, m_snapshots[no % MVCC_N_SNAPSHOTS])) {
+
+			view->m_snapshot_no = no;
+
+			return;
+		}
+
+		if (m_snapshots[no % MVCC_N_SNAPSHOTS].m_n_ids
+		    == ULINT_UNDEFINED) {
+
+			/* Too many active transactions. */
+			break;
+		}
+	}
+
+	trx_sys_mutex_enter();
+
+	/* Publish the current state first, so that no view or purge
+	snapshot taken later can see less than this one. */
+	view->m_snapshot_no = publish_snapshot();
+
+	view->prepare(id);
+
+	trx_sys_mutex_exit();
+}
+
 /**
 Allocate and create a view.
 @param view		view owned by this class created for the
@@ -547,6 +765,8 @@ MVCC::view_open(ReadView*& view, trx_t* trx)
 {
 	ut_ad(!srv_read_only_mode);
 
+	shard_t*	shard;
+
 	/** If no new RW transaction has been started since the last view
 	was created then reuse the the existing view. */
 	if (view != NULL) {
@@ -576,30 +796,37 @@ MVCC::view_open(ReadView*& view, trx_t* trx)
 			}
 		}
 
-		mutex_enter(&trx_sys->mutex);
+		shard = &m_shards[view->m_shard];
 
-		UT_LIST_REMOVE(m_views, view);
+		mutex_enter(&shard->mutex);
+
+		UT_LIST_REMOVE(shard->m_views, view);
 
 	} else {
-		mutex_enter(&trx_sys->mutex);
+		const ulint	i = counter_indexer_t<>::get_rnd_index()
+			% MVCC_N_SHARDS;
+
+		shard = &m_shards[i];
+
+		mutex_enter(&shard->mutex);
 
-		view = get_view();
+		view = get_view(i);
 	}
 
 	if (view != NULL) {
 
-		view->prepare(trx->id);
+		view_prepare(view, trx->id);
 
 		view->complete();
 
-		UT_LIST_ADD_FIRST(m_views, view);
+		UT_LIST_ADD_FIRST(shard->m_views, view);
 
 		ut_ad(!view->is_closed());
 
-		ut_ad(validate());
+		ut_ad(validate(*shard));
 	}
 
-	trx_sys_mutex_exit();
+	mutex_exit(&shard->mutex);
 }
 
 /**
@@ -609,20 +836,32 @@ Get the oldest (active) view in the system.
 ReadView*
 MVCC::get_oldest_view() const
 {
-	ReadView*	view;
+	ReadView*	oldest_view = NULL;
 
-	ut_ad(mutex_own(&trx_sys->mutex));
+	for (ulint i = 0; i < MVCC_N_SHARDS; ++i) {
+		const shard_t&	shard = m_shards[i];
+		ReadView*	view;
 
-	for (view = UT_LIST_GET_LAST(m_views);
-	     view != NULL;
-	     view = UT_LIST_GET_PREV(m_view_list, view)) {
+		ut_ad(mutex_own(&shard.mutex));
 
-		if (!view->is_closed()) {
-			break;
+		for (view = UT_LIST_GET_LAST(shard.m_views);
+		     view != NULL;
+		     view = UT_LIST_GET_PREV(m_view_list, view)) {
+
+			if (!view->is_closed()) {
+				break;
+			}
+		}
+
+		if (view != NULL
+		    && (oldest_view == NULL
+			|| view->m_snapshot_no < oldest_view->m_snapshot_no)) {
+
+			oldest_view = view;
 		}
 	}
 
-	return(view);
+	return(oldest_view);
 }
 
 /**
@@ -684,23 +923,27 @@ purge the delete marked record or not.
 void
 MVCC::clone_oldest_view(ReadView* view)
 {
-	mutex_enter(&trx_sys->mutex);
+	for (ulint i = 0; i < MVCC_N_SHARDS; ++i) {
+		mutex_enter(&m_shards[i].mutex);
+	}
 
 	ReadView*	oldest_view = get_oldest_view();
 
 	if (oldest_view == NULL) {
 
-		view->prepare(0);
-
-		trx_sys_mutex_exit();
-
-		view->complete();
+		view_prepare(view, 0);
 
 	} else {
 		view->copy_prepare(*oldest_view);
+	}
 
-		trx_sys_mutex_exit();
+	for (ulint i = 0; i < MVCC_N_SHARDS; ++i) {
+		mutex_exit(&m_shards[i].mutex);
+	}
 
+	if (oldest_view == NULL) {
+		view->complete();
+	} else {
 		view->copy_complete();
 	}
 }
@@ -711,20 +954,24 @@ MVCC::clone_oldest_view(ReadView* view)
 ulint
 MVCC::size() const
 {
-	trx_sys_mutex_enter();
-
 	ulint	size = 0;
 
-	for (const ReadView* view = UT_LIST_GET_FIRST(m_views);
-	     view != NULL;
-	     view = UT_LIST_GET_NEXT(m_view_list, view)) {
+	for (ulint i = 0; i < MVCC_N_SHARDS; ++i) {
+		shard_t&	shard = m_shards[i];
+
+		mutex_enter(&shard.mutex);
 
-		if (!view->is_closed()) {
-			++size;
+		for (const ReadView* view = UT_LIST_GET_FIRST(shard.m_views);
+		     view != NULL;
+		     view = UT_LIST_GET_NEXT(m_view_list, view)) {
+
+			if (!view->is_closed()) {
+				++size;
+			}
 		}
-	}
 
-	trx_sys_mutex_exit();
+		mutex_exit(&shard.mutex);
+	}
 
 	return(size);
 }
@@ -732,16 +979,19 @@ MVCC::size() const
 /**
 Close a view created by the above function.
 @param view		view allocated by trx_open.
-@param own_mutex	true if caller owns trx_sys_t::mutex */
+@param remove		true to move the view to the free list now, false
+			to only mark it closed, so that the next view_open()
+			of an AC-NL-RO transaction can reuse it. The caller
+			must not hold trx_sys_t::mutex if true. */
 
 void
-MVCC::view_close(ReadView*& view, bool own_mutex)
+MVCC::view_close(ReadView*& view, bool remove)
 {
 	uintptr_t	p = reinterpret_cast<uintptr_t>(view);
 
 	/* Note: The assumption here is that AC-NL-RO transactions will
-	call this function with own_mutex == false. */
-	if (!own_mutex) {
+	call this function with remove == false. */
+	if (!remove) {
 		/* Sanitise the pointer first. */
 		ReadView*	ptr = reinterpret_cast<ReadView*>(p & ~1);
 
@@ -754,12 +1004,20 @@ MVCC::view_close(ReadView*& view, bool own_mutex)
 	} else {
 		view = reinterpret_cast<ReadView*>(p & ~1);
 
+		shard_t&	shard = m_shards[view->m_shard];
+
+		ut_ad(!trx_sys_mutex_own());
+
+		mutex_enter(&shard.mutex);
+
 		view->close();
 
-		UT_LIST_REMOVE(m_views, view);
-		UT_LIST_ADD_LAST(m_free, view);
+		UT_LIST_REMOVE(shard.m_views, view);
+		UT_LIST_ADD_LAST(shard.m_free, view);
 
-		ut_ad(validate());
+		ut_ad(validate(shard));
+
+		mutex_exit(&shard.mutex);
 
 		view = NULL;
 	}
@@ -777,5 +1035,10 @@ MVCC::set_view_creator_trx_id(ReadView* view, trx_id_t id)
 	ut_ad(id > 0);
 	ut_ad(mutex_own(&trx_sys->mutex));
 
+	/* Purge may be copying the view concurrently, under the mutex of
+	its shard only. If it misses the id, that is harmless: the id is
+	not smaller than the low limit id of the view, which purge does not
+	see anyway. */
+
 	view->creator_trx_id(id);
 }
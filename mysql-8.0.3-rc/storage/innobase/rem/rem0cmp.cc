@@ -331,6 +331,74 @@ cmp_gis_field(
 	}
 }
 
+/** Longest common prefix in bytes that cmp_bytes() compares a word at a
+time; longer data is compared with memcmp() */
+static const ulint	CMP_BYTES_WORD_MAX = 16;
+
+/** Compare two byte strings of equal length in memcmp() order.
+A short string, such as an integer or system column or a short binary
+key, is compared eight bytes at a time: a word that is read with the most
+significant byte first compares as an unsigned integer exactly like its
+bytes compare lexicographically. This avoids the call overhead of memcmp().
+On x86 and x86-64, the GCC built-in memcmp() (repz cmpsb) seems to be very
+slow, so longer strings are compared with the libc version.
+http://gcc.gnu.org/bugzilla/show_bug.cgi?id=43052 tracks the slowness of
+the GCC built-in memcmp(). On other architectures than the IA32 or AMD64,
+there could be a built-in memcmp() that is faster than the word loop, so
+memcmp() is always used there.
+@param[in]	data1	byte string
+@param[in]	data2	byte string
+@param[in]	len	length of both strings in bytes
+@return the comparison result of data1 and data2
+@retval 0 if data1 is equal to data2
+@retval negative if data1 is less than data2
+@retval positive if data1 is greater than data2 */
+static inline
+int
+cmp_bytes(
+	const byte*	data1,
+	const byte*	data2,
+	ulint		len)
+{
+#if defined __i386__ || defined __x86_64__ || defined _M_IX86 || defined _M_X64
+	if (len <= CMP_BYTES_WORD_MAX) {
+		for (; len >= 8; data1 += 8, data2 += 8, len -= 8) {
+			ib_uint64_t	w1 = mach_read_from_8(data1);
+			ib_uint64_t	w2 = mach_read_from_8(data2);
+
+			if (w1 != w2) {
+				return(w1 < w2 ? -1 : 1);
+			}
+		}
+
+		if (len >= 4) {
+			ulint	w1 = mach_read_from_4(data1);
+			ulint	w2 = mach_read_from_4(data2);
+
+			if (w1 != w2) {
+				return(w1 < w2 ? -1 : 1);
+			}
+
+			data1 += 4;
+			data2 += 4;
+			len -= 4;
+		}
+
+		for (; len > 0; len--) {
+			int	cmp = int(*data1++) - int(*data2++);
+
+			if (cmp) {
+				return(cmp);
+			}
+		}
+
+		return(0);
+	}
+#endif /* IA32 or AMD64 */
+
+	return(memcmp(data1, data2, len));
+}
+
 /** Compare two data fields.
 @param[in]	mtype		main type
 @param[in]	prtype		precise type
@@ -505,48 +573,14 @@ cmp_data(
 	}
 
 	if (len) {
-#if defined __i386__ || defined __x86_64__ || defined _M_IX86 || defined _M_X64
-		/* Compare the first bytes with a loop to avoid the call
-		overhead of memcmp(). On x86 and x86-64, the GCC built-in
-		(repz cmpsb) seems to be very slow, so we will be calling the
-		libc version. http://gcc.gnu.org/bugzilla/show_bug.cgi?id=43052
-		tracks the slowness of the GCC built-in memcmp().
-
-		We compare up to the first 4..7 bytes with the loop.
-		The (len & 3) is used for "normalizing" or
-		"quantizing" the len parameter for the memcmp() call,
-		in case the whole prefix is equal. On x86 and x86-64,
-		the GNU libc memcmp() of equal strings is faster with
-		len=4 than with len=3.
-
-		On other architectures than the IA32 or AMD64, there could
-		be a built-in memcmp() that is faster than the loop.
-		We only use the loop where we know that it can improve
-		the performance. */
-		for (ulint i = 4 + (len & 3); i > 0; i--) {
-			cmp = int(*data1++) - int(*data2++);
-			if (cmp) {
-				goto func_exit;
-			}
+		cmp = cmp_bytes(data1, data2, len);
 
-			if (!--len) {
-				break;
-			}
+		if (cmp) {
+			goto func_exit;
 		}
 
-		if (len) {
-#endif /* IA32 or AMD64 */
-			cmp = memcmp(data1, data2, len);
-
-			if (cmp) {
-				goto func_exit;
-			}
-
-			data1 += len;
-			data2 += len;
-#if defined __i386__ || defined __x86_64__ || defined _M_IX86 || defined _M_X64
-		}
-#endif /* IA32 or AMD64 */
+		data1 += len;
+		data2 += len;
 	}
 
 	cmp = (int) (len1 - len2);
@@ -2111,6 +2111,10 @@ PageConverter::validate(
 		false, page, get_page_size(),
 		fsp_is_checksum_disabled(block->page.id.space()));
 
+	if (m_page_crc32 != NULL) {
+		reporter.set_crc32(*m_page_crc32);
+	}
+
 	if (reporter.is_corrupted()
 	    || (page_get_page_no(page) != offset / m_page_size.physical()
 		&& page_get_page_no(page) != 0)) {
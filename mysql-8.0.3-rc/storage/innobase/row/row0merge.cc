@@ -27,6 +27,9 @@ Completed by Sunny Bains and Marko Makela
 #include <fcntl.h>
 #include <math.h>
 #include <sys/types.h>
+#include <algorithm>
+#include <atomic>
+#include <vector>
 
 #include "btr0bulk.h"
 #include "dict0crea.h"
@@ -39,6 +42,7 @@ Completed by Sunny Bains and Marko Makela
 #include "my_dbug.h"
 #include "my_inttypes.h"
 #include "my_psi_config.h"
+#include "os0thread-create.h"
 #include "pars0pars.h"
 #include "row0ext.h"
 #include "row0ftsort.h"
@@ -3914,6 +3918,208 @@ row_merge_write_redo(
 	mtr.commit();
 }
 
+/** Sort the entries of an index and bulk load them into the index.
+@param[in]	trx		transaction
+@param[in]	dup		descriptor of the index being built
+@param[in,out]	file		file containing the index entries
+@param[in]	old_table	table where rows are read from
+@param[in,out]	block		3 buffers
+@param[in,out]	tmpfd		temporary file handle
+@param[in]	flush_observer	flush observer of the bulk load, or NULL
+@param[in,out]	stage		performance schema accounting object, or NULL
+@return DB_SUCCESS or error code */
+static
+dberr_t
+row_merge_sort_and_load(
+	trx_t*			trx,
+	const row_merge_dup_t*	dup,
+	merge_file_t*		file,
+	dict_table_t*		old_table,
+	row_merge_block_t*	block,
+	int*			tmpfd,
+	FlushObserver*		flush_observer,
+	ut_stage_alter_t*	stage)
+{
+	dberr_t	error = row_merge_sort(trx, dup, file, block, tmpfd, stage);
+
+	if (error == DB_SUCCESS) {
+		BtrBulk	btr_bulk(dup->index, trx->id, flush_observer);
+		btr_bulk.init();
+
+		error = row_merge_insert_index_tuples(
+			trx->id, dup->index, old_table, file->fd, block, NULL,
+			&btr_bulk, stage);
+
+		error = btr_bulk.finish(error);
+	}
+
+	return(error);
+}
+
+/** Number of index build threads that are running, across all the index
+creations. Limited to MAX_INDEX_BUILD_THREADS, because the threads are
+counted in srv_max_n_threads. */
+static std::atomic<ulint>	row_merge_n_build_threads(0);
+
+/** Indexes that are sorted and loaded concurrently after the clustered
+index has been read. Only indexes that cannot report duplicates are
+built this way, because a duplicate is reported in the MySQL record
+buffer of the table, which is shared by all the threads. */
+struct row_merge_build_t {
+	/** Transaction */
+	trx_t*			trx;
+
+	/** Table where rows are read from */
+	dict_table_t*		old_table;
+
+	/** MySQL table */
+	struct TABLE*		table;
+
+	/** Mapping of old column numbers to new ones, or NULL */
+	const ulint*		col_map;
+
+	/** Indexes to be created */
+	dict_index_t**		indexes;
+
+	/** Files containing the index entries, one per index */
+	merge_file_t*		merge_files;
+
+	/** Flush observer of the bulk load, or NULL */
+	FlushObserver*		flush_observer;
+
+	/** Numbers of the indexes to build concurrently */
+	std::vector<ulint, ut_allocator<ulint>>	todo;
+
+	/** Next entry of todo[] to build */
+	std::atomic<ulint>	next;
+
+	/** Set when a build fails, to stop taking more work */
+	std::atomic<bool>	failed;
+
+	/** Whether each index has been built */
+	bool*			built;
+
+	/** Result of each index build */
+	dberr_t*		errors;
+};
+
+/** Build indexes from the todo[] list of a concurrent index build
+until there are no more, or a build fails.
+@param[in,out]	build		concurrent index build
+@param[in,out]	block		3 buffers
+@param[in,out]	tmpfd		temporary file handle
+@param[in,out]	stage		performance schema accounting object, or
+NULL */
+static
+void
+row_merge_build_next(
+	row_merge_build_t*	build,
+	row_merge_block_t*	block,
+	int*			tmpfd,
+	ut_stage_alter_t*	stage)
+{
+	for (;;) {
+		const ulint	k = build->next.fetch_add(1);
+
+		if (k >= build->todo.size() || build->failed.load()) {
+			break;
+		}
+
+		const ulint		i = build->todo[k];
+		row_merge_dup_t		dup = {
+			build->indexes[i], build->table, build->col_map, 0};
+
+		ut_ad(!dict_index_is_unique(dup.index));
+
+		build->errors[i] = row_merge_sort_and_load(
+			build->trx, &dup, &build->merge_files[i],
+			build->old_table, block, tmpfd,
+			build->flush_observer, stage);
+
+		DBUG_EXECUTE_IF("ib_index_build_fail_concurrent",
+			if (k == 1) {
+				build->errors[i] = DB_TEMP_FILE_WRITE_FAIL;
+			});
+
+		build->built[i] = true;
+
+		if (build->errors[i] != DB_SUCCESS) {
+			build->failed.store(true);
+		}
+	}
+}
+
+/** Helper thread of a concurrent index build. The performance schema
+progress of the indexes built here is not reported, the stage object
+is used by the thread that runs the ALTER TABLE.
+@param[in,out]	build		concurrent index build */
+static
+void
+row_merge_build_thread(
+	row_merge_build_t*	build)
+{
+	ut_new_pfx_t				block_pfx;
+	ut_allocator<row_merge_block_t>		alloc(mem_key_row_merge_sort);
+	row_merge_block_t*			block;
+	int					tmpfd = -1;
+
+	block = alloc.allocate_large(3 * srv_sort_buf_size, &block_pfx);
+
+	/* Without a buffer, leave the work to the other threads. */
+	if (block != NULL) {
+		row_merge_build_next(build, block, &tmpfd, NULL);
+
+		row_merge_file_destroy_low(tmpfd);
+
+		alloc.deallocate_large(block, &block_pfx);
+	}
+}
+
+/** Sort and load concurrently the indexes that cannot report duplicates,
+with up to srv_index_build_threads threads. The calling thread takes
+part in the build. Other indexes are left to the caller.
+@param[in,out]	build		concurrent index build; todo[] is filled
+				in by the caller
+@param[in,out]	block		3 buffers
+@param[in,out]	tmpfd		temporary file handle
+@param[in,out]	stage		performance schema accounting object */
+static
+void
+row_merge_build_concurrently(
+	row_merge_build_t*	build,
+	row_merge_block_t*	block,
+	int*			tmpfd,
+	ut_stage_alter_t*	stage)
+{
+	ulint	n_threads = std::min(
+		ulint(srv_index_build_threads), build->todo.size()) - 1;
+
+	/* Reserve the helper threads. */
+	ulint	active = row_merge_n_build_threads.load();
+
+	do {
+		n_threads = std::min(
+			n_threads,
+			active < MAX_INDEX_BUILD_THREADS
+			? MAX_INDEX_BUILD_THREADS - active : 0);
+	} while (!row_merge_n_build_threads.compare_exchange_weak(
+			 active, active + n_threads));
+
+	Helper_threads	helpers;
+
+	for (ulint i = 0; i < n_threads; ++i) {
+		helpers.start(
+			index_build_thread_key, row_merge_build_thread,
+			build);
+	}
+
+	row_merge_build_next(build, block, tmpfd, stage);
+
+	helpers.join();
+
+	row_merge_n_build_threads.fetch_sub(n_threads);
+}
+
 /** Build indexes on a table by reading a clustered index, creating a temporary
 file containing index entries, merge sorting these index entries and inserting
 sorted index entries to indexes.
@@ -4035,6 +4241,22 @@ row_merge_build_indexes(
 		merge_files[i].fd = -1;
 	}
 
+	row_merge_build_t	build;
+
+	build.trx = trx;
+	build.old_table = old_table;
+	build.table = table;
+	build.col_map = col_map;
+	build.indexes = indexes;
+	build.merge_files = merge_files;
+	build.flush_observer = flush_observer;
+	build.next.store(0);
+	build.failed.store(false);
+	build.built = static_cast<bool*>(
+		ut_zalloc_nokey(n_indexes * sizeof *build.built));
+	build.errors = static_cast<dberr_t*>(
+		ut_malloc_nokey(n_indexes * sizeof *build.errors));
+
 	for (i = 0; i < n_indexes; i++) {
 		if (indexes[i]->type & DICT_FTS) {
 			ibool	opt_doc_id_size = FALSE;
@@ -4086,7 +4308,23 @@ row_merge_build_indexes(
 	DEBUG_SYNC_C("row_merge_after_scan");
 
 	/* Now we have files containing index entries ready for
-	sorting and inserting. */
+	sorting and inserting. Sort and load the indexes that cannot
+	report duplicates concurrently first. Their online logs are
+	applied below, in index order, like for the other indexes. */
+
+	for (i = 0; i < n_indexes; i++) {
+		if (merge_files[i].fd >= 0
+		    && !dict_index_is_spatial(indexes[i])
+		    && !(indexes[i]->type & DICT_FTS)
+		    && !dict_index_is_unique(indexes[i])) {
+
+			build.todo.push_back(i);
+		}
+	}
+
+	if (srv_index_build_threads > 1 && build.todo.size() > 1) {
+		row_merge_build_concurrently(&build, block, &tmpfd, stage);
+	}
 
 	for (i = 0; i < n_indexes; i++) {
 		dict_index_t*	sort_idx = indexes[i];
@@ -4160,26 +4398,15 @@ wait_again:
 #ifdef FTS_INTERNAL_DIAG_PRINT
 			DEBUG_FTS_SORT_PRINT("FTS_SORT: Complete Insert\n");
 #endif
+		} else if (build.built[i]) {
+			error = build.errors[i];
 		} else if (merge_files[i].fd >= 0) {
 			row_merge_dup_t	dup = {
 				sort_idx, table, col_map, 0};
 
-			error = row_merge_sort(
-				trx, &dup, &merge_files[i],
-				block, &tmpfd, stage);
-
-			if (error == DB_SUCCESS) {
-				BtrBulk	btr_bulk(sort_idx, trx->id,
-						 flush_observer);
-				btr_bulk.init();
-
-				error = row_merge_insert_index_tuples(
-					trx->id, sort_idx, old_table,
-					merge_files[i].fd, block, NULL,
-					&btr_bulk, stage);
-
-				error = btr_bulk.finish(error);
-			}
+			error = row_merge_sort_and_load(
+				trx, &dup, &merge_files[i], old_table,
+				block, &tmpfd, flush_observer, stage);
 		}
 
 		/* Close the temporary file to free up space. */
@@ -4239,6 +4466,8 @@ func_exit:
 	}
 
 	ut_free(merge_files);
+	ut_free(build.built);
+	ut_free(build.errors);
 
 	alloc.deallocate_large(block, &block_pfx);
 
@@ -63,6 +63,7 @@ Created 9/17/2000 Heikki Tuuri
 #include "row0ins.h"
 #include "row0merge.h"
 #include "row0mysql.h"
+#include "row0pread.h"
 #include "row0row.h"
 #include "row0sel.h"
 #include "row0upd.h"
@@ -4884,6 +4885,227 @@ funct_exit:
 	return(err);
 }
 
+/** Check that a record of an index is in ascending order after the
+previous entry, and that the unique constraint is not broken. Errors are
+reported to the error log.
+@param[in]	prev_entry	previous entry of the index
+@param[in]	rec		record after prev_entry
+@param[in]	index		index
+@param[in]	offsets		rec_get_offsets(rec, index)
+@return DB_SUCCESS, DB_INDEX_CORRUPT or DB_DUPLICATE_KEY */
+static
+dberr_t
+row_scan_check_order(
+	const dtuple_t*		prev_entry,
+	const rec_t*		rec,
+	const dict_index_t*	index,
+	const ulint*		offsets)
+{
+	ulint		matched_fields = 0;
+	ibool		contains_null = FALSE;
+	const int	cmp = cmp_dtuple_rec_with_match(
+		prev_entry, rec, index, offsets, &matched_fields);
+
+	/* In a unique secondary index we allow equal key values if
+	they contain SQL NULLs */
+
+	for (ulint i = 0;
+	     i < dict_index_get_n_ordering_defined_by_user(index);
+	     i++) {
+		if (UNIV_SQL_NULL == dfield_get_len(
+			    dtuple_get_nth_field(prev_entry, i))) {
+
+			contains_null = TRUE;
+			break;
+		}
+	}
+
+	dberr_t		ret;
+	const char*	msg;
+
+	if (cmp > 0) {
+		ret = DB_INDEX_CORRUPT;
+		msg = "index records in a wrong order in ";
+	} else if (dict_index_is_unique(index)
+		   && !contains_null
+		   && matched_fields
+		   >= dict_index_get_n_ordering_defined_by_user(index)) {
+		ret = DB_DUPLICATE_KEY;
+		msg = "duplicate key in ";
+	} else {
+		return(DB_SUCCESS);
+	}
+
+	ib::error()
+		<< msg << index->name
+		<< " of table " << index->table->name
+		<< ": " << *prev_entry << ", "
+		<< rec_offsets_print(rec, offsets);
+
+	return(ret);
+}
+
+/** Scan a clustered index in parallel for either COUNT(*) or CHECK
+TABLE. The records are read in the read view of the transaction. For
+CHECK TABLE the order of the records is checked within each range of
+the scan, and across the range boundaries after the scan.
+@param[in,out]	prebuilt	prebuilt struct in MySQL handle
+@param[in]	index		clustered index
+@param[in]	check_keys	true=check for mis-ordered or duplicate
+				records, false=count the rows only
+@param[out]	n_rows		number of entries seen in the consistent
+				read
+@return DB_SUCCESS or DB_INTERRUPTED */
+static
+dberr_t
+row_scan_index_parallel(
+	row_prebuilt_t*		prebuilt,
+	const dict_index_t*	index,
+	bool			check_keys,
+	ulint*			n_rows)
+{
+	/* State of the scan of one range */
+	struct Range_state {
+		/** Number of records seen */
+		ulint		n_rows;
+
+		/** Memory for prev_entry */
+		mem_heap_t*	heap;
+
+		/** The last entry seen */
+		dtuple_t*	prev_entry;
+
+		/** Memory for first_rec and first_offsets */
+		mem_heap_t*	first_heap;
+
+		/** Copy of the first record seen */
+		const rec_t*	first_rec;
+
+		/** rec_get_offsets(first_rec, index) */
+		const ulint*	first_offsets;
+	};
+
+	using Range_states = std::vector<
+		Range_state, ut_allocator<Range_state>>;
+
+	trx_t*	trx = prebuilt->trx;
+
+	trx_start_if_not_started(trx, false);
+
+	if (prebuilt->sql_stat_start) {
+		/* This is a consistent read, assign a read view for the
+		query, as row_search_mvcc() would do. */
+		if (!srv_read_only_mode) {
+			trx_assign_read_view(trx);
+		}
+
+		prebuilt->sql_stat_start = FALSE;
+	}
+
+	Parallel_reader	reader(
+		const_cast<dict_index_t*>(index), trx,
+		srv_parallel_read_threads);
+
+	reader.partition();
+
+	Range_states	states(reader.n_ranges(), Range_state());
+
+	dberr_t	ret = reader.run(
+		[&](const Parallel_reader::Ctx& ctx) -> dberr_t
+		{
+			Range_state&	state = states[ctx.m_range];
+
+			++state.n_rows;
+
+			if (!check_keys) {
+				return(DB_SUCCESS);
+			}
+
+			if (state.heap == NULL) {
+				const ulint	size = rec_offs_get_n_alloc(
+					ctx.m_offsets) * sizeof *ctx.m_offsets;
+
+				state.heap = mem_heap_create(100);
+				state.first_heap = mem_heap_create(
+					size + rec_offs_size(ctx.m_offsets));
+
+				byte*	buf = static_cast<byte*>(
+					mem_heap_alloc(
+						state.first_heap,
+						rec_offs_size(ctx.m_offsets)));
+
+				ulint*	offsets = static_cast<ulint*>(
+					mem_heap_dup(
+						state.first_heap,
+						ctx.m_offsets, size));
+
+				state.first_rec = rec_copy(
+					buf, ctx.m_rec, offsets);
+
+				rec_offs_make_valid(
+					state.first_rec, index, offsets);
+
+				state.first_offsets = offsets;
+			} else {
+				/* Continue reading after an error */
+				row_scan_check_order(
+					state.prev_entry, ctx.m_rec, index,
+					ctx.m_offsets);
+			}
+
+			ulint	n_ext;
+
+			mem_heap_empty(state.heap);
+
+			state.prev_entry = row_rec_to_index_entry(
+				ctx.m_rec, index, ctx.m_offsets, &n_ext,
+				state.heap);
+
+			return(DB_SUCCESS);
+		});
+
+	const Range_state*	prev = NULL;
+
+	for (auto& state : states) {
+
+		*n_rows += state.n_rows;
+
+		if (state.heap == NULL) {
+			continue;
+		}
+
+		/* Check the order at the boundary of two ranges. */
+		if (prev != NULL) {
+			row_scan_check_order(
+				prev->prev_entry, state.first_rec, index,
+				state.first_offsets);
+		}
+
+		prev = &state;
+	}
+
+	for (auto& state : states) {
+		if (state.heap != NULL) {
+			mem_heap_free(state.heap);
+			mem_heap_free(state.first_heap);
+		}
+	}
+
+	switch (ret) {
+	case DB_SUCCESS:
+	case DB_INTERRUPTED:
+		break;
+	default:
+		ib::warn() << (check_keys ? "CHECK TABLE" : "COUNT(*)")
+			<< " on index " << index->name << " of"
+			" table " << index->table->name << " returned " << ret;
+		/* This error is ignored by CHECK TABLE */
+		ret = DB_SUCCESS;
+	}
+
+	return(ret);
+}
+
 /*********************************************************************//**
 Scans an index for either COUNT(*) or CHECK TABLE.
 If CHECK TABLE; Checks that the index contains entries in an ascending order,
@@ -4903,13 +5125,9 @@ row_scan_index_for_mysql(
 						seen in the consistent read */
 {
 	dtuple_t*	prev_entry	= NULL;
-	ulint		matched_fields;
 	byte*		buf;
 	dberr_t		ret;
 	rec_t*		rec;
-	int		cmp;
-	ibool		contains_null;
-	ulint		i;
 	ulint		cnt;
 	mem_heap_t*	heap		= NULL;
 	ulint		n_ext;
@@ -4938,6 +5156,17 @@ row_scan_index_for_mysql(
 		return(DB_SUCCESS);
 	}
 
+	/* A consistent read of the clustered index can be split among
+	threads. Locking reads and temporary tables use the serial scan. */
+	if (index->is_clustered()
+	    && srv_parallel_read_threads > 1
+	    && prebuilt->select_lock_type == LOCK_NONE
+	    && !index->table->is_temporary()) {
+
+		return(row_scan_index_parallel(
+			       prebuilt, index, check_keys, n_rows));
+	}
+
 	ulint bufsize = ut_max(UNIV_PAGE_SIZE, prebuilt->mysql_row_len);
 	buf = static_cast<byte*>(ut_malloc_nokey(bufsize));
 	heap = mem_heap_create(100);
@@ -4996,47 +5225,8 @@ func_exit:
 				  ULINT_UNDEFINED, &heap);
 
 	if (prev_entry != NULL) {
-		matched_fields = 0;
-
-		cmp = cmp_dtuple_rec_with_match(
-			prev_entry, rec, index, offsets, &matched_fields);
-		contains_null = FALSE;
-
-		/* In a unique secondary index we allow equal key values if
-		they contain SQL NULLs */
-
-		for (i = 0;
-		     i < dict_index_get_n_ordering_defined_by_user(index);
-		     i++) {
-			if (UNIV_SQL_NULL == dfield_get_len(
-				    dtuple_get_nth_field(prev_entry, i))) {
-
-				contains_null = TRUE;
-				break;
-			}
-		}
-
-		const char* msg;
-
-		if (cmp > 0) {
-			ret = DB_INDEX_CORRUPT;
-			msg = "index records in a wrong order in ";
-not_ok:
-			ib::error()
-				<< msg << index->name
-				<< " of table " << index->table->name
-				<< ": " << *prev_entry << ", "
-				<< rec_offsets_print(rec, offsets);
-			/* Continue reading */
-		} else if (dict_index_is_unique(index)
-			   && !contains_null
-			   && matched_fields
-			   >= dict_index_get_n_ordering_defined_by_user(
-				   index)) {
-			ret = DB_DUPLICATE_KEY;
-			msg = "duplicate key in ";
-			goto not_ok;
-		}
+		/* Continue reading after an error */
+		ret = row_scan_check_order(prev_entry, rec, index, offsets);
 	}
 
 	{
@@ -0,0 +1,463 @@
+/*****************************************************************************
+
+Copyright (c) 2017, Oracle and/or its affiliates. All Rights Reserved.
+
+This program is free software; you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation; version 2 of the License.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Suite 500, Boston, MA 02110-1335 USA
+
+*****************************************************************************/
+
+/**************************************************//**
+@file row/row0pread.cc
+Parallel read of a clustered index
+
+Created Oct 17, 2017
+*******************************************************/
+
+#include "row0pread.h"
+
+#include "btr0btr.h"
+#include "btr0cur.h"
+#include "btr0pcur.h"
+#include "dict0dict.h"
+#include "lock0lock.h"
+#include "mtr0mtr.h"
+#include "os0thread-create.h"
+#include "read0read.h"
+#include "rem0cmp.h"
+#include "rem0rec.h"
+#include "row0vers.h"
+#include "srv0srv.h"
+#include "trx0trx.h"
+
+/** Number of threads that read a clustered index in parallel, for
+COUNT(*) and CHECK TABLE */
+ulong	srv_parallel_read_threads = 4;
+
+#ifdef UNIV_PFS_THREAD
+mysql_pfs_key_t	parallel_read_thread_key;
+#endif /* UNIV_PFS_THREAD */
+
+/** Number of ranges to create per thread, so that threads that finish
+their ranges early can help with the rest */
+static const size_t	PARALLEL_READ_RANGES_PER_THREAD = 8;
+
+/** Check for interruption after this many records */
+static const ulint	PARALLEL_READ_CHECK_INTERRUPT = 1000;
+
+/** Number of parallel read threads that are running, across all the
+readers. Limited to MAX_PARALLEL_READ_THREADS, because the threads are
+counted in srv_max_n_threads. */
+static std::atomic<size_t>	parallel_read_n_threads(0);
+
+/** Reserve threads for a parallel read.
+@param[in]	n	number of threads wanted
+@return number of threads reserved, 0 .. n */
+static
+size_t
+parallel_read_reserve_threads(size_t n)
+{
+	size_t	active = parallel_read_n_threads.load();
+
+	for (;;) {
+		if (active >= MAX_PARALLEL_READ_THREADS) {
+			return(0);
+		}
+
+		size_t	reserve = std::min(
+			n, size_t(MAX_PARALLEL_READ_THREADS) - active);
+
+		if (parallel_read_n_threads.compare_exchange_weak(
+			    active, active + reserve)) {
+
+			return(reserve);
+		}
+	}
+}
+
+/** Release threads reserved with parallel_read_reserve_threads().
+@param[in]	n	number of threads to release */
+static
+void
+parallel_read_release_threads(size_t n)
+{
+	ut_ad(parallel_read_n_threads.load() >= n);
+
+	parallel_read_n_threads.fetch_sub(n);
+}
+
+/** Move the cursor to the next user record of the index. The page latch
+is released at page boundaries, so that a long range does not keep an
+mtr open for the whole scan.
+@param[in,out]	pcur	persistent cursor
+@param[in,out]	mtr	mini-transaction
+@return false if the cursor went past the last record of the index */
+static
+bool
+parallel_read_move_to_next(
+	btr_pcur_t*	pcur,
+	mtr_t*		mtr)
+{
+	btr_pcur_move_to_next_on_page(pcur);
+
+	if (!btr_pcur_is_after_last_on_page(pcur)) {
+
+		ut_ad(btr_pcur_is_on_user_rec(pcur));
+		return(true);
+	}
+
+	if (btr_pcur_is_after_last_in_tree(pcur, mtr)) {
+
+		return(false);
+	}
+
+	/* Store the cursor position on the last user record of the
+	page, and restart the mini-transaction. */
+	btr_pcur_move_to_prev_on_page(pcur);
+
+	btr_pcur_store_position(pcur, mtr);
+
+	mtr_commit(mtr);
+
+	mtr_start(mtr);
+
+	/* Restore position on the record, or its predecessor if the
+	record was purged meanwhile, and move to its successor. */
+	btr_pcur_restore_position(BTR_SEARCH_LEAF, pcur, mtr);
+
+	return(btr_pcur_move_to_next_user_rec(pcur, mtr));
+}
+
+/** Constructor
+@param[in]	index		clustered index to read
+@param[in]	trx		transaction whose read view is used,
+				or whose interrupted state is checked
+				if it has no read view (READ
+				UNCOMMITTED)
+@param[in]	n_threads	maximum number of threads to use,
+				including the calling thread */
+Parallel_reader::Parallel_reader(
+	dict_index_t*	index,
+	trx_t*		trx,
+	size_t		n_threads)
+	:
+	m_index(index),
+	m_trx(trx),
+	m_view(),
+	m_n_threads(std::max(n_threads, size_t(1))),
+	m_heap(mem_heap_create(1024)),
+	m_next_range(0),
+	m_err(DB_SUCCESS)
+{
+	ut_ad(index->is_clustered());
+
+	/* There is no read view in read-only mode, all the records are
+	visible. */
+	if (trx->isolation_level > TRX_ISO_READ_UNCOMMITTED
+	    && MVCC::is_view_active(trx->read_view)) {
+
+		m_view = trx->read_view;
+	}
+}
+
+/** Destructor */
+Parallel_reader::~Parallel_reader()
+{
+	mem_heap_free(m_heap);
+}
+
+/** Copy the key of a node pointer record.
+@param[in]	rec		node pointer record
+@param[in]	offsets		rec_get_offsets(rec, m_index)
+@return the key, allocated from m_heap */
+const dtuple_t*
+Parallel_reader::copy_key(const rec_t* rec, const ulint* offsets)
+{
+	byte*	buf = static_cast<byte*>(
+		mem_heap_alloc(m_heap, rec_offs_size(offsets)));
+
+	rec_t*	copy = rec_copy(buf, rec, offsets);
+
+	return(dict_index_build_data_tuple(
+		       m_index, copy,
+		       dict_index_get_n_unique_in_tree(m_index), m_heap));
+}
+
+/** Split the index into key ranges at the node pointers of the
+highest B-tree level that has enough of them for the threads. */
+void
+Parallel_reader::partition()
+{
+	ut_ad(m_ranges.empty());
+
+	const size_t		target = m_n_threads
+		* PARALLEL_READ_RANGES_PER_THREAD;
+	const page_size_t	page_size(dict_table_page_size(m_index->table));
+	const space_id_t	space_id = dict_index_get_space(m_index);
+	const ulint		comp = dict_table_is_comp(m_index->table);
+
+	std::vector<page_no_t, ut_allocator<page_no_t>>	pages;
+	std::vector<page_no_t, ut_allocator<page_no_t>>	children;
+	std::vector<const dtuple_t*, ut_allocator<const dtuple_t*>> keys;
+
+	mem_heap_t*	heap = NULL;
+	ulint		offsets_[REC_OFFS_NORMAL_SIZE];
+	ulint*		offsets = offsets_;
+	mtr_t		mtr;
+
+	rec_offs_init(offsets_);
+
+	mtr_start(&mtr);
+
+	/* Block structure modifications of the tree while the node
+	pointers are read, the leaf pages are not latched. */
+	mtr_s_lock(dict_index_get_lock(m_index), &mtr);
+
+	buf_block_t*	block = btr_root_block_get(m_index, RW_S_LATCH, &mtr);
+	ulint		level = btr_page_get_level(
+		buf_block_get_frame(block), &mtr);
+
+	pages.push_back(block->page.id.page_no());
+
+	/* Descend from the root until a level has enough node pointers,
+	or the next level would be the leaf level. */
+	while (level > 0) {
+
+		keys.clear();
+		children.clear();
+
+		for (auto page_no : pages) {
+
+			block = btr_block_get(
+				page_id_t(space_id, page_no), page_size,
+				RW_S_LATCH, m_index, &mtr);
+
+			const page_t*	page = buf_block_get_frame(block);
+
+			ut_ad(btr_page_get_level(page, &mtr) == level);
+
+			for (const rec_t* rec = page_rec_get_next_const(
+				     page_get_infimum_rec(page));
+			     !page_rec_is_supremum(rec);
+			     rec = page_rec_get_next_const(rec)) {
+
+				offsets = rec_get_offsets(
+					rec, m_index, offsets,
+					ULINT_UNDEFINED, &heap);
+
+				children.push_back(
+					btr_node_ptr_get_child_page_no(
+						rec, offsets));
+
+				/* The leftmost node pointer of a level
+				stands for the lowest possible key. */
+				if (rec_get_info_bits(rec, comp)
+				    & REC_INFO_MIN_REC_FLAG) {
+
+					continue;
+				}
+
+				keys.push_back(copy_key(rec, offsets));
+			}
+		}
+
+		--level;
+
+		if (keys.size() + 1 >= target || level == 0) {
+			break;
+		}
+
+		pages.swap(children);
+	}
+
+	mtr_commit(&mtr);
+
+	if (heap != NULL) {
+		mem_heap_free(heap);
+	}
+
+	/* The keys of one level are in ascending order. */
+	const dtuple_t*	start = NULL;
+
+	for (auto key : keys) {
+		m_ranges.push_back({start, key});
+		start = key;
+	}
+
+	m_ranges.push_back({start, NULL});
+
+	m_n_threads = std::min(m_n_threads, m_ranges.size());
+}
+
+/** Read one range.
+@param[in]	thread_id	thread that reads the range
+@param[in]	range_id	range to read
+@param[in]	f		callback for each visible record
+@return DB_SUCCESS or error code */
+dberr_t
+Parallel_reader::read_range(size_t thread_id, size_t range_id, const F& f)
+{
+	const Range&	range = m_ranges[range_id];
+	const ulint	comp = dict_table_is_comp(m_index->table);
+	dberr_t		err = DB_SUCCESS;
+	mem_heap_t*	heap = mem_heap_create(1024);
+	ulint		offsets_[REC_OFFS_NORMAL_SIZE];
+	ulint		n_recs = 0;
+	btr_pcur_t	pcur;
+	mtr_t		mtr;
+
+	rec_offs_init(offsets_);
+
+	mtr_start(&mtr);
+
+	if (range.m_start == NULL) {
+		btr_pcur_open_at_index_side(
+			true, m_index, BTR_SEARCH_LEAF, &pcur, true, 0, &mtr);
+	} else {
+		btr_pcur_open(
+			m_index, range.m_start, PAGE_CUR_GE,
+			BTR_SEARCH_LEAF, &pcur, &mtr);
+	}
+
+	/* The cursor is on the first record of the range, or before it. */
+	bool	on_rec = btr_pcur_is_on_user_rec(&pcur)
+		|| btr_pcur_move_to_next_user_rec(&pcur, &mtr);
+
+	for (; on_rec; on_rec = parallel_read_move_to_next(&pcur, &mtr)) {
+
+		if (++n_recs % PARALLEL_READ_CHECK_INTERRUPT == 0) {
+
+			if (trx_is_interrupted(m_trx)) {
+				err = DB_INTERRUPTED;
+				break;
+			}
+
+			/* Another thread failed, the result is lost. */
+			if (m_err.load() != DB_SUCCESS) {
+				break;
+			}
+		}
+
+		const rec_t*	rec = btr_pcur_get_rec(&pcur);
+		ulint*		offsets = offsets_;
+
+		mem_heap_empty(heap);
+
+		offsets = rec_get_offsets(
+			rec, m_index, offsets, ULINT_UNDEFINED, &heap);
+
+		if (range.m_end != NULL
+		    && cmp_dtuple_rec(range.m_end, rec, m_index, offsets)
+		    <= 0) {
+
+			break;
+		}
+
+		if (m_view != NULL
+		    && !lock_clust_rec_cons_read_sees(
+			    rec, m_index, offsets, m_view)) {
+
+			rec_t*	old_vers;
+
+			err = row_vers_build_for_consistent_read(
+				rec, &mtr, m_index, &offsets, m_view, &heap,
+				heap, &old_vers, NULL);
+
+			if (err != DB_SUCCESS) {
+				break;
+			}
+
+			if (old_vers == NULL) {
+				/* The record did not exist in the view. */
+				continue;
+			}
+
+			rec = old_vers;
+		}
+
+		if (rec_get_deleted_flag(rec, comp)) {
+			continue;
+		}
+
+		const Ctx	ctx = {thread_id, range_id, rec, offsets};
+
+		err = f(ctx);
+
+		if (err != DB_SUCCESS) {
+			break;
+		}
+	}
+
+	btr_pcur_close(&pcur);
+
+	mtr_commit(&mtr);
+
+	mem_heap_free(heap);
+
+	return(err);
+}
+
+/** Read ranges until there are no more or an error occurs.
+@param[in]	thread_id	thread id
+@param[in]	f		callback for each visible record */
+void
+Parallel_reader::worker(size_t thread_id, const F* f)
+{
+	for (;;) {
+		const size_t	range = m_next_range.fetch_add(1);
+
+		if (range >= m_ranges.size()
+		    || m_err.load() != DB_SUCCESS) {
+
+			break;
+		}
+
+		dberr_t	err = read_range(thread_id, range, *f);
+
+		if (err != DB_SUCCESS) {
+			int	expected = DB_SUCCESS;
+
+			m_err.compare_exchange_strong(expected, err);
+			break;
+		}
+	}
+}
+
+/** Read the ranges, the calling thread takes part in the read.
+@param[in]	f	callback for each visible record
+@return DB_SUCCESS, DB_INTERRUPTED, or the error returned by f */
+dberr_t
+Parallel_reader::run(F&& f)
+{
+	ut_ad(!m_ranges.empty());
+
+	const F		callback(std::move(f));
+	const size_t	n_reserved = parallel_read_reserve_threads(
+		m_n_threads - 1);
+
+	Helper_threads	helpers;
+
+	for (size_t i = 1; i <= n_reserved; ++i) {
+
+		helpers.start(
+			parallel_read_thread_key, &Parallel_reader::worker,
+			this, i, &callback);
+	}
+
+	worker(0, &callback);
+
+	helpers.join();
+
+	parallel_read_release_threads(n_reserved);
+
+	return(static_cast<dberr_t>(m_err.load()));
+}
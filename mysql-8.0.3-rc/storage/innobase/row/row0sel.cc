@@ -4566,6 +4566,63 @@ row_sel_fill_vrow(
 	}
 }
 
+/** Returns the next row of the batch that an earlier call of
+row_search_mvcc() prefetched into the server's record buffer or into the
+prefetch cache of the handle. This is the same as PHASE 1 of
+row_search_mvcc(), after the same checks of the table and the index.
+@param[out]	buf		buffer for the fetched row in MySQL format
+@param[in,out]	prebuilt	prebuilt struct for the table handler
+@param[in]	direction	ROW_SEL_NEXT or ROW_SEL_PREV
+@return true if a row was returned in buf, false if the batch is exhausted
+and row_search_mvcc() must be called */
+bool
+row_search_fetch_cached(
+	byte*		buf,
+	row_prebuilt_t*	prebuilt,
+	ulint		direction)
+{
+	if (prebuilt->n_fetch_cached == 0
+	    || direction == 0
+	    || direction != prebuilt->fetch_direction) {
+
+		/* Let row_search_mvcc() handle the end of the batch and
+		a change of direction. */
+		return(false);
+	}
+
+	ut_ad(prebuilt->magic_n == ROW_PREBUILT_ALLOCATED);
+	ut_ad(!prebuilt->table->is_intrinsic());
+
+	if (dict_table_is_discarded(prebuilt->table)
+	    || prebuilt->table->ibd_file_missing
+	    || !prebuilt->index_usable
+	    || prebuilt->index->is_corrupted()) {
+
+		/* Let row_search_mvcc() return the error. */
+		return(false);
+	}
+
+	DEBUG_SYNC_C("row_search_fetch_cached");
+
+	prebuilt->new_rec_locks = 0;
+
+	row_sel_dequeue_cached_row_for_mysql(buf, prebuilt);
+
+	prebuilt->n_rows_fetched++;
+
+	/* row_search_mvcc() would set trx->op_info to "fetching rows" and
+	clear it again on return, so there is nothing to show here. The row
+	was not returned by a semi-consistent read, so reset the flag like
+	row_search_mvcc() does on return. */
+	prebuilt->trx->op_info = "";
+
+	if (prebuilt->row_read_type != ROW_READ_WITH_LOCKS) {
+		prebuilt->row_read_type = ROW_READ_TRY_SEMI_CONSISTENT;
+	}
+
+	return(true);
+}
+
 /** Searches for rows in the database using cursor.
 Function is mainly used for tables that are shared accorss connection and
 so it employs technique that can help re-construct the rows that
@@ -423,6 +423,12 @@ static monitor_info_t	innodb_counter_info[] =
 	 MONITOR_NONE,
 	 MONITOR_DEFAULT_START, MONITOR_LRU_GET_FREE_WAITS},
 
+	{"buffer_LRU_get_free_cleaner_waits", "buffer",
+	 "Total waits for the page cleaner to refill the free list"
+	 " in LRU get free",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_LRU_GET_FREE_CLEANER_WAITS},
+
 	{"buffer_flush_avg_page_rate", "buffer",
 	 "Average number of pages at which flushing is happening",
 	 MONITOR_NONE,
@@ -443,6 +449,12 @@ static monitor_info_t	innodb_counter_info[] =
 	 MONITOR_NONE,
 	 MONITOR_DEFAULT_START, MONITOR_FLUSH_PCT_FOR_LSN},
 
+	{"buffer_flush_pct_for_lsn_correction", "buffer",
+	 "Percent of IO capacity added to buffer_flush_pct_for_lsn"
+	 " while the checkpoint age stays above its target",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_FLUSH_PCT_FOR_LSN_CORRECTION},
+
 	{"buffer_flush_sync_waits", "buffer",
 	 "Number of times a wait happens due to sync flushing",
 	 MONITOR_NONE,
@@ -890,6 +902,27 @@ static monitor_info_t	innodb_counter_info[] =
 	 MONITOR_DISPLAY_CURRENT,
 	 MONITOR_DEFAULT_START, MONITOR_PURGE_RESUME_COUNT},
 
+	{"purge_undo_log_records", "purge",
+	 "Number of undo log records handed to the purge threads",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_PURGE_N_RECS},
+
+	{"purge_threads_active", "purge",
+	 "Number of purge threads that got work in the last purge batch",
+	 MONITOR_DISPLAY_CURRENT,
+	 MONITOR_DEFAULT_START, MONITOR_PURGE_N_THREADS},
+
+	{"purge_batch_tables", "purge",
+	 "Number of tables with undo log records in the last purge batch",
+	 MONITOR_DISPLAY_CURRENT,
+	 MONITOR_DEFAULT_START, MONITOR_PURGE_N_TABLES},
+
+	{"purge_batch_max_thread_records", "purge",
+	 "Largest number of undo log records given to one purge thread"
+	 " in the last purge batch",
+	 MONITOR_DISPLAY_CURRENT,
+	 MONITOR_DEFAULT_START, MONITOR_PURGE_MAX_THREAD_RECS},
+
 	/* ========== Counters for Recovery Module ========== */
 	{"module_log", "recovery", "Recovery Module",
 	 MONITOR_MODULE,
@@ -973,6 +1006,18 @@ static monitor_info_t	innodb_counter_info[] =
 	 MONITOR_EXISTING | MONITOR_DEFAULT_ON),
 	 MONITOR_DEFAULT_START, MONITOR_OVLD_LOG_PADDED},
 
+	{"log_wait_spin_hits", "recovery",
+	 "Number of times the log was written or flushed while a thread was"
+	 " spinning for it (innodb_log_wait_spin_rounds)",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_LOG_WAIT_SPIN_HITS},
+
+	{"log_wait_event_waits", "recovery",
+	 "Number of times a thread slept waiting for the log writer or"
+	 " the log flusher thread",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_LOG_WAIT_EVENT_WAITS},
+
 	/* ========== Counters for Page Compression ========== */
 	{"module_compress", "compression", "Page Compression Info",
 	 MONITOR_MODULE,
@@ -1079,6 +1124,24 @@ static monitor_info_t	innodb_counter_info[] =
 	 MONITOR_NONE,
 	 MONITOR_DEFAULT_START, MONITOR_ADAPTIVE_HASH_ROW_UPDATED},
 
+	{"adaptive_hash_pages_queued", "adaptive_hash_index",
+	 "Number of index pages queued for a background Adaptive Hash Index"
+	 " build",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_ADAPTIVE_HASH_PAGE_QUEUED},
+
+	{"adaptive_hash_index_disabled", "adaptive_hash_index",
+	 "Number of times Adaptive Hash Index searches were turned off for an"
+	 " index because too few of them succeeded",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_ADAPTIVE_HASH_INDEX_DISABLED},
+
+	{"adaptive_hash_index_enabled", "adaptive_hash_index",
+	 "Number of times Adaptive Hash Index searches were turned back on"
+	 " for an index",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_ADAPTIVE_HASH_INDEX_ENABLED},
+
 	/* ========== Counters for tablespace ========== */
 	{"module_file", "file_system", "Tablespace and File System Manager",
 	 MONITOR_MODULE,
@@ -1141,6 +1204,28 @@ static monitor_info_t	innodb_counter_info[] =
 	 MONITOR_EXISTING | MONITOR_DEFAULT_ON),
 	 MONITOR_DEFAULT_START, MONITOR_OVLD_IBUF_SIZE},
 
+	{"ibuf_merge_requests", "change_buffer",
+	 "Number of change buffer merges handed to the merge thread",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_IBUF_MERGE_REQUESTS},
+
+	{"ibuf_merge_sync_contractions", "change_buffer",
+	 "Number of times a thread inserting to the change buffer had to"
+	 " merge it itself",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_IBUF_MERGE_SYNC_CONTRACTIONS},
+
+	{"ibuf_merge_read_pages", "change_buffer",
+	 "Number of pages read by in-order background change buffer merges",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_IBUF_MERGE_READ_PAGES},
+
+	{"ibuf_merge_backlog", "change_buffer",
+	 "Change buffer pages above its maximum size, as last seen by the"
+	 " merge thread",
+	 MONITOR_DISPLAY_CURRENT,
+	 MONITOR_DEFAULT_START, MONITOR_IBUF_MERGE_BACKLOG},
+
 	/* ========== Counters for server operations ========== */
 	{"module_innodb", "innodb",
 	 "Counter for general InnoDB server wide operations and properties",
@@ -1919,7 +2004,7 @@ srv_mon_process_existing_counter(
 		break;
 
 	case MONITOR_OVLD_LSN_CURRENT:
-		value = (mon_type_t) log_sys->lsn;
+		value = (mon_type_t) log_get_lsn();
 		break;
 
 	case MONITOR_OVLD_BUF_OLDEST_LSN:
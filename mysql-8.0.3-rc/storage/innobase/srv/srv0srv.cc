@@ -154,6 +154,9 @@ bool	srv_file_per_table;
 
 /** Sort buffer size in index creation */
 ulong	srv_sort_buf_size = 1048576;
+/** Number of threads that sort and load the secondary indexes in index
+creation */
+ulong	srv_index_build_threads = 4;
 /** Maximum modification log file size for online index creation */
 unsigned long long	srv_online_max_size;
 /** Set if InnoDB operates in read-only mode or innodb-force-recovery
@@ -169,8 +172,18 @@ bool	srv_use_native_aio = TRUE; /* enabled by default on Windows */
 #else
 bool	srv_use_native_aio;
 #endif
+/* If this flag is TRUE, then Linux native aio uses io_uring, if the
+kernel supports it, otherwise libaio */
+bool	srv_use_io_uring;
 bool	srv_numa_interleave = FALSE;
 
+/** Zstandard level of transparent page compression */
+ulong	srv_compression_zstd_level = 3;
+
+/** Maximum size in bytes of the Zstandard dictionary trained for a
+tablespace, or 0 to compress without dictionaries */
+ulong	srv_compression_zstd_dict_size;
+
 #ifdef UNIV_DEBUG
 /** Force all user tables to use page compression. */
 ulong	srv_debug_compress;
@@ -210,6 +223,9 @@ uint		srv_flush_log_at_timeout = 1;
 ulong		srv_page_size = UNIV_PAGE_SIZE_DEF;
 ulong		srv_page_size_shift = UNIV_PAGE_SIZE_SHIFT_DEF;
 ulong		srv_log_write_ahead_size = 0;
+/** Number of rounds to spin waiting for the log writer or flusher thread
+before sleeping on an event */
+ulong		srv_log_wait_spin_rounds = 0;
 
 page_size_t	univ_page_size(0, 0, false);
 
@@ -259,6 +275,10 @@ ulint	srv_buf_pool_base_size	= 0;
 long long	srv_buf_pool_curr_size	= 0;
 /** Dump this % of each buffer pool during BP dump */
 ulong	srv_buf_pool_dump_pct;
+/** Format of the buffer pool dump file, see buf_dump_format_t */
+ulong	srv_buf_pool_dump_format;
+/** Number of threads that read the pages of a buffer pool load */
+ulong	srv_buf_pool_load_threads = 4;
 /** Lock table size in bytes */
 ulint	srv_lock_table_size	= ULINT_MAX;
 
@@ -273,6 +293,10 @@ bool	srv_random_read_ahead	= FALSE;
 in the buffer cache and accessed sequentially for InnoDB to trigger a
 readahead request. */
 ulong	srv_read_ahead_threshold	= 56;
+/* Maximum number of B-tree leaf pages that a scanning cursor reads ahead
+of its position, following the node pointers of the parent page. 0 disables
+the leaf read-ahead. */
+ulong	srv_read_ahead_leaf_pages	= 32;
 
 /** Maximum on-disk size of change buffer in terms of percentage
 of the buffer pool. */
@@ -311,6 +335,9 @@ ulong	srv_flushing_avg_loops		= 30;
 /* The number of purge threads to use.*/
 ulong	srv_n_purge_threads = 4;
 
+/** Number of threads that apply a batch of redo log records in recovery */
+ulong	srv_n_recv_apply_threads = 4;
+
 /* the number of pages to purge in one batch */
 ulong	srv_purge_batch_size = 20;
 
@@ -372,6 +399,13 @@ bool		srv_stats_persistent = TRUE;
 bool		srv_stats_include_delete_marked = FALSE;
 unsigned long long	srv_stats_persistent_sample_pages = 20;
 bool		srv_stats_auto_recalc = TRUE;
+/* Number of threads that analyze the indexes of a table when persistent
+statistics are calculated */
+ulong		srv_stats_analyze_threads = 4;
+
+/* Whether hot index pages keep a cache of the key prefixes of their page
+directory slots, so that a binary search on the page decodes fewer records */
+bool	srv_page_search_cache	= false;
 
 ibool	srv_use_doublewrite_buf	= TRUE;
 
@@ -1722,26 +1756,40 @@ srv_any_background_threads_are_active()
 	if (srv_read_only_mode) {
 		if (srv_buf_resize_thread_active) {
 			thread_active = "buf_resize_thread";
+		} else if (btr_search_build_thread_active) {
+			thread_active = "btr_search_build_thread";
 		}
 		os_event_set(srv_buf_resize_event);
+		os_event_set(btr_search_build_event);
 		return(thread_active);
 	} else if (srv_error_monitor_active) {
 		thread_active = "srv_error_monitor_thread";
 	} else if (lock_sys->timeout_thread_active) {
 		thread_active = "srv_lock_timeout thread";
+	} else if (lock_sys->deadlock_thread_active) {
+		thread_active = "lock_deadlock_detector_thread";
 	} else if (srv_monitor_active) {
 		thread_active = "srv_monitor_thread";
 	} else if (srv_buf_dump_thread_active) {
 		thread_active = "buf_dump_thread";
 	} else if (srv_buf_resize_thread_active) {
 		thread_active = "buf_resize_thread";
+	} else if (btr_search_build_thread_active) {
+		thread_active = "btr_search_build_thread";
+	} else if (ibuf_merge_thread_active) {
+		thread_active = "ibuf_merge_thread";
+	} else if (fsp_zstd_dict_n_threads.load() > 0) {
+		thread_active = "fsp_zstd_dict_thread";
 	}
 
 	os_event_set(srv_error_event);
 	os_event_set(srv_monitor_event);
 	os_event_set(srv_buf_dump_event);
 	os_event_set(lock_sys->timeout_event);
+	os_event_set(lock_sys->deadlock_event);
 	os_event_set(srv_buf_resize_event);
+	os_event_set(btr_search_build_event);
+	os_event_set(ibuf_merge_event);
 
 	return(thread_active);
 }
@@ -2666,9 +2714,16 @@ srv_do_purge(
 	}
 
 	do {
-		if (trx_sys->rseg_history_len > rseg_history_len
-		    || (srv_max_purge_lag > 0
-			&& rseg_history_len > srv_max_purge_lag)) {
+		if (srv_max_purge_lag > 0
+		    && trx_sys->rseg_history_len > srv_max_purge_lag) {
+
+			/* DML is being delayed because purge is lagging.
+			Use all the threads right away rather than adding
+			them one batch at a time. */
+
+			n_use_threads = n_threads;
+
+		} else if (trx_sys->rseg_history_len > rseg_history_len) {
 
 			/* History length is now longer than what it was
 			when we took the last snapshot. Use more threads. */
@@ -45,6 +45,7 @@ Created 2/16/1996 Heikki Tuuri
 
 #include "btr0btr.h"
 #include "btr0cur.h"
+#include "btr0sea.h"
 #include "buf0buf.h"
 #include "buf0dump.h"
 #include "current_thd.h"
@@ -185,17 +186,28 @@ static char*	srv_monitor_file_name;
 /* Keys to register InnoDB threads with performance schema */
 #ifdef UNIV_PFS_THREAD
 mysql_pfs_key_t	archiver_thread_key;
+mysql_pfs_key_t	btr_search_build_thread_key;
+mysql_pfs_key_t	buf_dblwr_recover_thread_key;
 mysql_pfs_key_t	buf_dump_thread_key;
+mysql_pfs_key_t	buf_load_thread_key;
 mysql_pfs_key_t	buf_resize_thread_key;
+mysql_pfs_key_t	dict_stats_analyze_thread_key;
 mysql_pfs_key_t	dict_stats_thread_key;
+mysql_pfs_key_t	fil_scan_thread_key;
+mysql_pfs_key_t	fsp_zstd_dict_thread_key;
 mysql_pfs_key_t	fts_optimize_thread_key;
 mysql_pfs_key_t	fts_parallel_merge_thread_key;
 mysql_pfs_key_t	fts_parallel_tokenization_thread_key;
+mysql_pfs_key_t	ibuf_merge_thread_key;
+mysql_pfs_key_t	index_build_thread_key;
 mysql_pfs_key_t	io_handler_thread_key;
 mysql_pfs_key_t	io_ibuf_thread_key;
 mysql_pfs_key_t	io_log_thread_key;
 mysql_pfs_key_t	io_read_thread_key;
 mysql_pfs_key_t	io_write_thread_key;
+mysql_pfs_key_t	lock_deadlock_detector_thread_key;
+mysql_pfs_key_t	log_flusher_thread_key;
+mysql_pfs_key_t	log_writer_thread_key;
 mysql_pfs_key_t	srv_error_monitor_thread_key;
 mysql_pfs_key_t	srv_lock_timeout_thread_key;
 mysql_pfs_key_t	srv_master_thread_key;
@@ -1586,8 +1598,10 @@ srv_shutdown_all_bg_threads()
 		if (!srv_read_only_mode) {
 
 			if (srv_start_state_is_set(SRV_START_STATE_LOCK_SYS)) {
-				/* a. Let the lock timeout thread exit */
+				/* a. Let the lock timeout thread and the
+				deadlock detector thread exit */
 				os_event_set(lock_sys->timeout_event);
+				os_event_set(lock_sys->deadlock_event);
 			}
 
 			/* b. srv error monitor thread exits automatically,
@@ -1628,6 +1642,23 @@ srv_shutdown_all_bg_threads()
 		logs_empty_and_mark_files_at_shutdown() and should have
 		already quit or is quitting right now. */
 
+		/* g. Stop the log writer and the log flusher threads. */
+		if (log_sys != NULL && !srv_read_only_mode) {
+			log_stop_background_threads();
+		}
+
+		/* Stop the adaptive hash index build thread. */
+		if (btr_search_build_thread_active) {
+
+			os_event_set(btr_search_build_event);
+		}
+
+		/* Stop the change buffer merge thread. */
+		if (ibuf_merge_thread_active) {
+
+			os_event_set(ibuf_merge_event);
+		}
+
 		/* Stop archiver thread. */
 		if (archiver_is_active) {
 
@@ -1723,7 +1754,7 @@ srv_prepare_to_delete_redo_log_files(
 
 		log_mutex_enter();
 
-		flushed_lsn = log_sys->lsn;
+		flushed_lsn = log_get_lsn();
 
 		{
 			ib::info	info;
@@ -2369,6 +2400,8 @@ files_checked:
 
 		recv_sys->dblwr.pages.clear();
 
+		buf_dblwr_free_recv_buf();
+
 		if (err == DB_SUCCESS) {
 			/* Initialize the change buffer. */
 			err = dict_boot();
@@ -2687,6 +2720,12 @@ files_checked:
 			srv_lock_timeout_thread_key,
 			lock_wait_timeout_thread);
 
+		/* Create the thread which resolves deadlocks when
+		innodb_deadlock_detect_async is set */
+		os_thread_create(
+			lock_deadlock_detector_thread_key,
+			lock_deadlock_detector_thread);
+
 		/* Create the thread which warns of long semaphore waits */
 		os_thread_create(
 			srv_error_monitor_thread_key,
@@ -2888,11 +2927,18 @@ srv_start_threads(
 {
 	os_thread_create(buf_resize_thread_key, buf_resize_thread);
 
+	/* Create the thread which builds adaptive hash indexes */
+	os_thread_create(btr_search_build_thread_key, btr_search_build_thread);
+
 	if (srv_read_only_mode) {
 		purge_sys->state = PURGE_STATE_DISABLED;
 		return;
 	}
 
+	/* From now on the commits wait for the log writer and the log
+	flusher threads to write and flush the redo log. */
+	log_start_background_threads();
+
 	if (!bootstrap && srv_force_recovery < SRV_FORCE_NO_TRX_UNDO
 	    && trx_sys_need_rollback()) {
 		/* Rollback all recovered transactions that are
@@ -2921,6 +2967,12 @@ srv_start_threads(
 		ibuf_update_max_tablespace_id();
 	}
 
+	if (srv_force_recovery < SRV_FORCE_NO_IBUF_MERGE) {
+		/* Create the thread which merges the change buffer when
+		it has grown too big */
+		os_thread_create(ibuf_merge_thread_key, ibuf_merge_thread);
+	}
+
 	/* Create the buffer pool dump/load thread */
 	os_thread_create(buf_dump_thread_key, buf_dump_thread);
 
@@ -43,6 +43,7 @@ unsigned int mysql_pfs_key_t::s_count = 0;
 /* Key to register autoinc_mutex with performance schema */
 mysql_pfs_key_t	autoinc_mutex_key;
 mysql_pfs_key_t	autoinc_persisted_mutex_key;
+mysql_pfs_key_t	ahi_build_queue_mutex_key;
 #  ifndef PFS_SKIP_BUFFER_MUTEX_RWLOCK
 mysql_pfs_key_t	buffer_block_mutex_key;
 #  endif /* !PFS_SKIP_BUFFER_MUTEX_RWLOCK */
@@ -107,9 +108,11 @@ mysql_pfs_key_t	trx_undo_mutex_key;
 mysql_pfs_key_t	trx_mutex_key;
 mysql_pfs_key_t	trx_pool_mutex_key;
 mysql_pfs_key_t	trx_pool_manager_mutex_key;
-mysql_pfs_key_t	lock_mutex_key;
+mysql_pfs_key_t	lock_sys_page_mutex_key;
+mysql_pfs_key_t	lock_sys_table_mutex_key;
 mysql_pfs_key_t	lock_wait_mutex_key;
 mysql_pfs_key_t	trx_sys_mutex_key;
+mysql_pfs_key_t	mvcc_view_mutex_key;
 mysql_pfs_key_t	srv_sys_mutex_key;
 mysql_pfs_key_t	srv_threads_mutex_key;
 #  ifndef PFS_SKIP_EVENT_MUTEX
@@ -137,6 +140,8 @@ mysql_pfs_key_t	buf_block_lock_key;
 mysql_pfs_key_t	buf_block_debug_latch_key;
 # endif /* UNIV_DEBUG */
 mysql_pfs_key_t	checkpoint_lock_key;
+mysql_pfs_key_t	log_sn_lock_key;
+mysql_pfs_key_t	lock_sys_latch_key;
 mysql_pfs_key_t	undo_spaces_lock_key;
 mysql_pfs_key_t	rsegs_lock_key;
 mysql_pfs_key_t	dict_operation_lock_key;
@@ -24,6 +24,7 @@ Created 3/26/1996 Heikki Tuuri
 *******************************************************/
 
 #include <sys/types.h>
+#include <algorithm>
 #include <new>
 
 #include "fsp0fsp.h"
@@ -1731,17 +1732,24 @@ trx_purge_fetch_next_rec(
 	return(trx_purge_get_next_rec(n_pages_handled, heap));
 }
 
-/** This function runs a purge batch.
-@param[in]	n_purge_threads	number of purge threads
+/** Distribute the undo records of one purge batch to the purge threads.
+All the records of a table go to the same thread, so that the threads do
+not contend on the index latches and pages of the same table. The tables
+are handed out largest first, each to the thread that has been given the
+fewest records so far.
+@param[in]	n_purge_threads	number of purge threads available
 @param[in,out]	purge_sys	purge instance
 @param[in]	batch_size	no. of pages to purge
+@param[out]	n_used		number of purge threads given work; the
+				first n_used purge query threads must be run
 @return number of undo log pages handled in the batch */
 static
 ulint
 trx_purge_attach_undo_recs(
 	const ulint	n_purge_threads,
 	trx_purge_t*	purge_sys,
-	ulint		batch_size)
+	ulint		batch_size,
+	ulint*		n_used)
 {
 	que_thr_t*	thr;
 	ulint		n_pages_handled = 0;
@@ -1753,7 +1761,7 @@ trx_purge_attach_undo_recs(
 
 	que_thr_t*	run_thrs[MAX_PURGE_THREADS];
 
-	/* Validate some pre-requisites and reset done flag. */
+	/* Validate some pre-requisites. */
 	ulint		i = 0;
 
 	for (thr = UT_LIST_GET_FIRST(purge_sys->query->thrs);
@@ -1769,8 +1777,6 @@ trx_purge_attach_undo_recs(
 		ut_a(node->recs == nullptr);
 		ut_a(node->done);
 
-		node->done = false;
-
 		ut_a(!thr->is_active);
 
 		run_thrs[i] = thr;
@@ -1795,6 +1801,8 @@ trx_purge_attach_undo_recs(
 		GroupBy::key_compare{},
 		mem_heap_allocator<GroupBy::value_type>{heap}};
 
+	ulint		n_recs = 0;
+
 	for (ulint i = 0; n_pages_handled < batch_size; ++i) {
 
 		/* Track the max {trx_id, undo_no} for truncating the
@@ -1819,6 +1827,8 @@ trx_purge_attach_undo_recs(
 			break;
 		}
 
+		++n_recs;
+
 		table_id_t	table_id;
 
 		table_id = trx_undo_rec_get_table_id(rec.undo_rec);
@@ -1850,31 +1860,85 @@ trx_purge_attach_undo_recs(
 
 	/* Objective is to ensure that all the table entries in one
 	batch are handled by the same thread. Ths is to avoid contention
-	on the dict_index_t::lock */
+	on the dict_index_t::lock. Threads that would get no records are
+	not woken up at all; at least one thread is always run, so that
+	the batch is completed in the usual way. */
 
-	GroupBy::const_iterator	end = group_by.cend();
+	*n_used = std::max(
+		ulint{1}, std::min(n_purge_threads,
+				 static_cast<ulint>(group_by.size())));
 
-	for (GroupBy::const_iterator it = group_by.cbegin(); it != end; ) {
+	using Groups = std::vector<
+		purge_node_t::Recs*, mem_heap_allocator<purge_node_t::Recs*>>;
 
-		for (ulint i = 0; i < n_purge_threads && it != end; ++i, ++it) {
+	Groups		groups{mem_heap_allocator<purge_node_t::Recs*>{heap}};
 
-			purge_node_t*	node;
+	groups.reserve(group_by.size());
 
-			node = static_cast<purge_node_t*>(run_thrs[i]->child);
+	for (const auto& group : group_by) {
+		groups.push_back(group.second);
+	}
 
-			ut_a(que_node_get_type(node) == QUE_NODE_PURGE);
+	std::stable_sort(
+		groups.begin(), groups.end(),
+		[](const purge_node_t::Recs* lhs,
+		   const purge_node_t::Recs* rhs) {
+			return(lhs->size() > rhs->size());
+		});
 
-			if (node->recs == nullptr) {
-				node->recs = it->second;
-			} else {
-				node->recs->insert(
-					std::end(*node->recs),
-					std::begin(*it->second),
-					std::end(*it->second));
+	ulint		n_thread_recs[MAX_PURGE_THREADS];
+
+	for (ulint i = 0; i < *n_used; ++i) {
+		n_thread_recs[i] = 0;
+	}
+
+	for (purge_node_t::Recs* recs : groups) {
+
+		/* Pick the thread with the least work assigned so far. */
+		ulint	least = 0;
+
+		for (ulint i = 1; i < *n_used; ++i) {
+			if (n_thread_recs[i] < n_thread_recs[least]) {
+				least = i;
 			}
 		}
+
+		n_thread_recs[least] += recs->size();
+
+		purge_node_t*	node;
+
+		node = static_cast<purge_node_t*>(run_thrs[least]->child);
+
+		ut_a(que_node_get_type(node) == QUE_NODE_PURGE);
+
+		if (node->recs == nullptr) {
+			node->recs = recs;
+		} else {
+			node->recs->insert(
+				std::end(*node->recs),
+				std::begin(*recs),
+				std::end(*recs));
+		}
+	}
+
+	ulint		max_thread_recs = 0;
+
+	for (ulint i = 0; i < *n_used; ++i) {
+
+		purge_node_t*	node;
+
+		node = static_cast<purge_node_t*>(run_thrs[i]->child);
+
+		node->done = false;
+
+		max_thread_recs = std::max(max_thread_recs, n_thread_recs[i]);
 	}
 
+	MONITOR_SET(MONITOR_PURGE_N_THREADS, *n_used);
+	MONITOR_SET(MONITOR_PURGE_N_TABLES, group_by.size());
+	MONITOR_SET(MONITOR_PURGE_MAX_THREAD_RECS, max_thread_recs);
+	MONITOR_INC_VALUE(MONITOR_PURGE_N_RECS, n_recs);
+
 	ut_ad(trx_purge_check_limit());
 
 	return(n_pages_handled);
@@ -2010,9 +2074,10 @@ trx_purge(
 	}
 #endif /* UNIV_DEBUG */
 
-	/* Fetch the UNDO recs that need to be purged. */
+	/* Fetch the UNDO recs that need to be purged. Only the threads
+that were given records are run. */
 	n_pages_handled = trx_purge_attach_undo_recs(
-		n_purge_threads, purge_sys, batch_size);
+		n_purge_threads, purge_sys, batch_size, &n_purge_threads);
 
 	/* Do we do an asynchronous purge or not ? */
 	if (n_purge_threads > 1) {
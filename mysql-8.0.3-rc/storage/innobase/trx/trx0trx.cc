@@ -245,6 +245,8 @@ struct TrxFactory {
 
 		new(&trx->hit_list) hit_list_t();
 
+		new(&trx->in_serialisation_queue) std::atomic<bool>(false);
+
 		trx_init(trx);
 
 		trx->state = TRX_STATE_NOT_STARTED;
@@ -268,6 +270,8 @@ struct TrxFactory {
 		mutex_create(LATCH_ID_TRX, &trx->mutex);
 		mutex_create(LATCH_ID_TRX_UNDO, &trx->undo_mutex);
 
+		trx->serialisation_event = os_event_create(0);
+
 		lock_trx_alloc_locks(trx);
 	}
 
@@ -299,6 +303,8 @@ struct TrxFactory {
 		mutex_free(&trx->mutex);
 		mutex_free(&trx->undo_mutex);
 
+		os_event_destroy(trx->serialisation_event);
+
 		trx->mod_tables.~trx_mod_tables_t();
 
 		ut_ad(trx->read_view == NULL);
@@ -665,6 +671,10 @@ trx_disconnect_from_mysql(
 	trx_t*	trx,
 	bool	prepared)
 {
+	if (trx->read_view != NULL) {
+		trx_sys->mvcc->view_close(trx->read_view, true);
+	}
+
 	trx_sys_mutex_enter();
 
 	ut_ad(trx->in_mysql_trx_list);
@@ -672,10 +682,6 @@ trx_disconnect_from_mysql(
 
 	UT_LIST_REMOVE(trx_sys->mysql_trx_list, trx);
 
-	if (trx->read_view != NULL) {
-		trx_sys->mvcc->view_close(trx->read_view, true);
-	}
-
 	ut_ad(trx_sys_validate_trx_list());
 
 	if (prepared) {
@@ -1106,6 +1112,12 @@ trx_lists_init_at_db_start(void)
 
 		UT_LIST_ADD_FIRST(trx_sys->rw_trx_list, it->m_trx);
 	}
+
+	trx_sys_mutex_enter();
+
+	trx_sys->mvcc->publish_snapshot();
+
+	trx_sys_mutex_exit();
 }
 
 /** Get next redo rollback segment in round-robin fashion.
@@ -1308,6 +1320,8 @@ trx_assign_rseg_temp(
 
 		trx_sys->rw_trx_ids.push_back(trx->id);
 
+		trx_sys->mvcc->publish_snapshot();
+
 		trx_sys->rw_trx_set.insert(TrxTrack(trx->id, trx));
 
 		mutex_exit(&trx_sys->mutex);
@@ -1410,6 +1424,8 @@ trx_start_low(
 
 		trx_sys->rw_trx_ids.push_back(trx->id);
 
+		trx_sys->mvcc->publish_snapshot();
+
 		trx_sys_rw_trx_add(trx);
 
 		ut_ad(trx->rsegs.m_redo.rseg != 0
@@ -1450,6 +1466,8 @@ trx_start_low(
 
 				trx_sys->rw_trx_ids.push_back(trx->id);
 
+				trx_sys->mvcc->publish_snapshot();
+
 				trx_sys->rw_trx_set.insert(
 					TrxTrack(trx->id, trx));
 
@@ -1478,66 +1496,150 @@ trx_start_low(
 	MONITOR_INC(MONITOR_TRX_ACTIVE);
 }
 
-/****************************************************************//**
-Set the transaction serialisation number.
-@return true if the transaction number was added to the serialisation_list. */
+/** Get the rollback segment of a committing transaction whose history is
+written with redo logging, if it needs a serialisation number.
+@param[in]	trx	transaction
+@return rollback segment, or NULL */
+static inline
+trx_rseg_t*
+trx_serialisation_redo_rseg(
+	const trx_t*	trx)
+{
+	return(trx->rsegs.m_redo.update_undo != NULL
+	       ? trx->rsegs.m_redo.rseg : NULL);
+}
+
+/** Get the temporary rollback segment of a committing transaction, if it
+needs a serialisation number.
+@param[in]	trx	transaction
+@return rollback segment, or NULL */
+static inline
+trx_rseg_t*
+trx_serialisation_temp_rseg(
+	const trx_t*	trx)
+{
+	return(trx->rsegs.m_noredo.update_undo != NULL
+	       ? trx->rsegs.m_noredo.rseg : NULL);
+}
+
+/** Add the rollback segments of a committing transaction to the purge
+queue if this is the first undo log being written to them. If a rollback
+segment is not empty then the new trx_t::no can't be less than any
+trx_t::no already in the rollback segment. User threads only produce events
+when a rollback segment is empty.
+@param[in]	trx	transaction that was assigned trx_t::no
+@param[in]	push	false to only check if something would be pushed
+@return true if there was something to push */
 static
 bool
-trx_serialisation_number_get(
-/*=========================*/
-	trx_t*		trx,			/*!< in/out: transaction */
-	trx_undo_ptr_t*	redo_rseg_undo_ptr,	/*!< in/out: Set trx
-						serialisation number in
-						referred undo rseg. */
-	trx_undo_ptr_t*	temp_rseg_undo_ptr)	/*!< in/out: Set trx
-						serialisation number in
-						referred undo rseg. */
+trx_serialisation_push_to_purge(
+	const trx_t*	trx,
+	bool		push)
 {
-	bool		added_trx_no;
-	trx_rseg_t*	redo_rseg = 0;
-	trx_rseg_t*	temp_rseg = 0;
+	trx_rseg_t*	redo_rseg = trx_serialisation_redo_rseg(trx);
+	trx_rseg_t*	temp_rseg = trx_serialisation_temp_rseg(trx);
+
+	/* The rollback segment mutexes are held by the committing threads,
+	which wait until the whole batch has been processed. */
+	ut_ad(redo_rseg == NULL || mutex_own(&redo_rseg->mutex)
+	      || trx->in_serialisation_queue.load(std::memory_order_relaxed));
+	ut_ad(temp_rseg == NULL || mutex_own(&temp_rseg->mutex)
+	      || trx->in_serialisation_queue.load(std::memory_order_relaxed));
+
+	bool	redo_empty = redo_rseg != NULL
+		&& redo_rseg->last_page_no == FIL_NULL;
+	bool	temp_empty = temp_rseg != NULL
+		&& temp_rseg->last_page_no == FIL_NULL;
 
-	if (redo_rseg_undo_ptr != NULL) {
-		ut_ad(mutex_own(&redo_rseg_undo_ptr->rseg->mutex));
-		redo_rseg = redo_rseg_undo_ptr->rseg;
+	if (!redo_empty && !temp_empty) {
+		return(false);
 	}
 
-	if (temp_rseg_undo_ptr != NULL) {
-		ut_ad(mutex_own(&temp_rseg_undo_ptr->rseg->mutex));
-		temp_rseg = temp_rseg_undo_ptr->rseg;
+	if (push) {
+		ut_ad(mutex_own(&purge_sys->pq_mutex));
+
+		TrxUndoRsegs	elem(trx->no);
+
+		if (redo_empty) {
+			elem.push_back(redo_rseg);
+		}
+
+		if (temp_empty) {
+			elem.push_back(temp_rseg);
+		}
+
+		purge_sys->purge_queue->push(elem);
 	}
 
-	trx_sys_mutex_enter();
+	return(true);
+}
 
-	trx->no = trx_sys_get_new_trx_id();
+/** Let the committing threads of a batch continue. A transaction can be
+reused as soon as its flag is cleared, so its link and event are read
+first. The events are never freed while the server runs.
+@param[in,out]	batch	transactions that were assigned trx_t::no */
+static
+void
+trx_serialisation_queue_release(
+	trx_t*	batch)
+{
+	while (batch != NULL) {
+		trx_t*		next = batch->serialisation_next;
+		os_event_t	event = batch->serialisation_event;
 
-	/* Track the minimum serialisation number. */
-	if (!trx->read_only) {
-		UT_LIST_ADD_LAST(trx_sys->serialisation_list, trx);
-		added_trx_no = true;
-	} else {
-		added_trx_no = false;
+		batch->in_serialisation_queue.store(
+			false, std::memory_order_release);
+
+		os_event_set(event);
+
+		batch = next;
 	}
+}
 
-	/* If the rollack segment is not empty then the
-	new trx_t::no can't be less than any trx_t::no
-	already in the rollback segment. User threads only
-	produce events when a rollback segment is empty. */
-	if ((redo_rseg != NULL && redo_rseg->last_page_no == FIL_NULL)
-	    || (temp_rseg != NULL && temp_rseg->last_page_no == FIL_NULL)) {
+/** Assign serialisation numbers to a batch of transactions that were
+taken from trx_sys->serialisation_queue. The transactions were pushed by
+concurrent commits, so they all hold different rollback segment mutexes
+and can be numbered in any order. Only the leader of the batch acquires
+trx_sys->mutex, and purge_sys->pq_mutex if needed, once for the whole
+batch. The other committing threads of the batch wait on their
+serialisation events, without acquiring either mutex.
+@param[in,out]	leader	transaction that was pushed to the empty queue */
+static
+void
+trx_serialisation_queue_process(
+	trx_t*	leader)
+{
+	trx_sys_mutex_enter();
 
-		TrxUndoRsegs	elem(trx->no);
+	/* No other leader can have taken the queue after the leader
+	pushed to it: the next leader is the first one that pushes to
+	the queue that is emptied here. */
+	trx_t*	batch = trx_sys->serialisation_queue.exchange(NULL);
+	bool	push = false;
 
-		if (redo_rseg != NULL && redo_rseg->last_page_no == FIL_NULL) {
-			elem.push_back(redo_rseg);
-		}
+	ut_d(bool found = false);
 
-		if (temp_rseg != NULL
-		    && temp_rseg->last_page_no == FIL_NULL) {
+	for (trx_t* trx = batch; trx != NULL; trx = trx->serialisation_next) {
 
-			elem.push_back(temp_rseg);
+		ut_ad(trx->in_serialisation_queue.load(
+			std::memory_order_relaxed));
+		ut_d(found |= trx == leader);
+
+		trx->no = trx_sys_get_new_trx_id();
+
+		/* Track the minimum serialisation number. */
+		if (!trx->read_only) {
+			UT_LIST_ADD_LAST(trx_sys->serialisation_list, trx);
 		}
 
+		if (!push) {
+			push = trx_serialisation_push_to_purge(trx, false);
+		}
+	}
+
+	ut_ad(found);
+
+	if (push) {
 		mutex_enter(&purge_sys->pq_mutex);
 
 		/* This is to reduce the pressure on the trx_sys_t::mutex
@@ -1547,14 +1649,78 @@ trx_serialisation_number_get(
 
 		trx_sys_mutex_exit();
 
-		purge_sys->purge_queue->push(elem);
+		for (trx_t* trx = batch; trx != NULL;
+		     trx = trx->serialisation_next) {
+
+			trx_serialisation_push_to_purge(trx, true);
+		}
 
 		mutex_exit(&purge_sys->pq_mutex);
 	} else {
 		trx_sys_mutex_exit();
 	}
 
-	return(added_trx_no);
+	trx_serialisation_queue_release(batch);
+}
+
+/****************************************************************//**
+Set the transaction serialisation number. Transactions that commit at the
+same time are numbered in batches: each one is pushed to
+trx_sys->serialisation_queue. The one that finds the queue empty becomes
+the leader of the batch. It acquires trx_sys->mutex and numbers all the
+transactions that were queued meanwhile. The others wait for the leader
+on their serialisation events, without spinning and without acquiring
+trx_sys->mutex.
+@return true if the transaction number was added to the serialisation_list. */
+static
+bool
+trx_serialisation_number_get(
+/*=========================*/
+	trx_t*		trx)	/*!< in/out: transaction */
+{
+	ut_ad(trx_serialisation_redo_rseg(trx) == NULL
+	      || mutex_own(&trx_serialisation_redo_rseg(trx)->mutex));
+	ut_ad(trx_serialisation_temp_rseg(trx) == NULL
+	      || mutex_own(&trx_serialisation_temp_rseg(trx)->mutex));
+
+	trx->in_serialisation_queue.store(true, std::memory_order_relaxed);
+
+	trx_t*	head = trx_sys->serialisation_queue.load(
+		std::memory_order_relaxed);
+
+	do {
+		trx->serialisation_next = head;
+	} while (!trx_sys->serialisation_queue.compare_exchange_weak(
+			 head, trx, std::memory_order_release,
+			 std::memory_order_relaxed));
+
+	if (head == NULL) {
+		DEBUG_SYNC_C("trx_serialisation_leader");
+
+		trx_serialisation_queue_process(trx);
+
+	} else {
+		DEBUG_SYNC_C("trx_serialisation_follower");
+
+		while (trx->in_serialisation_queue.load(
+			       std::memory_order_acquire)) {
+
+			int64_t	sig_count = os_event_reset(
+				trx->serialisation_event);
+
+			if (!trx->in_serialisation_queue.load(
+				    std::memory_order_acquire)) {
+				break;
+			}
+
+			os_event_wait_low(trx->serialisation_event, sig_count);
+		}
+	}
+
+	ut_ad(!trx->in_serialisation_queue.load(std::memory_order_acquire));
+	ut_ad(trx->no != TRX_ID_MAX);
+
+	return(!trx->read_only);
 }
 
 /****************************************************************//**
@@ -1623,17 +1789,8 @@ trx_write_serialisation_history(
 		if this is the first UNDO log being written to assigned
 		rollback segments. */
 
-		trx_undo_ptr_t* redo_rseg_undo_ptr =
-			trx->rsegs.m_redo.update_undo != NULL
-			? &trx->rsegs.m_redo : NULL;
-
-		trx_undo_ptr_t* temp_rseg_undo_ptr =
-			trx->rsegs.m_noredo.update_undo != NULL
-			? &trx->rsegs.m_noredo : NULL;
-
 		/* Will set trx->no and will add rseg to purge queue. */
-		serialised = trx_serialisation_number_get(
-			trx, redo_rseg_undo_ptr, temp_rseg_undo_ptr);
+		serialised = trx_serialisation_number_get(trx);
 
 		/* It is not necessary to obtain trx->undo_mutex here because
 		only a single OS thread is allowed to do the transaction commit
@@ -1667,7 +1824,8 @@ trx_write_serialisation_history(
 				trx->rsegs.m_noredo.update_undo, &temp_mtr);
 
 			ulint n_added_logs =
-				(redo_rseg_undo_ptr != NULL) ? 2 : 1;
+				(trx->rsegs.m_redo.update_undo != NULL)
+				? 2 : 1;
 
 			trx_undo_update_cleanup(
 				trx, &trx->rsegs.m_noredo, undo_hdr_page,
@@ -1895,6 +2053,10 @@ trx_erase_lists(
 	ut_ad(*it == trx->id);
 	trx_sys->rw_trx_ids.erase(it);
 
+	trx_sys->mvcc->publish_snapshot();
+
+	bool	close_view = false;
+
 	if (trx->read_only || trx->rsegs.m_redo.rseg == NULL) {
 
 		ut_ad(!trx->in_rw_trx_list);
@@ -1904,14 +2066,17 @@ trx_erase_lists(
 		ut_d(trx->in_rw_trx_list = false);
 		ut_ad(trx_sys_validate_trx_list());
 
-		if (trx->read_view != NULL) {
-			trx_sys->mvcc->view_close(trx->read_view, true);
-		}
+		close_view = (trx->read_view != NULL);
 	}
 
 	trx_sys->rw_trx_set.erase(TrxTrack(trx->id));
 
 	trx_sys_mutex_exit();
+
+	/* The view lists are not protected by trx_sys->mutex. */
+	if (close_view) {
+		trx_sys->mvcc->view_close(trx->read_view, true);
+	}
 }
 
 /****************************************************************//**
@@ -3190,6 +3355,8 @@ trx_set_rw_mode(
 
 	trx_sys->rw_trx_ids.push_back(trx->id);
 
+	trx_sys->mvcc->publish_snapshot();
+
 	trx_sys->rw_trx_set.insert(TrxTrack(trx->id, trx));
 
 	/* So that we can see our own changes. */
@@ -42,6 +42,7 @@ PSI_memory_key	mem_key_dict_stats_bg_recalc_pool_t;
 PSI_memory_key	mem_key_dict_stats_index_map_t;
 PSI_memory_key	mem_key_dict_stats_n_diff_on_level;
 PSI_memory_key	mem_key_other;
+PSI_memory_key	mem_key_page_search_cache;
 PSI_memory_key	mem_key_partitioning;
 PSI_memory_key	mem_key_row_log_buf;
 PSI_memory_key	mem_key_row_merge_sort;
@@ -75,6 +76,7 @@ static PSI_memory_info	pfs_info[] = {
 	{&mem_key_dict_stats_index_map_t, "dict_stats_index_map_t", 0, 0, PSI_DOCUMENT_ME},
 	{&mem_key_dict_stats_n_diff_on_level, "dict_stats_n_diff_on_level", 0, 0, PSI_DOCUMENT_ME},
 	{&mem_key_other, "other", 0, 0, PSI_DOCUMENT_ME},
+	{&mem_key_page_search_cache, "page_search_cache", 0, 0, PSI_DOCUMENT_ME},
 	{&mem_key_partitioning, "partitioning", 0, 0, PSI_DOCUMENT_ME},
 	{&mem_key_row_log_buf, "row_log_buf", 0, 0, PSI_DOCUMENT_ME},
 	{&mem_key_row_merge_sort, "row_merge_sort", 0, 0, PSI_DOCUMENT_ME},
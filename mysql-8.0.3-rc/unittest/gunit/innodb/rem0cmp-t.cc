@@ -0,0 +1,165 @@
+/* Copyright (c) 2017, Oracle and/or its affiliates. All rights reserved.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA */
+
+/* See http://code.google.com/p/googletest/wiki/Primer */
+
+// First include (the generated) my_config.h, to get correct platform defines.
+#include "my_config.h"
+
+#include <string.h>
+
+#include <gtest/gtest.h>
+
+#include "univ.i"
+
+#include "data0type.h"
+#include "rem0cmp.h"
+
+namespace innodb_rem0cmp_unittest {
+
+/** Longest string that the tests compare */
+static const ulint	MAX_LEN = 40;
+
+/** Pairs of differing bytes, the first one less than the second one.
+They differ in the lowest bit, in the highest bit, and in all bits. */
+static const byte	diff_bytes[][2] = {
+	{0x00, 0x01},
+	{0x7f, 0x80},
+	{0x01, 0x81},
+	{0xfe, 0xff},
+	{0x00, 0xff},
+};
+
+/** Get the sign of a comparison result.
+@param[in]	cmp	comparison result
+@return -1, 0 or 1 */
+static
+int
+cmp_sign(
+	int	cmp)
+{
+	return((cmp > 0) - (cmp < 0));
+}
+
+/** Check that cmp_data_data() orders two strings like memcmp() for the
+column types that are compared byte by byte, in both orders.
+@param[in]	a	string
+@param[in]	b	string
+@param[in]	len	length of a and b */
+static
+void
+check_memcmp_order(
+	const byte*	a,
+	const byte*	b,
+	ulint		len)
+{
+	static const ulint	binary = dtype_form_prtype(
+		DATA_BINARY_TYPE, DATA_MYSQL_BINARY_CHARSET_COLL);
+	static const struct {
+		ulint	mtype;
+		ulint	prtype;
+	} types[] = {
+		{DATA_FIXBINARY, binary},
+		{DATA_BINARY, binary},
+		{DATA_INT, DATA_UNSIGNED},
+		{DATA_SYS, DATA_NOT_NULL},
+	};
+
+	const int	expected = cmp_sign(memcmp(a, b, len));
+
+	for (ulint i = 0; i < UT_ARR_SIZE(types); i++) {
+		EXPECT_EQ(expected, cmp_sign(cmp_data_data(
+			types[i].mtype, types[i].prtype, true,
+			a, len, b, len)))
+			<< "mtype " << types[i].mtype << " len " << len;
+
+		EXPECT_EQ(-expected, cmp_sign(cmp_data_data(
+			types[i].mtype, types[i].prtype, false,
+			a, len, b, len)))
+			<< "mtype " << types[i].mtype << " len " << len;
+	}
+}
+
+/* Test that cmp_data_data() orders binary strings of 0..MAX_LEN bytes
+like memcmp(), when they differ in any byte: in an 8-byte word, in the
+4-byte tail or in the byte tail of the word comparison, or beyond the
+length that is compared a word at a time. */
+TEST(rem0cmp, cmpdatamemcmporder)
+{
+	byte	a[MAX_LEN];
+	byte	b[MAX_LEN];
+
+	for (ulint len = 0; len <= MAX_LEN; len++) {
+
+		for (ulint i = 0; i < len; i++) {
+			a[i] = static_cast<byte>(i * 37 + 11);
+		}
+
+		memcpy(b, a, len);
+
+		check_memcmp_order(a, b, len);
+
+		for (ulint pos = 0; pos < len; pos++) {
+
+			for (ulint d = 0; d < UT_ARR_SIZE(diff_bytes); d++) {
+
+				a[pos] = diff_bytes[d][0];
+				b[pos] = diff_bytes[d][1];
+
+				check_memcmp_order(a, b, len);
+				check_memcmp_order(b, a, len);
+
+				/* The first difference decides, whatever
+				follows it. */
+				for (ulint i = pos + 1; i < len; i++) {
+					a[i] = 0xff;
+					b[i] = 0x00;
+				}
+
+				check_memcmp_order(a, b, len);
+				check_memcmp_order(b, a, len);
+
+				for (ulint i = pos; i < len; i++) {
+					a[i] = b[i] = static_cast<byte>(
+						i * 37 + 11);
+				}
+			}
+		}
+	}
+}
+
+/* Test that a binary string that is a prefix of another one is less. */
+TEST(rem0cmp, cmpdataprefix)
+{
+	static const ulint	binary = dtype_form_prtype(
+		DATA_BINARY_TYPE, DATA_MYSQL_BINARY_CHARSET_COLL);
+	byte			a[MAX_LEN];
+
+	for (ulint i = 0; i < MAX_LEN; i++) {
+		a[i] = static_cast<byte>(0xff - i);
+	}
+
+	for (ulint len1 = 0; len1 <= MAX_LEN; len1++) {
+		for (ulint len2 = 0; len2 <= MAX_LEN; len2++) {
+			int	expected = cmp_sign(int(len1) - int(len2));
+
+			EXPECT_EQ(expected, cmp_sign(cmp_data_data(
+				DATA_BINARY, binary, true,
+				a, len1, a, len2)));
+		}
+	}
+}
+
+}
@@ -2165,6 +2165,48 @@ TEST(ut0crc32, basic)
 	delete[] buf;
 }
 
+/* test ut_crc32() on lengths around the interleaving thresholds */
+TEST(ut0crc32, lengths)
+{
+	init();
+
+	for (size_t len = 0; len <= page_size; len += 1 + len / 7) {
+		for (size_t offset = 0; offset < 8 && offset + len <= page_size;
+		     offset++) {
+
+			EXPECT_EQ(ut_crc32_byte_by_byte(page + offset, len),
+				  ut_crc32(page + offset, len));
+		}
+	}
+}
+
+/* test ut_crc32_batch() */
+TEST(ut0crc32, batch)
+{
+	init();
+
+	static const size_t	n_bufs = 7;
+	const byte*		bufs[n_bufs];
+	uint32_t		crcs[n_bufs];
+
+	for (size_t len = 0; len <= page_size - n_bufs;
+	     len += 1 + len / 3) {
+
+		for (size_t i = 0; i < n_bufs; i++) {
+			bufs[i] = page + i;
+		}
+
+		for (size_t n = 0; n <= n_bufs; n++) {
+
+			ut_crc32_batch(bufs, len, n, crcs);
+
+			for (size_t i = 0; i < n; i++) {
+				EXPECT_EQ(ut_crc32(bufs[i], len), crcs[i]);
+			}
+		}
+	}
+}
+
 static void BM_CRC32(size_t num_iterations)
 {
 	StopBenchmarkTiming();
@@ -2199,4 +2241,30 @@ static void BM_BigEndianCRC32(size_t num_iterations)
 }
 BENCHMARK(BM_BigEndianCRC32);
 
+static void BM_CRC32_batch(size_t num_iterations)
+{
+	StopBenchmarkTiming();
+	init();
+
+	static const size_t	n_bufs = 8;
+	const byte*		bufs[n_bufs];
+	uint32_t		crcs[n_bufs];
+
+	for (size_t i = 0; i < n_bufs; i++) {
+		bufs[i] = page;
+	}
+
+	StartBenchmarkTiming();
+	size_t sum = 0;
+	for (size_t n = 0; n < num_iterations; n++) {
+		ut_crc32_batch(bufs, sizeof(page), n_bufs, crcs);
+		sum += crcs[n % n_bufs];
+	}
+	StopBenchmarkTiming();
+
+	EXPECT_NE(0U, sum);  // To keep the compiler from optimizing it away.
+	SetBytesProcessed(num_iterations * n_bufs * sizeof(page));
+}
+BENCHMARK(BM_CRC32_batch);
+
 }  // namespace
@@ -258,7 +258,7 @@ bool page_decompress(
 
 	/* Set the dblwr recover flag to false. */
 	err = os_file_decompress_page(
-		false, buf, scratch, page_size.physical());
+		false, buf, scratch, page_size.physical(), NULL);
 
 	return(err == DB_SUCCESS);
 }